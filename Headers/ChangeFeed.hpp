@@ -0,0 +1,533 @@
+/**
+ * ChangeFeed.hpp
+ *
+ * Change-data-capture feed of catalog mutations.
+ *
+ * After Engine::enableChangeFeed(), every insert, erase or field update the
+ * engine applies (upsertProduct, eraseProduct, load with a mutation log, or
+ * a replica applying its primary's log) is recorded as a ChangeEvent.
+ * Events are held for a short window and coalesced per Uniq Id, then
+ * delivered in batches to in-process subscribers (callbacks) and, through
+ * ChangeFeedServer, to socket clients (ChangeFeedClient). A cache keeps
+ * itself current by dropping or refetching just the ids in each batch
+ * instead of polling `find` over every id.
+ *
+ * Coalescing within one window (first event, later event -> delivered):
+ * - insert, update -> insert      - update, update -> update (fields ORed)
+ * - insert, erase  -> nothing     - update, erase  -> erase
+ * - erase, insert  -> update (all fields)
+ * Each delivered event carries the sequence number of the last mutation
+ * merged into it; sequence numbers start at 1 and increase per mutation.
+ *
+ * Socket stream (endpoints as in Net.hpp), server -> client only:
+ *   batch header: u32 magic 'ICDC', u32 event count, u32 payload bytes,
+ *                 u32 reserved
+ *   event:        u8 kind, u16 changed fields, u64 sequence, u16 id length,
+ *                 id bytes
+ * The feed is live, not durable: a client receives the batches delivered
+ * while it is connected. A client that falls kMaxQueuedBatches behind is
+ * disconnected.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "HashTable.hpp"
+#include "MappedHashTable.hpp"
+#include "Net.hpp"
+
+namespace inv {
+
+/**
+ * ChangeEvent - One (coalesced) change to a product
+ */
+struct ChangeEvent {
+    enum Kind : std::uint8_t { None = 0, Insert = 1, Update = 2, Erase = 3 };
+
+    /** Bits of `fields`: which product fields an update changed */
+    enum Field : std::uint16_t {
+        ProductName = 1 << 0,
+        BrandName = 1 << 1,
+        Category = 1 << 2,
+        ListPrice = 1 << 3,
+        SellingPrice = 1 << 4,
+        Quantity = 1 << 5,
+        Asin = 1 << 6,
+        ModelNumber = 1 << 7,
+        Description = 1 << 8,
+        Stock = 1 << 9,
+        AllFields = (1 << 10) - 1
+    };
+
+    Kind kind {None};
+    std::uint16_t fields {0};    // AllFields for inserts, 0 for erases
+    std::uint64_t sequence {0};  // Last mutation merged into this event
+    std::string id;              // Uniq Id
+};
+
+/**
+ * Fields that differ between two versions of a product
+ *
+ * @return Mask of ChangeEvent::Field bits (0 if nothing changed)
+ */
+inline std::uint16_t changedFields(const Product &before, const Product &after) {
+    std::uint16_t f = 0;
+    if (before.productName != after.productName) f |= ChangeEvent::ProductName;
+    if (before.brandName != after.brandName) f |= ChangeEvent::BrandName;
+    if (before.category != after.category || before.categories != after.categories) f |= ChangeEvent::Category;
+    if (!(before.listPrice == after.listPrice)) f |= ChangeEvent::ListPrice;
+    if (!(before.sellingPrice == after.sellingPrice)) f |= ChangeEvent::SellingPrice;
+    if (!(before.quantity == after.quantity)) f |= ChangeEvent::Quantity;
+    if (!(before.asin == after.asin)) f |= ChangeEvent::Asin;
+    if (before.modelNumber != after.modelNumber) f |= ChangeEvent::ModelNumber;
+    if (before.productDescription != after.productDescription) f |= ChangeEvent::Description;
+    if (!(before.stock == after.stock)) f |= ChangeEvent::Stock;
+    return f;
+}
+
+/**
+ * Print an event as one line: "<sequence> <insert|update|erase> <id>
+ * [field,field,...]"
+ */
+inline void printChangeEvent(const ChangeEvent &e, std::ostream &out) {
+    static const char *const kKinds[] = {"none", "insert", "update", "erase"};
+    static const char *const kFields[] = {"productName", "brandName", "category", "listPrice", "sellingPrice",
+                                          "quantity", "asin", "modelNumber", "description", "stock"};
+    out << e.sequence << ' ' << kKinds[e.kind <= ChangeEvent::Erase ? e.kind : 0] << ' ' << e.id;
+    if (e.kind == ChangeEvent::Update) {
+        const char *sep = " ";
+        for (int b = 0; b < 10; ++b) {
+            if (e.fields & (1u << b)) { out << sep << kFields[b]; sep = ","; }
+        }
+    }
+    out << '\n';
+}
+
+namespace cdc {
+
+constexpr std::uint32_t kBatchMagic = 0x43444349u;  // "ICDC"
+constexpr std::size_t kBatchHeaderBytes = 16;
+constexpr std::size_t kEventHeaderBytes = 13;     // kind + fields + sequence + id length
+
+/** Default coalescing window */
+constexpr std::chrono::milliseconds kDefaultWindow {50};
+
+/** Default batch size at which a window is cut short */
+constexpr std::size_t kDefaultMaxBatch = 4096;
+
+/** Batches a socket client may fall behind before it is disconnected */
+constexpr std::size_t kMaxQueuedBatches = 1024;
+
+/** Encode a batch (header and events) for the socket stream */
+inline std::string encodeBatch(const std::vector<ChangeEvent> &events) {
+    std::string out(kBatchHeaderBytes, '\0');
+    for (const auto &e : events) {
+        std::uint16_t fields = e.fields;
+        std::uint16_t idLen = static_cast<std::uint16_t>(std::min<std::size_t>(e.id.size(), 0xFFFF));
+        out.push_back(static_cast<char>(e.kind));
+        out.append(reinterpret_cast<const char *>(&fields), sizeof fields);
+        mapped::put64(out, e.sequence);
+        out.append(reinterpret_cast<const char *>(&idLen), sizeof idLen);
+        out.append(e.id, 0, idLen);
+    }
+    std::uint32_t head[4] = {kBatchMagic, static_cast<std::uint32_t>(events.size()),
+                             static_cast<std::uint32_t>(out.size() - kBatchHeaderBytes), 0};
+    std::memcpy(&out[0], head, sizeof head);
+    return out;
+}
+
+/**
+ * Decode a batch payload (the bytes after the header)
+ * @return false if the payload is malformed
+ */
+inline bool decodeEvents(const std::string &payload, std::uint32_t count, std::vector<ChangeEvent> &events) {
+    events.resize(count);
+    const char *p = payload.data();
+    const char *end = p + payload.size();
+    for (auto &e : events) {
+        if (static_cast<std::size_t>(end - p) < kEventHeaderBytes) return false;
+        std::uint16_t fields, idLen;
+        e.kind = static_cast<ChangeEvent::Kind>(static_cast<std::uint8_t>(p[0]));
+        std::memcpy(&fields, p + 1, sizeof fields);
+        e.fields = fields;
+        e.sequence = mapped::load64(p + 3);
+        std::memcpy(&idLen, p + 11, sizeof idLen);
+        p += kEventHeaderBytes;
+        if (static_cast<std::size_t>(end - p) < idLen || e.kind == ChangeEvent::None || e.kind > ChangeEvent::Erase) return false;
+        e.id.assign(p, idLen);
+        p += idLen;
+    }
+    return p == end;
+}
+
+} // namespace cdc
+
+/**
+ * ChangeFeed - Coalesces change events and delivers them in batches
+ *
+ * record() is called by the engine under its catalog lock. A background
+ * thread delivers a batch once the oldest pending event is `window` old, or
+ * sooner when `maxBatch` distinct ids are pending. Subscribers run on that
+ * thread (or on the thread calling flush()), one batch at a time, in order.
+ */
+class ChangeFeed {
+public:
+    using Callback = std::function<void(const std::vector<ChangeEvent> &)>;
+
+    /** Counters since construction */
+    struct Stats {
+        std::uint64_t mutations {0};  // record() calls
+        std::uint64_t coalesced {0};  // Mutations merged into a pending event
+        std::uint64_t events {0};     // Events delivered
+        std::uint64_t batches {0};    // Batches delivered
+    };
+
+    /**
+     * @param window How long events are held for coalescing
+     * @param maxBatch Pending ids that cut a window short
+     */
+    explicit ChangeFeed(std::chrono::milliseconds window = cdc::kDefaultWindow, std::size_t maxBatch = cdc::kDefaultMaxBatch)
+        : window_(window), maxBatch_(maxBatch == 0 ? 1 : maxBatch), thread_([this]() { run(); }) {}
+
+    ~ChangeFeed() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        ready_.notify_all();
+        thread_.join();
+    }
+
+    ChangeFeed(const ChangeFeed &) = delete;
+    ChangeFeed &operator=(const ChangeFeed &) = delete;
+
+    /**
+     * Record one mutation
+     *
+     * @param kind Insert, Update or Erase
+     * @param id Uniq Id
+     * @param fields Changed fields (Update only)
+     *
+     * Time Complexity: O(1) average
+     */
+    void record(ChangeEvent::Kind kind, const std::string &id, std::uint16_t fields = 0) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++stats_.mutations;
+        std::uint64_t sequence = ++sequence_;
+        if (kind == ChangeEvent::Insert) fields = ChangeEvent::AllFields;
+        if (kind == ChangeEvent::Erase) fields = 0;
+
+        auto it = pendingIndex_.find(id);
+        if (it == pendingIndex_.end()) {
+            if (live_ == 0) oldest_ = std::chrono::steady_clock::now();
+            pendingIndex_.emplace(id, pending_.size());
+            pending_.push_back(ChangeEvent {kind, fields, sequence, id});
+            if (++live_ == 1 || live_ == maxBatch_) ready_.notify_all();
+            return;
+        }
+        ++stats_.coalesced;
+        ChangeEvent &e = pending_[it->second];
+        e.sequence = sequence;
+        if (e.kind == ChangeEvent::Insert && kind == ChangeEvent::Erase) {
+            e.kind = ChangeEvent::None;  // Never visible outside the window
+            pendingIndex_.erase(it);
+            --live_;
+        } else if (kind == ChangeEvent::Erase) {
+            e.kind = ChangeEvent::Erase;
+            e.fields = 0;
+        } else if (e.kind == ChangeEvent::Erase) {
+            e.kind = ChangeEvent::Update;
+            e.fields = ChangeEvent::AllFields;
+        } else {
+            e.fields |= fields;
+        }
+    }
+
+    /**
+     * Register a subscriber (must not call subscribe/unsubscribe itself)
+     * @return Handle for unsubscribe()
+     */
+    std::uint64_t subscribe(Callback fn) {
+        std::lock_guard<std::mutex> lock(deliverMutex_);
+        subscribers_.emplace(++lastHandle_, std::move(fn));
+        return lastHandle_;
+    }
+
+    /** Remove a subscriber; it is not called again once this returns */
+    void unsubscribe(std::uint64_t handle) {
+        std::lock_guard<std::mutex> lock(deliverMutex_);
+        subscribers_.erase(handle);
+    }
+
+    /** Deliver pending events now, on the calling thread */
+    void flush() {
+        std::lock_guard<std::mutex> lock(deliverMutex_);
+        deliver(take());
+    }
+
+    /** Counters since construction */
+    Stats stats() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return stats_;
+    }
+
+    /** Coalescing window */
+    std::chrono::milliseconds window() const { return window_; }
+
+private:
+    const std::chrono::milliseconds window_;
+    const std::size_t maxBatch_;
+
+    mutable std::mutex mutex_;  // Pending events and counters
+    std::condition_variable ready_;
+    std::vector<ChangeEvent> pending_;  // In order of first mutation; kind None = cancelled
+    std::unordered_map<std::string, std::size_t> pendingIndex_;
+    std::size_t live_ {0};
+    std::chrono::steady_clock::time_point oldest_;
+    std::uint64_t sequence_ {0};
+    Stats stats_;
+    bool stopping_ {false};
+
+    std::mutex deliverMutex_;  // Orders deliveries; guards subscribers_
+    std::map<std::uint64_t, Callback> subscribers_;
+    std::uint64_t lastHandle_ {0};
+
+    std::thread thread_;
+
+    /** Take the pending batch (deliverMutex_ held) */
+    std::vector<ChangeEvent> take() {
+        std::vector<ChangeEvent> batch;
+        std::lock_guard<std::mutex> lock(mutex_);
+        batch.reserve(live_);
+        for (auto &e : pending_) if (e.kind != ChangeEvent::None) batch.push_back(std::move(e));
+        pending_.clear();
+        pendingIndex_.clear();
+        live_ = 0;
+        if (!batch.empty()) {
+            ++stats_.batches;
+            stats_.events += batch.size();
+        }
+        return batch;
+    }
+
+    /** Call every subscriber (deliverMutex_ held) */
+    void deliver(const std::vector<ChangeEvent> &batch) {
+        if (batch.empty()) return;
+        for (auto &kv : subscribers_) kv.second(batch);
+    }
+
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (;;) {
+            ready_.wait(lock, [&]() { return stopping_ || live_ > 0; });
+            if (stopping_) return;
+            ready_.wait_until(lock, oldest_ + window_, [&]() { return stopping_ || live_ >= maxBatch_; });
+            if (stopping_) return;
+            lock.unlock();
+            flush();
+            lock.lock();
+        }
+    }
+};
+
+/**
+ * ChangeFeedServer - Streams a ChangeFeed's batches to socket clients
+ *
+ * Each client has a queue and a writer thread, so a slow client delays
+ * only itself; one that falls kMaxQueuedBatches behind is disconnected.
+ */
+class ChangeFeedServer {
+public:
+    ChangeFeedServer() = default;
+    ~ChangeFeedServer() { stop(); }
+    ChangeFeedServer(const ChangeFeedServer &) = delete;
+    ChangeFeedServer &operator=(const ChangeFeedServer &) = delete;
+
+    /**
+     * Bind and listen
+     *
+     * @param endpoint "unix:<path>" or "<host>:<port>" (port 0 = any free port)
+     * @return false if the endpoint cannot be bound
+     */
+    bool listen(const std::string &endpoint) {
+        int fd = net::listenOn(endpoint, endpoint_, unixPath_);
+        if (fd < 0) return false;
+        listenFd_ = fd;
+        return true;
+    }
+
+    /** Endpoint clients should connect to (with the actual port if 0 was given) */
+    const std::string &endpoint() const { return endpoint_; }
+
+    /** Number of connected clients */
+    std::size_t clientCount() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return clients_.size();
+    }
+
+    /**
+     * Accept clients and forward every batch of feed to them until stop()
+     *
+     * @param feed Feed to subscribe to (must outlive serve())
+     */
+    void serve(ChangeFeed &feed) {
+        std::uint64_t handle = feed.subscribe([this](const std::vector<ChangeEvent> &batch) { broadcast(batch); });
+        for (;;) {
+            int fd = ::accept4(listenFd_, nullptr, nullptr, SOCK_CLOEXEC);
+            if (fd < 0) {
+                if (stopping_ || errno != EINTR) break;
+                continue;
+            }
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (stopping_) { ::close(fd); break; }
+            std::shared_ptr<Client> c(new Client());
+            c->fd = fd;
+            clients_.push_back(c);
+            workers_.emplace_back([this, c]() { write(c); });
+        }
+        feed.unsubscribe(handle);
+        std::vector<std::thread> workers;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            workers.swap(workers_);
+        }
+        for (auto &w : workers) w.join();
+    }
+
+    /** Stop accepting, disconnect clients and unblock serve() */
+    void stop() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_ || listenFd_ < 0) return;
+        stopping_ = true;
+        ::shutdown(listenFd_, SHUT_RDWR);
+        ::close(listenFd_);
+        for (auto &c : clients_) close(*c);
+        if (!unixPath_.empty()) ::unlink(unixPath_.c_str());
+    }
+
+private:
+    struct Client {
+        int fd {-1};
+        std::mutex mutex;
+        std::condition_variable ready;
+        std::deque<std::shared_ptr<const std::string>> queue;
+        bool closed {false};
+    };
+
+    std::atomic<int> listenFd_ {-1};
+    std::string endpoint_;
+    std::string unixPath_;
+    mutable std::mutex mutex_;
+    std::atomic<bool> stopping_ {false};
+    std::vector<std::shared_ptr<Client>> clients_;
+    std::vector<std::thread> workers_;
+
+    static void close(Client &c) {
+        std::lock_guard<std::mutex> lock(c.mutex);
+        c.closed = true;
+        ::shutdown(c.fd, SHUT_RDWR);
+        c.ready.notify_all();
+    }
+
+    /** Queue one encoded batch for every client */
+    void broadcast(const std::vector<ChangeEvent> &batch) {
+        std::shared_ptr<const std::string> bytes = std::make_shared<const std::string>(cdc::encodeBatch(batch));
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto &c : clients_) {
+            std::lock_guard<std::mutex> clientLock(c->mutex);
+            if (c->closed) continue;
+            if (c->queue.size() >= cdc::kMaxQueuedBatches) {
+                c->closed = true;  // Too slow: drop it rather than buffer without bound
+                ::shutdown(c->fd, SHUT_RDWR);
+            } else {
+                c->queue.push_back(bytes);
+            }
+            c->ready.notify_all();
+        }
+    }
+
+    void write(std::shared_ptr<Client> c) {
+        for (;;) {
+            std::shared_ptr<const std::string> next;
+            {
+                std::unique_lock<std::mutex> lock(c->mutex);
+                c->ready.wait(lock, [&]() { return c->closed || !c->queue.empty(); });
+                if (c->closed) break;
+                next = std::move(c->queue.front());
+                c->queue.pop_front();
+            }
+            if (!net::sendAll(c->fd, next->data(), next->size())) break;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        clients_.erase(std::remove(clients_.begin(), clients_.end(), c), clients_.end());
+        ::close(c->fd);
+    }
+};
+
+/**
+ * ChangeFeedClient - Receives batches from a ChangeFeedServer
+ */
+class ChangeFeedClient {
+public:
+    ChangeFeedClient() = default;
+    ~ChangeFeedClient() { close(); }
+    ChangeFeedClient(const ChangeFeedClient &) = delete;
+    ChangeFeedClient &operator=(const ChangeFeedClient &) = delete;
+
+    /** @return false if the server is unreachable */
+    bool connect(const std::string &endpoint) {
+        close();
+        fd_ = net::connectTo(endpoint);
+        in_ = net::Reader(fd_);
+        return fd_ >= 0;
+    }
+
+    /**
+     * Wait for the next batch
+     *
+     * @param events Receives the batch's events
+     * @return false once the connection is closed or the stream is malformed
+     */
+    bool next(std::vector<ChangeEvent> &events) {
+        std::string header, payload;
+        if (fd_ < 0 || !in_.exact(cdc::kBatchHeaderBytes, header)) return false;
+        std::uint32_t head[4];
+        std::memcpy(head, header.data(), sizeof head);
+        if (head[0] != cdc::kBatchMagic || !in_.exact(head[2], payload)) return false;
+        return cdc::decodeEvents(payload, head[1], events);
+    }
+
+    /** Disconnect */
+    void close() {
+        if (fd_ >= 0) {
+            ::shutdown(fd_, SHUT_RDWR);
+            ::close(fd_);
+            fd_ = -1;
+        }
+    }
+
+private:
+    int fd_ {-1};
+    net::Reader in_;
+};
+
+} // namespace inv
@@ -0,0 +1,739 @@
+/**
+ * CuckooHashTable.hpp
+ *
+ * HashTable<T, Alloc, CuckooBuckets> - bucketized cuckoo hashing with
+ * constant worst-case lookups and lock-free readers.
+ *
+ * Layout:
+ * - A power-of-two array of buckets, each with 4 slots. A slot holds an
+ *   8-bit tag (0 = empty) and a pointer to a node that owns the key, its full
+ *   hash and the value. The 4 tags of a bucket share one 32-bit word.
+ * - Every key may live in exactly two buckets: its primary bucket
+ *   (hash & mask) and an alternate bucket derived from the primary and the
+ *   tag alone (partial-key cuckoo hashing, as in MemC3), so entries can be
+ *   moved without re-reading their keys.
+ *
+ * Lookups read at most two buckets and compare keys only on tag matches
+ * (about 8/255 false tag matches per miss), whatever the load: there are no
+ * chains to walk. Inserts place the entry in either bucket if it has a free
+ * slot, otherwise a breadth-first search finds a short path of entries to
+ * move to their alternate buckets (at most kMaxPathLength moves). If no path
+ * exists or the table is kMaxLoadFactor full, the bucket array doubles.
+ *
+ * Concurrency (one writer, any number of readers):
+ * - find() never takes a lock. Each bucket carries a version counter that
+ *   is odd while an entry is being moved out of or into it; a reader
+ *   snapshots the versions of both buckets, searches them, and retries if
+ *   either version changed (optimistic concurrency, like a seqlock). A key
+ *   in the middle of a cuckoo move is therefore never reported missing.
+ * - Nodes are never modified after they are published: updating a value
+ *   builds a new node and swaps the slot pointer (copy-on-write). Replaced
+ *   and erased nodes, and bucket arrays replaced by a rehash, are reclaimed
+ *   by epoch: each is tagged with the epoch it was retired in, readers count
+ *   themselves in per-stripe counters for the epoch they entered, and the
+ *   writer advances the epoch once no reader from the previous one is left.
+ *   What was retired before the oldest epoch a reader may still be in is
+ *   freed at the end of each write, so a steady stream of short reads never
+ *   holds memory back; only a reader that stays inside (a long-lived
+ *   ReadGuard) does, and stats().retiredBytes shows how much.
+ * - Pointers returned by find() stay valid while the caller holds a
+ *   ReadGuard (readGuard()), or until the next write without one.
+ * - Writers (insert, emplace, erase, clear, reserve) must be serialized by
+ *   the caller, as with the chained table.
+ *
+ * The interface matches the chained HashTable, so loadCsv and the Engine
+ * work unchanged with either policy. Differences:
+ * - The value pointer from emplace()/find() becomes stale once that key is
+ *   updated (the node is replaced); it stays valid across other inserts and
+ *   rehashes, which never move nodes.
+ * - enableMissFilter() is accepted but has no effect: the tags already reject
+ *   misses after reading two buckets, and a filter updated by the writer
+ *   could not be read safely by concurrent readers.
+ * - The table is not copyable.
+ *
+ * Usage:
+ *   inv::HashTable<inv::Product, inv::PoolAllocator<inv::Product>, inv::CuckooBuckets> table;
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "HashTable.hpp"
+
+namespace inv {
+
+/**
+ * CuckooBuckets - HashTable policy selecting bucketized cuckoo hashing
+ */
+struct CuckooBuckets {};
+
+/**
+ * HashTable<T, Alloc, CuckooBuckets> - 2 hash functions x 4-way buckets
+ *
+ * Time Complexity:
+ * - Find: O(1) worst case (two buckets, retried only while a concurrent
+ *   writer moves an entry between them)
+ * - Insert: O(1) amortized (bounded cuckoo path, amortized doubling)
+ * - Erase: O(1) worst case
+ *
+ * Space Complexity: O(n + m) where n is entries, m is slots
+ */
+template <typename T, typename Alloc>
+class HashTable<T, Alloc, CuckooBuckets> {
+    struct Node;
+    struct Bucket;
+    struct Table;
+
+public:
+    using allocator_type = Alloc;
+
+    /** Slots per bucket */
+    static constexpr std::size_t kSlots = 4;
+
+    /** Share of slots in use before the table grows proactively */
+    static constexpr double kMaxLoadFactor = 0.9;
+
+    /** Longest chain of entry moves an insert will try before growing */
+    static constexpr std::size_t kMaxPathLength = 5;
+
+    /**
+     * ReadGuard - Keeps nodes returned by find() alive while it exists
+     *
+     * Reader threads that use a value after find() returns hold one across
+     * the find and the use; the writer then defers freeing replaced nodes.
+     */
+    class ReadGuard {
+    public:
+        explicit ReadGuard(const HashTable &t) : counter_(t.enterRead()) {}
+        ReadGuard(ReadGuard &&o) noexcept : counter_(o.counter_) { o.counter_ = nullptr; }
+        ReadGuard(const ReadGuard &) = delete;
+        ReadGuard &operator=(const ReadGuard &) = delete;
+        ~ReadGuard() { if (counter_) counter_->fetch_sub(1); }
+    private:
+        std::atomic<long> *counter_;
+    };
+
+    /**
+     * Constructor - Allocate buckets for at least `bucketCount` entries
+     *
+     * @param bucketCount Entries to hold before the first growth (the
+     *                    chained table's bucket count, for drop-in use)
+     * @param alloc Allocator for nodes (copies share state)
+     */
+    explicit HashTable(std::size_t bucketCount = 1'003, const Alloc &alloc = Alloc())
+        : alloc_(alloc) {
+        table_.store(newTable(bucketsFor(bucketCount)));
+    }
+
+    HashTable(const HashTable &) = delete;
+    HashTable &operator=(const HashTable &) = delete;
+
+    ~HashTable() {
+        Table *t = table_.load();
+        forEachNode(t, [&](Node *n) { destroyNode(n); });
+        deleteTable(t);
+        reclaim(true);
+    }
+
+    /**
+     * Insert or update a key-value pair
+     *
+     * @param key String key to insert/update
+     * @param value Value to associate with the key
+     * @return true if new entry was inserted, false if existing entry was updated
+     *
+     * Time Complexity: O(1) amortized
+     */
+    bool insert(const std::string &key, const T &value) {
+        return emplaceImpl(key, true, value).second;
+    }
+
+    /**
+     * Insert or update a key-value pair, moving both into the table
+     *
+     * @return true if new entry was inserted, false if existing entry was updated
+     */
+    bool insert(std::string &&key, T &&value) {
+        return emplaceImpl(std::move(key), true, std::move(value)).second;
+    }
+
+    /**
+     * Insert or update an entry, constructing the value in a new node
+     *
+     * @return Pointer to the stored value, and true if a new entry was inserted
+     */
+    template <typename K, typename... Args>
+    std::pair<T*, bool> emplace(K &&key, Args &&...args) {
+        return emplaceImpl(std::forward<K>(key), true, std::forward<Args>(args)...);
+    }
+
+    /**
+     * Insert an entry only if the key is absent (arguments are left untouched
+     * if it exists)
+     *
+     * @return Pointer to the stored (new or existing) value, and true if inserted
+     */
+    template <typename K, typename... Args>
+    std::pair<T*, bool> try_emplace(K &&key, Args &&...args) {
+        return emplaceImpl(std::forward<K>(key), false, std::forward<Args>(args)...);
+    }
+
+    /**
+     * Find a value by key (safe to call concurrently with one writer)
+     *
+     * Modifying the value through the returned pointer is only safe when no
+     * other thread is reading the table.
+     *
+     * @param key String key to search for
+     * @return Pointer to value if found, nullptr if not found
+     *
+     * Time Complexity: O(1) worst case
+     */
+    T* find(const std::string &key) {
+        Node *n = findNode(key);
+        return n ? &n->value : nullptr;
+    }
+
+    const T* find(const std::string &key) const {
+        const Node *n = findNode(key);
+        return n ? &n->value : nullptr;
+    }
+
+    /**
+     * Remove a key-value pair (the node is freed once no reader can see it)
+     *
+     * @param key String key to remove
+     * @return true if key was found and removed, false if key didn't exist
+     *
+     * Time Complexity: O(1) worst case
+     */
+    bool erase(const std::string &key) {
+        const std::size_t h = hashOf(key);
+        Table *t = table_.load();
+        Location loc = locate(t, key, h);
+        if (!loc.node) return false;
+        Bucket &b = t->buckets[loc.bucket];
+        setTag(b, loc.slot, 0);
+        b.nodes[loc.slot].store(nullptr);
+        --size_;
+        retire(loc.node);
+        reclaim(false);
+        return true;
+    }
+
+    /**
+     * Remove every entry and shrink to the minimum bucket array
+     *
+     * Time Complexity: O(n + m) where n is entries, m is bucket count
+     */
+    void clear() {
+        Table *old = table_.load();
+        table_.store(newTable(kMinBuckets));
+        forEachNode(old, [&](Node *n) { retire(n); });
+        retire(old);
+        size_ = 0;
+        reclaim(false);
+    }
+
+    /** Number of key-value pairs */
+    std::size_t size() const { return size_; }
+
+    /** Number of buckets (each holding kSlots entries) */
+    std::size_t bucketCount() const { return table_.load()->mask + 1; }
+
+    /**
+     * Share of slots in use (size / (buckets * kSlots))
+     *
+     * Unlike the chained table's entries-per-bucket figure, this never
+     * exceeds 1.
+     */
+    double loadFactor() const {
+        return static_cast<double>(size_) / static_cast<double>(bucketCount() * kSlots);
+    }
+
+    /**
+     * Visit every key-value pair (bucket order); the table must not be
+     * modified from inside the callback
+     *
+     * @param fn Callable invoked as fn(const std::string &key, const T &value)
+     */
+    template <typename F>
+    void forEach(F &&fn) const {
+        forEachNode(table_.load(), [&](const Node *n) { fn(n->key, static_cast<const T &>(n->value)); });
+    }
+
+    /**
+     * Visit every key-value pair with mutable access to the values (only
+     * while no other thread reads the table)
+     */
+    template <typename F>
+    void forEach(F &&fn) {
+        forEachNode(table_.load(), [&](Node *n) { fn(static_cast<const std::string &>(n->key), n->value); });
+    }
+
+    /**
+     * Grow so that `count` entries fit without exceeding kMaxLoadFactor
+     *
+     * Time Complexity: O(n) where n is the number of entries (if growing)
+     */
+    void reserve(std::size_t count) {
+        std::size_t buckets = bucketsFor(count);
+        if (buckets > bucketCount()) rehash(buckets);
+    }
+
+    /** No effect (see the file comment); kept for interface compatibility */
+    void enableMissFilter(double = BlockedBloomFilter::kDefaultBitsPerKey) {}
+    void disableMissFilter() {}
+    bool missFilterEnabled() const { return false; }
+    const BlockedBloomFilter &missFilter() const { return noFilter_; }
+
+    /** Bytes of one node allocation (hash, key object and value) */
+    static constexpr std::size_t nodeBytes() { return sizeof(Node); }
+
+    /** Bytes of one bucket (version, tags and kSlots node pointers) */
+    static constexpr std::size_t bucketBytes() { return sizeof(Bucket); }
+
+    /** Allocator used for nodes */
+    allocator_type get_allocator() const { return alloc_.get(); }
+
+    /**
+     * Reader registration that keeps found nodes alive
+     *
+     * @return Guard to hold while using pointers from find() concurrently
+     *         with a writer
+     */
+    ReadGuard readGuard() const { return ReadGuard(*this); }
+
+    /**
+     * Collect bucket occupancy and probe statistics
+     *
+     * chainHistogram[k] counts buckets holding k entries; probes are
+     * counted in buckets read (1 or 2 for a hit, always 2 for a miss).
+     *
+     * Time Complexity: O(m) where m is the bucket count
+     */
+    HashTableStats stats() const {
+        HashTableStats st;
+        const Table *t = table_.load();
+        st.size = size_;
+        st.bucketCount = t->mask + 1;
+        st.loadFactor = loadFactor();
+        st.rehashCount = rehashCount_;
+        st.bucketSlots = kSlots;
+        st.bucketBytes = st.bucketCount * bucketBytes();
+        st.nodeBytes = size_ * nodeBytes();
+        st.retiredBytes = retiredBytes_;
+        st.chainHistogram.assign(kSlots + 1, 0);
+        std::size_t inAlternate = 0;
+        for (std::size_t i = 0; i <= t->mask; ++i) {
+            std::size_t used = 0;
+            for (std::size_t s = 0; s < kSlots; ++s) {
+                const Node *n = t->buckets[i].nodes[s].load();
+                if (!n) continue;
+                ++used;
+                if ((n->hash & t->mask) != i) ++inAlternate;
+            }
+            ++st.chainHistogram[used];
+            if (used == 0) ++st.emptyBuckets;
+            st.longestChain = std::max(st.longestChain, used);
+        }
+        if (size_ > 0) st.avgProbesHit = 1.0 + static_cast<double>(inAlternate) / static_cast<double>(size_);
+        st.avgProbesMiss = 2.0;
+        return st;
+    }
+
+private:
+    struct Node {
+        std::size_t hash;   // Full key hash (primary bucket and tag; kept for rehashing)
+        std::string key;
+        T value;
+
+        template <typename K, typename... Args>
+        Node(std::size_t h, K &&k, Args &&...args)
+            : hash(h), key(std::forward<K>(k)), value(std::forward<Args>(args)...) {}
+    };
+
+    struct Bucket {
+        std::atomic<std::uint32_t> version {0};  // Odd while an entry moves in or out
+        std::atomic<std::uint32_t> tags {0};     // kSlots 8-bit tags, 0 = empty slot
+        std::atomic<Node *> nodes[kSlots] {};
+    };
+
+    struct Table {
+        std::size_t mask;   // Bucket count - 1 (power of two)
+        Bucket *buckets;
+    };
+
+    /** Where a key was found (node == nullptr if absent) */
+    struct Location {
+        std::size_t bucket;
+        std::size_t slot;
+        Node *node;
+    };
+
+    using NodeAlloc = typename std::allocator_traits<Alloc>::template rebind_alloc<Node>;
+    using NodeTraits = std::allocator_traits<NodeAlloc>;
+
+    static constexpr std::size_t kMinBuckets = 2;
+    static constexpr std::size_t kReaderStripes = 16;
+
+    /**
+     * Reader counters padded to a cache line so reader threads don't share
+     * lines; count[e & 1] counts readers that entered in epoch e (readers
+     * two epochs apart never overlap, so two counters suffice)
+     */
+    struct ReaderStripe {
+        std::atomic<long> count[2] {{0}, {0}};
+        char pad[64 - 2 * sizeof(std::atomic<long>)];
+    };
+
+    /** Something the writer unlinked, and the epoch it was unlinked in */
+    template <typename P>
+    struct Retired {
+        std::uint64_t epoch;
+        P *ptr;
+    };
+
+    AllocatorState<Alloc> alloc_;
+    std::atomic<Table *> table_ {nullptr};
+    std::size_t size_ {0};
+    std::size_t rehashCount_ {0};
+    // Nodes and bucket arrays unlinked by the writer, oldest first, freed
+    // once no reader that could have seen them is left
+    std::vector<Retired<Node>> retired_;
+    std::vector<Retired<Table>> retiredTables_;
+    std::size_t retiredBytes_ {0};
+    std::atomic<std::uint64_t> epoch_ {2};  // Advanced by the writer only
+    mutable ReaderStripe readers_[kReaderStripes];
+    BlockedBloomFilter noFilter_;
+
+    // ------------------------------------------------------------------
+    // Hashing
+    // ------------------------------------------------------------------
+
+    static std::size_t hashOf(const std::string &key) { return std::hash<std::string>{}(key); }
+
+    /** 8-bit tag from the high bits of the mixed hash (never 0) */
+    static std::uint32_t tagOf(std::size_t h) {
+        std::uint32_t tag = static_cast<std::uint32_t>((static_cast<std::uint64_t>(h) * 0x9E3779B97F4A7C15ULL) >> 56);
+        return tag ? tag : 1;
+    }
+
+    /** The other bucket of an entry with this tag (an involution; never `bucket`) */
+    static std::size_t altBucket(std::size_t bucket, std::uint32_t tag, std::size_t mask) {
+        return (bucket ^ ((static_cast<std::size_t>(tag) * 0x5bd1e995u) | 1)) & mask;
+    }
+
+    static std::uint32_t tagAt(std::uint32_t tags, std::size_t slot) { return (tags >> (8 * slot)) & 0xFF; }
+
+    static void setTag(Bucket &b, std::size_t slot, std::uint32_t tag) {
+        std::uint32_t tags = b.tags.load();
+        tags = (tags & ~(0xFFu << (8 * slot))) | (tag << (8 * slot));
+        b.tags.store(tags);
+    }
+
+    static std::size_t bucketsFor(std::size_t entries) {
+        std::size_t buckets = kMinBuckets;
+        while (static_cast<double>(entries) > static_cast<double>(buckets * kSlots) * kMaxLoadFactor) buckets *= 2;
+        return buckets;
+    }
+
+    // ------------------------------------------------------------------
+    // Readers
+    // ------------------------------------------------------------------
+
+    /**
+     * Count this thread as a reader in the current epoch
+     *
+     * The epoch is re-read after counting: if the writer advanced it in
+     * between, it may not have seen this reader, so count again under the
+     * new epoch (nothing has been read yet).
+     *
+     * @return The counter to decrement when the read is over
+     */
+    std::atomic<long> *enterRead() const {
+        static thread_local std::size_t stripe = std::hash<std::thread::id>{}(std::this_thread::get_id()) % kReaderStripes;
+        for (;;) {
+            const std::uint64_t e = epoch_.load();
+            std::atomic<long> *counter = &readers_[stripe].count[e & 1];
+            counter->fetch_add(1);
+            if (epoch_.load() == e) return counter;
+            counter->fetch_sub(1);
+        }
+    }
+
+    /** Search one bucket for the key (nullptr if absent) */
+    static Node *searchBucket(const Bucket &b, std::uint32_t tag, const std::string &key) {
+        std::uint32_t tags = b.tags.load();
+        for (std::size_t s = 0; s < kSlots; ++s) {
+            if (tagAt(tags, s) != tag) continue;
+            Node *n = b.nodes[s].load();
+            if (n && n->key == key) return n;
+        }
+        return nullptr;
+    }
+
+    /**
+     * Optimistic lookup: search both buckets between two reads of their
+     * version counters, retrying if a move was in progress
+     */
+    Node *findNode(const std::string &key) const {
+        const std::size_t h = hashOf(key);
+        const std::uint32_t tag = tagOf(h);
+        std::atomic<long> *reader = enterRead();
+        Node *found;
+        for (;;) {
+            const Table *t = table_.load();
+            const Bucket &b1 = t->buckets[h & t->mask];
+            const Bucket &b2 = t->buckets[altBucket(h & t->mask, tag, t->mask)];
+            std::uint32_t v1 = b1.version.load(), v2 = b2.version.load();
+            if ((v1 | v2) & 1) { std::this_thread::yield(); continue; }
+            found = searchBucket(b1, tag, key);
+            if (!found) found = searchBucket(b2, tag, key);
+            if (b1.version.load() == v1 && b2.version.load() == v2 && table_.load() == t) break;
+        }
+        reader->fetch_sub(1);
+        return found;
+    }
+
+    // ------------------------------------------------------------------
+    // Writer
+    // ------------------------------------------------------------------
+
+    /** Writer-side lookup (no concurrent writer, so no version checks) */
+    Location locate(Table *t, const std::string &key, std::size_t h) const {
+        const std::uint32_t tag = tagOf(h);
+        const std::size_t b1 = h & t->mask;
+        for (std::size_t b : {b1, altBucket(b1, tag, t->mask)}) {
+            std::uint32_t tags = t->buckets[b].tags.load();
+            for (std::size_t s = 0; s < kSlots; ++s) {
+                if (tagAt(tags, s) != tag) continue;
+                Node *n = t->buckets[b].nodes[s].load();
+                if (n->key == key) return {b, s, n};
+            }
+        }
+        return {0, 0, nullptr};
+    }
+
+    template <typename K, typename... Args>
+    std::pair<T*, bool> emplaceImpl(K &&key, bool assign, Args &&...args) {
+        const std::size_t h = hashOf(key);
+        Table *t = table_.load();
+        Location loc = locate(t, key, h);
+        if (loc.node) {
+            if (!assign) return {&loc.node->value, false};
+            // Copy-on-write: readers keep seeing the old node until the swap
+            Node *n = makeNode(h, loc.node->key, std::forward<Args>(args)...);
+            t->buckets[loc.bucket].nodes[loc.slot].store(n);
+            retire(loc.node);
+            reclaim(false);
+            return {&n->value, false};
+        }
+        Node *n = makeNode(h, std::forward<K>(key), std::forward<Args>(args)...);
+        if (static_cast<double>(size_ + 1) > static_cast<double>(bucketCount() * kSlots) * kMaxLoadFactor) {
+            rehash(bucketCount() * 2);
+        }
+        while (!place(table_.load(), n, true)) rehash(bucketCount() * 2);
+        ++size_;
+        reclaim(false);
+        return {&n->value, true};
+    }
+
+    /**
+     * Put a node into one of its two buckets, moving other entries along a
+     * cuckoo path if both are full
+     *
+     * @param t Bucket array
+     * @param n Node to place
+     * @param live true if readers may see `t` (moves bump bucket versions)
+     * @return false if no path of at most kMaxPathLength moves was found
+     */
+    bool place(Table *t, Node *n, bool live) {
+        const std::uint32_t tag = tagOf(n->hash);
+        const std::size_t b1 = n->hash & t->mask;
+        const std::size_t b2 = altBucket(b1, tag, t->mask);
+        for (int attempt = 0; attempt < 2; ++attempt) {
+            if (storeInFreeSlot(t->buckets[b1], n, tag) || storeInFreeSlot(t->buckets[b2], n, tag)) return true;
+            if (!makeRoom(t, b1, b2, live)) return false;
+        }
+        return false;
+    }
+
+    /** Publish a node in a free slot of `b` (pointer first, then the tag) */
+    static bool storeInFreeSlot(Bucket &b, Node *n, std::uint32_t tag) {
+        std::uint32_t tags = b.tags.load();
+        for (std::size_t s = 0; s < kSlots; ++s) {
+            if (tagAt(tags, s) != 0) continue;
+            b.nodes[s].store(n);
+            setTag(b, s, tag);
+            return true;
+        }
+        return false;
+    }
+
+    /**
+     * Breadth-first search from buckets b1 and b2 for a bucket with a free
+     * slot, then move entries back along the path so that b1 or b2 gets a
+     * free slot
+     */
+    bool makeRoom(Table *t, std::size_t b1, std::size_t b2, bool live) {
+        struct Step {
+            std::size_t bucket;
+            int parent;       // Index of the step whose entry moves into `bucket`
+            int slot;         // Slot of that entry in the parent's bucket
+            std::size_t depth;
+        };
+        std::vector<Step> q;
+        q.push_back({b1, -1, -1, 0});
+        q.push_back({b2, -1, -1, 0});
+        int found = -1;
+        for (std::size_t head = 0; head < q.size() && found < 0; ++head) {
+            const Step cur = q[head];
+            std::uint32_t tags = t->buckets[cur.bucket].tags.load();
+            for (std::size_t s = 0; s < kSlots; ++s) {
+                if (tagAt(tags, s) == 0) { found = static_cast<int>(head); break; }
+            }
+            if (found >= 0 || cur.depth >= kMaxPathLength) continue;
+            for (std::size_t s = 0; s < kSlots; ++s) {
+                q.push_back({altBucket(cur.bucket, tagAt(tags, s), t->mask), static_cast<int>(head),
+                             static_cast<int>(s), cur.depth + 1});
+            }
+        }
+        if (found < 0) return false;
+        // Move entries from the free end of the path back towards b1/b2
+        for (int i = found; q[i].parent >= 0; i = q[i].parent) {
+            Bucket &from = t->buckets[q[q[i].parent].bucket];
+            Bucket &to = t->buckets[q[i].bucket];
+            const std::size_t s = static_cast<std::size_t>(q[i].slot);
+            const std::uint32_t tag = tagAt(from.tags.load(), s);
+            if (tag == 0) continue;  // Already vacated by an earlier step of this path
+            // An earlier step may have put a different entry in this slot
+            if (altBucket(q[q[i].parent].bucket, tag, t->mask) != q[i].bucket) return false;
+            if (live) { beginMove(from); beginMove(to); }
+            bool moved = storeInFreeSlot(to, from.nodes[s].load(), tag);
+            if (moved) { setTag(from, s, 0); from.nodes[s].store(nullptr); }
+            if (live) { endMove(to); endMove(from); }
+            if (!moved) return false;
+        }
+        return true;
+    }
+
+    static void beginMove(Bucket &b) { b.version.store(b.version.load() + 1); }
+    static void endMove(Bucket &b) { b.version.store(b.version.load() + 1); }
+
+    /**
+     * Rebuild into a larger bucket array (nodes are reused, not copied) and
+     * retire the old array
+     */
+    void rehash(std::size_t buckets) {
+        Table *old = table_.load();
+        for (;;) {
+            Table *t = newTable(buckets);
+            bool ok = true;
+            forEachNode(old, [&](Node *n) { if (ok) ok = place(t, n, false); });
+            if (ok) {
+                table_.store(t);
+                retire(old);
+                ++rehashCount_;
+                return;
+            }
+            deleteTable(t);
+            buckets *= 2;
+        }
+    }
+
+    /** Queue an unlinked node for freeing */
+    void retire(Node *n) {
+        retired_.push_back({epoch_.load(), n});
+        retiredBytes_ += nodeBytes();
+    }
+
+    /** Queue a replaced bucket array for freeing */
+    void retire(Table *t) {
+        retiredTables_.push_back({epoch_.load(), t});
+        retiredBytes_ += tableBytes(t);
+    }
+
+    /**
+     * Free retired nodes and tables no reader can still see (or all of
+     * them, when destroying)
+     *
+     * The epoch moves from e to e + 1 once no reader counted in e - 1 is
+     * left (up to twice per call). Readers still inside then entered in the
+     * current or previous epoch, after everything retired earlier had been
+     * unlinked, so that is freed.
+     */
+    void reclaim(bool force) {
+        if (retired_.empty() && retiredTables_.empty()) return;
+        std::uint64_t freeBefore = ~std::uint64_t(0);
+        if (!force) {
+            for (int step = 0; step < 2; ++step) {
+                const std::uint64_t e = epoch_.load();
+                long behind = 0;
+                for (const auto &r : readers_) behind += r.count[(e - 1) & 1].load();
+                if (behind != 0) break;
+                epoch_.store(e + 1);
+            }
+            freeBefore = epoch_.load() - 1;
+        }
+        std::size_t nodes = 0;
+        while (nodes < retired_.size() && retired_[nodes].epoch < freeBefore) destroyNode(retired_[nodes++].ptr);
+        retired_.erase(retired_.begin(), retired_.begin() + nodes);
+        retiredBytes_ -= nodes * nodeBytes();
+        std::size_t tables = 0;
+        while (tables < retiredTables_.size() && retiredTables_[tables].epoch < freeBefore) {
+            retiredBytes_ -= tableBytes(retiredTables_[tables].ptr);
+            deleteTable(retiredTables_[tables++].ptr);
+        }
+        retiredTables_.erase(retiredTables_.begin(), retiredTables_.begin() + tables);
+    }
+
+    template <typename F>
+    static void forEachNode(const Table *t, F &&fn) {
+        for (std::size_t i = 0; i <= t->mask; ++i) {
+            for (std::size_t s = 0; s < kSlots; ++s) {
+                if (Node *n = t->buckets[i].nodes[s].load()) fn(n);
+            }
+        }
+    }
+
+    template <typename K, typename... Args>
+    Node *makeNode(std::size_t h, K &&key, Args &&...args) {
+        NodeAlloc a(alloc_.get());
+        Node *n = NodeTraits::allocate(a, 1);
+        try {
+            NodeTraits::construct(a, n, h, std::forward<K>(key), std::forward<Args>(args)...);
+        } catch (...) {
+            NodeTraits::deallocate(a, n, 1);
+            throw;
+        }
+        return n;
+    }
+
+    void destroyNode(Node *n) {
+        NodeAlloc a(alloc_.get());
+        NodeTraits::destroy(a, n);
+        NodeTraits::deallocate(a, n, 1);
+    }
+
+    static Table *newTable(std::size_t buckets) { return new Table{buckets - 1, new Bucket[buckets]}; }
+
+    static std::size_t tableBytes(const Table *t) { return sizeof(Table) + (t->mask + 1) * sizeof(Bucket); }
+
+    static void deleteTable(Table *t) {
+        delete[] t->buckets;
+        delete t;
+    }
+};
+
+} // namespace inv
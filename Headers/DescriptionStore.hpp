@@ -0,0 +1,354 @@
+/**
+ * DescriptionStore.hpp
+ *
+ * Block-compressed storage for product descriptions.
+ *
+ * Descriptions are most of each record's bytes but are only read when `find`
+ * prints a single product. DescriptionStore appends them to a block buffer;
+ * when a block fills up it is compressed with a small self-contained LZ77
+ * codec (lz namespace below) and only the compressed bytes are kept. Products
+ * hold a 32-bit handle instead of the text.
+ *
+ * Reading a description decompresses its block on demand. The last few
+ * decompressed blocks are kept in a tiny cache, so printing several products
+ * loaded close together (the common case for `listInventory` followed by
+ * `find`) decompresses each block once.
+ *
+ * Codec format (LZ4-style sequences, no external library):
+ *   token        : 1 byte, high nibble = literal length, low nibble = match length - 4
+ *   [lit ext]    : if literal nibble == 15, bytes of 255 followed by one byte < 255
+ *   literals     : raw bytes
+ *   offset       : 2 bytes little-endian, distance back into the output (1..65535)
+ *   [match ext]  : if match nibble == 15, same extension scheme as literals
+ * The final sequence has literals only; the input ends right after them.
+ *
+ * Thread Safety: get() may be called from any number of threads (the cache is
+ * guarded by a mutex). add() and seal() must not run concurrently with anything.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace inv {
+
+namespace lz {
+
+/** Shortest match worth encoding */
+constexpr std::size_t kMinMatch = 4;
+
+/** Largest back-reference distance */
+constexpr std::size_t kMaxOffset = 65535;
+
+namespace detail {
+
+inline std::uint32_t read32(const char *p) {
+    std::uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline void writeLength(std::string &out, std::size_t len) {
+    while (len >= 255) { out.push_back(static_cast<char>(255)); len -= 255; }
+    out.push_back(static_cast<char>(len));
+}
+
+inline bool readLength(const unsigned char *src, std::size_t n, std::size_t &ip, std::size_t &len) {
+    unsigned char b;
+    do {
+        if (ip >= n) return false;
+        b = src[ip++];
+        len += b;
+    } while (b == 255);
+    return true;
+}
+
+inline void emitSequence(std::string &out, const char *lit, std::size_t litLen, std::size_t offset, std::size_t matchLen) {
+    std::size_t m = matchLen ? matchLen - kMinMatch : 0;
+    unsigned char token = static_cast<unsigned char>((litLen < 15 ? litLen : 15) << 4 | (m < 15 ? m : 15));
+    out.push_back(static_cast<char>(token));
+    if (litLen >= 15) writeLength(out, litLen - 15);
+    out.append(lit, litLen);
+    if (!matchLen) return;
+    out.push_back(static_cast<char>(offset & 0xFF));
+    out.push_back(static_cast<char>(offset >> 8));
+    if (m >= 15) writeLength(out, m - 15);
+}
+
+} // namespace detail
+
+/**
+ * compress - LZ77-compress a buffer
+ *
+ * Greedy parser over hash chains: positions are chained by the hash of their
+ * next 4 bytes, and up to kMaxChain earlier positions within kMaxOffset are
+ * tried at each step; the longest verified match wins.
+ *
+ * @param src Input bytes
+ * @param n Input length
+ * @return Compressed bytes (decompress needs n to restore them)
+ *
+ * Time Complexity: O(n * kMaxChain) worst case
+ */
+inline std::string compress(const char *src, std::size_t n) {
+    const int kHashBits = 15;
+    const int kMaxChain = 32;
+    const std::uint32_t kEmpty = 0xFFFFFFFFu;
+    std::vector<std::uint32_t> head(std::size_t(1) << kHashBits, kEmpty);
+    std::vector<std::uint32_t> prev(n, kEmpty);  // prev[i] = previous position with i's hash
+    auto insert = [&](std::size_t i) {
+        std::size_t h = (detail::read32(src + i) * 2654435761u) >> (32 - kHashBits);
+        prev[i] = head[h];
+        head[h] = static_cast<std::uint32_t>(i);
+        return prev[i];
+    };
+
+    std::string out;
+    out.reserve(n / 2 + 16);
+    std::size_t anchor = 0, i = 0;
+    while (i + kMinMatch <= n) {
+        std::size_t bestLen = 0, bestPos = 0;
+        std::uint32_t cand = insert(i);
+        for (int depth = 0; depth < kMaxChain && cand != kEmpty && i - cand <= kMaxOffset; ++depth, cand = prev[cand]) {
+            if (src[cand + bestLen] != src[i + bestLen] || detail::read32(src + cand) != detail::read32(src + i)) continue;
+            std::size_t len = kMinMatch;
+            while (i + len < n && src[cand + len] == src[i + len]) ++len;
+            if (len > bestLen) { bestLen = len; bestPos = cand; }
+            if (i + len == n) break;
+        }
+        if (bestLen) {
+            detail::emitSequence(out, src + anchor, i - anchor, i - bestPos, bestLen);
+            // Chain the skipped positions so later matches can refer to them
+            for (std::size_t k = i + 1; k < i + bestLen && k + kMinMatch <= n; ++k) insert(k);
+            i += bestLen;
+            anchor = i;
+        } else {
+            ++i;
+        }
+    }
+    detail::emitSequence(out, src + anchor, n - anchor, 0, 0);
+    return out;
+}
+
+/**
+ * decompress - Restore a buffer produced by compress()
+ *
+ * Every length and offset is bounds-checked, so corrupt input fails instead
+ * of reading or writing out of range.
+ *
+ * @param src Compressed bytes
+ * @param n Compressed length
+ * @param dst Output buffer of exactly dstLen bytes
+ * @param dstLen Original (uncompressed) length
+ * @return true if the input decoded to exactly dstLen bytes
+ *
+ * Time Complexity: O(dstLen)
+ */
+inline bool decompress(const char *src, std::size_t n, char *dst, std::size_t dstLen) {
+    const unsigned char *in = reinterpret_cast<const unsigned char *>(src);
+    std::size_t ip = 0, op = 0;
+    while (ip < n) {
+        unsigned char token = in[ip++];
+        std::size_t litLen = token >> 4;
+        if (litLen == 15 && !detail::readLength(in, n, ip, litLen)) return false;
+        if (litLen > n - ip || litLen > dstLen - op) return false;
+        std::memcpy(dst + op, src + ip, litLen);
+        ip += litLen;
+        op += litLen;
+        if (ip == n) break;  // Final, literal-only sequence
+
+        if (n - ip < 2) return false;
+        std::size_t offset = in[ip] | static_cast<std::size_t>(in[ip + 1]) << 8;
+        ip += 2;
+        std::size_t matchLen = token & 15;
+        if (matchLen == 15 && !detail::readLength(in, n, ip, matchLen)) return false;
+        matchLen += kMinMatch;
+        if (offset == 0 || offset > op || matchLen > dstLen - op) return false;
+        // Byte-wise copy: the match may overlap the bytes it produces
+        const char *from = dst + op - offset;
+        for (std::size_t k = 0; k < matchLen; ++k) dst[op + k] = from[k];
+        op += matchLen;
+    }
+    return op == dstLen;
+}
+
+} // namespace lz
+
+/**
+ * DescriptionStore - Append-only, block-compressed string store
+ */
+class DescriptionStore {
+public:
+    /** Handle of "no description stored" (Product::descriptionRef default) */
+    static constexpr std::uint32_t kNone = 0xFFFFFFFFu;
+
+    /**
+     * @param blockBytes Raw bytes per compressed block (at most 64 KiB, the
+     *                   codec's window; larger descriptions get a block of their own)
+     * @param cacheBlocks Number of decompressed blocks kept for reuse
+     */
+    explicit DescriptionStore(std::size_t blockBytes = 64 * 1024, std::size_t cacheBlocks = 4)
+        : blockBytes_(blockBytes < lz::kMaxOffset ? blockBytes : lz::kMaxOffset + 1),
+          cache_(cacheBlocks ? cacheBlocks : 1) {}
+
+    DescriptionStore(const DescriptionStore &) = delete;
+    DescriptionStore &operator=(const DescriptionStore &) = delete;
+
+    /**
+     * Append a description
+     *
+     * @param text Description text
+     * @return Handle for get() (kNone for an empty description)
+     *
+     * Time Complexity: O(length) amortized (a full block is compressed once)
+     */
+    std::uint32_t add(const std::string &text) {
+        if (text.empty()) return kNone;
+        if (!open_.empty() && open_.size() + text.size() > blockBytes_) compressOpenBlock();
+        if (entries_.size() >= kNone) throw std::length_error("DescriptionStore: too many entries");
+        entries_.push_back(Entry{static_cast<std::uint32_t>(blocks_.size()),
+                                 static_cast<std::uint32_t>(open_.size()),
+                                 static_cast<std::uint32_t>(text.size())});
+        open_ += text;
+        rawBytes_ += text.size();
+        return static_cast<std::uint32_t>(entries_.size() - 1);
+    }
+
+    /**
+     * Compress the open block and trim the handle table (call once loading
+     * is done); later add() calls start a new block
+     */
+    void seal() {
+        compressOpenBlock();
+        entries_.shrink_to_fit();
+    }
+
+    /**
+     * Fetch a description
+     *
+     * @param ref Handle returned by add()
+     * @return The description ("" for kNone or an unknown handle)
+     *
+     * Time Complexity: O(1) on a cache hit, O(block size) on a miss
+     */
+    std::string get(std::uint32_t ref) const {
+        if (ref >= entries_.size()) return std::string();
+        const Entry &e = entries_[ref];
+        if (e.block == blocks_.size()) return open_.substr(e.offset, e.length);
+
+        std::lock_guard<std::mutex> lock(cacheMutex_);
+        CacheSlot *slot = nullptr;
+        for (auto &s : cache_) {
+            if (s.valid && s.block == e.block) { slot = &s; break; }
+        }
+        if (slot) {
+            ++hits_;
+        } else {
+            ++misses_;
+            // Evict the least recently used slot (or fill an empty one)
+            slot = &cache_[0];
+            for (auto &s : cache_) {
+                if (!s.valid) { slot = &s; break; }
+                if (s.lastUse < slot->lastUse) slot = &s;
+            }
+            const Block &b = blocks_[e.block];
+            slot->data.resize(b.rawSize);
+            if (!lz::decompress(b.data.data(), b.data.size(), &slot->data[0], b.rawSize)) {
+                slot->valid = false;
+                throw std::runtime_error("DescriptionStore: corrupt block");
+            }
+            slot->block = e.block;
+            slot->valid = true;
+        }
+        slot->lastUse = ++tick_;
+        return slot->data.substr(e.offset, e.length);
+    }
+
+    /** Number of stored descriptions */
+    std::size_t size() const { return entries_.size(); }
+
+    /** Number of compressed blocks */
+    std::size_t blockCount() const { return blocks_.size(); }
+
+    /** Bytes of description text added */
+    std::size_t rawBytes() const { return rawBytes_; }
+
+    /** Bytes of compressed blocks (excluding the open block) */
+    std::size_t compressedBytes() const { return compressedBytes_; }
+
+    /** Bytes of the open (not yet compressed) block */
+    std::size_t openBytes() const { return open_.size(); }
+
+    /** Bytes of the handle table */
+    std::size_t entryBytes() const { return entries_.capacity() * sizeof(Entry); }
+
+    /** Cache hits / misses since construction */
+    std::size_t cacheHits() const { std::lock_guard<std::mutex> lock(cacheMutex_); return hits_; }
+    std::size_t cacheMisses() const { std::lock_guard<std::mutex> lock(cacheMutex_); return misses_; }
+
+    /** Visit every block buffer, compressed ones then the open one (for memory accounting) */
+    template <typename F>
+    void forEachBlock(F f) const {
+        for (const auto &b : blocks_) f(b.data);
+        if (!open_.empty()) f(open_);
+    }
+
+    /** Visit every decompressed block held by the cache (for memory accounting) */
+    template <typename F>
+    void forEachCached(F f) const {
+        std::lock_guard<std::mutex> lock(cacheMutex_);
+        for (const auto &s : cache_) f(s.data);
+    }
+
+private:
+    struct Entry {
+        std::uint32_t block;   // Index into blocks_ (== blocks_.size() while still in open_)
+        std::uint32_t offset;  // Offset within the block's raw bytes
+        std::uint32_t length;
+    };
+
+    struct Block {
+        std::uint32_t rawSize {0};
+        std::string data;      // lz::compress output
+    };
+
+    struct CacheSlot {
+        bool valid {false};
+        std::uint32_t block {0};
+        std::uint64_t lastUse {0};
+        std::string data;      // Decompressed block
+    };
+
+    std::size_t blockBytes_;
+    std::vector<Entry> entries_;
+    std::vector<Block> blocks_;
+    std::string open_;         // Raw bytes of the block being filled
+    std::size_t rawBytes_ {0};
+    std::size_t compressedBytes_ {0};
+
+    mutable std::mutex cacheMutex_;
+    mutable std::vector<CacheSlot> cache_;
+    mutable std::uint64_t tick_ {0};
+    mutable std::size_t hits_ {0};
+    mutable std::size_t misses_ {0};
+
+    /** Compress open_ into a new block */
+    void compressOpenBlock() {
+        if (open_.empty()) return;
+        Block b;
+        b.rawSize = static_cast<std::uint32_t>(open_.size());
+        b.data = lz::compress(open_.data(), open_.size());
+        b.data.shrink_to_fit();
+        compressedBytes_ += b.data.size();
+        blocks_.push_back(std::move(b));
+        std::string().swap(open_);
+    }
+};
+
+} // namespace inv
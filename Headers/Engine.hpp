@@ -0,0 +1,1185 @@
+/**
+ * Engine.hpp
+ *
+ * Query engine for the inventory management system.
+ *
+ * The Engine owns the product table and category index and evaluates REPL
+ * commands against them, writing results to any std::ostream. Keeping the
+ * engine independent of std::cin/std::cout lets the same command handling run
+ * in the interactive REPL (src/main.cpp) and in in-process tools such as the
+ * workload replayer (src/replay.cpp).
+ *
+ * Thread Safety:
+ * - evalCommand() only reads engine state, so any number of threads may call
+ *   it concurrently once loading has finished. Per-command statistics (when
+ *   enabled) are merged under a mutex.
+ * - upsertProduct(), eraseProduct() and applyMutations() may run while other
+ *   threads evaluate commands: commands hold a shared lock on the catalog
+ *   and mutations an exclusive one, so a command sees each mutation either
+ *   entirely or not at all.
+ * - load(), freeze(), openCatalog(), attachSharedCatalog(),
+ *   enableMutationLog(), enableChangeFeed(), setPrerenderedOutput(),
+ *   enableRequestCoalescing() and enableCommandStats() must not run
+ *   concurrently with anything else.
+ * - With a shared-memory catalog, each command runs against the generation
+ *   that was newest when it started; a swap never changes a running command.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <shared_mutex>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "ChangeFeed.hpp"
+#include "CuckooHashTable.hpp"
+#include "DescriptionStore.hpp"
+#include "HashTable.hpp"
+#include "LoadPipeline.hpp"
+#include "MappedHashTable.hpp"
+#include "MemoryUsage.hpp"
+#include "MutationLog.hpp"
+#include "Parser.hpp"
+#include "PerfectHashTable.hpp"
+#include "PerfCounters.hpp"
+#include "PoolAllocator.hpp"
+#include "RenderedStore.hpp"
+#include "ResultCache.hpp"
+#include "SharedCatalog.hpp"
+#include "SingleFlight.hpp"
+
+namespace inv {
+
+/**
+ * printProduct - Print a product's details in a formatted, human-readable manner
+ * Wraps long product descriptions to improve readability
+ *
+ * @param p The product to print
+ * @param out Stream to write to
+ * @param descriptions Store holding the description if p.descriptionRef is set
+ */
+inline void printProduct(const Product &p, std::ostream &out, const DescriptionStore *descriptions = nullptr) {
+    out << "Uniq Id: " << p.uniqId << '\n';
+    out << "Product Name: " << p.productName << '\n';
+    out << "Brand Name: " << p.brandName << '\n';
+    out << "Category: " << p.category << '\n';
+    out << "List Price: " << p.listPrice << '\n';
+    out << "Selling Price: " << p.sellingPrice << '\n';
+    out << "Quantity: " << p.quantity << '\n';
+    if (!p.asin.empty()) out << "Asin: " << p.asin << '\n';
+    if (!p.modelNumber.empty()) out << "Model Number: " << p.modelNumber << '\n';
+
+    /**
+     * Lambda helper to wrap and print long text fields with proper indentation
+     * Breaks text into lines that fit within maxWidth characters
+     */
+    auto wrapAndPrint = [&](const std::string &label, const std::string &text, size_t maxWidth = 100) {
+        out << label;
+        if (text.empty()) { out << '\n'; return; }
+
+        // Split text into words
+        std::istringstream iss(text);
+        std::vector<std::string> words;
+        std::string w;
+        while (iss >> w) words.push_back(w);
+
+        const std::string indent = "    "; // 4 spaces for wrapped lines
+        size_t lineWidth = maxWidth;
+
+        // Start a new line for the wrapped block
+        out << '\n';
+        std::string cur = indent;
+        for (size_t i = 0; i < words.size(); ++i) {
+            const std::string &word = words[i];
+            if (cur.size() + (cur.size() > indent.size() ? 1 : 0) + word.size() > lineWidth) {
+                out << cur << '\n';
+                cur = indent + word;
+            } else {
+                if (cur.size() > indent.size()) cur += ' ';
+                cur += word;
+            }
+        }
+        if (!cur.empty()) out << cur << '\n';
+    };
+
+    if (descriptions && p.descriptionRef != DescriptionStore::kNone) {
+        wrapAndPrint("Product Description:", descriptions->get(p.descriptionRef), 100);
+    } else {
+        wrapAndPrint("Product Description:", p.productDescription, 100);
+    }
+    if (!p.stock.empty()) out << "Stock: " << p.stock << '\n';
+}
+
+/**
+ * printTableStats - Print a hash table's internal statistics
+ * The chain-length histogram is shown next to the count a uniformly
+ * distributed hash would produce (Poisson with mean = load factor), which
+ * makes clustering visible at a glance.
+ *
+ * @param st Statistics snapshot from HashTable::stats()
+ * @param out Stream to write to
+ */
+inline void printTableStats(const HashTableStats &st, std::ostream &out) {
+    auto flags = out.flags();
+    auto prec = out.precision();
+    out << "Entries: " << st.size << '\n';
+    if (st.bucketSlots > 0) {
+        // Fixed-width (cuckoo) buckets: occupancy instead of chain lengths
+        out << "Buckets: " << st.bucketCount << " x " << st.bucketSlots << " slots (cuckoo)" << '\n';
+        out << "Slot load factor: " << std::fixed << std::setprecision(3) << st.loadFactor << '\n';
+        out << "Empty buckets: " << st.emptyBuckets << '\n';
+        out << "Avg buckets read (hit): " << st.avgProbesHit << '\n';
+        out << "Buckets read (miss): " << st.avgProbesMiss << '\n';
+        out << "Rehashes: " << st.rehashCount << '\n';
+        out << "Bucket bytes: " << st.bucketBytes << '\n';
+        out << "Node bytes: " << st.nodeBytes << '\n';
+        out << "Retired bytes: " << st.retiredBytes << '\n';
+        out << "Bucket occupancy histogram (entries: buckets):" << '\n';
+        for (size_t k = 0; k < st.chainHistogram.size(); ++k) out << "  " << k << ": " << st.chainHistogram[k] << '\n';
+        out.flags(flags);
+        out.precision(prec);
+        return;
+    }
+    out << "Buckets: " << st.bucketCount << '\n';
+    out << "Load factor: " << std::fixed << std::setprecision(3) << st.loadFactor << '\n';
+    out << "Empty buckets: " << st.emptyBuckets << '\n';
+    out << "Longest chain: " << st.longestChain << '\n';
+    out << "Avg probes (hit): " << st.avgProbesHit << '\n';
+    out << "Avg probes (miss): " << st.avgProbesMiss << '\n';
+    out << "Rehashes: " << st.rehashCount << '\n';
+    out << "Bucket bytes: " << st.bucketBytes << '\n';
+    out << "Node bytes: " << st.nodeBytes << '\n';
+    if (st.missFilter) {
+        out << "Miss filter: " << st.filterBytes << " bytes (" << std::setprecision(1) << st.filterBitsPerKey
+            << " bits/key), expected false positives " << std::setprecision(2)
+            << 100.0 * st.filterFalsePositiveRate << "%" << '\n';
+        out << std::setprecision(3);
+    }
+    out << "Chain length histogram (length: buckets / expected if uniform):" << '\n';
+    double poisson = std::exp(-st.loadFactor); // P(k = 0)
+    for (size_t k = 0; k < st.chainHistogram.size(); ++k) {
+        if (k > 0) poisson *= st.loadFactor / static_cast<double>(k);
+        out << "  " << k << ": " << st.chainHistogram[k] << " / "
+            << std::setprecision(1) << poisson * static_cast<double>(st.bucketCount) << '\n';
+        out << std::setprecision(3);
+    }
+    out.flags(flags);
+    out.precision(prec);
+}
+
+/**
+ * printPerfectHashStats - Print a read-only snapshot's perfect hash layout
+ * (the `:tablestats` command after Engine::freeze())
+ *
+ * @param st Statistics from PerfectHashTable::stats()
+ * @param out Stream to write to
+ */
+inline void printPerfectHashStats(const PerfectHashStats &st, std::ostream &out) {
+    auto flags = out.flags();
+    auto prec = out.precision();
+    out << "Read-only snapshot (minimal perfect hash)" << '\n';
+    out << "Entries: " << st.size << '\n';
+    out << "Slots before remap: " << st.slots << " (" << st.remapped << " remapped)" << '\n';
+    out << "Pilots: " << st.buckets << " x " << st.pilotBits << " bits (max pilot " << st.maxPilot << ")" << '\n';
+    out << "Index bits per key: " << std::fixed << std::setprecision(2) << st.bitsPerKey << '\n';
+    out << "Probes per lookup: 1" << '\n';
+    out << "Entry bytes: " << st.entryBytes << '\n';
+    out << "Build time: " << std::setprecision(3) << 1e3 * st.buildSec << " ms (" << st.seedAttempts << " seed(s))" << '\n';
+    out.flags(flags);
+    out.precision(prec);
+}
+
+/**
+ * CommandStats - Aggregate cost of one kind of REPL command
+ */
+struct CommandStats {
+    std::size_t count {0};   // Number of commands evaluated
+    double totalSec {0.0};   // Total wall-clock time
+    double maxSec {0.0};     // Slowest single command
+    PerfSample perf;         // Hardware counters (valid only if enabled and available)
+};
+
+/**
+ * Bucket policy of the engine's product table
+ * Build with -DINV_TABLE_POLICY=CuckooBuckets (`make ... TABLE=cuckoo`) for
+ * cuckoo hashing with two-bucket worst-case lookups.
+ */
+#ifndef INV_TABLE_POLICY
+#define INV_TABLE_POLICY ChainedBuckets
+#endif
+
+/**
+ * ProductTable - Product storage used by the engine
+ * Nodes come from a slab pool, so the whole catalog's nodes sit in a few
+ * large contiguous allocations instead of one malloc() per product.
+ */
+using ProductTable = HashTable<Product, PoolAllocator<Product>, INV_TABLE_POLICY>;
+
+/**
+ * Engine - Product storage plus REPL command evaluation
+ *
+ * Data Structures:
+ * - table_: Hash table mapping Uniq Id -> Product (O(1) average-case lookup)
+ * - categoryIndex_: Category -> list of Uniq Ids (products can belong to
+ *   multiple categories, stored in Product.categories)
+ * - descriptions_: Compressed product descriptions (only used after
+ *   setCompressDescriptions(true))
+ * - coldFields_: Source-file locations of deferred cold fields (only used
+ *   after setLazyColdFields(true))
+ * - snapshot_: Minimal perfect hash table replacing table_ after freeze()
+ * - catalog_: Memory-mapped catalog file replacing the table and index
+ *   after openCatalog()
+ * - sharedCatalog_: Shared-memory catalog published by a loader process,
+ *   replacing the table and index after attachSharedCatalog()
+ * - log_: Every mutation since enableMutationLog(), for replicas
+ * - feed_: Coalesced change events since enableChangeFeed(), for caches
+ * - resultCache_: Rendered find/listInventory output tagged with the
+ *   dataset generation (only after enableResultCache())
+ * - rendered_: Every product's `find` output, referenced by
+ *   Product::renderedRef (only after setPrerenderedOutput(true))
+ * - singleFlight_: listInventory commands in flight, joined by identical
+ *   concurrent ones (only after enableRequestCoalescing(true))
+ */
+class Engine {
+public:
+    /**
+     * Load a CSV file into the product table and category index
+     *
+     * With a mutation log or change feed, the file's products are applied
+     * (and logged / fed) as upserts in file order, replacing products with
+     * the same Uniq Id. With pre-rendered output, the rendered store is
+     * rebuilt afterwards (loads may replace products in place).
+     *
+     * @param path Path to CSV file
+     * @param stats Optional per-phase timing output
+     * @return true if the file was loaded, false if it could not be opened
+     *         (or the engine was frozen)
+     */
+    bool load(const std::string &path, LoadStats *stats = nullptr) {
+        return loadWith([&](ProductTable &table, CategoryIndex &index, DescriptionStore *descriptions, ColdFieldStore *coldFields) {
+            return loadFile(path, table, index, stats, descriptions, coldFields);
+        });
+    }
+
+    /**
+     * Load CSV text from a stream (a pipe, or StreamInput's decompressed
+     * input) like load(path); cold fields are never lazy, as there is no
+     * file to leave them in
+     *
+     * @param in Stream positioned at the header line
+     * @param stats Optional per-phase timing output
+     * @return true if loaded, false if the stream has no header line (or
+     *         the engine was frozen)
+     */
+    bool load(std::istream &in, LoadStats *stats = nullptr) {
+        return loadWith([&](ProductTable &table, CategoryIndex &index, DescriptionStore *descriptions, ColdFieldStore *) {
+            const ShardFilter *shard = shard_.count > 1 ? &shard_ : nullptr;
+            if (loadParsers_ == 0) return loadCsv(in, table, index, stats, descriptions, shard);
+            LoadPipelineOptions options;
+            options.parsers = loadParsers_;
+            return loadCsvPipelined(in, table, index, options, stats, descriptions, shard);
+        });
+    }
+
+    /**
+     * Keep descriptions loaded from now on block-compressed in a
+     * DescriptionStore instead of in each Product; they are decompressed
+     * only when `find` prints a product
+     *
+     * @param enable true to compress descriptions of subsequent loads
+     */
+    void setCompressDescriptions(bool enable) { compressDescriptions_ = enable; }
+
+    /**
+     * Leave the cold fields (asin, model number, description) of files
+     * loaded from now on in the mmapped source file; `find` parses them from
+     * there the first time a product is printed. Takes precedence over
+     * compressed descriptions.
+     *
+     * @param enable true to defer cold fields of subsequent loads
+     */
+    void setLazyColdFields(bool enable) { lazyColdFields_ = enable; }
+
+    /**
+     * Load files from now on with the multi-threaded pipeline (see
+     * LoadPipeline.hpp) instead of on the calling thread; the result is
+     * the same
+     *
+     * @param parsers Parser threads; 0 loads on the calling thread
+     */
+    void setLoadPipeline(std::size_t parsers) { loadParsers_ = parsers; }
+
+    /**
+     * Make this engine one partition of a sharded catalog: files loaded from
+     * now on keep only the products whose Uniq Id hashes to shard `index`
+     * of `count` (see ShardFilter and ShardRouter)
+     *
+     * @param index This shard's number (0 <= index < count)
+     * @param count Number of shards (1 = unpartitioned)
+     */
+    void setShard(std::size_t index, std::size_t count) {
+        shard_.index = index;
+        shard_.count = count;
+    }
+
+    /** Partition this engine loads (count 1 unless setShard() was called) */
+    const ShardFilter &shard() const { return shard_; }
+
+    /**
+     * Put a blocked Bloom filter in front of product lookups, so `find` of
+     * an unknown id usually returns after one cache-line read instead of
+     * walking a bucket chain. Products already loaded are added right away;
+     * later loads add theirs as they are inserted.
+     *
+     * @param enable true to filter misses, false to drop the filter
+     */
+    void setMissFilter(bool enable) {
+        if (enable) table_.enableMissFilter();
+        else table_.disableMissFilter();
+    }
+
+    /**
+     * Freeze the catalog into a read-only snapshot
+     *
+     * Moves every product out of the chained hash table into a
+     * PerfectHashTable, so each lookup is one probe plus one key comparison
+     * and the index costs about 3 bits per product. Afterwards load() fails
+     * and the chained table is empty.
+     *
+     * Time Complexity: O(n) expected
+     */
+    void freeze() {
+        if (frozen_ || mapped_) return;
+        std::vector<std::pair<std::string, Product>> entries;
+        entries.reserve(table_.size());
+        table_.forEach([&](const std::string &key, Product &p) { entries.emplace_back(key, std::move(p)); });
+        table_.clear();
+        snapshot_ = PerfectHashTable<Product>(std::move(entries));
+        frozen_ = true;
+        ++generation_;
+    }
+
+    /**
+     * Pre-render every product's `find` output (see RenderedStore.hpp)
+     *
+     * Each product is printed once, now and again whenever it is loaded or
+     * upserted, and `find` writes the stored bytes instead of formatting
+     * it. Blocks of replaced or erased products are released, and the
+     * store is rebuilt once released bytes outweigh live ones. A frozen
+     * snapshot keeps the blocks rendered before freeze().
+     *
+     * @param enable true to render, false to drop the rendered output
+     * @return false if the engine is frozen or mapped
+     *
+     * Time Complexity: O(n) products printed
+     */
+    bool setPrerenderedOutput(bool enable) {
+        if (frozen_ || mapped_) return false;
+        prerender_ = enable;
+        renderAll();
+        return true;
+    }
+
+    /** Rendered output store (empty unless setPrerenderedOutput(true)) */
+    const RenderedStore &renderedOutput() const { return rendered_; }
+
+    /** true once freeze() has run */
+    bool frozen() const { return frozen_; }
+
+    /**
+     * Write the catalog (products and category index) to a table file
+     *
+     * Products are stored complete: deferred cold fields and compressed
+     * descriptions are resolved first, so the file does not depend on the
+     * source CSV. The file is written next to path and renamed into place,
+     * so processes that have the old file open are unaffected.
+     *
+     * @param path Output file (read back with openCatalog())
+     * @return true if the file was written
+     *
+     * Time Complexity: O(n + catalog bytes)
+     */
+    bool saveCatalog(const std::string &path) const {
+        MappedTableBuilder<Product> products;
+        MappedTableBuilder<std::vector<std::string>> index;
+        buildCatalog(products, index);
+        return writeMappedImages(path, {&products.image(), &index.image()});
+    }
+
+    /**
+     * Publish the catalog to shared memory as a new generation
+     *
+     * Query processes attached with attachSharedCatalog() switch to it at
+     * their next command; the previous generation's name is removed.
+     *
+     * @param name Shared-memory base name (e.g. "/inv_catalog")
+     * @param generation Receives the published generation number
+     * @return true if the generation was published
+     *
+     * Time Complexity: O(n + catalog bytes)
+     */
+    bool publishCatalog(const std::string &name, std::uint64_t *generation = nullptr) const {
+        MappedTableBuilder<Product> products;
+        MappedTableBuilder<std::vector<std::string>> index;
+        buildCatalog(products, index);
+        return publishSharedCatalog(name, packMappedImages({&products.image(), &index.image()}), generation);
+    }
+
+    /**
+     * Serve a catalog file written by saveCatalog() instead of loading a CSV
+     *
+     * The file is memory-mapped read-only: lookups decode products straight
+     * from the shared page cache, so any number of processes can open the
+     * same file and share one copy of the catalog. The engine is read-only
+     * afterwards (load() fails).
+     *
+     * @param path Catalog file
+     * @return false if the engine already holds data or the file is not a
+     *         valid catalog
+     */
+    bool openCatalog(const std::string &path) {
+        if (mapped_ || frozen_ || table_.size() != 0) return false;
+        catalog_ = MappedCatalog::openFile(path);
+        mapped_ = catalog_ != nullptr;
+        ++generation_;
+        return mapped_;
+    }
+
+    /**
+     * Serve the shared-memory catalog published under name (by another
+     * process's publishCatalog()) instead of loading a CSV
+     *
+     * Lookups read the shared pages directly. Before each command the
+     * engine checks the published generation and maps a newer one, so
+     * republished data is served without a restart. The engine is
+     * read-only afterwards (load() fails).
+     *
+     * @param name Base name given to publishCatalog()
+     * @return false if the engine already holds data or nothing has been
+     *         published under name
+     */
+    bool attachSharedCatalog(const std::string &name) {
+        if (mapped_ || frozen_ || table_.size() != 0) return false;
+        std::unique_ptr<SharedCatalogReader> reader(new SharedCatalogReader());
+        if (!reader->attach(name)) return false;
+        sharedCatalog_ = std::move(reader);
+        mapped_ = true;
+        ++generation_;
+        return true;
+    }
+
+    /** true once openCatalog() or attachSharedCatalog() has succeeded */
+    bool mapped() const { return mapped_; }
+
+    /**
+     * Mapped catalog to serve from (nullptr unless mapped()); with a shared
+     * catalog, the newest generation. A generation stays mapped while the
+     * returned pointer is held.
+     */
+    std::shared_ptr<const MappedCatalog> mappedCatalog() const {
+        return sharedCatalog_ ? sharedCatalog_->current() : catalog_;
+    }
+
+    /**
+     * Start logging mutations for replicas (see Headers/Replication.hpp)
+     *
+     * The log starts with one upsert per product already loaded, in source
+     * record order, so a replica that reads it from position 0 builds the
+     * same catalog. Every later load(), upsertProduct() and eraseProduct()
+     * is appended.
+     *
+     * @return false if the engine is frozen or mapped (read-only)
+     *
+     * Time Complexity: O(n log n + catalog bytes)
+     */
+    bool enableMutationLog() {
+        if (frozen_ || mapped_) return false;
+        if (log_) return true;
+        std::vector<const Product *> rows;
+        rows.reserve(table_.size());
+        table_.forEach([&](const std::string &, const Product &p) { rows.push_back(&p); });
+        std::sort(rows.begin(), rows.end(), [](const Product *a, const Product *b) {
+            return a->recordIndex != b->recordIndex ? a->recordIndex < b->recordIndex : a->uniqId < b->uniqId;
+        });
+        log_.reset(new MutationLog());
+        for (const Product *p : rows) log_->appendUpsert(complete(*p));
+        return true;
+    }
+
+    /** Mutation log (nullptr until enableMutationLog()) */
+    const MutationLog *mutationLog() const { return log_.get(); }
+
+    /**
+     * Start emitting change events (see Headers/ChangeFeed.hpp)
+     *
+     * From now on every product insert, erase or field update applied to
+     * this engine (including those a replica receives from its primary) is
+     * recorded; upserts that change nothing are not. Calling it again
+     * returns the existing feed.
+     *
+     * @param window How long events are held for per-id coalescing
+     * @param maxBatch Distinct pending ids that cut a window short
+     * @return The feed, for subscribe() or a ChangeFeedServer
+     */
+    ChangeFeed &enableChangeFeed(std::chrono::milliseconds window = cdc::kDefaultWindow,
+                                 std::size_t maxBatch = cdc::kDefaultMaxBatch) {
+        if (!feed_) feed_.reset(new ChangeFeed(window, maxBatch));
+        return *feed_;
+    }
+
+    /** Change feed (nullptr until enableChangeFeed()) */
+    ChangeFeed *changeFeed() const { return feed_.get(); }
+
+    /**
+     * Cache the output of `find` and `listInventory` (see ResultCache.hpp)
+     *
+     * Entries are tagged with the dataset generation, which every load,
+     * mutation, freeze or catalog swap advances, so a changed catalog is
+     * never answered from the cache.
+     *
+     * @param capacityBytes Cache size bound; 0 disables the cache
+     */
+    void enableResultCache(std::size_t capacityBytes) {
+        if (capacityBytes == 0) resultCache_.reset();
+        else resultCache_.reset(new ResultCache(capacityBytes));
+    }
+
+    /** Result cache (nullptr unless enabled) */
+    const ResultCache *resultCache() const { return resultCache_.get(); }
+
+    /**
+     * Coalesce identical concurrent `listInventory` commands (see
+     * SingleFlight.hpp): while one thread scans a category, others asking
+     * for the same category at the same generation wait and share its
+     * output. `find` is a single lookup and is never coalesced.
+     *
+     * @param enable true to coalesce, false to run every command itself
+     */
+    void enableRequestCoalescing(bool enable) {
+        if (!enable) singleFlight_.reset();
+        else if (!singleFlight_) singleFlight_.reset(new SingleFlight());
+    }
+
+    /** Coalescing state (nullptr unless enabled) */
+    const SingleFlight *requestCoalescing() const { return singleFlight_.get(); }
+
+    /**
+     * Dataset generation: changes whenever command output may change
+     * (load, mutation, freeze, opening or swapping a mapped catalog)
+     */
+    std::uint64_t generation() const {
+        std::shared_lock<std::shared_timed_mutex> lock(dataMutex_);
+        std::shared_ptr<const MappedCatalog> cat = mapped_ ? mappedCatalog() : nullptr;
+        return generation(cat.get());
+    }
+
+    /**
+     * Insert a product or replace the one with the same Uniq Id
+     *
+     * The id stays at its place in categories it already belonged to, is
+     * removed from categories it left and appended to ones it joined.
+     *
+     * @param p Complete product (uniqId must be set)
+     * @return false if the engine is read-only or p has no id
+     *
+     * Time Complexity: O(1) average plus O(size) of each category left
+     */
+    bool upsertProduct(Product p) {
+        if (frozen_ || mapped_ || p.uniqId.empty()) return false;
+        std::unique_lock<std::shared_timed_mutex> lock(dataMutex_);
+        applyUpsert(std::move(p));
+        return true;
+    }
+
+    /**
+     * Remove a product and its category index entries
+     *
+     * @param id Uniq Id
+     * @return false if the engine is read-only or has no such product
+     *
+     * Time Complexity: O(1) average plus O(size) of each of its categories
+     */
+    bool eraseProduct(const std::string &id) {
+        if (frozen_ || mapped_) return false;
+        std::unique_lock<std::shared_timed_mutex> lock(dataMutex_);
+        return applyErase(id);
+    }
+
+    /**
+     * Apply a batch of mutations under one exclusive lock (how replicas
+     * apply what they receive); products are moved out of the batch
+     *
+     * @param batch Decoded log records, applied in order
+     * @return false if the engine is read-only
+     */
+    bool applyMutations(std::vector<Mutation> &batch) {
+        if (frozen_ || mapped_) return false;
+        std::unique_lock<std::shared_timed_mutex> lock(dataMutex_);
+        for (auto &m : batch) {
+            if (m.op == Mutation::Upsert) applyUpsert(std::move(m.product));
+            else applyErase(m.product.uniqId);
+        }
+        return true;
+    }
+
+    /** Number of products (in the table, the frozen snapshot or the mapped catalog) */
+    std::size_t productCount() const {
+        std::shared_lock<std::shared_timed_mutex> lock(dataMutex_);
+        if (mapped_) {
+            std::shared_ptr<const MappedCatalog> cat = mappedCatalog();
+            return cat ? cat->products.size() : 0;
+        }
+        return frozen_ ? snapshot_.size() : table_.size();
+    }
+
+    /**
+     * Display help information about available commands
+     * @param out Stream to write to
+     */
+    static void printHelp(std::ostream &out) {
+        out << "Supported list of commands: " << '\n';
+        out << " 1. find <inventoryid> - Finds if the inventory exists. If exists, prints details. If not, prints 'Inventory not found'." << '\n';
+        out << " 2. listInventory <category_string> - Lists just the id and name of all inventory belonging to the specified category. If the category doesn't exists, prints 'Invalid Category'." << '\n';
+        out << " 3. :tablestats - Prints bucket chain and probe statistics for the product hash table." << '\n';
+        out << " 4. :stats - Prints per-command counts, latency and (if enabled) hardware counters." << '\n';
+        out << " 5. :memory - Prints exact bytes used by the product table and category index.\n"
+            << '\n';
+        out << " Use :quit to quit the REPL" << '\n';
+    }
+
+    /**
+     * Validate whether a command line is recognized
+     * @param line User input command
+     * @return true if command is valid, false otherwise
+     */
+    static bool validCommand(const std::string &line) {
+        return (line == ":help") ||
+               (line == ":tablestats") ||
+               (line == ":stats") ||
+               (line == ":memory") ||
+               (line.rfind("find", 0) == 0) ||
+               (line.rfind("listInventory", 0) == 0);
+    }
+
+    /**
+     * Turn on per-command statistics reported by `:stats`
+     *
+     * Wall-clock time is always collected once enabled. With
+     * hardwareCounters, each evaluating thread also opens a PerfCounters
+     * group and the cycles/instructions/cache/branch misses of every command
+     * are added to its kind's totals.
+     *
+     * @param hardwareCounters Also collect perf_event counters
+     */
+    void enableCommandStats(bool hardwareCounters = false) {
+        statsEnabled_ = true;
+        perfEnabled_ = hardwareCounters;
+    }
+
+    /**
+     * Evaluate and execute a user command
+     * Parses the command and its arguments, then performs the requested action
+     *
+     * @param line User input command string
+     * @param out Stream that receives the command's output
+     */
+    void evalCommand(const std::string &line, std::ostream &out) const {
+        if (!statsEnabled_) { dispatch(line, out); return; }
+
+        using Clock = std::chrono::steady_clock;
+        PerfCounters *pc = perfEnabled_ ? &threadCounters() : nullptr;
+        PerfSample before = pc ? pc->read() : PerfSample();
+        auto start = Clock::now();
+        dispatch(line, out);
+        double sec = std::chrono::duration<double>(Clock::now() - start).count();
+        PerfSample delta = pc ? pc->read() - before : PerfSample();
+
+        std::lock_guard<std::mutex> lock(statsMutex_);
+        CommandStats &cs = commandStats_[commandKind(line)];
+        ++cs.count;
+        cs.totalSec += sec;
+        if (sec > cs.maxSec) cs.maxSec = sec;
+        cs.perf += delta;
+    }
+
+    /**
+     * Print per-command statistics (the `:stats` command)
+     * @param out Stream to write to
+     */
+    void printCommandStats(std::ostream &out) const {
+        if (resultCache_) {
+            ResultCacheStats rc = resultCache_->stats();
+            std::uint64_t lookups = rc.hits + rc.misses;
+            auto flags = out.flags();
+            auto prec = out.precision();
+            out << "Result cache: " << rc.hits << " hits, " << rc.misses << " misses (" << rc.stale << " stale), "
+                << std::fixed << std::setprecision(1) << (lookups ? 100.0 * static_cast<double>(rc.hits) / static_cast<double>(lookups) : 0.0)
+                << "% hit rate; " << rc.entries << " entries, " << rc.bytes << " / " << rc.capacityBytes << " bytes, "
+                << rc.evictions << " evictions" << '\n';
+            out.flags(flags);
+            out.precision(prec);
+        }
+        if (singleFlight_) {
+            SingleFlightStats sf = singleFlight_->stats();
+            out << "Request coalescing: " << sf.computed << " computed, " << sf.shared << " shared" << '\n';
+        }
+        if (!statsEnabled_) { out << "Command statistics are disabled" << '\n'; return; }
+        if (perfEnabled_ && !threadCounters().available()) {
+            out << "Hardware counters unavailable (" << threadCounters().error() << ")" << '\n';
+        }
+        std::lock_guard<std::mutex> lock(statsMutex_);
+        auto flags = out.flags();
+        auto prec = out.precision();
+        out << std::fixed;
+        for (const auto &kv : commandStats_) {
+            const CommandStats &cs = kv.second;
+            out << kv.first << ": " << cs.count << " calls, avg "
+                << std::setprecision(1) << (cs.count ? 1e6 * cs.totalSec / static_cast<double>(cs.count) : 0.0) << " us, max "
+                << 1e6 * cs.maxSec << " us" << '\n';
+            if (cs.perf.valid) {
+                out << "  per call: ";
+                printPerf(out, cs.perf, cs.count);
+                out << '\n';
+            }
+        }
+        out.flags(flags);
+        out.precision(prec);
+    }
+
+    /** Product table (Uniq Id -> Product); empty once frozen */
+    const ProductTable &table() const { return table_; }
+
+    /** Read-only snapshot (Uniq Id -> Product); empty until frozen */
+    const PerfectHashTable<Product> &snapshot() const { return snapshot_; }
+
+    /**
+     * Visit the products listed under a category, in index order
+     *
+     * @param category Category name
+     * @param fn Called as fn(id, product) for each product in the category
+     * @return false if the category does not exist
+     */
+    template <typename F>
+    bool forEachInCategory(const std::string &category, F fn) const {
+        std::shared_lock<std::shared_timed_mutex> lock(dataMutex_);
+        std::shared_ptr<const MappedCatalog> cat = mapped_ ? mappedCatalog() : nullptr;
+        return forEachInCategory(category, cat.get(), fn);
+    }
+
+    /** Category index (Category -> Uniq Ids) */
+    const std::unordered_map<std::string, std::vector<std::string>> &categoryIndex() const { return categoryIndex_; }
+
+    /** Compressed descriptions (empty unless setCompressDescriptions(true)) */
+    const DescriptionStore &descriptions() const { return descriptions_; }
+
+private:
+    ProductTable table_;
+    std::unordered_map<std::string, std::vector<std::string>> categoryIndex_;
+    DescriptionStore descriptions_;
+    bool compressDescriptions_ {false};
+    ColdFieldStore coldFields_;
+    bool lazyColdFields_ {false};
+    std::size_t loadParsers_ {0};  // Parser threads of a pipelined load (0 = loadCsv)
+    ShardFilter shard_;
+    PerfectHashTable<Product> snapshot_;
+    bool frozen_ {false};
+    std::shared_ptr<const MappedCatalog> catalog_;
+    std::unique_ptr<SharedCatalogReader> sharedCatalog_;
+    bool mapped_ {false};
+    std::unique_ptr<MutationLog> log_;
+    std::unique_ptr<ChangeFeed> feed_;
+    std::unique_ptr<ResultCache> resultCache_;
+    std::unique_ptr<SingleFlight> singleFlight_;
+    RenderedStore rendered_;
+    bool prerender_ {false};
+    std::uint64_t generation_ {0};  // Local changes; written under dataMutex_ held exclusively
+    mutable std::shared_timed_mutex dataMutex_;  // Shared: commands; exclusive: mutations
+
+    // Per-command statistics (see enableCommandStats)
+    bool statsEnabled_ {false};
+    bool perfEnabled_ {false};
+    mutable std::mutex statsMutex_;
+    mutable std::map<std::string, CommandStats> commandStats_;
+
+    /**
+     * Hardware counters for the calling thread (opened on first use)
+     */
+    static PerfCounters &threadCounters() {
+        static thread_local PerfCounters counters;
+        return counters;
+    }
+
+    using CategoryIndex = std::unordered_map<std::string, std::vector<std::string>>;
+
+    /**
+     * Body of load(): run `loadInto(table, index, descriptions, coldFields)`
+     * into the live table, or into a scratch table whose products are then
+     * applied as upserts (with a mutation log or change feed)
+     *
+     * The scratch load gets stores of its own, so compressed descriptions
+     * and deferred cold fields work there too; once the lock is held, its
+     * source files are adopted into coldFields_ and its descriptions
+     * re-added to descriptions_.
+     */
+    template <typename F>
+    bool loadWith(F loadInto) {
+        if (frozen_ || mapped_) return false;  // Snapshots and mapped catalogs are read-only
+        if (log_ || feed_) {
+            ProductTable loaded;
+            CategoryIndex index;
+            DescriptionStore descriptions;
+            ColdFieldStore coldFields;
+            if (!loadInto(loaded, index, compressDescriptions_ ? &descriptions : nullptr,
+                          lazyColdFields_ ? &coldFields : nullptr)) return false;
+            std::vector<Product *> rows;
+            rows.reserve(loaded.size());
+            loaded.forEach([&](const std::string &, Product &p) { rows.push_back(&p); });
+            std::sort(rows.begin(), rows.end(), [](const Product *a, const Product *b) { return a->recordIndex < b->recordIndex; });
+            std::unique_lock<std::shared_timed_mutex> lock(dataMutex_);
+            const std::uint32_t coldBase = coldFields_.adopt(coldFields);
+            for (Product *p : rows) {
+                if (p->sourceRef != ColdFieldStore::kNone) p->sourceRef += coldBase;
+                if (p->descriptionRef != DescriptionStore::kNone) p->descriptionRef = descriptions_.add(descriptions.get(p->descriptionRef));
+                applyUpsert(std::move(*p));
+            }
+            descriptions_.seal();
+            return true;
+        }
+        ++generation_;
+        bool ok = loadInto(table_, categoryIndex_, compressDescriptions_ ? &descriptions_ : nullptr,
+                           lazyColdFields_ ? &coldFields_ : nullptr);
+        descriptions_.seal();
+        if (prerender_) renderAll();
+        return ok;
+    }
+
+    /** loadCsv(), or loadCsvPipelined() after setLoadPipeline() */
+    bool loadFile(const std::string &path, ProductTable &table, std::unordered_map<std::string, std::vector<std::string>> &index,
+                  LoadStats *stats, DescriptionStore *descriptions, ColdFieldStore *coldFields) const {
+        const ShardFilter *shard = shard_.count > 1 ? &shard_ : nullptr;
+        if (loadParsers_ == 0) return loadCsv(path, table, index, stats, descriptions, coldFields, shard);
+        LoadPipelineOptions options;
+        options.parsers = loadParsers_;
+        return loadCsvPipelined(path, table, index, options, stats, descriptions, coldFields, shard);
+    }
+
+    /**
+     * Fill a builder pair with every product (cold fields and descriptions
+     * resolved) and the category index
+     */
+    void buildCatalog(MappedTableBuilder<Product> &products, MappedTableBuilder<std::vector<std::string>> &index) const {
+        auto addProduct = [&](const std::string &key, const Product &p) {
+            if (p.sourceRef == ColdFieldStore::kNone && p.descriptionRef == DescriptionStore::kNone) products.add(key, p);
+            else products.add(key, complete(p));
+        };
+        if (mapped_) {
+            std::shared_ptr<const MappedCatalog> cat = mappedCatalog();
+            if (!cat) return;
+            cat->products.forEach(addProduct);
+            cat->categories.forEach([&](const std::string &c, const std::vector<std::string> &ids) { index.add(c, ids); });
+        } else {
+            if (frozen_) snapshot_.forEach(addProduct);
+            else table_.forEach(addProduct);
+            for (const auto &kv : categoryIndex_) index.add(kv.first, kv.second);
+        }
+    }
+
+    /**
+     * Copy of p with deferred cold fields and compressed description filled in
+     * (cold fields are parsed without caching: callers visit the whole catalog)
+     */
+    Product complete(const Product &p) const {
+        Product full = p;
+        if (full.sourceRef != ColdFieldStore::kNone) coldFields_.fill(full, false);
+        if (full.descriptionRef != DescriptionStore::kNone) full.productDescription = descriptions_.get(full.descriptionRef);
+        full.sourceRef = ColdFieldStore::kNone;
+        full.descriptionRef = DescriptionStore::kNone;
+        return full;
+    }
+
+    /** A product's `find` output (cold fields and description resolved) */
+    std::string render(const Product &p) const {
+        std::ostringstream out;
+        if (p.sourceRef != ColdFieldStore::kNone) {
+            Product full = p;
+            coldFields_.fill(full, false);  // Rendered once; the rendered store keeps the result
+            printProduct(full, out, &descriptions_);
+        } else {
+            printProduct(p, out, &descriptions_);
+        }
+        return out.str();
+    }
+
+    /** Rebuild rendered_ from the table (or just clear it when disabled) */
+    void renderAll() {
+        rendered_.clear();
+        table_.forEach([&](const std::string &, Product &p) {
+            p.renderedRef = prerender_ ? rendered_.add(render(p)) : RenderedStore::kNone;
+        });
+    }
+
+    /** Rebuild rendered_ once released blocks outweigh live ones */
+    void reclaimRendered() {
+        if (rendered_.garbageBytes() >= RenderedStore::kChunkBytes && rendered_.garbageBytes() > rendered_.liveBytes()) renderAll();
+    }
+
+    /** Remove id from one category's list (and the category once empty) */
+    void unindex(const std::string &category, const std::string &id) {
+        auto it = categoryIndex_.find(category);
+        if (it == categoryIndex_.end()) return;
+        auto &ids = it->second;
+        ids.erase(std::remove(ids.begin(), ids.end(), id), ids.end());
+        if (ids.empty()) categoryIndex_.erase(it);
+    }
+
+    /** upsertProduct() with dataMutex_ held exclusively */
+    void applyUpsert(Product p) {
+        ++generation_;
+        // The log and the feed carry every field, deferred or not
+        const Product *whole = &p;
+        Product full;
+        if ((log_ || feed_) && (p.sourceRef != ColdFieldStore::kNone || p.descriptionRef != DescriptionStore::kNone)) {
+            full = complete(p);
+            whole = &full;
+        }
+        if (log_) log_->appendUpsert(*whole);
+        const Product *old = table_.find(p.uniqId);
+        std::vector<std::string> before;
+        if (old) before = old->categories;
+        auto has = [](const std::vector<std::string> &v, const std::string &c) {
+            return std::find(v.begin(), v.end(), c) != v.end();
+        };
+        if (feed_) {
+            if (!old) feed_->record(ChangeEvent::Insert, p.uniqId);
+            else if (std::uint16_t fields = changedFields(old->sourceRef == ColdFieldStore::kNone && old->descriptionRef == DescriptionStore::kNone ? *old : complete(*old), *whole)) {
+                feed_->record(ChangeEvent::Update, p.uniqId, fields);
+            }
+        }
+        for (const auto &c : before) if (!has(p.categories, c)) unindex(c, p.uniqId);
+        for (const auto &c : p.categories) if (!has(before, c)) categoryIndex_[c].push_back(p.uniqId);
+        if (old && old->sourceRef != ColdFieldStore::kNone && old->sourceRef != p.sourceRef) coldFields_.forget(old->sourceRef);
+        p.renderedRef = RenderedStore::kNone;  // Handles are local to this engine's store
+        if (prerender_) {
+            if (old) rendered_.release(old->renderedRef);
+            p.renderedRef = rendered_.add(render(p));
+        }
+        std::string key = p.uniqId;
+        table_.insert(std::move(key), std::move(p));
+        if (prerender_) reclaimRendered();
+    }
+
+    /** eraseProduct() with dataMutex_ held exclusively */
+    bool applyErase(const std::string &id) {
+        const Product *old = table_.find(id);
+        if (!old) return false;
+        ++generation_;
+        if (log_) log_->appendErase(id);
+        if (feed_) feed_->record(ChangeEvent::Erase, id);
+        for (const auto &c : old->categories) unindex(c, id);
+        rendered_.release(old->renderedRef);
+        if (old->sourceRef != ColdFieldStore::kNone) coldFields_.forget(old->sourceRef);
+        bool erased = table_.erase(id);
+        if (prerender_) reclaimRendered();
+        return erased;
+    }
+
+    /**
+     * Find a product in the table, in the snapshot once frozen, or in the
+     * mapped catalog cat (decoded into scratch)
+     */
+    const Product *lookup(const std::string &id, Product &scratch, const MappedCatalog *cat) const {
+        if (mapped_) return cat && cat->products.find(id, scratch) ? &scratch : nullptr;
+        return frozen_ ? snapshot_.find(id) : table_.find(id);
+    }
+
+    /**
+     * forEachInCategory() against a pinned mapped catalog generation
+     */
+    template <typename F>
+    bool forEachInCategory(const std::string &category, const MappedCatalog *cat, F fn) const {
+        const std::vector<std::string> *ids = nullptr;
+        std::vector<std::string> mappedIds;
+        if (mapped_) {
+            if (cat && cat->categories.find(category, mappedIds)) ids = &mappedIds;
+        } else {
+            auto it = categoryIndex_.find(category);
+            if (it != categoryIndex_.end()) ids = &it->second;
+        }
+        if (!ids) return false;
+
+        Product scratch;
+        for (const auto &id : *ids) {
+            const Product *p = lookup(id, scratch, cat);
+            if (p) fn(id, *p);
+        }
+        return true;
+    }
+
+    /**
+     * Name under which a command's statistics are aggregated
+     * Commands with arguments are grouped by their first word.
+     */
+    static std::string commandKind(const std::string &line) {
+        auto pos = line.find(' ');
+        return pos == std::string::npos ? line : line.substr(0, pos);
+    }
+
+    /** generation() for a pinned mapped catalog (shared generations count too) */
+    std::uint64_t generation(const MappedCatalog *cat) const {
+        return generation_ + (cat ? cat->generation << 32 : 0);
+    }
+
+    /**
+     * Cache key of a cacheable command: "f:<id>" for find, "l:<category>"
+     * for listInventory (arguments trimmed as dispatch() trims them)
+     *
+     * @return false if the command's output must not be cached
+     */
+    static bool cacheKey(const std::string &line, std::string &key) {
+        char kind;
+        if (line.rfind("find", 0) == 0) kind = 'f';
+        else if (line.rfind("listInventory", 0) == 0) kind = 'l';
+        else return false;
+        auto pos = line.find(' ');
+        if (pos == std::string::npos || pos + 1 >= line.size()) return false;
+        std::string arg = detail::trim(line.substr(pos + 1));
+        if (arg.empty()) return false;
+        key.reserve(arg.size() + 2);
+        key.assign(1, kind);
+        key += ':';
+        key += arg;
+        return true;
+    }
+
+    /**
+     * Execute a command without collecting statistics
+     * Query output comes from the result cache when it holds an entry of
+     * the current generation; otherwise it is rendered (by this thread, or
+     * by an identical listInventory already in flight) and cached.
+     */
+    void dispatch(const std::string &line, std::ostream &out) const {
+        std::shared_lock<std::shared_timed_mutex> lock(dataMutex_);
+        // Pin one catalog generation for the whole command
+        std::shared_ptr<const MappedCatalog> cat = mapped_ ? mappedCatalog() : nullptr;
+        std::string key;
+        if ((resultCache_ || singleFlight_) && cacheKey(line, key)) {
+            std::uint64_t gen = generation(cat.get());
+            if (resultCache_ && resultCache_->lookup(key, gen, out)) return;
+            auto render = [&]() {
+                std::ostringstream rendered;
+                execute(line, rendered, cat);
+                return rendered.str();
+            };
+            if (singleFlight_ && key[0] == 'l') {
+                bool leader = false;
+                std::shared_ptr<const std::string> text = singleFlight_->run(key, gen, render, &leader);
+                out.write(text->data(), static_cast<std::streamsize>(text->size()));
+                if (resultCache_ && leader) resultCache_->insert(key, gen, std::move(text));
+                return;
+            }
+            if (resultCache_) {
+                std::string text = render();
+                out.write(text.data(), static_cast<std::streamsize>(text.size()));
+                resultCache_->insert(key, gen, std::move(text));
+                return;
+            }
+        }
+        execute(line, out, cat);
+    }
+
+    /**
+     * Evaluate a command against a pinned catalog generation
+     */
+    void execute(const std::string &line, std::ostream &out, const std::shared_ptr<const MappedCatalog> &cat) const {
+        if (line == ":help")
+        {
+            printHelp(out);
+        }
+        else if (line == ":tablestats")
+        {
+            if (cat) {
+                out << "Memory-mapped catalog: " << cat->products.imageBytes() << " bytes of product table";
+                if (cat->generation != 0) out << " (shared generation " << cat->generation << ")";
+                out << '\n';
+                printTableStats(cat->products.stats(), out);
+            }
+            else if (frozen_) printPerfectHashStats(snapshot_.stats(), out);
+            else printTableStats(table_.stats(), out);
+        }
+        else if (line == ":stats")
+        {
+            printCommandStats(out);
+        }
+        else if (line == ":memory")
+        {
+            const DescriptionStore *descriptions = compressDescriptions_ ? &descriptions_ : nullptr;
+            const ColdFieldStore *coldFields = lazyColdFields_ ? &coldFields_ : nullptr;
+            const RenderedStore *rendered = prerender_ ? &rendered_ : nullptr;
+            if (cat) printMemoryReport(measureMappedMemory(cat->products, cat->categories, cat->heapBytes), out);
+            else if (frozen_) printMemoryReport(measureMemory(snapshot_, categoryIndex_, descriptions, coldFields, rendered), out);
+            else printMemoryReport(measureMemory(table_, categoryIndex_, descriptions, coldFields, rendered), out);
+        }
+        else if (line.rfind("find", 0) == 0)
+        {
+            // Command: find <id>
+            // Searches for a product by unique ID and displays full details
+            auto pos = line.find(' ');
+            if (pos == std::string::npos || pos + 1 >= line.size()) {
+                out << "Inventory not found" << '\n';
+                return;
+            }
+            std::string id = detail::trim(line.substr(pos + 1));
+            if (id.empty()) {
+                out << "Inventory not found" << '\n';
+                return;
+            }
+
+            // Lookup product in hash table (O(1) average case)
+            Product scratch;
+            auto *p = lookup(id, scratch, cat.get());
+            if (!p) {
+                out << "Inventory not found" << '\n';
+            } else if (p->renderedRef != RenderedStore::kNone) {
+                // Pre-rendered: one write of the stored bytes
+                rendered_.write(p->renderedRef, out);
+            } else if (p->sourceRef != ColdFieldStore::kNone) {
+                Product full = *p;
+                coldFields_.fill(full);
+                printProduct(full, out, &descriptions_);
+            } else {
+                printProduct(*p, out, &descriptions_);
+            }
+        }
+        else if (line.rfind("listInventory", 0) == 0)
+        {
+            // Command: listInventory <category>
+            // Lists all products belonging to a specific category
+            auto pos = line.find(' ');
+            if (pos == std::string::npos || pos + 1 >= line.size()) {
+                out << "Invalid Category" << '\n';
+                return;
+            }
+            std::string category = detail::trim(line.substr(pos + 1));
+
+            // Iterate through all product IDs in this category (if it exists)
+            bool found = forEachInCategory(category, cat.get(), [&](const std::string &id, const Product &p) {
+                out << id << " - " << p.productName << '\n';
+            });
+            if (!found) {
+                out << "Invalid Category" << '\n';
+            }
+        }
+    }
+};
+
+} // namespace inv
@@ -0,0 +1,439 @@
+/**
+ * Gzip.hpp
+ *
+ * Self-contained streaming gzip decoder (RFC 1952 members holding RFC 1951
+ * deflate data), so compressed feeds can be loaded without a temporary
+ * uncompressed file and without linking zlib.
+ *
+ * gzip::Decoder pulls compressed bytes through a read callback and hands
+ * decompressed output to a write callback in blocks (256 KiB by default),
+ * keeping only the 32 KiB deflate window in between. Every member's CRC-32
+ * and length are checked; concatenated members (as `cat a.gz b.gz` makes)
+ * decode as one stream.
+ *
+ * Huffman decoding follows the usual table scheme: codes of up to 10 bits
+ * are resolved with one lookup in a table indexed by the next 10 input bits;
+ * longer codes fall back to a canonical-code walk over the remaining
+ * lengths.
+ *
+ * Errors (truncated input, corrupt data, checksum mismatch) make run()
+ * return false with a message in error(); output already written stays
+ * written.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace inv {
+
+namespace gzip {
+
+/** Deflate's back-reference window */
+constexpr std::size_t kWindow = 32768;
+
+/**
+ * CRC-32 (IEEE, as used by gzip) of a buffer, continuing from crc
+ * (start with 0)
+ */
+inline std::uint32_t crc32(std::uint32_t crc, const char *p, std::size_t n) {
+    static const std::vector<std::uint32_t> table = []() {
+        std::vector<std::uint32_t> t(256);
+        for (std::uint32_t i = 0; i < 256; ++i) {
+            std::uint32_t c = i;
+            for (int k = 0; k < 8; ++k) c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            t[i] = c;
+        }
+        return t;
+    }();
+    crc = ~crc;
+    for (std::size_t i = 0; i < n; ++i) crc = table[(crc ^ static_cast<unsigned char>(p[i])) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+/** true if a buffer starts with the gzip magic bytes */
+inline bool isGzip(const char *p, std::size_t n) {
+    return n >= 2 && static_cast<unsigned char>(p[0]) == 0x1F && static_cast<unsigned char>(p[1]) == 0x8B;
+}
+
+namespace detail {
+
+constexpr int kFastBits = 10;
+
+/**
+ * Canonical Huffman code with a kFastBits-bit lookup table
+ */
+struct Huffman {
+    std::uint16_t fast[1 << kFastBits];  // (length << 9) | symbol, 0 = longer code
+    std::uint16_t firstCode[16];
+    std::uint32_t maxCode[17];           // Per length, first code not of that length, shifted to 16 bits
+    std::uint16_t firstSymbol[16];
+    std::uint8_t size[288];
+    std::uint16_t value[288];
+
+    /**
+     * Build from per-symbol code lengths (0 = unused)
+     * @return false if the lengths oversubscribe the code space
+     */
+    bool build(const std::uint8_t *lengths, int count) {
+        int sizes[17] = {0};
+        int nextCode[16];
+        std::memset(fast, 0, sizeof(fast));
+        for (int i = 0; i < count; ++i) ++sizes[lengths[i]];
+        sizes[0] = 0;
+        int code = 0, k = 0;
+        for (int i = 1; i < 16; ++i) {
+            if (sizes[i] > (1 << i)) return false;
+            nextCode[i] = code;
+            firstCode[i] = static_cast<std::uint16_t>(code);
+            firstSymbol[i] = static_cast<std::uint16_t>(k);
+            code += sizes[i];
+            if (sizes[i] && code - 1 >= (1 << i)) return false;
+            maxCode[i] = static_cast<std::uint32_t>(code) << (16 - i);
+            code <<= 1;
+            k += sizes[i];
+        }
+        maxCode[16] = 0x10000;
+        for (int i = 0; i < count; ++i) {
+            int s = lengths[i];
+            if (!s) continue;
+            int c = nextCode[s] - firstCode[s] + firstSymbol[s];
+            size[c] = static_cast<std::uint8_t>(s);
+            value[c] = static_cast<std::uint16_t>(i);
+            if (s <= kFastBits) {
+                for (int j = reverse(nextCode[s], s); j < (1 << kFastBits); j += 1 << s) {
+                    fast[j] = static_cast<std::uint16_t>(s << 9 | i);
+                }
+            }
+            ++nextCode[s];
+        }
+        return true;
+    }
+
+    /** The low n bits of v in reverse order */
+    static int reverse(int v, int n) {
+        int r = 0;
+        for (int i = 0; i < n; ++i, v >>= 1) r = r << 1 | (v & 1);
+        return r;
+    }
+};
+
+constexpr std::uint16_t kLengthBase[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                                           35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+constexpr std::uint8_t kLengthExtra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                                           3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+constexpr std::uint16_t kDistBase[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+                                         257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+                                         8193, 12289, 16385, 24577};
+constexpr std::uint8_t kDistExtra[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+                                         7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+} // namespace detail
+
+/**
+ * Decoder - Decompresses one gzip stream from a read callback
+ */
+class Decoder {
+public:
+    /** Fills buf with up to n compressed bytes; returns 0 at end of input */
+    using Read = std::function<std::size_t(char *buf, std::size_t n)>;
+
+    /** Receives decompressed bytes; returning false stops decoding */
+    using Write = std::function<bool(const char *data, std::size_t n)>;
+
+    /**
+     * @param read Source of compressed bytes
+     * @param blockBytes Output bytes collected per write() call
+     */
+    explicit Decoder(Read read, std::size_t blockBytes = 256 * 1024)
+        : read_(std::move(read)), in_(64 * 1024), out_(kWindow + (blockBytes < 1024 ? 1024 : blockBytes)) {}
+
+    Decoder(const Decoder &) = delete;
+    Decoder &operator=(const Decoder &) = delete;
+
+    /**
+     * Decode every member until the input ends
+     *
+     * @param write Receives the output in order
+     * @return false on malformed input or if write() stopped decoding
+     *
+     * Time Complexity: O(compressed + decompressed bytes)
+     */
+    bool run(const Write &write) {
+        bool first = true;
+        do {
+            if (!readHeader(first)) return false;
+            first = false;
+            if (!inflateMember(write)) return false;
+            alignToByte();
+            std::uint32_t crc = bits(32);
+            std::uint32_t length = bits(32);
+            if (overrun_) return fail("truncated gzip trailer");
+            if (crc != crc_) return fail("gzip CRC mismatch");
+            if (length != static_cast<std::uint32_t>(memberBytes_)) return fail("gzip length mismatch");
+            crc_ = 0;
+            memberBytes_ = 0;
+        } while (!atEnd());
+        return true;
+    }
+
+    /** Why run() returned false */
+    const std::string &error() const { return error_; }
+
+    /** Compressed bytes read so far */
+    std::uint64_t inputBytes() const { return inputBytes_; }
+
+    /** Decompressed bytes written so far */
+    std::uint64_t outputBytes() const { return outputBytes_; }
+
+private:
+    Read read_;
+    std::vector<char> in_;
+    std::size_t inPos_ {0};
+    std::size_t inEnd_ {0};
+    bool inputDone_ {false};
+    std::uint64_t bitBuf_ {0};
+    unsigned bitCount_ {0};
+    bool overrun_ {false};  // More bits were consumed than the input held
+
+    std::vector<char> out_;      // Window history followed by the block being filled
+    std::size_t outPos_ {0};
+    std::size_t outFlushed_ {0};
+    std::uint64_t memberBytes_ {0};
+    std::uint32_t crc_ {0};
+    std::uint64_t inputBytes_ {0};
+    std::uint64_t outputBytes_ {0};
+
+    detail::Huffman lit_, dist_, fixedLit_, fixedDist_;
+    bool fixedBuilt_ {false};
+    std::string error_;
+
+    bool fail(const char *message) {
+        if (error_.empty()) error_ = message;
+        return false;
+    }
+
+    // ---- Input bits (LSB first) ----
+
+    bool refill() {
+        if (inputDone_) return false;
+        inPos_ = 0;
+        inEnd_ = read_(in_.data(), in_.size());
+        inputBytes_ += inEnd_;
+        if (inEnd_ == 0) inputDone_ = true;
+        return inEnd_ > 0;
+    }
+
+    void fill() {
+        while (bitCount_ <= 56) {
+            if (inPos_ == inEnd_ && !refill()) return;
+            bitBuf_ |= static_cast<std::uint64_t>(static_cast<unsigned char>(in_[inPos_++])) << bitCount_;
+            bitCount_ += 8;
+        }
+    }
+
+    /** Next n (<= 32) bits; zeros (and overrun_) past the end of input */
+    std::uint32_t bits(unsigned n) {
+        if (bitCount_ < n) {
+            fill();
+            if (bitCount_ < n) { overrun_ = true; bitCount_ = n; }
+        }
+        std::uint32_t v = static_cast<std::uint32_t>(bitBuf_ & ((std::uint64_t(1) << n) - 1));
+        bitBuf_ >>= n;
+        bitCount_ -= n;
+        return v;
+    }
+
+    void alignToByte() {
+        unsigned drop = bitCount_ % 8;
+        bitBuf_ >>= drop;
+        bitCount_ -= drop;
+    }
+
+    /** true if nothing follows (call at a byte boundary) */
+    bool atEnd() {
+        if (bitCount_ > 0 || inPos_ < inEnd_) return false;
+        return !refill();
+    }
+
+    /** Next symbol of code h, or -1 if the input is not a valid code */
+    int decode(const detail::Huffman &h) {
+        if (bitCount_ < 16) fill();
+        unsigned s;
+        int symbol;
+        std::uint16_t f = h.fast[bitBuf_ & ((1u << detail::kFastBits) - 1)];
+        if (f) {
+            s = f >> 9;
+            symbol = f & 511;
+        } else {
+            int k = detail::Huffman::reverse(static_cast<int>(bitBuf_ & 0xFFFF), 16);
+            for (s = detail::kFastBits + 1; static_cast<std::uint32_t>(k) >= h.maxCode[s]; ++s) {}
+            if (s >= 16) return -1;
+            int b = (k >> (16 - s)) - h.firstCode[s] + h.firstSymbol[s];
+            if (b >= 288 || h.size[b] != s) return -1;
+            symbol = h.value[b];
+        }
+        if (s > bitCount_) { overrun_ = true; return -1; }
+        bitBuf_ >>= s;
+        bitCount_ -= s;
+        return symbol;
+    }
+
+    // ---- Output ----
+
+    /** Hand the filled part of the block to write() and keep the window */
+    bool flush(const Write &write) {
+        if (outPos_ > outFlushed_) {
+            std::size_t n = outPos_ - outFlushed_;
+            crc_ = crc32(crc_, out_.data() + outFlushed_, n);
+            outputBytes_ += n;
+            if (!write(out_.data() + outFlushed_, n)) return fail("output closed");
+        }
+        if (outPos_ > kWindow) {
+            std::memmove(out_.data(), out_.data() + outPos_ - kWindow, kWindow);
+            outPos_ = kWindow;
+        }
+        outFlushed_ = outPos_;
+        return true;
+    }
+
+    // ---- Format ----
+
+    bool readHeader(bool first) {
+        if (bits(8) != 0x1F || bits(8) != 0x8B) return fail(first ? "not a gzip stream" : "trailing data after gzip stream");
+        if (bits(8) != 8) return fail("unsupported gzip compression method");
+        std::uint32_t flags = bits(8);
+        bits(32);  // Modification time
+        bits(16);  // Extra flags, OS
+        if (flags & 4) {
+            for (std::uint32_t extra = bits(16); extra > 0 && !overrun_; --extra) bits(8);
+        }
+        if (flags & 8) while (bits(8) != 0 && !overrun_) {}   // File name
+        if (flags & 16) while (bits(8) != 0 && !overrun_) {}  // Comment
+        if (flags & 2) bits(16);                              // Header CRC
+        return overrun_ ? fail("truncated gzip header") : true;
+    }
+
+    bool inflateMember(const Write &write) {
+        bool last;
+        do {
+            last = bits(1) != 0;
+            std::uint32_t type = bits(2);
+            if (overrun_) return fail("truncated deflate stream");
+            bool ok;
+            if (type == 0) {
+                ok = storedBlock(write);
+            } else if (type == 1) {
+                if (!fixedBuilt_) buildFixed();
+                ok = codedBlock(fixedLit_, fixedDist_, write);
+            } else if (type == 2) {
+                ok = readDynamicCodes() && codedBlock(lit_, dist_, write);
+            } else {
+                ok = fail("invalid deflate block type");
+            }
+            if (!ok) return false;
+        } while (!last);
+        return flush(write);
+    }
+
+    bool storedBlock(const Write &write) {
+        alignToByte();
+        std::uint32_t length = bits(16);
+        std::uint32_t check = bits(16);
+        if (overrun_) return fail("truncated deflate stream");
+        if ((length ^ 0xFFFFu) != check) return fail("corrupt stored deflate block");
+        for (; length > 0; --length) {
+            if (outPos_ == out_.size() && !flush(write)) return false;
+            out_[outPos_++] = static_cast<char>(bits(8));
+            ++memberBytes_;
+        }
+        return overrun_ ? fail("truncated deflate stream") : true;
+    }
+
+    void buildFixed() {
+        std::uint8_t lengths[288];
+        std::memset(lengths, 8, 144);
+        std::memset(lengths + 144, 9, 112);
+        std::memset(lengths + 256, 7, 24);
+        std::memset(lengths + 280, 8, 8);
+        fixedLit_.build(lengths, 288);
+        std::memset(lengths, 5, 32);
+        fixedDist_.build(lengths, 32);
+        fixedBuilt_ = true;
+    }
+
+    bool readDynamicCodes() {
+        static const std::uint8_t order[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+        unsigned litCount = bits(5) + 257;
+        unsigned distCount = bits(5) + 1;
+        unsigned lengthCount = bits(4) + 4;
+        if (litCount > 286 || distCount > 30) return fail("corrupt deflate code counts");
+        std::uint8_t codeLengths[19] = {0};
+        for (unsigned i = 0; i < lengthCount; ++i) codeLengths[order[i]] = static_cast<std::uint8_t>(bits(3));
+        detail::Huffman lengthCode;
+        if (!lengthCode.build(codeLengths, 19)) return fail("corrupt deflate code lengths");
+
+        std::uint8_t lengths[286 + 30];
+        unsigned n = 0, total = litCount + distCount;
+        while (n < total) {
+            int sym = decode(lengthCode);
+            if (sym < 0) return fail(overrun_ ? "truncated deflate stream" : "corrupt deflate code lengths");
+            if (sym < 16) { lengths[n++] = static_cast<std::uint8_t>(sym); continue; }
+            std::uint8_t fillValue = 0;
+            unsigned repeat;
+            if (sym == 16) {
+                if (n == 0) return fail("corrupt deflate code lengths");
+                fillValue = lengths[n - 1];
+                repeat = 3 + bits(2);
+            } else if (sym == 17) {
+                repeat = 3 + bits(3);
+            } else {
+                repeat = 11 + bits(7);
+            }
+            if (n + repeat > total) return fail("corrupt deflate code lengths");
+            std::memset(lengths + n, fillValue, repeat);
+            n += repeat;
+        }
+        if (lengths[256] == 0) return fail("deflate block without end code");
+        if (!lit_.build(lengths, static_cast<int>(litCount)) || !dist_.build(lengths + litCount, static_cast<int>(distCount))) {
+            return fail("corrupt deflate code lengths");
+        }
+        return true;
+    }
+
+    bool codedBlock(const detail::Huffman &lit, const detail::Huffman &dist, const Write &write) {
+        for (;;) {
+            if (outPos_ + 258 > out_.size() && !flush(write)) return false;
+            int sym = decode(lit);
+            if (sym < 256) {
+                if (sym < 0) return fail(overrun_ ? "truncated deflate stream" : "corrupt deflate data");
+                out_[outPos_++] = static_cast<char>(sym);
+                ++memberBytes_;
+                continue;
+            }
+            if (sym == 256) return true;
+            sym -= 257;
+            if (sym >= 29) return fail("corrupt deflate data");
+            std::size_t length = detail::kLengthBase[sym] + bits(detail::kLengthExtra[sym]);
+            int d = decode(dist);
+            if (d < 0 || d >= 30) return fail(overrun_ ? "truncated deflate stream" : "corrupt deflate data");
+            std::size_t distance = detail::kDistBase[d] + bits(detail::kDistExtra[d]);
+            if (overrun_) return fail("truncated deflate stream");
+            if (distance > memberBytes_ || distance > outPos_) return fail("deflate distance too far back");
+            char *dst = out_.data() + outPos_;
+            const char *src = dst - distance;
+            if (distance >= length) std::memcpy(dst, src, length);
+            else for (std::size_t i = 0; i < length; ++i) dst[i] = src[i];  // Overlapping: repeats the pattern
+            outPos_ += length;
+            memberBytes_ += length;
+        }
+    }
+};
+
+} // namespace gzip
+
+} // namespace inv
@@ -6,16 +6,25 @@
  * 2. HashTable<T> - templated hash table with string keys
  * 
  * The hash table uses separate chaining for collision resolution and
- * automatically resizes when load factor exceeds threshold.
+ * automatically resizes when load factor exceeds threshold. The bucket
+ * layout is a template policy: ChainedBuckets (this file, the default) or
+ * CuckooBuckets (CuckooHashTable.hpp).
  */
 
 #pragma once
 
+#include <cstdint>
 #include <string>
 #include <vector>
-#include <list>
+#include <forward_list>
+#include <memory>
 #include <functional>
-#include <optional>
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+#include "MissFilter.hpp"
+#include "SmallString.hpp"
 
 namespace inv {
 
@@ -28,9 +37,17 @@ namespace inv {
  * 
  * Design Notes:
  * - Prices stored as strings to preserve original formatting ($, commas, etc.)
+ * - Short fields (prices, quantity, asin, stock) are SmallStrings: 24 bytes
+ *   with up to 23 characters inline, instead of a 32-byte std::string
  * - Categories stored in two forms:
  *   1. `category`: Human-readable joined string for display
  *   2. `categories`: Vector of individual categories for indexing
+ * - The description is either held in `productDescription` or, when loaded
+ *   with a DescriptionStore, compressed there and referenced by `descriptionRef`
+ * - In lazy mode, `asin`, `modelNumber` and `productDescription` stay empty
+ *   and `sourceRef` locates the record in the source file (ColdFieldStore)
+ * - With pre-rendered output, `renderedRef` locates the product's complete
+ *   `find` output in a RenderedStore
  */
 struct Product {
     // Required fields - core product information
@@ -39,32 +56,103 @@ struct Product {
     std::string brandName;       // Manufacturer/brand
     std::string category;        // Joined category string for display (e.g., "Electronics | Computers")
     std::vector<std::string> categories; // Individual category strings for indexing
-    std::string listPrice;       // Original price (stored as string with $ and formatting)
-    std::string sellingPrice;    // Current sale price (stored as string)
-    std::string quantity;        // Available quantity (stored as string)
+    SmallString listPrice;       // Original price (stored as string with $ and formatting)
+    SmallString sellingPrice;    // Current sale price (stored as string)
+    SmallString quantity;        // Available quantity (stored as string)
 
     // Optional fields - additional product details (may be empty)
-    std::string asin;            // Amazon Standard Identification Number
+    SmallString asin;            // Amazon Standard Identification Number
     std::string modelNumber;     // Manufacturer model number
-    std::string productDescription; // Detailed product description
-    std::string stock;           // Stock status/availability
+    std::string productDescription; // Detailed product description (empty if held in a DescriptionStore)
+    SmallString stock;           // Stock status/availability
+    std::uint32_t descriptionRef {0xFFFFFFFFu}; // DescriptionStore handle, or DescriptionStore::kNone
+    std::uint32_t sourceRef {0xFFFFFFFFu};      // ColdFieldStore handle, or ColdFieldStore::kNone
+    std::uint32_t recordIndex {0xFFFFFFFFu};    // Record number in its source CSV (orders merged shard listings)
+    std::uint32_t renderedRef {0xFFFFFFFFu};    // RenderedStore handle of its `find` output, or RenderedStore::kNone
+};
+
+/**
+ * HashTableStats - Snapshot of a HashTable's internal layout
+ * 
+ * Produced by HashTable<T>::stats(). Used to diagnose hash distribution
+ * problems (clustering) and memory usage of the bucket array and nodes.
+ * 
+ * Probe counts are computed from the current chain layout, assuming every
+ * stored key is equally likely to be looked up (hits) and that missing keys
+ * hash uniformly across buckets (misses).
+ */
+struct HashTableStats {
+    std::size_t size {0};          // Number of entries
+    std::size_t bucketCount {0};   // Number of buckets
+    double loadFactor {0.0};       // size / bucketCount
+    std::size_t emptyBuckets {0};  // Buckets with no entries
+    std::size_t longestChain {0};  // Length of the longest bucket chain
+    std::vector<std::size_t> chainHistogram; // chainHistogram[k] = number of buckets holding k entries
+    double avgProbesHit {0.0};     // Average key comparisons for a successful find
+    double avgProbesMiss {0.0};    // Average key comparisons for an unsuccessful find
+    std::size_t rehashCount {0};   // Number of rehashes since construction
+    std::size_t bucketBytes {0};   // Bytes used by the bucket array
+    std::size_t nodeBytes {0};     // Bytes used by chain nodes (excluding heap owned by keys/values)
+    std::size_t retiredBytes {0};  // Unlinked nodes and bucket arrays still waiting for readers to leave (cuckoo)
+    std::size_t bucketSlots {0};   // Slots per bucket for fixed-width buckets (0 = chained buckets)
+    bool missFilter {false};       // Whether a miss filter is in front of find()
+    std::size_t filterBytes {0};   // Bytes used by the miss filter's bit array
+    double filterBitsPerKey {0.0}; // Filter bits per stored entry
+    double filterFalsePositiveRate {0.0}; // Expected share of misses the filter lets through
+};
+
+/**
+ * Bucket layout policies for HashTable
+ * 
+ * - ChainedBuckets: separate chaining (default, defined below)
+ * - CuckooBuckets: bucketized cuckoo hashing with lock-free readers
+ *   (CuckooHashTable.hpp)
+ */
+struct ChainedBuckets {};
+struct CuckooBuckets;
+
+/**
+ * AllocatorState<Alloc> - What a table keeps for its allocator
+ * 
+ * A table builds its allocator through this once and hands copies of
+ * get() to its buckets and nodes. The primary template just holds the
+ * allocator. Allocators whose copies only point at shared state specialize
+ * it so the table owns that state (PoolAllocator.hpp), which keeps every
+ * per-bucket allocator copy pointer-sized.
+ */
+template <typename Alloc>
+class AllocatorState {
+public:
+    explicit AllocatorState(const Alloc &alloc) : alloc_(alloc) {}
+    const Alloc &get() const { return alloc_; }
+private:
+    Alloc alloc_;
 };
 
 /**
  * HashTable<T> - Templated hash table with string keys
  * 
  * A hash table implementation that maps string keys to values of any type T.
- * Uses separate chaining (linked lists) for collision resolution and
+ * Uses separate chaining (singly linked lists) for collision resolution and
  * automatically resizes when load factor exceeds 0.9 to maintain O(1)
  * average-case performance.
  * 
  * Design Decisions:
  * - Key Type: Fixed to std::string (common use case for this application)
  * - Value Type: Template parameter T (allows flexibility)
- * - Collision Resolution: Separate chaining with std::list
+ * - Collision Resolution: Separate chaining with std::forward_list (one link
+ *   per node and one pointer per bucket; chains are only walked forwards)
+ * - Allocator: Template parameter Alloc (rebound to list nodes and buckets,
+ *   kept through AllocatorState); use PoolAllocator (PoolAllocator.hpp) to
+ *   carve nodes from a slab pool the table owns
+ * - Policy: Template parameter selecting the bucket layout; this primary
+ *   template implements ChainedBuckets
  * - Hash Function: std::hash<std::string> from standard library
  * - Load Factor Threshold: 0.9 (balances space vs. time efficiency)
  * - Resize Strategy: Double size + 1 when threshold exceeded
+ * - Miss Filter: Optional blocked Bloom filter (MissFilter.hpp) consulted by
+ *   find() and erase() before the chain is walked; enableMissFilter()
+ *   turns it on, and every rehash rebuilds it for the new capacity
  * 
  * Time Complexity:
  * - Insert: O(1) average, O(n) worst-case, amortized O(1) with rehashing
@@ -74,17 +162,20 @@ struct Product {
  * 
  * Space Complexity: O(n + m) where n is entries, m is bucket count
  */
-template <typename T>
+template <typename T, typename Alloc = std::allocator<T>, typename Policy = ChainedBuckets>
 class HashTable {
 public:
+    using allocator_type = Alloc;
+
     /**
      * Constructor - Initialize hash table with specified bucket count
      * 
      * @param bucketCount Initial number of buckets (default: 1003)
      *                    Using a prime-ish number helps distribute hash values
+     * @param alloc Allocator for nodes and the bucket array (copies share state)
      */
-    explicit HashTable(std::size_t bucketCount = 1'003)
-        : buckets_(bucketCount) {}
+    explicit HashTable(std::size_t bucketCount = 1'003, const Alloc &alloc = Alloc())
+        : alloc_(alloc), buckets_(bucketCount, Bucket(NodeAlloc(alloc_.get())), BucketAlloc(alloc_.get())) {}
 
     /**
      * Insert or update a key-value pair
@@ -100,25 +191,59 @@ public:
      * Time Complexity: O(1) average, O(n) if rehashing triggered
      */
     bool insert(const std::string &key, const T &value) {
-        auto &bucket = buckets_[indexFor(key)];
-        
-        // Check if key already exists - if so, update it
-        for (auto &node : bucket) {
-            if (node.key == key) {
-                node.value = value; // Replace existing value
-                return false;       // Indicate update (not new insertion)
-            }
-        }
-        
-        // Key doesn't exist - add new entry
-        bucket.push_back(Node{key, value});
-        ++size_;
-        
-        // Check if we need to rehash to maintain performance
-        if (loadFactor() > kMaxLoadFactor) {
-            rehash(buckets_.size() * 2 + 1);
-        }
-        return true; // Indicate new insertion
+        return emplaceImpl(key, true, value).second;
+    }
+
+    /**
+     * Insert or update a key-value pair, moving both into the table
+     * 
+     * Same semantics as insert(const std::string&, const T&), but the key and
+     * value are moved into the node (or the value is move-assigned over an
+     * existing entry) instead of being copied.
+     * 
+     * @param key String key to insert/update (moved from)
+     * @param value Value to associate with the key (moved from)
+     * @return true if new entry was inserted, false if existing entry was updated
+     * 
+     * Time Complexity: O(1) average, O(n) if rehashing triggered
+     */
+    bool insert(std::string &&key, T &&value) {
+        return emplaceImpl(std::move(key), true, std::move(value)).second;
+    }
+
+    /**
+     * Insert or update an entry, constructing the value in place
+     * 
+     * The value is constructed from `args` directly inside the new node. If
+     * the key already exists, a value constructed from `args` is
+     * move-assigned over the old one (insert/update semantics, like insert()).
+     * 
+     * @param key String key (copied or moved into the node)
+     * @param args Arguments forwarded to T's constructor
+     * @return Pointer to the stored value, and true if a new entry was inserted
+     * 
+     * Time Complexity: O(1) average, O(n) if rehashing triggered
+     */
+    template <typename K, typename... Args>
+    std::pair<T*, bool> emplace(K &&key, Args &&...args) {
+        return emplaceImpl(std::forward<K>(key), true, std::forward<Args>(args)...);
+    }
+
+    /**
+     * Insert an entry only if the key is absent, constructing the value in place
+     * 
+     * If the key already exists nothing is constructed, moved or modified
+     * (arguments passed as rvalues are left untouched).
+     * 
+     * @param key String key (copied or moved into the node)
+     * @param args Arguments forwarded to T's constructor
+     * @return Pointer to the stored (new or existing) value, and true if inserted
+     * 
+     * Time Complexity: O(1) average, O(n) if rehashing triggered
+     */
+    template <typename K, typename... Args>
+    std::pair<T*, bool> try_emplace(K &&key, Args &&...args) {
+        return emplaceImpl(std::forward<K>(key), false, std::forward<Args>(args)...);
     }
 
     /**
@@ -130,7 +255,9 @@ public:
      * Time Complexity: O(1) average, O(n) worst-case
      */
     T* find(const std::string &key) {
-        auto &bucket = buckets_[indexFor(key)];
+        const std::size_t h = hashOf(key);
+        if (!filter_.mayContain(h)) return nullptr; // Definitely absent
+        auto &bucket = buckets_[h % buckets_.size()];
         for (auto &node : bucket) {
             if (node.key == key) {
                 return &node.value;
@@ -148,7 +275,9 @@ public:
      * Time Complexity: O(1) average, O(n) worst-case
      */
     const T* find(const std::string &key) const {
-        const auto &bucket = buckets_[indexFor(key)];
+        const std::size_t h = hashOf(key);
+        if (!filter_.mayContain(h)) return nullptr; // Definitely absent
+        const auto &bucket = buckets_[h % buckets_.size()];
         for (const auto &node : bucket) {
             if (node.key == key) {
                 return &node.value;
@@ -166,10 +295,12 @@ public:
      * Time Complexity: O(1) average, O(n) worst-case
      */
     bool erase(const std::string &key) {
-        auto &bucket = buckets_[indexFor(key)];
-        for (auto it = bucket.begin(); it != bucket.end(); ++it) {
+        const std::size_t h = hashOf(key);
+        if (!filter_.mayContain(h)) return false;
+        auto &bucket = buckets_[h % buckets_.size()];
+        for (auto prev = bucket.before_begin(), it = bucket.begin(); it != bucket.end(); prev = it++) {
             if (it->key == key) {
-                bucket.erase(it);
+                bucket.erase_after(prev);
                 --size_;
                 return true; // Found and erased
             }
@@ -177,6 +308,56 @@ public:
         return false; // Key not found
     }
 
+    /**
+     * Remove every entry and release the bucket array
+     * 
+     * The table keeps a single empty bucket and grows again on insert.
+     * 
+     * Time Complexity: O(n + m) where n is entries, m is bucket count
+     */
+    void clear() {
+        buckets_.clear();
+        buckets_.shrink_to_fit();
+        buckets_.emplace_back(NodeAlloc(alloc_.get()));
+        size_ = 0;
+        if (filter_.enabled()) resetFilter();
+    }
+
+    /**
+     * Put a blocked Bloom filter in front of find() and erase()
+     * 
+     * Lookups of absent keys are then rejected after one cache-line read
+     * (false positive rate about 1% at 10 bits per key) instead of walking a
+     * chain. The filter is built from the current keys, updated on every
+     * insert, and rebuilt at each rehash; erased keys stay in it until then.
+     * 
+     * @param bitsPerKey Filter bits per entry the table can hold before its
+     *                   next rehash
+     * 
+     * Time Complexity: O(n + m) where n is entries, m is bucket count
+     */
+    void enableMissFilter(double bitsPerKey = BlockedBloomFilter::kDefaultBitsPerKey) {
+        filterBitsPerKey_ = bitsPerKey;
+        resetFilter();
+    }
+
+    /**
+     * Remove the miss filter and free its memory
+     * 
+     * Time Complexity: O(1)
+     */
+    void disableMissFilter() { filter_.release(); }
+
+    /** true if find() consults a miss filter */
+    bool missFilterEnabled() const { return filter_.enabled(); }
+
+    /**
+     * The miss filter (for memory accounting)
+     * 
+     * @return The filter; not enabled() unless enableMissFilter() was called
+     */
+    const BlockedBloomFilter &missFilter() const { return filter_; }
+
     /**
      * Get the number of key-value pairs in the hash table
      * 
@@ -210,6 +391,121 @@ public:
         return static_cast<double>(size_) / static_cast<double>(buckets_.size());
     }
 
+    /**
+     * Visit every key-value pair in the table
+     * 
+     * Iteration order is unspecified (bucket order). The table must not be
+     * modified from inside the callback.
+     * 
+     * @param fn Callable invoked as fn(const std::string &key, const T &value)
+     * 
+     * Time Complexity: O(n + m) where n is entries, m is bucket count
+     */
+    template <typename F>
+    void forEach(F &&fn) const {
+        for (const auto &bucket : buckets_) {
+            for (const auto &node : bucket) fn(node.key, node.value);
+        }
+    }
+
+    /**
+     * Visit every key-value pair with mutable access to the values
+     * 
+     * Same as the const version, but fn receives `T &value`, so values can be
+     * modified or moved out (e.g. when converting to another container).
+     * 
+     * Time Complexity: O(n + m) where n is entries, m is bucket count
+     */
+    template <typename F>
+    void forEach(F &&fn) {
+        for (auto &bucket : buckets_) {
+            for (auto &node : bucket) fn(static_cast<const std::string &>(node.key), node.value);
+        }
+    }
+
+    /**
+     * Pre-size the bucket array for an expected number of entries
+     * 
+     * Rehashes so that `count` entries fit without exceeding the maximum
+     * load factor. Does nothing if the table is already large enough.
+     * 
+     * @param count Number of entries the table should hold without growing
+     * 
+     * Time Complexity: O(n) where n is the number of entries (if rehashing)
+     */
+    void reserve(std::size_t count) {
+        std::size_t needed = static_cast<std::size_t>(static_cast<double>(count) / kMaxLoadFactor) + 1;
+        if (needed > buckets_.size()) rehash(needed);
+    }
+
+    /**
+     * Size of one chain node allocation
+     * 
+     * std::forward_list nodes hold the next pointer followed by the
+     * stored key-value pair (libstdc++ and libc++ layout).
+     * 
+     * @return Bytes requested from the allocator per entry
+     */
+    static constexpr std::size_t nodeBytes() { return sizeof(Node) + sizeof(void*); }
+
+    /**
+     * Size of one bucket (a std::forward_list header) in the bucket array
+     * 
+     * @return Bytes per bucket
+     */
+    static constexpr std::size_t bucketBytes() { return sizeof(Bucket); }
+
+    /**
+     * Allocator used for nodes and buckets
+     * 
+     * @return Copy of the table's allocator
+     */
+    allocator_type get_allocator() const { return alloc_.get(); }
+
+    /**
+     * Collect statistics about the table's internal layout
+     * 
+     * Walks every bucket to build the chain-length histogram and derive
+     * probe counts. Node bytes assume the usual singly-linked list node
+     * layout (one pointer followed by the stored Node).
+     * 
+     * @return HashTableStats snapshot of the current table
+     * 
+     * Time Complexity: O(n + m) where n is entries, m is bucket count
+     */
+    HashTableStats stats() const {
+        HashTableStats st;
+        st.size = size_;
+        st.bucketCount = buckets_.size();
+        st.loadFactor = loadFactor();
+        st.rehashCount = rehashCount_;
+        st.bucketBytes = buckets_.capacity() * bucketBytes();
+        st.nodeBytes = size_ * nodeBytes();
+        if (filter_.enabled()) {
+            st.missFilter = true;
+            st.filterBytes = filter_.bytes();
+            if (size_ > 0) st.filterBitsPerKey = 8.0 * static_cast<double>(st.filterBytes) / static_cast<double>(size_);
+            st.filterFalsePositiveRate = filter_.expectedFalsePositiveRate(filter_.count());
+        }
+
+        std::size_t hitProbes = 0;
+        for (const auto &bucket : buckets_) {
+            std::size_t len = static_cast<std::size_t>(std::distance(bucket.begin(), bucket.end()));
+            if (len >= st.chainHistogram.size()) st.chainHistogram.resize(len + 1, 0);
+            ++st.chainHistogram[len];
+            if (len == 0) ++st.emptyBuckets;
+            st.longestChain = std::max(st.longestChain, len);
+            // The i-th node of a chain (1-based) is found after i comparisons
+            hitProbes += len * (len + 1) / 2;
+        }
+        if (size_ > 0) st.avgProbesHit = static_cast<double>(hitProbes) / static_cast<double>(size_);
+        // A miss compares against every node in the bucket it hashes to
+        // (only when the miss filter lets it through)
+        st.avgProbesMiss = st.loadFactor;
+        if (st.missFilter) st.avgProbesMiss *= st.filterFalsePositiveRate;
+        return st;
+    }
+
 private:
     /**
      * Node - Internal storage structure for key-value pairs
@@ -218,13 +514,30 @@ private:
     struct Node {
         std::string key;
         T value;
+
+        template <typename K, typename... Args>
+        Node(K &&k, Args &&...args) : key(std::forward<K>(k)), value(std::forward<Args>(args)...) {}
     };
 
+    using NodeAlloc = typename std::allocator_traits<Alloc>::template rebind_alloc<Node>;
+    using Bucket = std::forward_list<Node, NodeAlloc>;
+    using BucketAlloc = typename std::allocator_traits<Alloc>::template rebind_alloc<Bucket>;
+
+    // Allocator shared by every bucket (declared before buckets_, which uses it)
+    AllocatorState<Alloc> alloc_;
+
     // Hash table storage: vector of buckets, each bucket is a list of nodes
-    std::vector<std::list<Node>> buckets_;
+    std::vector<Bucket, BucketAlloc> buckets_;
     
     // Current number of key-value pairs stored
     std::size_t size_ {0};
+
+    // Number of times rehash() has run (reported by stats())
+    std::size_t rehashCount_ {0};
+
+    // Optional filter rejecting absent keys in find()/erase() (disabled by default)
+    BlockedBloomFilter filter_;
+    double filterBitsPerKey_ {BlockedBloomFilter::kDefaultBitsPerKey};
     
     // Maximum load factor before triggering rehash
     // 0.9 chosen as a balance: high enough for space efficiency,
@@ -232,43 +545,109 @@ private:
     static constexpr double kMaxLoadFactor = 0.9;
 
     /**
-     * Compute bucket index for a given key
-     * Uses std::hash and modulo to map keys to bucket indices
+     * Hash a key
+     * The bucket index is hashOf(key) % buckets_.size(); the miss filter
+     * re-mixes the same value, so each operation hashes the key once
      * 
      * @param key String key to hash
-     * @return Bucket index (0 to buckets_.size() - 1)
+     * @return std::hash of the key
      * 
-     * Time Complexity: O(1)
+     * Time Complexity: O(key length)
+     */
+    static std::size_t hashOf(const std::string &key) {
+        return std::hash<std::string>{}(key);
+    }
+
+    /**
+     * Size the miss filter for the entries the current bucket array can hold
+     * before the next rehash, and add every stored key to it
      */
-    std::size_t indexFor(const std::string &key) const {
-        return std::hash<std::string>{}(key) % buckets_.size();
+    void resetFilter() {
+        std::size_t capacity = static_cast<std::size_t>(static_cast<double>(buckets_.size()) * kMaxLoadFactor) + 1;
+        filter_.reset(std::max(capacity, size_), filterBitsPerKey_);
+        for (const auto &bucket : buckets_) {
+            for (const auto &node : bucket) filter_.add(hashOf(node.key));
+        }
     }
 
+    /**
+     * Shared implementation of insert/emplace/try_emplace
+     * 
+     * Scans the key's chain once. If the key exists, either assigns a value
+     * built from `args` (assign == true) or leaves it alone. Otherwise a node
+     * is constructed in place at the end of the chain and the table grows if
+     * the load factor threshold is exceeded. Nodes are never moved by a
+     * rehash, so the returned pointer stays valid until the entry is erased.
+     * 
+     * @param key Key to insert (forwarded into the node)
+     * @param assign Whether to overwrite an existing value
+     * @param args Arguments forwarded to T's constructor
+     * @return Pointer to the stored value, and true if a new entry was inserted
+     */
+    template <typename K, typename... Args>
+    std::pair<T*, bool> emplaceImpl(K &&key, bool assign, Args &&...args) {
+        const std::size_t h = hashOf(key);
+        auto &bucket = buckets_[h % buckets_.size()];
+        
+        // Check if key already exists - if so, update it (or leave it)
+        auto last = bucket.before_begin();
+        for (auto it = bucket.begin(); it != bucket.end(); last = it++) {
+            if (it->key == key) {
+                if (assign) assignValue(it->value, std::forward<Args>(args)...); // Replace existing value
+                return {&it->value, false}; // Indicate update (not new insertion)
+            }
+        }
+        
+        // Key doesn't exist - append new entry to the chain
+        auto node = bucket.emplace_after(last, std::forward<K>(key), std::forward<Args>(args)...);
+        ++size_;
+        if (filter_.enabled()) filter_.add(h);
+        
+        // Check if we need to rehash to maintain performance
+        if (loadFactor() > kMaxLoadFactor) {
+            rehash(buckets_.size() * 2 + 1);
+        }
+        return {&node->value, true}; // Indicate new insertion
+    }
+
+    /**
+     * Overwrite a value: plain (copy/move) assignment for a single T
+     * argument, otherwise assignment from a freshly constructed T
+     */
+    static void assignValue(T &dst, const T &src) { dst = src; }
+    static void assignValue(T &dst, T &&src) { dst = std::move(src); }
+    template <typename... Args>
+    static void assignValue(T &dst, Args &&...args) { dst = T(std::forward<Args>(args)...); }
+
     /**
      * Rehash all entries into a new larger bucket array
      * 
      * Called automatically when load factor exceeds threshold.
-     * Creates a new bucket array, rehashes all existing entries into it,
-     * then swaps the old array with the new one.
+     * Creates a new bucket array, relinks all existing nodes into it with
+     * splice_after (no node is reallocated or copied), then swaps the old
+     * array with the new one.
      * 
      * @param newBucketCount New number of buckets (typically 2*old + 1)
      * 
      * Time Complexity: O(n) where n is the number of entries
      */
     void rehash(std::size_t newBucketCount) {
-        std::vector<std::list<Node>> newBuckets(newBucketCount);
+        std::vector<Bucket, BucketAlloc> newBuckets(newBucketCount, Bucket(NodeAlloc(alloc_.get())), BucketAlloc(alloc_.get()));
         
-        // Rehash all existing entries into new bucket array
+        // Move every node into its new bucket (all buckets share one allocator)
         for (auto &bucket : buckets_) {
-            for (auto &node : bucket) {
+            while (!bucket.empty()) {
                 // Recompute bucket index with new bucket count
-                std::size_t idx = std::hash<std::string>{}(node.key) % newBucketCount;
-                newBuckets[idx].push_back(std::move(node));
+                std::size_t idx = hashOf(bucket.front().key) % newBucketCount;
+                auto &dst = newBuckets[idx];
+                dst.splice_after(dst.before_begin(), bucket, bucket.before_begin());
             }
         }
         
         // Replace old buckets with new buckets
         buckets_.swap(newBuckets);
+        ++rehashCount_;
+        if (filter_.enabled()) resetFilter(); // Resize for the new capacity (drops erased keys)
         // Old buckets automatically destroyed when newBuckets goes out of scope
     }
 };
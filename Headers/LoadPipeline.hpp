@@ -0,0 +1,365 @@
+/**
+ * LoadPipeline.hpp
+ *
+ * Multi-threaded CSV loading: the phases of loadCsv() as pipeline stages.
+ *
+ * loadCsv() reads, parses, inserts and indexes each record on one thread.
+ * loadCsvPipelined() produces the same table and index (same products, same
+ * handles, same category order) with the phases on separate threads:
+ *
+ *   read ──> parse x N ──> insert ──> index
+ *
+ * - read:   one thread pulls complete records from the file (readRecord)
+ *           and cuts them into batches; batch k goes to parser k mod N
+ * - parse:  N threads split and sanitize their batches into Products
+ *           (parseCsvLine + fillProduct), dropping records without an id or
+ *           owned by another shard
+ * - insert: one thread takes parsed batches back in batch order (from
+ *           parser 0, 1, ..., N-1, 0, ...), assigns description/cold-field
+ *           handles and moves the products into the table
+ * - index:  the calling thread appends each product's id to its categories
+ *
+ * Every connection is an SpscRing of batches, so no stage takes a lock and
+ * the round-robin hand-off keeps file order without a reorder buffer. The
+ * rings are bounded: a fast stage blocks when its consumer falls behind,
+ * which also bounds the records in flight to about
+ * (2N + 1) * ringBatches * batchRecords.
+ *
+ * Each stage reports its busy time and how long it waited for input
+ * (starved) or for room downstream (blocked). The stage with the lowest
+ * capacity (records per busy second, times its threads) is the bottleneck;
+ * stages before it block and stages after it starve.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "HashTable.hpp"
+#include "Parser.hpp"
+#include "SpscRing.hpp"
+
+namespace inv {
+
+/**
+ * LoadPipelineOptions - Shape of a pipelined load
+ */
+struct LoadPipelineOptions {
+    std::size_t parsers {2};        // Parser threads
+    std::size_t batchRecords {256}; // Records per batch
+    std::size_t ringBatches {8};    // Batches each ring holds
+};
+
+/**
+ * PipelineStageStats - What one stage did during a pipelined load
+ */
+struct PipelineStageStats {
+    std::size_t threads {1};
+    std::size_t records {0};    // Records (read, parse) or products (insert, index) handled
+    std::size_t batches {0};
+    double busySec {0.0};       // Summed over the stage's threads
+    double starvedSec {0.0};    // Waiting for input
+    double blockedSec {0.0};    // Waiting for room in the next ring
+
+    /** Records per second this stage could sustain on its own */
+    double capacity() const {
+        return busySec > 0 ? static_cast<double>(records) * static_cast<double>(threads) / busySec : 0.0;
+    }
+};
+
+/**
+ * LoadPipelineStats - Per-stage report of loadCsvPipelined()
+ */
+struct LoadPipelineStats {
+    PipelineStageStats read, parse, insert, index;
+    double totalSec {0.0};
+};
+
+/**
+ * printPipelineStats - One line per stage plus the bottleneck
+ */
+inline void printPipelineStats(const LoadPipelineStats &st, std::ostream &out) {
+    auto flags = out.flags();
+    auto prec = out.precision();
+    const std::pair<const char *, const PipelineStageStats *> stages[] = {
+        {"read", &st.read}, {"parse", &st.parse}, {"insert", &st.insert}, {"index", &st.index}};
+    const char *bottleneck = nullptr;
+    double lowest = 0.0;
+    out << std::fixed;
+    for (const auto &s : stages) {
+        const PipelineStageStats &p = *s.second;
+        out << "  " << std::left << std::setw(7) << s.first << std::right << p.threads << " thread(s)"
+            << std::setw(10) << p.records << " rec"
+            << std::setw(10) << std::setprecision(3) << p.busySec << " s busy"
+            << std::setw(10) << std::setprecision(0) << p.capacity() << " rec/s"
+            << std::setw(9) << std::setprecision(3) << p.starvedSec << " s starved"
+            << std::setw(9) << p.blockedSec << " s blocked" << '\n';
+        if (p.records > 0 && (!bottleneck || p.capacity() < lowest)) {
+            bottleneck = s.first;
+            lowest = p.capacity();
+        }
+    }
+    if (bottleneck) out << "  bottleneck: " << bottleneck << '\n';
+    out.flags(flags);
+    out.precision(prec);
+}
+
+namespace detail {
+
+/** A record as read from the file */
+struct RawRecord {
+    std::string text;
+    std::uint64_t offset {0};       // Byte offset in the file
+    std::uint32_t recordIndex {0};  // Product::recordIndex
+};
+
+/** A parsed record waiting to be inserted */
+struct ParsedRecord {
+    Product product;
+    std::uint64_t offset {0};  // Source location, for lazy cold fields
+    std::uint32_t length {0};
+};
+
+/** A product's index entries */
+struct IndexEntry {
+    std::string id;
+    std::vector<std::string> categories;
+};
+
+/** Seconds since start */
+inline double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * loadCsvPipelinedFrom - loadCsvPipelined() on an open stream
+ *
+ * @param in Stream positioned at the header line (read by the reader thread)
+ * @param path File behind `in`, or nullptr for a pipe (no lazy cold fields)
+ */
+template <typename Alloc, typename Policy>
+inline bool loadCsvPipelinedFrom(std::istream &in, const std::string *path, HashTable<Product, Alloc, Policy> &table,
+                                 std::unordered_map<std::string, std::vector<std::string>> &categoryIndex,
+                                 const LoadPipelineOptions &options, LoadStats *stats,
+                                 DescriptionStore *descriptions, ColdFieldStore *coldFields,
+                                 const ShardFilter *shard) {
+    using Clock = std::chrono::steady_clock;
+    using RawBatch = std::vector<detail::RawRecord>;
+    using ParsedBatch = std::vector<detail::ParsedRecord>;
+    using IndexBatch = std::vector<detail::IndexEntry>;
+    const auto loadStart = Clock::now();
+
+    std::string headerLine; if (!std::getline(in, headerLine)) return false;
+    const detail::HeaderMap H = detail::buildHeader(headerLine);
+    const std::uint64_t firstOffset = headerLine.size() + (in.eof() ? 0 : 1);
+    const int coldFile = coldFields && path ? coldFields->addFile(*path, H) : -1;
+    const std::vector<bool> keep = detail::loadedColumns(H, coldFile >= 0);
+
+    const std::size_t n = std::max<std::size_t>(1, options.parsers);
+    const std::size_t batchRecords = std::max<std::size_t>(1, options.batchRecords);
+    std::vector<std::unique_ptr<SpscRing<RawBatch>>> toParse;
+    std::vector<std::unique_ptr<SpscRing<ParsedBatch>>> toInsert;
+    for (std::size_t i = 0; i < n; ++i) {
+        toParse.emplace_back(new SpscRing<RawBatch>(options.ringBatches));
+        toInsert.emplace_back(new SpscRing<ParsedBatch>(options.ringBatches));
+    }
+    SpscRing<IndexBatch> toIndex(options.ringBatches);
+
+    LoadPipelineStats st;
+    std::vector<PipelineStageStats> parserStats(n);
+    std::size_t bytesRead = 0;
+
+    // read: file -> parser rings, round robin
+    std::thread reader([&]() {
+        auto start = Clock::now();
+        PipelineStageStats &s = st.read;
+        std::uint64_t offset = firstOffset;
+        std::uint32_t recordNo = 0;
+        std::size_t target = 0;
+        RawBatch batch;
+        std::string rec;
+        std::size_t consumed = 0;
+        while (detail::readRecord(in, rec, &consumed)) {
+            const std::uint64_t recOffset = offset;
+            offset += consumed;
+            ++s.records;
+            bytesRead += rec.size();
+            if (rec.empty()) continue;
+            detail::RawRecord r;
+            r.text.swap(rec);
+            r.offset = recOffset;
+            r.recordIndex = recordNo++;
+            batch.push_back(std::move(r));
+            if (batch.size() == batchRecords) {
+                toParse[target]->push(std::move(batch), &s.blockedSec);
+                batch = RawBatch();
+                batch.reserve(batchRecords);
+                target = (target + 1) % n;
+                ++s.batches;
+            }
+        }
+        if (!batch.empty()) {
+            toParse[target]->push(std::move(batch), &s.blockedSec);
+            ++s.batches;
+        }
+        for (auto &r : toParse) r->close();
+        s.busySec = detail::secondsSince(start) - s.blockedSec;
+    });
+
+    // parse: raw batches -> products, one thread per ring pair
+    std::vector<std::thread> parsers;
+    for (std::size_t i = 0; i < n; ++i) {
+        parsers.emplace_back([&, i]() {
+            auto start = Clock::now();
+            PipelineStageStats &s = parserStats[i];
+            RawBatch raw;
+            while (toParse[i]->pop(raw, &s.starvedSec)) {
+                ParsedBatch parsed;
+                parsed.reserve(raw.size());
+                for (auto &r : raw) {
+                    auto cols = detail::parseCsvLine(r.text, &keep);
+                    ++s.records;
+                    detail::ParsedRecord out;
+                    Product &p = out.product;
+                    p.uniqId = detail::sanitize(detail::safeGet(cols, H.get("Uniq Id")));
+                    if (p.uniqId.empty() || (shard && !shard->owns(p.uniqId))) continue;
+                    p.recordIndex = r.recordIndex;
+                    detail::fillProduct(cols, H, coldFile >= 0, p);
+                    out.offset = r.offset;
+                    out.length = static_cast<std::uint32_t>(r.text.size());
+                    parsed.push_back(std::move(out));
+                }
+                // Pushed even if empty: the inserter expects one batch per raw batch
+                toInsert[i]->push(std::move(parsed), &s.blockedSec);
+                ++s.batches;
+            }
+            toInsert[i]->close();
+            s.busySec = detail::secondsSince(start) - s.starvedSec - s.blockedSec;
+        });
+    }
+
+    // insert: parsed batches in batch order -> table; index entries -> indexer
+    std::thread inserter([&]() {
+        auto start = Clock::now();
+        PipelineStageStats &s = st.insert;
+        ParsedBatch parsed;
+        for (std::size_t source = 0; toInsert[source]->pop(parsed, &s.starvedSec); source = (source + 1) % n) {
+            IndexBatch entries;
+            entries.reserve(parsed.size());
+            for (auto &r : parsed) {
+                Product &p = r.product;
+                if (coldFile >= 0) {
+                    p.sourceRef = coldFields->addRecord(coldFile, r.offset, r.length);
+                } else if (descriptions) {
+                    p.descriptionRef = descriptions->add(p.productDescription);
+                    std::string().swap(p.productDescription);
+                }
+                entries.push_back(detail::IndexEntry {p.uniqId, p.categories});
+                std::string key = p.uniqId;
+                table.emplace(std::move(key), std::move(p));
+                ++s.records;
+            }
+            toIndex.push(std::move(entries), &s.blockedSec);
+            ++s.batches;
+        }
+        toIndex.close();
+        s.busySec = detail::secondsSince(start) - s.starvedSec - s.blockedSec;
+    });
+
+    // index: on this thread
+    {
+        auto start = Clock::now();
+        PipelineStageStats &s = st.index;
+        IndexBatch entries;
+        while (toIndex.pop(entries, &s.starvedSec)) {
+            for (auto &e : entries) {
+                for (const auto &cat : e.categories) categoryIndex[cat].push_back(e.id);
+                ++s.records;
+            }
+            ++s.batches;
+        }
+        s.busySec = detail::secondsSince(start) - s.starvedSec;
+    }
+    reader.join();
+    for (auto &t : parsers) t.join();
+    inserter.join();
+    if (coldFile >= 0) coldFields->shrink();
+
+    st.parse.threads = n;
+    for (const auto &p : parserStats) {
+        st.parse.records += p.records;
+        st.parse.batches += p.batches;
+        st.parse.busySec += p.busySec;
+        st.parse.starvedSec += p.starvedSec;
+        st.parse.blockedSec += p.blockedSec;
+    }
+    st.totalSec = detail::secondsSince(loadStart);
+    if (stats) {
+        stats->records += st.read.records;
+        stats->products += st.insert.records;
+        stats->bytes += bytesRead;
+        stats->readSec += st.read.busySec;
+        stats->parseSec += st.parse.busySec;
+        stats->insertSec += st.insert.busySec;
+        stats->indexSec += st.index.busySec;
+        stats->totalSec += st.totalSec;
+        if (stats->pipeline) *stats->pipeline = st;
+    }
+    return true;
+}
+
+} // namespace detail
+
+/**
+ * loadCsvPipelined - loadCsv() with its phases on separate threads
+ *
+ * Same parameters and result as loadCsv(), plus `options`. With `stats`,
+ * the record/product/byte counts and total time are filled as by loadCsv();
+ * readSec, parseSec (including build), insertSec and indexSec receive each
+ * stage's busy time, and stats->pipeline (if set) the per-stage report.
+ * Hardware counters (stats->perf) are not sampled.
+ *
+ * @param options Parser threads, batch size and ring size
+ * @return true if file loaded successfully, false on file open error
+ *
+ * Time Complexity: O(n*m) work as loadCsv(), spread over N + 3 threads
+ */
+template <typename Alloc, typename Policy>
+inline bool loadCsvPipelined(const std::string &path, HashTable<Product, Alloc, Policy> &table,
+                             std::unordered_map<std::string, std::vector<std::string>> &categoryIndex,
+                             const LoadPipelineOptions &options, LoadStats *stats = nullptr,
+                             DescriptionStore *descriptions = nullptr, ColdFieldStore *coldFields = nullptr,
+                             const ShardFilter *shard = nullptr) {
+    std::ifstream in(path);
+    if (!in.is_open()) return false;
+    return detail::loadCsvPipelinedFrom(in, &path, table, categoryIndex, options, stats, descriptions, coldFields, shard);
+}
+
+/**
+ * loadCsvPipelined - Pipelined load from a CSV stream (a pipe, decompressed input)
+ *
+ * Same as loadCsvPipelined(path, ...) without lazy cold fields; the read
+ * stage pulls from `in`.
+ *
+ * @param in Stream positioned at the header line
+ * @return false if the stream has no header line
+ */
+template <typename Alloc, typename Policy>
+inline bool loadCsvPipelined(std::istream &in, HashTable<Product, Alloc, Policy> &table,
+                             std::unordered_map<std::string, std::vector<std::string>> &categoryIndex,
+                             const LoadPipelineOptions &options, LoadStats *stats = nullptr,
+                             DescriptionStore *descriptions = nullptr, const ShardFilter *shard = nullptr) {
+    return detail::loadCsvPipelinedFrom(in, nullptr, table, categoryIndex, options, stats, descriptions, nullptr, shard);
+}
+
+} // namespace inv
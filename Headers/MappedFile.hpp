@@ -0,0 +1,107 @@
+/**
+ * MappedFile.hpp
+ *
+ * Read-only memory mapping of a whole file.
+ *
+ * On POSIX systems the file is mmap()ed, so its pages are only read from disk
+ * (or the page cache) when touched and are shared with every other process
+ * mapping the same file. Elsewhere, or if mmap() fails, the file is read into
+ * a heap buffer instead; callers see the same data()/size() either way.
+ *
+ * The file must not be modified or truncated while it is mapped.
+ *
+ * Usage:
+ *   inv::MappedFile f;
+ *   if (f.open("data.csv")) use(f.data(), f.size());
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace inv {
+
+/**
+ * MappedFile - RAII read-only view of a file's bytes
+ */
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile() { close(); }
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    /**
+     * Map a file (any previous mapping is released first)
+     *
+     * @param path File to map
+     * @return true if the file's bytes are available through data()
+     */
+    bool open(const std::string &path) {
+        close();
+#if defined(__unix__) || defined(__APPLE__)
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+            void *p = ::mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p != MAP_FAILED) {
+                data_ = static_cast<const char *>(p);
+                size_ = static_cast<std::size_t>(st.st_size);
+                mapped_ = true;
+                ::close(fd);
+                return true;
+            }
+        }
+        ::close(fd);
+#endif
+        // Fallback (and empty files): read into memory
+        std::ifstream in(path, std::ios::binary);
+        if (!in.is_open()) return false;
+        buffer_.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        data_ = buffer_.data();
+        size_ = buffer_.size();
+        return true;
+    }
+
+    /** Release the mapping */
+    void close() {
+#if defined(__unix__) || defined(__APPLE__)
+        if (mapped_) ::munmap(const_cast<char *>(data_), size_);
+#endif
+        mapped_ = false;
+        data_ = nullptr;
+        size_ = 0;
+        std::string().swap(buffer_);
+    }
+
+    /** First byte of the file (nullptr if nothing is open) */
+    const char *data() const { return data_; }
+
+    /** Size of the file in bytes */
+    std::size_t size() const { return size_; }
+
+    /** true if the bytes are memory-mapped rather than copied to the heap */
+    bool mapped() const { return mapped_; }
+
+    /** Heap bytes held by the read-into-memory fallback */
+    std::size_t heapBytes() const { return mapped_ ? 0 : buffer_.capacity(); }
+
+private:
+    const char *data_ {nullptr};
+    std::size_t size_ {0};
+    bool mapped_ {false};
+    std::string buffer_;  // Used only when mmap() is unavailable
+};
+
+} // namespace inv
@@ -0,0 +1,581 @@
+/**
+ * MappedHashTable.hpp
+ *
+ * Read-only hash table that lives entirely in a memory-mapped file.
+ *
+ * A table image is one contiguous block of bytes holding a header, a bucket
+ * array and every key and value. Positions are stored as byte offsets from
+ * the start of the image instead of pointers, so the image means the same
+ * thing wherever it is mapped. Every process that opens the file maps the
+ * same page-cache pages: N processes serving one catalog share one copy of
+ * it instead of each parsing the CSV into private heap memory.
+ *
+ * Image layout (native byte order, all offsets relative to the image):
+ *   header   64 bytes: magic "INVMHT01", version, entry count, bucket count,
+ *            bucket array offset, entry area offset, image size
+ *   buckets  bucketCount + 1 uint64 offsets; bucket b's entries occupy
+ *            [buckets[b], buckets[b + 1]) in the entry area
+ *   entries  per entry: uint64 hash, uint32 key length, uint32 value length,
+ *            key bytes, encoded value bytes, padding to 8 bytes
+ *
+ * Entries of a bucket are stored next to each other, so a lookup reads two
+ * adjacent bucket offsets and then scans one short contiguous run, comparing
+ * the stored 64-bit hash before any key bytes.
+ *
+ * Values are stored in a flat encoding given by MappedCodec<T> (raw bytes for
+ * trivially copyable types; specializations for strings, string vectors and
+ * Product). find() decodes into a caller-provided object.
+ *
+ * Files are written with writeMappedImages(), which writes a temporary file
+ * and renames it over the target. Processes that already mapped the old file
+ * keep reading the old inode, so a catalog can be republished while readers
+ * are running. Several images (e.g. products and the category index) can be
+ * stored in one file; packMappedImages() returns the same bytes in memory
+ * (SharedCatalog.hpp copies them into a shared-memory segment).
+ *
+ * Usage:
+ *   inv::MappedTableBuilder<int> b;
+ *   b.add("a", 1);
+ *   inv::writeMappedImages("t.invt", {&b.image()});
+ *   inv::MappedHashTable<int> t;
+ *   int v;
+ *   if (t.open("t.invt") && t.find("a", v)) ...
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "HashTable.hpp"
+#include "MappedFile.hpp"
+
+namespace inv {
+
+namespace mapped {
+
+constexpr char kTableMagic[8] = {'I', 'N', 'V', 'M', 'H', 'T', '0', '1'};
+constexpr char kFileMagic[8] = {'I', 'N', 'V', 'I', 'M', 'G', '0', '1'};
+constexpr std::uint32_t kVersion = 1;
+constexpr std::size_t kHeaderBytes = 64;
+constexpr std::size_t kEntryHeaderBytes = 16;
+constexpr std::size_t kImageAlign = 64;
+
+/**
+ * Hash stored in the file: FNV-1a followed by a splitmix64 finalizer.
+ * Fixed here (rather than std::hash) so that files stay readable by
+ * binaries built with another standard library.
+ */
+inline std::uint64_t hashKey(const char *s, std::size_t n) {
+    std::uint64_t h = 0xcbf29ce484222325ULL;
+    for (std::size_t i = 0; i < n; ++i) {
+        h ^= static_cast<unsigned char>(s[i]);
+        h *= 0x100000001b3ULL;
+    }
+    h ^= h >> 30; h *= 0xbf58476d1ce4e5b9ULL;
+    h ^= h >> 27; h *= 0x94d049bb133111ebULL;
+    return h ^ (h >> 31);
+}
+
+inline std::uint64_t load64(const char *p) { std::uint64_t v; std::memcpy(&v, p, sizeof v); return v; }
+inline std::uint32_t load32(const char *p) { std::uint32_t v; std::memcpy(&v, p, sizeof v); return v; }
+inline void put64(std::string &out, std::uint64_t v) { out.append(reinterpret_cast<const char *>(&v), sizeof v); }
+inline void put32(std::string &out, std::uint32_t v) { out.append(reinterpret_cast<const char *>(&v), sizeof v); }
+inline void store64(std::string &out, std::size_t at, std::uint64_t v) { std::memcpy(&out[at], &v, sizeof v); }
+
+inline void putString(std::string &out, const char *s, std::size_t n) {
+    put32(out, static_cast<std::uint32_t>(n));
+    out.append(s, n);
+}
+
+/**
+ * Bounds-checked cursor over an encoded value
+ */
+struct Reader {
+    const char *p;
+    const char *end;
+
+    bool u32(std::uint32_t &v) {
+        if (end - p < 4) return false;
+        v = load32(p);
+        p += 4;
+        return true;
+    }
+    bool bytes(const char *&s, std::uint32_t &n) {
+        if (!u32(n) || static_cast<std::size_t>(end - p) < n) return false;
+        s = p;
+        p += n;
+        return true;
+    }
+    bool str(std::string &out) {
+        const char *s; std::uint32_t n;
+        if (!bytes(s, n)) return false;
+        out.assign(s, n);
+        return true;
+    }
+    bool str(SmallString &out) {
+        const char *s; std::uint32_t n;
+        if (!bytes(s, n)) return false;
+        out = SmallString(s, n);
+        return true;
+    }
+};
+
+inline std::size_t alignUp(std::size_t n, std::size_t a) { return (n + a - 1) / a * a; }
+
+} // namespace mapped
+
+/**
+ * MappedCodec<T> - Flat encoding of a value stored in a mapped table
+ *
+ * encode() appends the value's bytes; decode() rebuilds it from exactly
+ * those bytes and returns false if they are malformed. The primary template
+ * copies trivially copyable types byte for byte.
+ */
+template <typename T>
+struct MappedCodec {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "MappedCodec<T> needs a specialization for types that own memory");
+    static void encode(const T &v, std::string &out) { out.append(reinterpret_cast<const char *>(&v), sizeof(T)); }
+    static bool decode(const char *p, std::size_t n, T &out) {
+        if (n != sizeof(T)) return false;
+        std::memcpy(&out, p, sizeof(T));
+        return true;
+    }
+};
+
+template <>
+struct MappedCodec<std::string> {
+    static void encode(const std::string &v, std::string &out) { out.append(v); }
+    static bool decode(const char *p, std::size_t n, std::string &out) { out.assign(p, n); return true; }
+};
+
+template <>
+struct MappedCodec<std::vector<std::string>> {
+    static void encode(const std::vector<std::string> &v, std::string &out) {
+        mapped::put32(out, static_cast<std::uint32_t>(v.size()));
+        for (const auto &s : v) mapped::putString(out, s.data(), s.size());
+    }
+    static bool decode(const char *p, std::size_t n, std::vector<std::string> &out) {
+        mapped::Reader r {p, p + n};
+        std::uint32_t count;
+        if (!r.u32(count) || count > n) return false;
+        out.resize(count);
+        for (auto &s : out) if (!r.str(s)) return false;
+        return r.p == r.end;
+    }
+};
+
+/**
+ * Product is stored with all of its fields inline; descriptionRef,
+ * sourceRef and renderedRef are not stored (they refer to in-process
+ * stores), so a decoded Product is always complete.
+ */
+template <>
+struct MappedCodec<Product> {
+    static void encode(const Product &v, std::string &out) {
+        for (const std::string *f : {&v.uniqId, &v.productName, &v.brandName, &v.category}) {
+            mapped::putString(out, f->data(), f->size());
+        }
+        MappedCodec<std::vector<std::string>>::encode(v.categories, out);
+        for (const SmallString *f : {&v.listPrice, &v.sellingPrice, &v.quantity, &v.asin}) {
+            mapped::putString(out, f->data(), f->size());
+        }
+        mapped::putString(out, v.modelNumber.data(), v.modelNumber.size());
+        mapped::putString(out, v.productDescription.data(), v.productDescription.size());
+        mapped::putString(out, v.stock.data(), v.stock.size());
+    }
+    static bool decode(const char *p, std::size_t n, Product &out) {
+        mapped::Reader r {p, p + n};
+        std::uint32_t count;
+        if (!r.str(out.uniqId) || !r.str(out.productName) || !r.str(out.brandName) || !r.str(out.category)) return false;
+        if (!r.u32(count) || count > n) return false;
+        out.categories.resize(count);
+        for (auto &c : out.categories) if (!r.str(c)) return false;
+        if (!r.str(out.listPrice) || !r.str(out.sellingPrice) || !r.str(out.quantity) || !r.str(out.asin) ||
+            !r.str(out.modelNumber) || !r.str(out.productDescription) || !r.str(out.stock)) return false;
+        out.descriptionRef = 0xFFFFFFFFu;
+        out.sourceRef = 0xFFFFFFFFu;
+        out.renderedRef = 0xFFFFFFFFu;
+        return r.p == r.end;
+    }
+};
+
+/**
+ * MappedTableBuilder<T> - Collects key-value pairs and lays out a table image
+ *
+ * Keys must be distinct; adding a key twice stores both entries and find()
+ * returns whichever comes first.
+ */
+template <typename T>
+class MappedTableBuilder {
+public:
+    /**
+     * Add an entry
+     *
+     * @param key Lookup key
+     * @param value Value, encoded with MappedCodec<T> right away
+     *
+     * Time Complexity: O(key + encoded value)
+     */
+    void add(const std::string &key, const T &value) {
+        Pending e;
+        e.hash = mapped::hashKey(key.data(), key.size());
+        e.key = key;
+        MappedCodec<T>::encode(value, e.value);
+        pending_.push_back(std::move(e));
+        image_.clear();
+    }
+
+    /** Number of entries added */
+    std::size_t size() const { return pending_.size(); }
+
+    /**
+     * Lay out the image (bucket count: the next power of two >= size)
+     *
+     * @return Image bytes, valid until the next add()
+     *
+     * Time Complexity: O(n + total bytes)
+     */
+    const std::string &image() {
+        if (!image_.empty()) return image_;
+        const std::size_t n = pending_.size();
+        std::size_t buckets = 1;
+        while (buckets < n) buckets <<= 1;
+
+        // Counting sort of entries by bucket
+        std::vector<std::size_t> start(buckets + 1, 0);
+        for (const auto &e : pending_) ++start[(e.hash & (buckets - 1)) + 1];
+        for (std::size_t b = 0; b < buckets; ++b) start[b + 1] += start[b];
+        std::vector<std::size_t> order(n);
+        std::vector<std::size_t> fill(start.begin(), start.end() - 1);
+        for (std::size_t i = 0; i < n; ++i) order[fill[pending_[i].hash & (buckets - 1)]++] = i;
+
+        const std::size_t bucketsOffset = mapped::kHeaderBytes;
+        const std::size_t entriesOffset = bucketsOffset + (buckets + 1) * sizeof(std::uint64_t);
+        image_.assign(entriesOffset, '\0');
+        std::memcpy(&image_[0], mapped::kTableMagic, sizeof mapped::kTableMagic);
+        std::uint32_t version = mapped::kVersion, headerBytes = mapped::kHeaderBytes;
+        std::memcpy(&image_[8], &version, 4);
+        std::memcpy(&image_[12], &headerBytes, 4);
+        mapped::store64(image_, 16, n);
+        mapped::store64(image_, 24, buckets);
+        mapped::store64(image_, 32, bucketsOffset);
+        mapped::store64(image_, 40, entriesOffset);
+
+        std::size_t next = 0;
+        for (std::size_t b = 0; b < buckets; ++b) {
+            mapped::store64(image_, bucketsOffset + b * 8, image_.size());
+            for (; next < start[b + 1]; ++next) {
+                const Pending &e = pending_[order[next]];
+                mapped::put64(image_, e.hash);
+                mapped::put32(image_, static_cast<std::uint32_t>(e.key.size()));
+                mapped::put32(image_, static_cast<std::uint32_t>(e.value.size()));
+                image_.append(e.key);
+                image_.append(e.value);
+                image_.resize(mapped::alignUp(image_.size(), 8), '\0');
+            }
+        }
+        mapped::store64(image_, bucketsOffset + buckets * 8, image_.size());
+        mapped::store64(image_, 48, image_.size());
+        return image_;
+    }
+
+private:
+    struct Pending {
+        std::uint64_t hash;
+        std::string key;
+        std::string value;
+    };
+    std::vector<Pending> pending_;
+    std::string image_;
+};
+
+/**
+ * packMappedImages - Lay out table images as the bytes of one file
+ *
+ * The file starts with a directory (magic "INVIMG01", image count, then an
+ * offset/size pair per image); images follow at 64-byte aligned offsets.
+ *
+ * @param images Images from MappedTableBuilder::image()
+ * @return File bytes (read back with mappedImage())
+ */
+inline std::string packMappedImages(const std::vector<const std::string *> &images) {
+    std::string out(mapped::kFileMagic, sizeof mapped::kFileMagic);
+    mapped::put64(out, images.size());
+    std::size_t offset = mapped::alignUp(out.size() + images.size() * 16, mapped::kImageAlign);
+    for (const std::string *img : images) {
+        mapped::put64(out, offset);
+        mapped::put64(out, img->size());
+        offset = mapped::alignUp(offset + img->size(), mapped::kImageAlign);
+    }
+    out.reserve(offset);
+    for (const std::string *img : images) {
+        out.resize(mapped::alignUp(out.size(), mapped::kImageAlign), '\0');
+        out.append(*img);
+    }
+    return out;
+}
+
+/**
+ * writeMappedImages - Write table images into one file
+ *
+ * The bytes (see packMappedImages()) go to "<path>.tmp", which is then
+ * renamed over path, so readers never see a half-written file.
+ *
+ * @param path Output file
+ * @param images Images from MappedTableBuilder::image()
+ * @return true if the file was written and renamed into place
+ */
+inline bool writeMappedImages(const std::string &path, const std::vector<const std::string *> &images) {
+    const std::string bytes = packMappedImages(images);
+    const std::string tmp = path + ".tmp";
+    {
+        std::ofstream f(tmp, std::ios::binary | std::ios::trunc);
+        if (!f.is_open()) return false;
+        f.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+        if (!f.good()) { f.close(); std::remove(tmp.c_str()); return false; }
+    }
+    if (std::rename(tmp.c_str(), path.c_str()) != 0) { std::remove(tmp.c_str()); return false; }
+    return true;
+}
+
+/**
+ * mappedImage - Locate one image in a file written by writeMappedImages()
+ *
+ * @param data File bytes
+ * @param size File size
+ * @param index Image number
+ * @param image Set to the image's first byte
+ * @param bytes Set to the image's size
+ * @return false if the directory is malformed or has no such image
+ */
+inline bool mappedImage(const char *data, std::size_t size, std::size_t index, const char *&image, std::size_t &bytes) {
+    if (!data || size < 16 || std::memcmp(data, mapped::kFileMagic, sizeof mapped::kFileMagic) != 0) return false;
+    std::uint64_t count = mapped::load64(data + 8);
+    if (index >= count || (size - 16) / 16 < count) return false;
+    std::uint64_t offset = mapped::load64(data + 16 + index * 16);
+    std::uint64_t length = mapped::load64(data + 24 + index * 16);
+    if (offset > size || length > size - offset) return false;
+    image = data + offset;
+    bytes = static_cast<std::size_t>(length);
+    return true;
+}
+
+/**
+ * MappedHashTable<T> - Read-only view of a table image
+ *
+ * A view either owns its file mapping (open()) or borrows an image that the
+ * caller keeps alive (attach()). All methods are const and touch only the
+ * mapped bytes, so any number of threads (and processes) can read at once.
+ */
+template <typename T>
+class MappedHashTable {
+public:
+    /** Empty view; find() misses and size() is 0 */
+    MappedHashTable() = default;
+    MappedHashTable(const MappedHashTable &) = delete;
+    MappedHashTable &operator=(const MappedHashTable &) = delete;
+
+    /**
+     * Map a file written by writeMappedImages() and view one of its images
+     *
+     * @param path Table file
+     * @param index Image number within the file
+     * @return false if the file cannot be mapped or is not a valid table
+     */
+    bool open(const std::string &path, std::size_t index = 0) {
+        close();
+        std::unique_ptr<MappedFile> file(new MappedFile());
+        const char *img;
+        std::size_t bytes;
+        if (!file->open(path) || !mappedImage(file->data(), file->size(), index, img, bytes)) return false;
+        if (!attach(img, bytes)) return false;
+        file_ = std::move(file);
+        return true;
+    }
+
+    /**
+     * View an image held elsewhere (which must outlive this view)
+     *
+     * Checks the header and that the bucket array and entry area lie inside
+     * the image; entries are bounds-checked as they are read.
+     *
+     * @param image First byte of the image
+     * @param bytes Image size
+     * @return false if the header is not valid (the view is left empty)
+     */
+    bool attach(const char *image, std::size_t bytes) {
+        close();
+        if (!image || bytes < mapped::kHeaderBytes ||
+            std::memcmp(image, mapped::kTableMagic, sizeof mapped::kTableMagic) != 0 ||
+            mapped::load32(image + 8) != mapped::kVersion) return false;
+        std::uint64_t size = mapped::load64(image + 16), buckets = mapped::load64(image + 24);
+        std::uint64_t bucketsOffset = mapped::load64(image + 32), entriesOffset = mapped::load64(image + 40);
+        std::uint64_t imageBytes = mapped::load64(image + 48);
+        if (imageBytes != bytes || buckets == 0 || (buckets & (buckets - 1)) != 0 ||
+            bucketsOffset < mapped::kHeaderBytes || bucketsOffset > bytes ||
+            (bytes - bucketsOffset) / 8 <= buckets || entriesOffset != bucketsOffset + (buckets + 1) * 8 ||
+            mapped::load64(image + bucketsOffset) != entriesOffset ||
+            mapped::load64(image + bucketsOffset + buckets * 8) != bytes) return false;
+        image_ = image;
+        bytes_ = bytes;
+        size_ = static_cast<std::size_t>(size);
+        bucketCount_ = static_cast<std::size_t>(buckets);
+        buckets_ = image + bucketsOffset;
+        return true;
+    }
+
+    /** Drop the view (and the mapping, if this view owns it) */
+    void close() {
+        image_ = buckets_ = nullptr;
+        bytes_ = size_ = bucketCount_ = 0;
+        file_.reset();
+    }
+
+    /** true if a table is attached */
+    bool isOpen() const { return image_ != nullptr; }
+
+    /** Number of entries */
+    std::size_t size() const { return size_; }
+
+    /** Number of buckets */
+    std::size_t bucketCount() const { return bucketCount_; }
+
+    /** Size of the image in bytes */
+    std::size_t imageBytes() const { return bytes_; }
+
+    /** Heap bytes held by the file's read fallback (0 when mmapped) */
+    std::size_t heapBytes() const { return file_ ? file_->heapBytes() : 0; }
+
+    /**
+     * Locate a key's encoded value without decoding it
+     *
+     * @param key Key to search for
+     * @param value Set to the first byte of the encoded value
+     * @param n Set to its length
+     * @return true if the key is present
+     *
+     * Time Complexity: O(1) average; reads one bucket's contiguous entries
+     */
+    bool findEncoded(const std::string &key, const char *&value, std::size_t &n) const {
+        if (!image_) return false;
+        const std::uint64_t h = mapped::hashKey(key.data(), key.size());
+        const std::size_t b = static_cast<std::size_t>(h & (bucketCount_ - 1));
+        std::uint64_t pos = mapped::load64(buckets_ + b * 8), end = mapped::load64(buckets_ + b * 8 + 8);
+        if (end > bytes_) return false;
+        while (pos + mapped::kEntryHeaderBytes <= end) {
+            const char *e = image_ + pos;
+            std::uint32_t keyLen = mapped::load32(e + 8), valueLen = mapped::load32(e + 12);
+            std::uint64_t next = pos + mapped::alignUp(mapped::kEntryHeaderBytes + std::uint64_t(keyLen) + valueLen, 8);
+            if (next > end) return false;
+            if (mapped::load64(e) == h && keyLen == key.size() &&
+                std::memcmp(e + mapped::kEntryHeaderBytes, key.data(), keyLen) == 0) {
+                value = e + mapped::kEntryHeaderBytes + keyLen;
+                n = valueLen;
+                return true;
+            }
+            pos = next;
+        }
+        return false;
+    }
+
+    /**
+     * Find a key and decode its value
+     *
+     * @param key Key to search for
+     * @param out Receives the value (unspecified if false is returned)
+     * @return true if the key is present and its value decoded
+     */
+    bool find(const std::string &key, T &out) const {
+        const char *v;
+        std::size_t n;
+        return findEncoded(key, v, n) && MappedCodec<T>::decode(v, n, out);
+    }
+
+    /** true if the key is present */
+    bool contains(const std::string &key) const {
+        const char *v;
+        std::size_t n;
+        return findEncoded(key, v, n);
+    }
+
+    /**
+     * Call fn(key, value) for every entry, in bucket order
+     * Each value is decoded into a temporary; entries that fail to decode
+     * are skipped.
+     *
+     * Time Complexity: O(n + image bytes)
+     */
+    template <typename F>
+    void forEach(F fn) const {
+        if (!image_) return;
+        std::string key;
+        T value;
+        std::uint64_t pos = mapped::load64(buckets_), end = bytes_;
+        while (pos + mapped::kEntryHeaderBytes <= end) {
+            const char *e = image_ + pos;
+            std::uint32_t keyLen = mapped::load32(e + 8), valueLen = mapped::load32(e + 12);
+            std::uint64_t next = pos + mapped::alignUp(mapped::kEntryHeaderBytes + std::uint64_t(keyLen) + valueLen, 8);
+            if (next > end) return;
+            key.assign(e + mapped::kEntryHeaderBytes, keyLen);
+            if (MappedCodec<T>::decode(e + mapped::kEntryHeaderBytes + keyLen, valueLen, value)) {
+                const T &cv = value;
+                fn(key, cv);
+            }
+            pos = next;
+        }
+    }
+
+    /**
+     * Bucket layout in HashTable's terms: chain lengths are the entry runs
+     * per bucket, bucket bytes the offset array and node bytes the entry area
+     *
+     * Time Complexity: O(buckets + n)
+     */
+    HashTableStats stats() const {
+        HashTableStats st;
+        st.size = size_;
+        st.bucketCount = bucketCount_;
+        if (!image_) return st;
+        st.loadFactor = static_cast<double>(size_) / static_cast<double>(bucketCount_);
+        st.bucketBytes = (bucketCount_ + 1) * sizeof(std::uint64_t);
+        st.nodeBytes = bytes_ - mapped::kHeaderBytes - st.bucketBytes;
+        std::size_t hitProbes = 0;
+        for (std::size_t b = 0; b < bucketCount_; ++b) {
+            std::uint64_t pos = mapped::load64(buckets_ + b * 8), end = mapped::load64(buckets_ + b * 8 + 8);
+            std::size_t len = 0;
+            while (pos + mapped::kEntryHeaderBytes <= end) {
+                const char *e = image_ + pos;
+                pos += mapped::alignUp(mapped::kEntryHeaderBytes + std::uint64_t(mapped::load32(e + 8)) + mapped::load32(e + 12), 8);
+                ++len;
+            }
+            if (len >= st.chainHistogram.size()) st.chainHistogram.resize(len + 1, 0);
+            ++st.chainHistogram[len];
+            if (len == 0) ++st.emptyBuckets;
+            if (len > st.longestChain) st.longestChain = len;
+            hitProbes += len * (len + 1) / 2;
+        }
+        st.avgProbesHit = size_ ? static_cast<double>(hitProbes) / static_cast<double>(size_) : 0.0;
+        st.avgProbesMiss = st.loadFactor;
+        return st;
+    }
+
+private:
+    const char *image_ {nullptr};
+    const char *buckets_ {nullptr};
+    std::size_t bytes_ {0};
+    std::size_t size_ {0};
+    std::size_t bucketCount_ {0};
+    std::unique_ptr<MappedFile> file_;  // Set when this view owns the mapping
+};
+
+} // namespace inv
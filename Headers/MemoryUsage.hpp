@@ -0,0 +1,435 @@
+/**
+ * MemoryUsage.hpp
+ *
+ * Exact memory accounting for the product table and category index.
+ *
+ * Walks every container and string and adds up the bytes each one asks the
+ * allocator for, split by purpose:
+ *
+ * - Product table: bucket array, node overhead (list links), key strings,
+ *   field strings (including the categories vector), and the inline bytes of
+ *   the Product objects themselves
+ * - Category index: bucket array, map nodes, category name strings, id vector
+ *   buffers, and the id string copies they hold
+ *
+ * Allocator slack is computed per allocation from glibc malloc's chunk
+ * rounding rules (8-byte header, 16-byte granularity, 32-byte minimum, mmap
+ * above the mmap threshold), so "requested + slack" is exactly what malloc
+ * hands out. On other C libraries slack is reported as zero.
+ *
+ * Tables using PoolAllocator are accounted by slab: the node allocations are
+ * the slabs themselves, and everything in a slab not occupied by a live node
+ * (rounding, free-listed nodes, the unused tail) counts as slack.
+ *
+ * When descriptions are kept in a DescriptionStore, its compressed blocks,
+ * handle table, open block and decompression cache are reported separately.
+ * In lazy cold-field mode the record location table and the cache of parsed
+ * cold fields are reported too; the mapped source file is file-backed page
+ * cache, not heap, and is shown separately from the total. A catalog opened
+ * from a MappedHashTable file is all page cache; only its image sizes are
+ * reported. Pre-rendered `find` output (RenderedStore) is reported with its
+ * live and released bytes.
+ *
+ * Strings short enough for the small-string optimization live inside their
+ * owner and contribute no heap bytes; this is detected by checking whether the
+ * character buffer lies inside the string object (SmallString reports it directly).
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "DescriptionStore.hpp"
+#include "HashTable.hpp"
+#include "MappedHashTable.hpp"
+#include "Parser.hpp"
+#include "PerfectHashTable.hpp"
+#include "PoolAllocator.hpp"
+#include "RenderedStore.hpp"
+
+namespace inv {
+
+/**
+ * mallocChunkBytes - Bytes malloc actually reserves for a request
+ *
+ * glibc (64-bit): chunks are request + 8-byte header rounded up to 16, at
+ * least 32 bytes; requests at or above the default mmap threshold (128 KiB)
+ * are served by mmap in whole pages with a 16-byte header.
+ *
+ * @param request Bytes requested (0 means no allocation)
+ * @return Bytes consumed including header and rounding
+ */
+inline std::size_t mallocChunkBytes(std::size_t request) {
+    if (request == 0) return 0;
+#if defined(__GLIBC__)
+    const std::size_t header = sizeof(std::size_t);
+    const std::size_t align = 2 * sizeof(std::size_t);
+    const std::size_t mmapThreshold = 128 * 1024;
+    const std::size_t minChunk = 4 * sizeof(std::size_t);
+    std::size_t chunk = (request + header + align - 1) / align * align;
+    if (chunk < minChunk) chunk = minChunk;
+    if (request >= mmapThreshold) {
+        const std::size_t page = 4096;
+        return (chunk + header + page - 1) / page * page;
+    }
+    return chunk;
+#else
+    return request;
+#endif
+}
+
+/**
+ * HeapBytes - Requested bytes plus allocator slack for a group of allocations
+ */
+struct HeapBytes {
+    std::size_t requested {0};    // Bytes asked of the allocator
+    std::size_t slack {0};        // Headers + rounding on top of `requested`
+    std::size_t allocations {0};  // Number of separate allocations
+
+    /** Record one allocation of `request` bytes */
+    void add(std::size_t request) {
+        if (request == 0) return;
+        requested += request;
+        slack += mallocChunkBytes(request) - request;
+        ++allocations;
+    }
+
+    /** Requested bytes + slack */
+    std::size_t total() const { return requested + slack; }
+
+    HeapBytes &operator+=(const HeapBytes &o) {
+        requested += o.requested; slack += o.slack; allocations += o.allocations;
+        return *this;
+    }
+};
+
+/**
+ * Record the heap buffer of a string (nothing if stored inline via SSO)
+ */
+inline void addString(HeapBytes &h, const std::string &s) {
+    const char *data = s.data();
+    const char *self = reinterpret_cast<const char *>(&s);
+    if (data >= self && data < self + sizeof(std::string)) return; // small-string buffer
+    h.add(s.capacity() + 1);
+}
+
+/**
+ * Record the heap buffer of a SmallString (nothing if stored inline)
+ */
+inline void addString(HeapBytes &h, const SmallString &s) {
+    if (!s.isInline()) h.add(s.size() + 1);
+}
+
+/**
+ * Record a vector's element buffer (not the elements' own heap data)
+ */
+template <typename V>
+inline void addVectorBuffer(HeapBytes &h, const std::vector<V> &v) {
+    h.add(v.capacity() * sizeof(V));
+}
+
+/**
+ * Record `count` table nodes of `nodeBytes` each
+ * Default allocators make one malloc() per node.
+ */
+template <typename A>
+inline void addNodes(HeapBytes &h, const A &, std::size_t count, std::size_t nodeBytes) {
+    for (std::size_t i = 0; i < count; ++i) h.add(nodeBytes);
+}
+
+/**
+ * Record `count` table nodes carved from a NodePool's slabs
+ */
+template <typename U>
+inline void addNodes(HeapBytes &h, const PoolAllocator<U> &a, std::size_t count, std::size_t nodeBytes) {
+    const NodePool &pool = a.pool();
+    std::size_t used = count * nodeBytes;
+    std::size_t reserved = pool.slabCount() * mallocChunkBytes(pool.slabBytes());
+    h.requested += used;
+    h.slack += reserved > used ? reserved - used : 0;
+    h.allocations += pool.slabCount();
+}
+
+/**
+ * MemoryReport - Breakdown produced by measureMemory()
+ */
+struct MemoryReport {
+    // Product table
+    std::size_t products {0};
+    HeapBytes tableBuckets;    // Bucket array (one list header per bucket)
+    HeapBytes tableNodes;      // Node allocations (list links + key object + Product object), or slabs when pooled
+    std::size_t nodeLinkBytes {0};     // Part of tableNodes.requested spent on list links
+    std::size_t nodeInlineBytes {0};   // Part of tableNodes.requested spent on key/Product objects
+    HeapBytes keyStrings;      // Heap buffers of table keys
+    HeapBytes fieldStrings;    // Heap buffers of Product string fields and categories vectors
+    HeapBytes tableFilter;     // Miss filter bit array (only when enabled)
+
+    // Category index
+    std::size_t categories {0};
+    HeapBytes indexBuckets;    // Bucket array of the unordered_map
+    HeapBytes indexNodes;      // Map nodes (next link + cached hash + key/vector objects)
+    HeapBytes indexKeys;       // Heap buffers of category names
+    HeapBytes indexIdVectors;  // Id vector buffers (sizeof(std::string) per slot)
+    HeapBytes indexIdStrings;  // Heap buffers of the id copies
+
+    // Description store (only when descriptions are compressed)
+    bool hasDescriptionStore {false};
+    std::size_t descriptionRawBytes {0}; // Uncompressed size of the stored text
+    HeapBytes descriptionBlocks;  // Compressed blocks plus the open block
+    HeapBytes descriptionEntries; // Handle table
+    HeapBytes descriptionCache;   // Decompressed blocks kept for reuse
+
+    // Lazy cold fields (only in lazy mode)
+    bool hasColdFields {false};
+    std::size_t coldRecords {0};       // Products whose cold fields are deferred
+    std::size_t coldCached {0};        // Products whose parsed cold fields are cached
+    std::size_t coldMappedBytes {0};   // Source file bytes mapped (not heap)
+    HeapBytes coldLocations;      // Record offset/length table (plus the file copy if mmap was unavailable)
+    HeapBytes coldCache;          // Parsed cold fields cache: map buckets and nodes, slots, strings
+
+    // Pre-rendered find output (only when enabled)
+    bool hasRenderedStore {false};
+    std::size_t renderedBlocks {0};        // Products with a rendered block
+    std::size_t renderedLiveBytes {0};     // Bytes of current blocks
+    std::size_t renderedGarbageBytes {0};  // Bytes of released blocks not yet reclaimed
+    HeapBytes renderedChunks;     // Arena chunks
+    HeapBytes renderedHandles;    // Handle table and free list
+
+    // Memory-mapped catalog (only after Engine::openCatalog)
+    bool hasMappedCatalog {false};
+    std::size_t mappedProductBytes {0}; // Product table image (page cache, not heap)
+    std::size_t mappedIndexBytes {0};   // Category index image (page cache, not heap)
+    HeapBytes mappedFileCopy;     // Heap copy of the file if mmap was unavailable
+
+    /** Everything owned by the product table */
+    HeapBytes tableTotal() const {
+        HeapBytes h = tableBuckets; h += tableNodes; h += keyStrings; h += fieldStrings; h += tableFilter;
+        return h;
+    }
+
+    /** Everything owned by the category index */
+    HeapBytes indexTotal() const {
+        HeapBytes h = indexBuckets; h += indexNodes; h += indexKeys; h += indexIdVectors; h += indexIdStrings;
+        return h;
+    }
+
+    /** Everything owned by the description store */
+    HeapBytes descriptionTotal() const {
+        HeapBytes h = descriptionBlocks; h += descriptionEntries; h += descriptionCache;
+        return h;
+    }
+
+    /** Everything owned by the cold field store */
+    HeapBytes coldTotal() const {
+        HeapBytes h = coldLocations; h += coldCache;
+        return h;
+    }
+
+    /** Everything owned by the rendered output store */
+    HeapBytes renderedTotal() const {
+        HeapBytes h = renderedChunks; h += renderedHandles;
+        return h;
+    }
+};
+
+/**
+ * Record a HashTable's bucket array and nodes (any bucket policy)
+ */
+template <typename T, typename A, typename P>
+inline void addTableStorage(MemoryReport &r, const HashTable<T, A, P> &table) {
+    // Bucket array: one allocation of bucketCount bucket headers
+    r.tableBuckets.add(table.bucketCount() * HashTable<T, A, P>::bucketBytes());
+    addNodes(r.tableNodes, table.get_allocator(), table.size(), HashTable<T, A, P>::nodeBytes());
+    if (table.missFilterEnabled()) r.tableFilter.add(table.missFilter().bytes());
+}
+
+/**
+ * Record a PerfectHashTable's pilot and remap arrays (reported as its
+ * buckets) and its dense entry array (reported as its nodes, with no links)
+ */
+template <typename T>
+inline void addTableStorage(MemoryReport &r, const PerfectHashTable<T> &table) {
+    const PerfectHashStats &st = table.stats();
+    r.tableBuckets.add(st.pilotBytes);
+    r.tableBuckets.add(st.remapBytes);
+    r.tableNodes.add(st.entryBytes);
+}
+
+/**
+ * measureMemory - Account for every byte owned by the table and index
+ *
+ * @param table Product table (HashTable or PerfectHashTable)
+ * @param categoryIndex Category -> Uniq Ids index
+ * @param descriptions Compressed description store, if one is used
+ * @param coldFields Lazy cold field store, if one is used
+ * @param rendered Pre-rendered output store, if one is used
+ * @return Exact breakdown of requested bytes and allocator slack
+ *
+ * Time Complexity: O(n + m) over all entries, buckets and index ids
+ */
+template <typename Table>
+MemoryReport measureMemory(const Table &table,
+                           const std::unordered_map<std::string, std::vector<std::string>> &categoryIndex,
+                           const DescriptionStore *descriptions = nullptr,
+                           const ColdFieldStore *coldFields = nullptr,
+                           const RenderedStore *rendered = nullptr) {
+    MemoryReport r;
+    r.products = table.size();
+
+    addTableStorage(r, table);
+    table.forEach([&](const std::string &key, const Product &p) {
+        addString(r.keyStrings, key);
+        for (const std::string *f : {&p.uniqId, &p.productName, &p.brandName, &p.category,
+                                     &p.modelNumber, &p.productDescription}) {
+            addString(r.fieldStrings, *f);
+        }
+        for (const SmallString *f : {&p.listPrice, &p.sellingPrice, &p.quantity, &p.asin, &p.stock}) {
+            addString(r.fieldStrings, *f);
+        }
+        addVectorBuffer(r.fieldStrings, p.categories);
+        for (const auto &c : p.categories) addString(r.fieldStrings, c);
+    });
+    r.nodeInlineBytes = r.products * (sizeof(std::string) + sizeof(Product));
+    r.nodeLinkBytes = r.tableNodes.requested - r.nodeInlineBytes;
+
+    // unordered_map: bucket pointer array + one node per element holding the
+    // next link, the key/value pair and (for std::string keys) the cached hash
+    using Index = std::unordered_map<std::string, std::vector<std::string>>;
+    r.categories = categoryIndex.size();
+    if (categoryIndex.bucket_count() > 1) r.indexBuckets.add(categoryIndex.bucket_count() * sizeof(void *));
+    const std::size_t mapNode = sizeof(void *) + sizeof(Index::value_type) + sizeof(std::size_t);
+    for (const auto &kv : categoryIndex) {
+        r.indexNodes.add(mapNode);
+        addString(r.indexKeys, kv.first);
+        addVectorBuffer(r.indexIdVectors, kv.second);
+        for (const auto &id : kv.second) addString(r.indexIdStrings, id);
+    }
+
+    if (descriptions) {
+        r.hasDescriptionStore = true;
+        r.descriptionRawBytes = descriptions->rawBytes();
+        descriptions->forEachBlock([&](const std::string &b) { addString(r.descriptionBlocks, b); });
+        r.descriptionEntries.add(descriptions->entryBytes());
+        descriptions->forEachCached([&](const std::string &b) { if (!b.empty()) addString(r.descriptionCache, b); });
+    }
+
+    if (coldFields) {
+        r.hasColdFields = true;
+        r.coldRecords = coldFields->size();
+        r.coldMappedBytes = coldFields->mappedBytes();
+        r.coldLocations.add(coldFields->recordBytes());
+        r.coldLocations.add(coldFields->fileHeapBytes());
+        if (coldFields->cacheBucketCount() > 1) r.coldCache.add(coldFields->cacheBucketCount() * sizeof(void *));
+        r.coldCache.add(coldFields->cacheSlotBytes());
+        // Integer keys: next link + ref/slot pair (no cached hash)
+        const std::size_t node = sizeof(void *) + sizeof(std::pair<const std::uint32_t, std::uint32_t>);
+        coldFields->forEachCached([&](const ColdFields &c) {
+            ++r.coldCached;
+            r.coldCache.add(node);
+            addString(r.coldCache, c.asin);
+            addString(r.coldCache, c.modelNumber);
+            addString(r.coldCache, c.productDescription);
+        });
+    }
+
+    if (rendered) {
+        r.hasRenderedStore = true;
+        r.renderedBlocks = rendered->size();
+        r.renderedLiveBytes = rendered->liveBytes();
+        r.renderedGarbageBytes = rendered->garbageBytes();
+        rendered->forEachChunk([&](std::size_t bytes) { r.renderedChunks.add(bytes); });
+        if (rendered->spanBytes() > 0) r.renderedHandles.add(rendered->spanBytes());
+    }
+    return r;
+}
+
+/**
+ * measureMappedMemory - Account for a memory-mapped catalog
+ * The images are file-backed pages shared with every process mapping the
+ * same file; only the read fallback's copy (if mmap failed) is heap.
+ *
+ * @param products Mapped product table
+ * @param categories Mapped category index
+ * @param fileHeapBytes Heap bytes held by the file's read fallback
+ * @return Report with only the mapped catalog fields set
+ */
+inline MemoryReport measureMappedMemory(const MappedHashTable<Product> &products,
+                                        const MappedHashTable<std::vector<std::string>> &categories,
+                                        std::size_t fileHeapBytes) {
+    MemoryReport r;
+    r.hasMappedCatalog = true;
+    r.products = products.size();
+    r.categories = categories.size();
+    r.mappedProductBytes = products.imageBytes();
+    r.mappedIndexBytes = categories.imageBytes();
+    if (fileHeapBytes > 0) r.mappedFileCopy.add(fileHeapBytes);
+    return r;
+}
+
+/**
+ * printMemoryReport - Human-readable breakdown (the `:memory` command)
+ */
+inline void printMemoryReport(const MemoryReport &r, std::ostream &out) {
+    auto line = [&](const char *label, const HeapBytes &h) {
+        out << "  " << label << ": " << h.requested << " bytes + " << h.slack << " slack ("
+            << h.allocations << " allocations)" << '\n';
+    };
+    if (r.hasMappedCatalog) {
+        out << "Mapped catalog (" << r.products << " products, " << r.categories << " categories): "
+            << r.mappedProductBytes + r.mappedIndexBytes << " bytes mapped (page cache, shared, not heap)" << '\n';
+        out << "    product table image: " << r.mappedProductBytes << " bytes" << '\n';
+        out << "    category index image: " << r.mappedIndexBytes << " bytes" << '\n';
+        if (r.mappedFileCopy.allocations > 0) line("heap copy (mmap unavailable)", r.mappedFileCopy);
+        out << "Allocator slack: " << r.mappedFileCopy.slack << " bytes" << '\n';
+        out << "Total: " << r.mappedFileCopy.total() << " bytes in " << r.mappedFileCopy.allocations << " allocations" << '\n';
+        return;
+    }
+    HeapBytes table = r.tableTotal(), index = r.indexTotal();
+    out << "Product table (" << r.products << " products): " << table.total() << " bytes" << '\n';
+    line("bucket array", r.tableBuckets);
+    line("nodes", r.tableNodes);
+    out << "    node overhead (list links): " << r.nodeLinkBytes << " bytes" << '\n';
+    out << "    inline key/Product objects: " << r.nodeInlineBytes << " bytes" << '\n';
+    line("key strings", r.keyStrings);
+    line("field strings", r.fieldStrings);
+    if (r.tableFilter.allocations > 0) line("miss filter", r.tableFilter);
+    out << "Category index (" << r.categories << " categories): " << index.total() << " bytes" << '\n';
+    line("bucket array", r.indexBuckets);
+    line("map nodes", r.indexNodes);
+    line("category names", r.indexKeys);
+    line("id vectors", r.indexIdVectors);
+    line("id string copies", r.indexIdStrings);
+    HeapBytes all = table; all += index;
+    if (r.hasDescriptionStore) {
+        HeapBytes desc = r.descriptionTotal();
+        out << "Description store (" << r.descriptionRawBytes << " bytes of text): " << desc.total() << " bytes" << '\n';
+        line("compressed blocks", r.descriptionBlocks);
+        line("handle table", r.descriptionEntries);
+        line("decompression cache", r.descriptionCache);
+        all += desc;
+    }
+    if (r.hasColdFields) {
+        HeapBytes cold = r.coldTotal();
+        out << "Cold fields (" << r.coldRecords << " deferred, " << r.coldCached << " cached): " << cold.total() << " bytes" << '\n';
+        line("record locations", r.coldLocations);
+        line("parsed cache", r.coldCache);
+        out << "    source file mapped (page cache, not heap): " << r.coldMappedBytes << " bytes" << '\n';
+        all += cold;
+    }
+    if (r.hasRenderedStore) {
+        HeapBytes rendered = r.renderedTotal();
+        out << "Rendered output (" << r.renderedBlocks << " products, " << r.renderedLiveBytes << " bytes live, "
+            << r.renderedGarbageBytes << " released): " << rendered.total() << " bytes" << '\n';
+        line("arena chunks", r.renderedChunks);
+        line("handle table", r.renderedHandles);
+        all += rendered;
+    }
+    out << "Allocator slack: " << all.slack << " bytes" << '\n';
+    out << "Total: " << all.total() << " bytes in " << all.allocations << " allocations" << '\n';
+}
+
+} // namespace inv
@@ -0,0 +1,185 @@
+/**
+ * MissFilter.hpp
+ *
+ * Split-block Bloom filter used by HashTable to reject lookups of absent
+ * keys before any bucket chain is walked.
+ *
+ * Layout: the filter is an array of 32-byte blocks of eight 32-bit words,
+ * aligned so no block straddles a 64-byte cache line. A key's hash picks one
+ * block, and sets (or tests) one bit in each of the block's eight words, so
+ * an add or a query touches exactly one cache line and never branches on
+ * intermediate results.
+ *
+ * Keys are never removed: erasing a key from the table leaves its bits set,
+ * which only raises the false positive rate. The owner rebuilds the filter
+ * whenever its capacity changes (HashTable does so on every rehash).
+ *
+ * Bloom filters support insertion, so the table can keep the filter current
+ * on every insert; static filters (xor, binary fuse) are smaller but would
+ * have to be rebuilt from scratch after each change.
+ *
+ * False positive rate: about 1% at 10 bits per key, 0.1% at 16.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace inv {
+
+/**
+ * BlockedBloomFilter - Approximate set of 64-bit hashes with one-line probes
+ */
+class BlockedBloomFilter {
+public:
+    /** Default bits of filter per expected key */
+    static constexpr double kDefaultBitsPerKey = 10.0;
+
+    /** Empty filter; enabled() stays false until reset() */
+    BlockedBloomFilter() = default;
+
+    /**
+     * Size the filter for an expected number of keys and clear every bit
+     *
+     * @param capacity Keys the filter should hold at about bitsPerKey each
+     * @param bitsPerKey Filter bits per key (more bits, fewer false positives)
+     *
+     * Time Complexity: O(capacity)
+     */
+    void reset(std::size_t capacity, double bitsPerKey = kDefaultBitsPerKey) {
+        bitsPerKey_ = bitsPerKey;
+        capacity_ = capacity;
+        double bits = std::max(1.0, static_cast<double>(capacity) * bitsPerKey);
+        blocks_ = static_cast<std::size_t>(std::ceil(bits / kBlockBits));
+        // Room to round the first block up to a cache-line boundary
+        words_.assign(blocks_ * kWordsPerBlock + kLineWords, 0);
+        std::uintptr_t addr = reinterpret_cast<std::uintptr_t>(words_.data());
+        base_ = ((kLineBytes - addr % kLineBytes) % kLineBytes) / sizeof(std::uint32_t);
+        count_ = 0;
+    }
+
+    /** Drop the bit array; mayContain() answers true for everything */
+    void release() {
+        std::vector<std::uint32_t>().swap(words_);
+        blocks_ = base_ = capacity_ = count_ = 0;
+    }
+
+    /** true once reset() has sized the filter */
+    bool enabled() const { return blocks_ != 0; }
+
+    /**
+     * Record a key's hash
+     *
+     * @param hash Hash of the key (re-mixed here, so the table's own bucket
+     *             hash can be passed without correlating with bucket choice)
+     *
+     * Time Complexity: O(1), one cache line
+     */
+    void add(std::uint64_t hash) {
+        hash = mix(hash);
+        std::uint32_t *block = blockFor(hash);
+        const std::uint32_t h = static_cast<std::uint32_t>(hash);
+        for (std::size_t i = 0; i < kWordsPerBlock; ++i) block[i] |= bitFor(h, i);
+        ++count_;
+    }
+
+    /**
+     * Test whether a key's hash may have been added
+     *
+     * @param hash Hash of the key, as passed to add()
+     * @return false if the key was definitely never added; true if it was
+     *         added or on a false positive (and always if not enabled())
+     *
+     * Time Complexity: O(1), one cache line
+     */
+    bool mayContain(std::uint64_t hash) const {
+        if (blocks_ == 0) return true;
+        hash = mix(hash);
+        const std::uint32_t *block = blockFor(hash);
+        const std::uint32_t h = static_cast<std::uint32_t>(hash);
+        std::uint32_t missing = 0;
+        for (std::size_t i = 0; i < kWordsPerBlock; ++i) missing |= bitFor(h, i) & ~block[i];
+        return missing == 0;
+    }
+
+    /** Keys the filter was sized for */
+    std::size_t capacity() const { return capacity_; }
+
+    /** add() calls since the last reset() (including erased keys) */
+    std::size_t count() const { return count_; }
+
+    /** Configured bits per key */
+    double bitsPerKey() const { return bitsPerKey_; }
+
+    /** Bytes of the bit array (including alignment slack) */
+    std::size_t bytes() const { return words_.capacity() * sizeof(std::uint32_t); }
+
+    /**
+     * Expected false positive rate after n distinct adds
+     *
+     * Block loads are Poisson with mean n / blocks; a query for an absent key
+     * passes if its block already has all eight of its bits set.
+     *
+     * @param n Number of keys added
+     * @return Probability that mayContain() is true for an absent key
+     */
+    double expectedFalsePositiveRate(std::size_t n) const {
+        if (blocks_ == 0) return 1.0;
+        const double lambda = static_cast<double>(n) / static_cast<double>(blocks_);
+        double fpr = 0.0, p = std::exp(-lambda);  // p = P(block holds i keys)
+        for (std::size_t i = 0; i < 1000 && (i < lambda || p > 1e-12); ++i) {
+            double wordFull = 1.0 - std::pow(1.0 - 1.0 / 32.0, static_cast<double>(i));
+            fpr += p * std::pow(wordFull, static_cast<double>(kWordsPerBlock));
+            p *= lambda / static_cast<double>(i + 1);
+        }
+        return fpr;
+    }
+
+private:
+    static constexpr std::size_t kWordsPerBlock = 8;
+    static constexpr double kBlockBits = 32.0 * kWordsPerBlock;
+    static constexpr std::size_t kLineBytes = 64;
+    static constexpr std::size_t kLineWords = kLineBytes / sizeof(std::uint32_t);
+
+    std::vector<std::uint32_t> words_;
+    // Index of the first cache-line aligned word (a copy keeps the offset, so
+    // it stays correct but may lose the alignment until the next reset())
+    std::size_t base_ {0};
+    std::size_t blocks_ {0};
+    std::size_t capacity_ {0};
+    std::size_t count_ {0};
+    double bitsPerKey_ {kDefaultBitsPerKey};
+
+    /** splitmix64 finalizer */
+    static std::uint64_t mix(std::uint64_t x) {
+        x ^= x >> 30; x *= 0xbf58476d1ce4e5b9ULL;
+        x ^= x >> 27; x *= 0x94d049bb133111ebULL;
+        return x ^ (x >> 31);
+    }
+
+    /** The high 32 bits pick the block (multiply-shift instead of modulo) */
+    std::size_t blockIndex(std::uint64_t hash) const {
+        return static_cast<std::size_t>(((hash >> 32) * static_cast<std::uint64_t>(blocks_)) >> 32);
+    }
+
+    std::uint32_t *blockFor(std::uint64_t hash) {
+        return words_.data() + base_ + blockIndex(hash) * kWordsPerBlock;
+    }
+    const std::uint32_t *blockFor(std::uint64_t hash) const {
+        return words_.data() + base_ + blockIndex(hash) * kWordsPerBlock;
+    }
+
+    /** The low 32 bits pick one bit per word via eight odd multipliers */
+    static std::uint32_t bitFor(std::uint32_t h, std::size_t word) {
+        static const std::uint32_t kSalt[kWordsPerBlock] = {
+            0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+            0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U};
+        return std::uint32_t(1) << ((h * kSalt[word]) >> 27);
+    }
+};
+
+} // namespace inv
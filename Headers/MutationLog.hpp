@@ -0,0 +1,178 @@
+/**
+ * MutationLog.hpp
+ *
+ * Append-only log of catalog mutations (product upserts and erases).
+ *
+ * Every change an Engine makes after enableMutationLog() is appended as one
+ * binary record; positions are record sequence numbers starting at 0, so a
+ * reader that has applied records [0, p) resumes by asking for position p.
+ * Replicas (Headers/Replication.hpp) copy batches of raw records straight
+ * from the log onto a socket and decode them on the other side.
+ *
+ * Record layout (little-endian, as written by the host):
+ *   u8  op           1 = upsert, 2 = erase
+ *   u32 recordIndex  Product::recordIndex (upserts; 0 for erases)
+ *   u32 length       payload bytes
+ *   ... payload      upsert: MappedCodec<Product> encoding; erase: the id
+ *
+ * Thread Safety: append() and the readers may run concurrently; readers can
+ * block in waitBeyond() until a record past a position exists.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "HashTable.hpp"
+#include "MappedHashTable.hpp"
+
+namespace inv {
+
+/**
+ * One decoded log record
+ */
+struct Mutation {
+    enum Op : std::uint8_t { Upsert = 1, Erase = 2 };
+
+    Op op {Upsert};
+    Product product;  // Complete product for Upsert; only uniqId is set for Erase
+};
+
+/**
+ * MutationLog - Sequence of encoded mutations with blocking tail reads
+ *
+ * Memory: every record stays in memory (a full copy of each upserted
+ * product); there is no compaction.
+ */
+class MutationLog {
+public:
+    static constexpr std::size_t kRecordHeader = 9;  // op + recordIndex + length
+
+    /**
+     * Append an upsert of p
+     * @return Position of the new record
+     *
+     * Time Complexity: O(encoded product)
+     */
+    std::uint64_t appendUpsert(const Product &p) {
+        std::string payload;
+        MappedCodec<Product>::encode(p, payload);
+        return append(Mutation::Upsert, p.recordIndex, payload);
+    }
+
+    /**
+     * Append an erase of id
+     * @return Position of the new record
+     */
+    std::uint64_t appendErase(const std::string &id) {
+        return append(Mutation::Erase, 0, id);
+    }
+
+    /** Position after the last record (= number of records) */
+    std::uint64_t end() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return offsets_.size();
+    }
+
+    /** Bytes of encoded records held */
+    std::size_t bytes() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return data_.size();
+    }
+
+    /**
+     * Copy encoded records starting at position from
+     *
+     * At least one record is copied if any exists at from, even if it is
+     * larger than maxBytes.
+     *
+     * @param from First position to copy
+     * @param maxRecords Upper bound on records copied
+     * @param maxBytes Soft upper bound on bytes copied
+     * @param out Receives the concatenated records (replaced)
+     * @return Number of records copied
+     */
+    std::size_t read(std::uint64_t from, std::size_t maxRecords, std::size_t maxBytes, std::string &out) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        out.clear();
+        if (from >= offsets_.size()) return 0;
+        std::uint64_t last = from;
+        std::size_t begin = offsets_[from];
+        while (last < offsets_.size() && last - from < maxRecords) {
+            std::size_t next = last + 1 < offsets_.size() ? offsets_[last + 1] : data_.size();
+            if (last > from && next - begin > maxBytes) break;
+            ++last;
+        }
+        std::size_t stop = last < offsets_.size() ? offsets_[last] : data_.size();
+        out.assign(data_, begin, stop - begin);
+        return static_cast<std::size_t>(last - from);
+    }
+
+    /**
+     * Wait until a record exists at position (i.e. end() > position)
+     *
+     * @param position Position waited for
+     * @param timeout Longest wait
+     * @return true if the record exists
+     */
+    template <typename Duration>
+    bool waitBeyond(std::uint64_t position, Duration timeout) const {
+        std::unique_lock<std::mutex> lock(mutex_);
+        return grew_.wait_for(lock, timeout, [&]() { return offsets_.size() > position; });
+    }
+
+    /**
+     * Decode the record at the start of [p, end)
+     *
+     * @param p Record start; advanced past the record on success
+     * @param end End of the buffer
+     * @param out Decoded mutation
+     * @return false if the record is truncated or malformed
+     */
+    static bool decode(const char *&p, const char *end, Mutation &out) {
+        if (static_cast<std::size_t>(end - p) < kRecordHeader) return false;
+        std::uint8_t op = static_cast<std::uint8_t>(p[0]);
+        std::uint32_t recordIndex = mapped::load32(p + 1);
+        std::uint32_t length = mapped::load32(p + 5);
+        const char *payload = p + kRecordHeader;
+        if (static_cast<std::size_t>(end - payload) < length) return false;
+        if (op == Mutation::Upsert) {
+            out.op = Mutation::Upsert;
+            if (!MappedCodec<Product>::decode(payload, length, out.product)) return false;
+            out.product.recordIndex = recordIndex;
+        } else if (op == Mutation::Erase) {
+            out.op = Mutation::Erase;
+            out.product = Product();
+            out.product.uniqId.assign(payload, length);
+        } else {
+            return false;
+        }
+        p = payload + length;
+        return true;
+    }
+
+private:
+    mutable std::mutex mutex_;
+    mutable std::condition_variable grew_;
+    std::string data_;                   // Encoded records, back to back
+    std::vector<std::size_t> offsets_;   // Start of each record in data_
+
+    std::uint64_t append(Mutation::Op op, std::uint32_t recordIndex, const std::string &payload) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        offsets_.push_back(data_.size());
+        data_.push_back(static_cast<char>(op));
+        mapped::put32(data_, recordIndex);
+        mapped::put32(data_, static_cast<std::uint32_t>(payload.size()));
+        data_.append(payload);
+        grew_.notify_all();
+        return offsets_.size() - 1;
+    }
+};
+
+} // namespace inv
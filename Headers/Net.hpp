@@ -0,0 +1,188 @@
+/**
+ * Net.hpp
+ *
+ * Small blocking socket helpers shared by the shard, replication and
+ * change-feed servers.
+ *
+ * Endpoints are "unix:<path>" (Unix domain socket) or "<host>:<port>" (TCP,
+ * IPv4; "localhost" means 127.0.0.1). Framed replies are the payload length
+ * in decimal, '\n', then exactly that many bytes (at most kMaxReplyBytes).
+ */
+
+#pragma once
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace inv {
+
+namespace net {
+
+/** Largest framed reply accepted; a longer length header fails the read */
+constexpr std::size_t kMaxReplyBytes = std::size_t(256) << 20;
+
+/**
+ * Parse an endpoint into a socket address
+ *
+ * @return false if the endpoint is malformed
+ */
+inline bool parseEndpoint(const std::string &endpoint, sockaddr_storage &addr, socklen_t &len) {
+    std::memset(&addr, 0, sizeof addr);
+    if (endpoint.compare(0, 5, "unix:") == 0) {
+        sockaddr_un *un = reinterpret_cast<sockaddr_un *>(&addr);
+        std::string path = endpoint.substr(5);
+        if (path.empty() || path.size() >= sizeof un->sun_path) return false;
+        un->sun_family = AF_UNIX;
+        std::memcpy(un->sun_path, path.c_str(), path.size() + 1);
+        len = static_cast<socklen_t>(offsetof(sockaddr_un, sun_path) + path.size() + 1);
+        return true;
+    }
+    auto colon = endpoint.rfind(':');
+    if (colon == std::string::npos) return false;
+    std::string host = endpoint.substr(0, colon);
+    if (host.empty() || host == "localhost") host = "127.0.0.1";
+    sockaddr_in *in = reinterpret_cast<sockaddr_in *>(&addr);
+    in->sin_family = AF_INET;
+    in->sin_port = htons(static_cast<std::uint16_t>(std::atoi(endpoint.c_str() + colon + 1)));
+    if (::inet_pton(AF_INET, host.c_str(), &in->sin_addr) != 1) return false;
+    len = sizeof(sockaddr_in);
+    return true;
+}
+
+/** Open a connection (-1 on failure) */
+inline int connectTo(const std::string &endpoint) {
+    sockaddr_storage addr;
+    socklen_t len;
+    if (!parseEndpoint(endpoint, addr, len)) return -1;
+    int fd = ::socket(addr.ss_family, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+    if (::connect(fd, reinterpret_cast<sockaddr *>(&addr), len) != 0) { ::close(fd); return -1; }
+    return fd;
+}
+
+/**
+ * Bind and listen on an endpoint (a stale Unix socket file is replaced)
+ *
+ * @param endpoint "unix:<path>" or "<host>:<port>" (port 0 = any free port)
+ * @param bound Receives the endpoint to connect to (actual port filled in)
+ * @param unixPath Receives the socket file to unlink later (or empty)
+ * @return Listening socket, or -1 if the endpoint cannot be bound
+ */
+inline int listenOn(const std::string &endpoint, std::string &bound, std::string &unixPath) {
+    sockaddr_storage addr;
+    socklen_t len;
+    if (!parseEndpoint(endpoint, addr, len)) return -1;
+    int fd = ::socket(addr.ss_family, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+    unixPath.clear();
+    if (addr.ss_family == AF_UNIX) {
+        unixPath = endpoint.substr(5);
+        ::unlink(unixPath.c_str());
+    } else {
+        int one = 1;
+        ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof one);
+    }
+    if (::bind(fd, reinterpret_cast<sockaddr *>(&addr), len) != 0 || ::listen(fd, 64) != 0) {
+        ::close(fd);
+        return -1;
+    }
+    bound = endpoint;
+    if (addr.ss_family == AF_INET) {
+        sockaddr_in in;
+        socklen_t inLen = sizeof in;
+        ::getsockname(fd, reinterpret_cast<sockaddr *>(&in), &inLen);
+        bound = endpoint.substr(0, endpoint.rfind(':') + 1) + std::to_string(ntohs(in.sin_port));
+    }
+    return fd;
+}
+
+/** Write every byte (no SIGPIPE if the peer went away) */
+inline bool sendAll(int fd, const char *data, std::size_t n) {
+    while (n > 0) {
+        ssize_t w = ::send(fd, data, n, MSG_NOSIGNAL);
+        if (w <= 0) return false;
+        data += w;
+        n -= static_cast<std::size_t>(w);
+    }
+    return true;
+}
+
+/**
+ * Buffered reads of lines and fixed-size blocks from a socket
+ */
+class Reader {
+public:
+    explicit Reader(int fd = -1) : fd_(fd) {}
+
+    /**
+     * Read up to '\n' (not included)
+     * @param maxBytes Fail if no '\n' arrives within this many bytes
+     * @return false on EOF, error or an overlong line
+     */
+    bool line(std::string &out, std::size_t maxBytes = std::string::npos) {
+        for (;;) {
+            auto nl = buf_.find('\n', pos_);
+            if (nl != std::string::npos) {
+                if (nl - pos_ > maxBytes) return false;
+                out.assign(buf_, pos_, nl - pos_);
+                pos_ = nl + 1;
+                return true;
+            }
+            if (buf_.size() - pos_ > maxBytes || !fill()) return false;
+        }
+    }
+
+    /** Read exactly n bytes; false on EOF or error */
+    bool exact(std::size_t n, std::string &out) {
+        while (buf_.size() - pos_ < n) if (!fill()) return false;
+        out.assign(buf_, pos_, n);
+        pos_ += n;
+        return true;
+    }
+
+private:
+    int fd_;
+    std::string buf_;
+    std::size_t pos_ {0};
+
+    bool fill() {
+        if (pos_ > 0) { buf_.erase(0, pos_); pos_ = 0; }
+        char chunk[64 * 1024];
+        ssize_t r = ::recv(fd_, chunk, sizeof chunk, 0);
+        if (r <= 0) return false;
+        buf_.append(chunk, static_cast<std::size_t>(r));
+        return true;
+    }
+};
+
+/** Send one framed reply */
+inline bool sendReply(int fd, const std::string &body) {
+    std::string head = std::to_string(body.size()) + "\n";
+    return sendAll(fd, head.data(), head.size()) && sendAll(fd, body.data(), body.size());
+}
+
+/**
+ * Receive one framed reply
+ * @return false on EOF, error, a malformed length or one over kMaxReplyBytes
+ */
+inline bool receiveReply(Reader &in, std::string &body) {
+    std::string head;
+    if (!in.line(head, 20) || head.empty() || head.find_first_not_of("0123456789") != std::string::npos) return false;
+    unsigned long long n = std::strtoull(head.c_str(), nullptr, 10);
+    if (n > kMaxReplyBytes) return false;
+    return in.exact(static_cast<std::size_t>(n), body);
+}
+
+} // namespace net
+
+} // namespace inv
@@ -18,6 +18,8 @@
  * - Header-only implementation for simplicity and inlining
  * - Robust error handling (missing columns default to empty strings)
  * - Category index built during load for O(1) category lookups
+ * - Optional lazy mode: cold fields (asin, model number, description) are
+ *   left in the mmapped source file and parsed on first use (ColdFieldStore)
  */
 
 #pragma once
@@ -29,7 +31,15 @@
 #include <cctype>
 #include <sstream>
 #include <set>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include "DescriptionStore.hpp"
 #include "HashTable.hpp"
+#include "MappedFile.hpp"
+#include "PerfCounters.hpp"
 
 namespace inv {
 
@@ -267,13 +277,18 @@ inline bool isBalancedQuotes(const std::string &s) {
  *   Line 2: multi-line field",field3
  *   → Returns: 'field1,"This is a\nmulti-line field",field3'
  * 
+ * The record text is byte-for-byte what the file holds between the record's
+ * start and its terminating newline, so `consumed` lets callers track each
+ * record's byte offset in the file.
+ * 
  * @param in Input stream to read from
  * @param record Output string to store complete record
+ * @param consumed Optional: bytes consumed from the stream (record + newlines)
  * @return true if record was read, false on EOF
  * 
  * Time Complexity: O(n) where n = total record length
  */
-inline bool readRecord(std::istream &in, std::string &record) {
+inline bool readRecord(std::istream &in, std::string &record, std::size_t *consumed = nullptr) {
     record.clear();
     std::string line; if (!std::getline(in, line)) return false;
     record = line;
@@ -282,6 +297,8 @@ inline bool readRecord(std::istream &in, std::string &record) {
         record.push_back('\n');
         record += extra;
     }
+    // getline() sets eof only when the last line had no terminating newline
+    if (consumed) *consumed = record.size() + (in.eof() ? 0 : 1);
     return true;
 }
 
@@ -307,24 +324,32 @@ inline bool readRecord(std::istream &in, std::string &record) {
  *   'a,b,"c,d",e' → ["a", "b", "c,d", "e"]
  *   '"He said ""Hi""","next"' → ['He said "Hi"', "next"]
  * 
+ * Column Mask:
+ * - If `keep` is given, columns with keep[i] == false are still counted but
+ *   left empty, so unused (or lazily loaded) columns cost a scan, not a copy
+ * - Columns beyond keep->size() are kept
+ * 
  * @param line Complete CSV record to parse
+ * @param keep Optional per-column mask of fields to materialize
  * @return Vector of field values (quotes and escapes removed)
  * 
  * Time Complexity: O(n) where n = record length
  */
-inline std::vector<std::string> parseCsvLine(const std::string &line) {
+inline std::vector<std::string> parseCsvLine(const std::string &line, const std::vector<bool> *keep = nullptr) {
     std::vector<std::string> result; std::string cur; bool inQuotes = false;
+    auto kept = [&]() { return !keep || result.size() >= keep->size() || (*keep)[result.size()]; };
+    bool store = kept();
     for (size_t i = 0; i < line.size(); ++i) {
         char c = line[i];
         if (inQuotes) {
             if (c == '"') {
-                if (i + 1 < line.size() && line[i+1] == '"') { cur.push_back('"'); ++i; }
+                if (i + 1 < line.size() && line[i+1] == '"') { if (store) cur.push_back('"'); ++i; }
                 else { inQuotes = false; }
-            } else { cur.push_back(c); }
+            } else if (store) { cur.push_back(c); }
         } else {
             if (c == '"') inQuotes = true;
-            else if (c == ',') { result.push_back(cur); cur.clear(); }
-            else cur.push_back(c);
+            else if (c == ',') { result.push_back(cur); cur.clear(); store = kept(); }
+            else if (store) cur.push_back(c);
         }
     }
     result.push_back(cur);
@@ -343,6 +368,7 @@ inline std::vector<std::string> parseCsvLine(const std::string &line) {
  */
 struct HeaderMap {
     std::unordered_map<std::string, size_t> idx;
+    size_t width {0};  // Number of columns in the header
     
     /**
      * Get column index by name
@@ -369,6 +395,7 @@ struct HeaderMap {
 inline HeaderMap buildHeader(const std::string &headerLine) {
     HeaderMap h;
     auto cols = parseCsvLine(headerLine);
+    h.width = cols.size();
     for (size_t i = 0; i < cols.size(); ++i) {
         h.idx[trim(cols[i])] = i;
     }
@@ -393,6 +420,535 @@ inline std::string safeGet(const std::vector<std::string> &row, size_t idx) { re
 
 } // namespace detail
 
+/**
+ * ColdFields - Rarely used Product fields, parsed on demand by ColdFieldStore
+ */
+struct ColdFields {
+    std::string asin;
+    std::string modelNumber;
+    std::string productDescription;  // Falls back to "About Product" like loadCsv
+};
+
+/**
+ * ColdFieldStore - Lazily parsed cold fields, located by byte offset in the source CSV
+ * 
+ * Most products are never printed individually, yet their description is
+ * the bulk of each record. In lazy mode loadCsv() does not materialize
+ * `asin`, `modelNumber` or `productDescription`; it records each record's
+ * byte offset and length in the source file instead and stores the handle
+ * in Product::sourceRef. The source file is mmapped (MappedFile), so only the
+ * pages of records that are actually viewed are ever read back in.
+ * 
+ * fill() re-parses a record from the mapping and keeps the result in a
+ * cache bounded by a byte budget (kDefaultCacheBytes, see setCacheBudget())
+ * with CLOCK eviction, so products viewed repeatedly are parsed once while
+ * the cache never grows toward an eager copy of the catalog. Whole-catalog
+ * passes (saving, publishing, logging, pre-rendering) use parse() or
+ * fill(p, false), which bypass the cache; the owner calls forget() when a
+ * product is erased or replaced.
+ * 
+ * Requirements: the source file must stay unchanged while the store exists.
+ * 
+ * Thread Safety: fill()/get()/parse()/forget() may run concurrently (the
+ * cache is guarded by a mutex); addFile()/addRecord()/adopt() must not run
+ * concurrently with anything.
+ */
+class ColdFieldStore {
+public:
+    /** Handle of "no source record" (Product::sourceRef default) */
+    static constexpr std::uint32_t kNone = 0xFFFFFFFFu;
+
+    /** Default byte budget of the parsed-field cache */
+    static constexpr std::size_t kDefaultCacheBytes = 4 * 1024 * 1024;
+
+    /** Bytes charged per cached entry on top of its fields (slot, map node, string headers) */
+    static constexpr std::size_t kEntryOverhead = 160;
+
+    /**
+     * Map a source file and remember where its cold columns are
+     * 
+     * @param path CSV file being loaded
+     * @param H Header of that file
+     * @return File id for addRecord(), or -1 if the file could not be mapped
+     */
+    int addFile(const std::string &path, const detail::HeaderMap &H) {
+        std::unique_ptr<SourceFile> f(new SourceFile());
+        if (!f->map.open(path)) return -1;
+        f->asin = H.get("Asin");
+        f->modelNumber = H.get("Model Number");
+        f->description = H.get("Product Description");
+        f->about = H.get("About Product");
+        f->keep.assign(H.width, false);
+        for (size_t c : {f->asin, f->modelNumber, f->description, f->about}) {
+            if (c < f->keep.size()) f->keep[c] = true;
+        }
+        files_.push_back(std::move(f));
+        return static_cast<int>(files_.size() - 1);
+    }
+
+    /**
+     * Record where a product's record lives in a source file
+     * 
+     * @param file Id returned by addFile()
+     * @param offset Byte offset of the record in the file
+     * @param length Record length in bytes (without the final newline)
+     * @return Handle to store in Product::sourceRef
+     */
+    std::uint32_t addRecord(int file, std::uint64_t offset, std::uint32_t length) {
+        if (records_.size() >= kNone) throw std::length_error("ColdFieldStore: too many records");
+        records_.push_back(Record{offset, length, static_cast<std::uint32_t>(file)});
+        return static_cast<std::uint32_t>(records_.size() - 1);
+    }
+
+    /**
+     * Parse a record's cold fields from the mapping, bypassing the cache
+     * (for one-off passes over the whole catalog, which would otherwise
+     * fill the cache with every record)
+     * 
+     * @param ref Handle returned by addRecord()
+     * @return Parsed fields (empty for kNone or an unknown handle)
+     * 
+     * Time Complexity: O(record length)
+     */
+    ColdFields parse(std::uint32_t ref) const {
+        ColdFields c;
+        if (ref >= records_.size()) return c;
+        const Record &r = records_[ref];
+        const SourceFile &f = *files_[r.file];
+        if (r.offset + r.length <= f.map.size()) {
+            std::string rec(f.map.data() + r.offset, r.length);
+            auto cols = detail::parseCsvLine(rec, &f.keep);
+            c.asin = detail::sanitize(detail::safeGet(cols, f.asin));
+            c.modelNumber = detail::sanitize(detail::safeGet(cols, f.modelNumber));
+            c.productDescription = detail::sanitize(detail::safeGet(cols, f.description));
+            if (c.productDescription.empty()) c.productDescription = detail::sanitize(detail::safeGet(cols, f.about));
+        }
+        return c;
+    }
+
+    /**
+     * Cold fields of a record, through the cache
+     * 
+     * @param ref Handle returned by addRecord()
+     * @return Parsed fields (empty for kNone or an unknown handle)
+     * 
+     * Time Complexity: O(1) average on a hit, O(record length) on a miss
+     */
+    ColdFields get(std::uint32_t ref) const {
+        if (ref >= records_.size()) return ColdFields();
+        {
+            std::lock_guard<std::mutex> lock(cacheMutex_);
+            auto it = cacheIndex_.find(ref);
+            if (it != cacheIndex_.end()) {
+                CacheSlot &slot = cache_[it->second];
+                slot.referenced = true;
+                return slot.fields;
+            }
+        }
+        ColdFields c = parse(ref);
+        std::size_t charge = kEntryOverhead + c.asin.size() + c.modelNumber.size() + c.productDescription.size();
+        std::lock_guard<std::mutex> lock(cacheMutex_);
+        if (charge > cacheBudget_ || cacheIndex_.count(ref)) return c;  // Too big, or cached by a concurrent miss
+        while (cacheBytes_ + charge > cacheBudget_) evictOne();
+        std::uint32_t index;
+        if (!freeSlots_.empty()) {
+            index = freeSlots_.back();
+            freeSlots_.pop_back();
+        } else {
+            index = static_cast<std::uint32_t>(cache_.size());
+            cache_.emplace_back();
+        }
+        CacheSlot &slot = cache_[index];
+        slot.ref = ref;
+        slot.bytes = charge;
+        slot.referenced = false;  // Must be hit once to survive the next sweep
+        slot.fields = c;
+        cacheIndex_.emplace(ref, index);
+        cacheBytes_ += charge;
+        return c;
+    }
+
+    /**
+     * Fill in a product's cold fields if they were deferred
+     * @param p Product (unchanged if p.sourceRef is kNone)
+     * @param cached false to parse without touching the cache (see parse())
+     */
+    void fill(Product &p, bool cached = true) const {
+        if (p.sourceRef == kNone) return;
+        ColdFields c = cached ? get(p.sourceRef) : parse(p.sourceRef);
+        p.asin = std::move(c.asin);
+        p.modelNumber = std::move(c.modelNumber);
+        p.productDescription = std::move(c.productDescription);
+    }
+
+    /**
+     * Drop a record's cached fields (its product was erased or replaced)
+     * @param ref Handle returned by addRecord() (kNone is ignored)
+     */
+    void forget(std::uint32_t ref) {
+        std::lock_guard<std::mutex> lock(cacheMutex_);
+        auto it = cacheIndex_.find(ref);
+        if (it != cacheIndex_.end()) release(it->second);
+    }
+
+    /**
+     * Set the cache's byte budget, evicting down to it (0 disables caching)
+     * @param bytes Budget for parsed fields plus kEntryOverhead per entry
+     */
+    void setCacheBudget(std::size_t bytes) {
+        std::lock_guard<std::mutex> lock(cacheMutex_);
+        cacheBudget_ = bytes;
+        while (cacheBytes_ > cacheBudget_) evictOne();
+    }
+
+    /** The cache's byte budget */
+    std::size_t cacheBudget() const { std::lock_guard<std::mutex> lock(cacheMutex_); return cacheBudget_; }
+
+    /** Bytes charged to the cache (fields plus kEntryOverhead per entry) */
+    std::size_t cacheBytes() const { std::lock_guard<std::mutex> lock(cacheMutex_); return cacheBytes_; }
+
+    /** Number of deferred records */
+    std::size_t size() const { return records_.size(); }
+
+    /** Bytes of the record location table */
+    std::size_t recordBytes() const { return records_.capacity() * sizeof(Record); }
+
+    /** Bytes of source files mapped (file-backed, paged in on demand) */
+    std::size_t mappedBytes() const {
+        std::size_t n = 0;
+        for (const auto &f : files_) n += f->map.mapped() ? f->map.size() : 0;
+        return n;
+    }
+
+    /** Heap bytes of source files read into memory because mmap was unavailable */
+    std::size_t fileHeapBytes() const {
+        std::size_t n = 0;
+        for (const auto &f : files_) n += f->map.heapBytes();
+        return n;
+    }
+
+    /** Release unused capacity of the record table (call once loading is done) */
+    void shrink() { records_.shrink_to_fit(); }
+
+    /**
+     * Take over another store's source files and records (a file loaded
+     * on the side), keeping this store's handles valid
+     * 
+     * @param other Store whose handles nothing will resolve through any
+     *              more (left without files or records)
+     * @return Offset to add to other's handles to get handles into this store
+     * 
+     * Time Complexity: O(records of other)
+     */
+    std::uint32_t adopt(ColdFieldStore &other) {
+        if (records_.size() + other.records_.size() >= kNone) throw std::length_error("ColdFieldStore: too many records");
+        const std::uint32_t base = static_cast<std::uint32_t>(records_.size());
+        const std::uint32_t fileBase = static_cast<std::uint32_t>(files_.size());
+        for (auto &f : other.files_) files_.push_back(std::move(f));
+        records_.reserve(records_.size() + other.records_.size());
+        for (Record r : other.records_) {
+            r.file += fileBase;
+            records_.push_back(r);
+        }
+        other.files_.clear();
+        other.records_.clear();
+        return base;
+    }
+
+    /** Visit every cached entry's fields (for memory accounting); the cache stays locked meanwhile */
+    template <typename F>
+    void forEachCached(F f) const {
+        std::lock_guard<std::mutex> lock(cacheMutex_);
+        for (const auto &slot : cache_) if (slot.ref != kNone) f(slot.fields);
+    }
+
+    /** Buckets of the cache's ref -> slot map (for memory accounting) */
+    std::size_t cacheBucketCount() const { std::lock_guard<std::mutex> lock(cacheMutex_); return cacheIndex_.bucket_count(); }
+
+    /** Bytes of the cache's slot and free-list buffers (for memory accounting) */
+    std::size_t cacheSlotBytes() const {
+        std::lock_guard<std::mutex> lock(cacheMutex_);
+        return cache_.capacity() * sizeof(CacheSlot) + freeSlots_.capacity() * sizeof(std::uint32_t);
+    }
+
+private:
+    struct SourceFile {
+        MappedFile map;
+        std::size_t asin, modelNumber, description, about;  // Column indices (-1 if missing)
+        std::vector<bool> keep;                               // Columns to materialize when re-parsing
+    };
+
+    struct Record {
+        std::uint64_t offset;
+        std::uint32_t length;
+        std::uint32_t file;
+    };
+
+    struct CacheSlot {
+        std::uint32_t ref {kNone};  // kNone = free
+        bool referenced {false};    // CLOCK reference bit
+        std::size_t bytes {0};      // Charged bytes
+        ColdFields fields;
+    };
+
+    std::vector<std::unique_ptr<SourceFile>> files_;
+    std::vector<Record> records_;
+    mutable std::mutex cacheMutex_;
+    mutable std::unordered_map<std::uint32_t, std::uint32_t> cacheIndex_;  // ref -> slot in cache_
+    mutable std::vector<CacheSlot> cache_;
+    mutable std::vector<std::uint32_t> freeSlots_;
+    mutable std::size_t cacheHand_ {0};
+    mutable std::size_t cacheBytes_ {0};
+    std::size_t cacheBudget_ {kDefaultCacheBytes};
+
+    /** Empty a slot (cacheMutex_ held) */
+    void release(std::uint32_t index) const {
+        CacheSlot &slot = cache_[index];
+        cacheIndex_.erase(slot.ref);
+        cacheBytes_ -= slot.bytes;
+        slot = CacheSlot();
+        freeSlots_.push_back(index);
+    }
+
+    /** Advance the CLOCK hand and evict one entry (cacheMutex_ held, cache not empty) */
+    void evictOne() const {
+        for (;;) {
+            if (cacheHand_ >= cache_.size()) cacheHand_ = 0;
+            CacheSlot &slot = cache_[cacheHand_++];
+            if (slot.ref == kNone) continue;
+            if (slot.referenced) { slot.referenced = false; continue; }
+            release(static_cast<std::uint32_t>(cacheHand_ - 1));
+            return;
+        }
+    }
+};
+
+namespace detail {
+
+/**
+ * loadedColumns - Column mask of the fields the loaders read
+ *
+ * @param H Header of the file
+ * @param cold true if asin, model number and description stay in the file
+ * @return keep mask for parseCsvLine()
+ */
+inline std::vector<bool> loadedColumns(const HeaderMap &H, bool cold) {
+    std::vector<bool> keep(H.width, false);
+    for (const char *col : {"Uniq Id", "Product Name", "Brand Name", "Category", "List Price",
+                            "Selling Price", "Quantity", "Stock"}) {
+        if (H.get(col) < keep.size()) keep[H.get(col)] = true;
+    }
+    if (!cold) {
+        for (const char *col : {"Asin", "Model Number", "Product Description", "About Product"}) {
+            if (H.get(col) < keep.size()) keep[H.get(col)] = true;
+        }
+    }
+    return keep;
+}
+
+/**
+ * fillProduct - Sanitize a parsed record's fields into a Product
+ *
+ * Sets every field except uniqId (which the loaders check first),
+ * recordIndex and the store handles.
+ *
+ * @param cols Fields from parseCsvLine()
+ * @param H Header of the file
+ * @param cold true to leave asin, model number and description empty
+ * @param p Product to fill
+ */
+inline void fillProduct(const std::vector<std::string> &cols, const HeaderMap &H, bool cold, Product &p) {
+    p.productName = sanitize(safeGet(cols, H.get("Product Name")));
+    p.brandName = sanitize(safeGet(cols, H.get("Brand Name")));
+
+    // Multi-category handling
+    {
+        std::string rawCat = sanitize(safeGet(cols, H.get("Category")));
+        p.categories = extractCategories(rawCat);
+        p.category = joinCategories(p.categories); // for display
+    }
+
+    // Pricing and inventory
+    p.listPrice = cleanPrice(safeGet(cols, H.get("List Price")));
+    p.sellingPrice = cleanPrice(safeGet(cols, H.get("Selling Price")));
+    p.quantity = sanitize(safeGet(cols, H.get("Quantity")));
+
+    // Optional fields (cold: deferred to the source file in lazy mode)
+    if (!cold) {
+        p.asin = sanitize(safeGet(cols, H.get("Asin")));
+        p.modelNumber = sanitize(safeGet(cols, H.get("Model Number")));
+        p.productDescription = sanitize(safeGet(cols, H.get("Product Description")));
+        if (p.productDescription.empty()) p.productDescription = sanitize(safeGet(cols, H.get("About Product")));
+    }
+    p.stock = sanitize(safeGet(cols, H.get("Stock")));
+}
+
+} // namespace detail
+
+struct LoadPipelineStats;
+
+/**
+ * LoadStats - Per-phase timing collected by loadCsv
+ * 
+ * Pass a LoadStats to loadCsv() to have it time each phase of ingestion.
+ * Phases are timed per record with a steady clock, so collecting stats adds
+ * a small constant overhead per record; pass nullptr (the default) to skip it.
+ * 
+ * Phases:
+ * - read:    readRecord() - pulling a complete (possibly multi-line) record from the stream
+ * - parse:   parseCsvLine() - splitting the record into fields
+ * - build:   sanitizing fields and filling in the Product
+ * - insert:  table.insert()
+ * - index:   category index updates
+ * 
+ * Hardware counters: set `perf` to a PerfCounters opened on the loading
+ * thread to also collect cycles/instructions/cache misses/branch misses per
+ * phase. This costs one read(2) per phase per record, so use it for
+ * diagnosis rather than for wall-clock numbers.
+ * 
+ * Pipelined loads (loadCsvPipelined, LoadPipeline.hpp) run the phases on
+ * separate threads; they report each stage's busy time (parse includes
+ * build), and per-stage details through `pipeline` if it is set.
+ */
+struct LoadStats {
+    std::size_t records {0};   // Records read (including skipped ones)
+    std::size_t products {0};  // Products inserted or updated
+    std::size_t bytes {0};     // Bytes of record text read (excluding line terminators)
+    double readSec {0.0};
+    double parseSec {0.0};
+    double buildSec {0.0};
+    double insertSec {0.0};
+    double indexSec {0.0};
+    double totalSec {0.0};     // Wall-clock time of the whole loadCsv call
+
+    PerfCounters *perf {nullptr}; // Optional: counters to sample at each phase boundary
+    PerfSample readPerf, parsePerf, buildPerf, insertPerf, indexPerf;
+
+    LoadPipelineStats *pipeline {nullptr}; // Optional: per-stage report of a pipelined load
+};
+
+/**
+ * ShardFilter - Which products a partitioned (sharded) load keeps
+ * 
+ * Products are assigned to shards by a hash of their Uniq Id that is fixed
+ * here (not std::hash), so shard processes and the coordinator agree even
+ * when built separately. Pass one to loadCsv() to keep only the products
+ * of shard `index` out of `count`.
+ */
+struct ShardFilter {
+    std::size_t index {0};  // This shard (0 <= index < count)
+    std::size_t count {1};  // Number of shards
+
+    /**
+     * Shard owning a Uniq Id
+     * FNV-1a plus a splitmix64 finalizer; the high 32 bits are scaled to
+     * [0, count) by multiply-shift.
+     */
+    static std::size_t shardOf(const std::string &id, std::size_t count) {
+        std::uint64_t h = 0xcbf29ce484222325ULL;
+        for (unsigned char c : id) { h ^= c; h *= 0x100000001b3ULL; }
+        h ^= h >> 30; h *= 0xbf58476d1ce4e5b9ULL;
+        h ^= h >> 27; h *= 0x94d049bb133111ebULL;
+        h ^= h >> 31;
+        return static_cast<std::size_t>(((h >> 32) * static_cast<std::uint64_t>(count)) >> 32);
+    }
+
+    /** true if this shard stores the product with this Uniq Id */
+    bool owns(const std::string &id) const { return count <= 1 || shardOf(id, count) == index; }
+};
+
+namespace detail {
+
+/**
+ * loadCsvFrom - loadCsv() on an open stream
+ *
+ * @param in Stream positioned at the header line
+ * @param path File behind `in`, or nullptr for a pipe (lazy cold fields
+ *             need a file to point into, so they are loaded eagerly then)
+ */
+template <typename Alloc, typename Policy>
+inline bool loadCsvFrom(std::istream &in, const std::string *path, HashTable<Product, Alloc, Policy> &table, std::unordered_map<std::string, std::vector<std::string>> &categoryIndex, LoadStats *stats, DescriptionStore *descriptions, ColdFieldStore *coldFields, const ShardFilter *shard) {
+    using Clock = std::chrono::steady_clock;
+    const auto loadStart = Clock::now();
+    auto mark = loadStart;
+    PerfSample perfMark;
+    // Adds the time (and counters) since the previous mark to `phase` (no-op without stats)
+    auto lap = [&](double LoadStats::*phase, PerfSample LoadStats::*perfPhase) {
+        if (!stats) return;
+        auto now = Clock::now();
+        stats->*phase += std::chrono::duration<double>(now - mark).count();
+        mark = now;
+        if (stats->perf) {
+            PerfSample cur = stats->perf->read();
+            stats->*perfPhase += cur - perfMark;
+            perfMark = cur;
+        }
+    };
+
+    std::string headerLine; if (!std::getline(in, headerLine)) return false;
+    auto H = detail::buildHeader(headerLine);
+    std::uint64_t offset = headerLine.size() + (in.eof() ? 0 : 1);  // Byte offset of the next record
+
+    // Lazy mode: cold columns stay in the (mapped) file
+    int coldFile = coldFields && path ? coldFields->addFile(*path, H) : -1;
+
+    // Only materialize the columns read below
+    std::vector<bool> keep = detail::loadedColumns(H, coldFile >= 0);
+
+    size_t count = 0;
+    std::uint32_t recordNo = 0;
+    std::string rec;
+    std::size_t consumed = 0;
+    if (stats) {
+        mark = Clock::now();
+        if (stats->perf) perfMark = stats->perf->read();
+    }
+    while (detail::readRecord(in, rec, &consumed)) {
+        const std::uint64_t recOffset = offset;
+        offset += consumed;
+        lap(&LoadStats::readSec, &LoadStats::readPerf);
+        if (stats) { ++stats->records; stats->bytes += rec.size(); }
+        if (rec.empty()) continue;
+        const std::uint32_t recordIndex = recordNo++;
+        auto cols = detail::parseCsvLine(rec, &keep);
+        lap(&LoadStats::parseSec, &LoadStats::parsePerf);
+        Product p;
+        
+        // Required fields
+        p.uniqId = detail::sanitize(detail::safeGet(cols, H.get("Uniq Id")));
+        if (p.uniqId.empty() || (shard && !shard->owns(p.uniqId))) { lap(&LoadStats::buildSec, &LoadStats::buildPerf); continue; } // Skip records without primary key or owned by another shard
+        p.recordIndex = recordIndex;
+        detail::fillProduct(cols, H, coldFile >= 0, p);
+        if (coldFile >= 0) {
+            p.sourceRef = coldFields->addRecord(coldFile, recOffset, static_cast<std::uint32_t>(rec.size()));
+        } else if (descriptions) {
+            p.descriptionRef = descriptions->add(p.productDescription);
+            std::string().swap(p.productDescription);
+        }
+        lap(&LoadStats::buildSec, &LoadStats::buildPerf);
+
+        // Insert into hash table, moving the record in (no deep copy)
+        std::string key = p.uniqId;
+        const Product *stored = table.emplace(std::move(key), std::move(p)).first;
+        lap(&LoadStats::insertSec, &LoadStats::insertPerf);
+        
+        // Build category index for efficient category searches
+        for (const auto &cat : stored->categories) {
+            categoryIndex[cat].push_back(stored->uniqId);
+        }
+        lap(&LoadStats::indexSec, &LoadStats::indexPerf);
+        ++count;
+    }
+    if (coldFile >= 0) coldFields->shrink();
+    if (stats) {
+        stats->products += count;
+        stats->totalSec += std::chrono::duration<double>(Clock::now() - loadStart).count();
+    }
+    return true;
+}
+
+} // namespace detail
+
 /**
  * loadCsv - Load products from CSV file into hash table
  * 
@@ -408,9 +964,10 @@ inline std::string safeGet(const std::vector<std::string> &row, size_t idx) { re
  *    b. Parse into fields
  *    c. Extract and sanitize all product fields
  *    d. Handle multi-category extraction (pipe-delimited)
- *    e. Insert into hash table with uniqId as key
+ *    e. Move the Product into the hash table with uniqId as key
  *    f. Add to category index for each category
- * 4. Skip records with empty/missing uniqId
+ * 4. Skip records with empty/missing uniqId (and, with `shard`, records
+ *    owned by other shards)
  * 
  * Field Mapping:
  * - Required: Uniq Id (key), Product Name, Brand Name, Category
@@ -423,6 +980,10 @@ inline std::string safeGet(const std::vector<std::string> &row, size_t idx) { re
  * - Price fields: cleanPrice() - removes spaces, preserves currency
  * - Category field: extractCategories() - splits on '|', deduplicates
  * - Missing columns: safeGet() returns empty string (graceful degradation)
+ * - Descriptions: moved into `descriptions` (if given) and replaced by a handle
+ * - Cold fields: with `coldFields`, asin/model number/description are not
+ *   parsed at all; the record's byte range is stored in Product::sourceRef
+ * - Columns the loader never reads are skipped by parseCsvLine() (column mask)
  * 
  * Category Index:
  * - Maps category name → list of product IDs
@@ -437,59 +998,41 @@ inline std::string safeGet(const std::vector<std::string> &row, size_t idx) { re
  * @param path Path to CSV file
  * @param table Hash table to populate with products
  * @param categoryIndex Category index to build (category → product IDs)
+ * @param stats Optional per-phase timing output (nullptr to disable)
+ * @param descriptions Optional compressed description store; the caller
+ *                     seals it once loading is done. Descriptions of updated
+ *                     (duplicate-id) records stay in the store unreferenced.
+ * @param coldFields Optional lazy cold-field store; takes precedence over
+ *                   `descriptions`. If the file cannot be mapped, the
+ *                   fields are loaded eagerly as usual.
+ * @param shard Optional partition filter; records whose Uniq Id belongs to
+ *              another shard are skipped right after the id is parsed
  * @return true if file loaded successfully, false on file open error
  * 
  * Time Complexity: O(n*m) where n = number of records, m = avg record size
  * Space Complexity: O(n*k) where k = avg categories per product
  */
-inline bool loadCsv(const std::string &path, HashTable<Product> &table, std::unordered_map<std::string, std::vector<std::string>> &categoryIndex) {
+template <typename Alloc, typename Policy>
+inline bool loadCsv(const std::string &path, HashTable<Product, Alloc, Policy> &table, std::unordered_map<std::string, std::vector<std::string>> &categoryIndex, LoadStats *stats = nullptr, DescriptionStore *descriptions = nullptr, ColdFieldStore *coldFields = nullptr, const ShardFilter *shard = nullptr) {
     std::ifstream in(path);
     if (!in.is_open()) return false;
-    std::string headerLine; if (!std::getline(in, headerLine)) return false;
-    auto H = detail::buildHeader(headerLine);
+    return detail::loadCsvFrom(in, &path, table, categoryIndex, stats, descriptions, coldFields, shard);
+}
 
-    size_t count = 0;
-    std::string rec;
-    while (detail::readRecord(in, rec)) {
-        if (rec.empty()) continue;
-        auto cols = detail::parseCsvLine(rec);
-        Product p;
-        
-        // Required fields
-        p.uniqId = detail::sanitize(detail::safeGet(cols, H.get("Uniq Id")));
-        if (p.uniqId.empty()) continue; // Skip records without primary key
-        p.productName = detail::sanitize(detail::safeGet(cols, H.get("Product Name")));
-        p.brandName = detail::sanitize(detail::safeGet(cols, H.get("Brand Name")));
-        
-        // Multi-category handling
-        {
-            std::string rawCat = detail::sanitize(detail::safeGet(cols, H.get("Category")));
-            p.categories = detail::extractCategories(rawCat);
-            p.category = detail::joinCategories(p.categories); // for display
-        }
-        
-        // Pricing and inventory
-        p.listPrice = detail::cleanPrice(detail::safeGet(cols, H.get("List Price")));
-        p.sellingPrice = detail::cleanPrice(detail::safeGet(cols, H.get("Selling Price")));
-        p.quantity = detail::sanitize(detail::safeGet(cols, H.get("Quantity")));
-        
-        // Optional fields
-        p.asin = detail::sanitize(detail::safeGet(cols, H.get("Asin")));
-        p.modelNumber = detail::sanitize(detail::safeGet(cols, H.get("Model Number")));
-        p.productDescription = detail::sanitize(detail::safeGet(cols, H.get("Product Description")));
-        if (p.productDescription.empty()) p.productDescription = detail::sanitize(detail::safeGet(cols, H.get("About Product")));
-        p.stock = detail::sanitize(detail::safeGet(cols, H.get("Stock")));
-
-        // Insert into hash table
-        table.insert(p.uniqId, p);
-        
-        // Build category index for efficient category searches
-        for (const auto &cat : p.categories) {
-            categoryIndex[cat].push_back(p.uniqId);
-        }
-        ++count;
-    }
-    return true;
+/**
+ * loadCsv - Load products from a CSV stream (a pipe, decompressed input)
+ *
+ * Same as loadCsv(path, ...) except that there are no lazy cold fields,
+ * which need a file to point into.
+ *
+ * @param in Stream positioned at the header line
+ * @return false if the stream has no header line
+ *
+ * Time Complexity: O(n*m) where n = number of records, m = avg record size
+ */
+template <typename Alloc, typename Policy>
+inline bool loadCsv(std::istream &in, HashTable<Product, Alloc, Policy> &table, std::unordered_map<std::string, std::vector<std::string>> &categoryIndex, LoadStats *stats = nullptr, DescriptionStore *descriptions = nullptr, const ShardFilter *shard = nullptr) {
+    return detail::loadCsvFrom(in, nullptr, table, categoryIndex, stats, descriptions, nullptr, shard);
 }
 
 } // namespace inv
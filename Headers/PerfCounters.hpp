@@ -0,0 +1,192 @@
+/**
+ * PerfCounters.hpp
+ *
+ * Optional hardware performance counters for hot-path instrumentation.
+ *
+ * Wraps Linux perf_event_open(2) to count, for the calling thread:
+ * - CPU cycles
+ * - retired instructions
+ * - last-level cache misses
+ * - branch misses
+ *
+ * The four counters are opened as one group so they are scheduled together
+ * and read with a single read(2). Values are scaled when the kernel had to
+ * multiplex the group. Only user-space events are counted, which works with
+ * the default perf_event_paranoid setting.
+ *
+ * Counters are optional: on non-Linux builds, in containers without
+ * perf_event access, or on CPUs/VMs without a PMU, available() returns false,
+ * every read returns an empty sample, and callers simply report nothing.
+ *
+ * Usage:
+ *   inv::PerfCounters pc;                 // opens counters for this thread
+ *   inv::PerfSample before = pc.read();
+ *   ... hot code ...
+ *   inv::PerfSample delta = pc.read() - before;
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <string>
+
+#if defined(__linux__)
+#include <cerrno>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace inv {
+
+/**
+ * PerfSample - Counter values (absolute or a delta between two reads)
+ */
+struct PerfSample {
+    std::uint64_t cycles {0};
+    std::uint64_t instructions {0};
+    std::uint64_t cacheMisses {0};
+    std::uint64_t branchMisses {0};
+    bool valid {false};  // false when counters were unavailable
+
+    /** Instructions per cycle (0 if no cycles were counted) */
+    double ipc() const { return cycles ? static_cast<double>(instructions) / static_cast<double>(cycles) : 0.0; }
+
+    PerfSample &operator+=(const PerfSample &o) {
+        cycles += o.cycles; instructions += o.instructions;
+        cacheMisses += o.cacheMisses; branchMisses += o.branchMisses;
+        valid = valid || o.valid;
+        return *this;
+    }
+
+    friend PerfSample operator-(const PerfSample &a, const PerfSample &b) {
+        PerfSample d;
+        d.valid = a.valid && b.valid;
+        if (!d.valid) return d;
+        d.cycles = a.cycles - b.cycles; d.instructions = a.instructions - b.instructions;
+        d.cacheMisses = a.cacheMisses - b.cacheMisses; d.branchMisses = a.branchMisses - b.branchMisses;
+        return d;
+    }
+};
+
+/**
+ * Print a sample as "cycles ..., instr ..., IPC ..., cache-miss ..., branch-miss ..."
+ * Values are divided by `per` (e.g. the number of operations) when non-zero.
+ *
+ * @param out Stream to write to
+ * @param s Sample to print
+ * @param per Divisor for per-operation figures (0 or 1 for totals)
+ */
+inline void printPerf(std::ostream &out, const PerfSample &s, std::uint64_t per = 0) {
+    if (!s.valid) { out << "perf n/a"; return; }
+    double d = per > 1 ? static_cast<double>(per) : 1.0;
+    auto flags = out.flags();
+    auto prec = out.precision();
+    out.setf(std::ios::fixed, std::ios::floatfield);
+    out.precision(per > 1 ? 1 : 0);
+    out << "cycles " << static_cast<double>(s.cycles) / d
+        << ", instr " << static_cast<double>(s.instructions) / d;
+    out.precision(2);
+    out << ", IPC " << s.ipc();
+    out.precision(per > 1 ? 2 : 0);
+    out << ", cache-miss " << static_cast<double>(s.cacheMisses) / d
+        << ", branch-miss " << static_cast<double>(s.branchMisses) / d;
+    out.flags(flags);
+    out.precision(prec);
+}
+
+/**
+ * PerfCounters - A group of hardware counters for the calling thread
+ *
+ * Not copyable. Counters measure the thread that constructed the object, so
+ * create one per thread (e.g. thread_local) when instrumenting several threads.
+ */
+class PerfCounters {
+public:
+    PerfCounters() { open(); }
+    ~PerfCounters() { close(); }
+    PerfCounters(const PerfCounters &) = delete;
+    PerfCounters &operator=(const PerfCounters &) = delete;
+
+    /** true if the counter group was opened successfully */
+    bool available() const { return fds_[0] >= 0; }
+
+    /** Reason the counters are unavailable (empty when available) */
+    const std::string &error() const { return error_; }
+
+    /**
+     * Read the current (cumulative) counter values
+     * @return Sample with valid == false if counters are unavailable
+     */
+    PerfSample read() const {
+        PerfSample s;
+#if defined(__linux__)
+        if (!available()) return s;
+        // PERF_FORMAT_GROUP layout: nr, time_enabled, time_running, values[nr]
+        std::uint64_t buf[3 + kEvents];
+        ssize_t n = ::read(fds_[0], buf, sizeof(buf));
+        if (n != static_cast<ssize_t>(sizeof(buf)) || buf[0] != kEvents) return s;  // Short read: values missing
+        double scale = (buf[2] > 0 && buf[2] < buf[1]) ? static_cast<double>(buf[1]) / static_cast<double>(buf[2]) : 1.0;
+        auto v = [&](int i) { return static_cast<std::uint64_t>(static_cast<double>(buf[3 + i]) * scale); };
+        s.cycles = v(0); s.instructions = v(1); s.cacheMisses = v(2); s.branchMisses = v(3);
+        s.valid = true;
+#endif
+        return s;
+    }
+
+private:
+    static constexpr int kEvents = 4;
+    int fds_[kEvents] {-1, -1, -1, -1};
+    std::string error_;
+
+    /**
+     * Open the counter group (cycles is the group leader)
+     * On any failure all counters are closed and error_ records why.
+     */
+    void open() {
+#if defined(__linux__)
+        const std::uint64_t configs[kEvents] = {
+            PERF_COUNT_HW_CPU_CYCLES,
+            PERF_COUNT_HW_INSTRUCTIONS,
+            PERF_COUNT_HW_CACHE_MISSES,
+            PERF_COUNT_HW_BRANCH_MISSES,
+        };
+        for (int i = 0; i < kEvents; ++i) {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = configs[i];
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            attr.disabled = (i == 0) ? 1 : 0; // leader starts disabled; enabled once the group is complete
+            int fd = static_cast<int>(::syscall(__NR_perf_event_open, &attr, 0, -1, i == 0 ? -1 : fds_[0], 0));
+            if (fd < 0) {
+                error_ = std::string("perf_event_open: ") + std::strerror(errno);
+                close();
+                return;
+            }
+            fds_[i] = fd;
+        }
+        ::ioctl(fds_[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ::ioctl(fds_[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#else
+        error_ = "hardware counters are only supported on Linux";
+#endif
+    }
+
+    void close() {
+#if defined(__linux__)
+        for (int i = kEvents - 1; i >= 0; --i) {
+            if (fds_[i] >= 0) ::close(fds_[i]);
+            fds_[i] = -1;
+        }
+#endif
+    }
+};
+
+} // namespace inv
@@ -0,0 +1,308 @@
+/**
+ * PerfectHashTable.hpp
+ *
+ * Read-only hash table built on a minimal perfect hash (PTHash-style).
+ *
+ * For a catalog snapshot that is never mutated, every key is known up front,
+ * so a hash function can be built that maps the n keys to n distinct slots.
+ * A lookup is then exactly one slot probe plus one key comparison, with no
+ * chains and no empty slots.
+ *
+ * Construction (PTHash, "pilot" search):
+ * 1. Each key gets a seeded 64-bit hash h; keys are split into n / kBucketSize
+ *    buckets by h.
+ * 2. Buckets are processed largest first. For each one, pilot values p = 0,
+ *    1, 2, ... are tried until every key in the bucket lands on a distinct
+ *    free slot mix(h ^ mix(p)) mod m, where m = n / kAlpha is slightly larger
+ *    than n so the last buckets still find free slots quickly.
+ * 3. Slots >= n are remapped to the free slots < n (minimality), so values
+ *    are stored densely in an array of exactly n entries.
+ *
+ * Pilots are bit-packed with just enough bits for the largest one, which
+ * with kBucketSize keys per bucket comes to roughly 2-3 bits per key; the
+ * remap table adds a 32-bit word for about 1% of keys.
+ *
+ * Interface: find(), size() and forEach() behave like HashTable's, so code
+ * that only reads (the engine's query commands) works with either.
+ *
+ * Requirements: T must be default-constructible and move-assignable; keys
+ * must be distinct (duplicates throw std::invalid_argument).
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace inv {
+
+/**
+ * PerfectHashStats - Build and layout figures of a PerfectHashTable
+ */
+struct PerfectHashStats {
+    std::size_t size {0};         // Number of keys
+    std::size_t slots {0};        // Slots the pilots map into (m >= size)
+    std::size_t buckets {0};      // Number of pilots
+    unsigned pilotBits {0};       // Bits per packed pilot
+    std::uint64_t maxPilot {0};   // Largest pilot found
+    std::size_t remapped {0};     // Keys whose slot >= size was remapped
+    std::size_t seedAttempts {0}; // Seeds tried before a build succeeded
+    double buildSec {0.0};        // Construction time
+    double bitsPerKey {0.0};      // Pilot + remap bits per key (excluding entries)
+    std::size_t pilotBytes {0};   // Bytes of the packed pilot array
+    std::size_t remapBytes {0};   // Bytes of the remap array
+    std::size_t entryBytes {0};   // Bytes of the entry array
+};
+
+/**
+ * PerfectHashTable<T> - Immutable string-keyed table with single-probe lookups
+ */
+template <typename T>
+class PerfectHashTable {
+public:
+    /** Average keys per bucket (more: fewer pilot bits, slower build) */
+    static constexpr double kBucketSize = 6.0;
+
+    /** Load factor of the slot space before remapping */
+    static constexpr double kAlpha = 0.99;
+
+    /** Pilot search limit per bucket before trying another seed */
+    static constexpr std::uint64_t kMaxPilot = std::uint64_t(1) << 24;
+
+    /** Empty table */
+    PerfectHashTable() = default;
+
+    /**
+     * Build the table from key-value pairs (moved from)
+     *
+     * @param entries Distinct keys and their values
+     * @throws std::invalid_argument if a key appears twice
+     *
+     * Time Complexity: O(n) expected
+     */
+    explicit PerfectHashTable(std::vector<std::pair<std::string, T>> &&entries) {
+        auto start = std::chrono::steady_clock::now();
+        const std::size_t n = entries.size();
+        std::vector<std::uint32_t> slotOf;
+        for (std::uint64_t seed = 0x5eed; ; seed = mix(seed + 1)) {
+            ++stats_.seedAttempts;
+            if (tryBuild(entries, seed, slotOf)) break;
+            if (stats_.seedAttempts > 16) throw std::runtime_error("PerfectHashTable: no perfect hash found");
+        }
+        entries_.resize(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            Entry &e = entries_[slotOf[i]];
+            e.key = std::move(entries[i].first);
+            e.value = std::move(entries[i].second);
+        }
+        stats_.size = n;
+        stats_.slots = slots_;
+        stats_.buckets = pilotCount_;
+        stats_.pilotBits = pilotBits_;
+        stats_.pilotBytes = pilots_.capacity() * sizeof(std::uint64_t);
+        stats_.remapBytes = remap_.capacity() * sizeof(std::uint32_t);
+        stats_.entryBytes = entries_.capacity() * sizeof(Entry);
+        stats_.bitsPerKey = n ? 8.0 * static_cast<double>(stats_.pilotBytes + stats_.remapBytes) / static_cast<double>(n) : 0.0;
+        stats_.buildSec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    /**
+     * Find a value by key: one slot probe plus one key comparison
+     *
+     * @param key String key to search for
+     * @return Const pointer to value if found, nullptr if not found
+     *
+     * Time Complexity: O(1) worst-case (plus the key comparison)
+     */
+    const T *find(const std::string &key) const {
+        if (entries_.empty()) return nullptr;
+        const Entry &e = entries_[slotFor(hashKey(key, seed_))];
+        return e.key == key ? &e.value : nullptr;
+    }
+
+    /** Number of entries */
+    std::size_t size() const { return entries_.size(); }
+
+    /**
+     * Visit every key-value pair (slot order)
+     * @param fn Callable invoked as fn(const std::string &key, const T &value)
+     */
+    template <typename F>
+    void forEach(F &&fn) const {
+        for (const auto &e : entries_) fn(e.key, e.value);
+    }
+
+    /** Build and layout statistics */
+    const PerfectHashStats &stats() const { return stats_; }
+
+    /** Bytes of one entry (key object + value object) in the entry array */
+    static constexpr std::size_t entryBytes() { return sizeof(Entry); }
+
+private:
+    struct Entry {
+        std::string key;
+        T value;
+    };
+
+    std::vector<Entry> entries_;          // Exactly size() entries, indexed by slot
+    std::vector<std::uint64_t> pilots_;   // Bit-packed pilots, pilotBits_ each
+    std::vector<std::uint32_t> remap_;    // remap_[s - size()] = final slot for s >= size()
+    std::uint64_t seed_ {0};
+    std::size_t slots_ {0};
+    std::size_t pilotCount_ {0};
+    unsigned pilotBits_ {0};
+    PerfectHashStats stats_;
+
+    /** splitmix64 finalizer */
+    static std::uint64_t mix(std::uint64_t x) {
+        x ^= x >> 30; x *= 0xbf58476d1ce4e5b9ULL;
+        x ^= x >> 27; x *= 0x94d049bb133111ebULL;
+        x ^= x >> 31;
+        return x;
+    }
+
+    /** Seeded 64-bit string hash (8 bytes per round) */
+    static std::uint64_t hashKey(const std::string &k, std::uint64_t seed) {
+        std::uint64_t h = seed ^ (k.size() * 0x9e3779b97f4a7c15ULL);
+        std::size_t i = 0;
+        for (; i + 8 <= k.size(); i += 8) {
+            std::uint64_t w;
+            std::memcpy(&w, k.data() + i, 8);
+            h = mix(h ^ w);
+        }
+        std::uint64_t tail = 0;
+        std::memcpy(&tail, k.data() + i, k.size() - i);
+        return mix(h ^ tail ^ 0xff51afd7ed558ccdULL);
+    }
+
+    /**
+     * Skewed bucket assignment: 60% of keys go to the first 30% of buckets.
+     * The dense buckets are placed first, while most slots are free, which
+     * leaves small buckets for the crowded end of the search.
+     */
+    std::size_t bucketFor(std::uint64_t h) const {
+        const std::uint64_t x = h >> 32;
+        const std::uint64_t denseShare = (std::uint64_t(1) << 32) * 6 / 10;
+        std::size_t dense = std::max<std::size_t>(1, pilotCount_ * 3 / 10);
+        if (dense >= pilotCount_) return static_cast<std::size_t>(x % pilotCount_);
+        return x < denseShare ? static_cast<std::size_t>(x % dense)
+                              : dense + static_cast<std::size_t>(x % (pilotCount_ - dense));
+    }
+
+    std::size_t positionFor(std::uint64_t h, std::uint64_t pilot) const {
+        return static_cast<std::size_t>(mix(h ^ mix(pilot + 1)) % slots_);
+    }
+
+    std::uint64_t pilotAt(std::size_t b) const {
+        if (pilotBits_ == 0) return 0;
+        std::size_t bit = b * pilotBits_, word = bit / 64, shift = bit % 64;
+        std::uint64_t v = pilots_[word] >> shift;
+        if (shift + pilotBits_ > 64) v |= pilots_[word + 1] << (64 - shift);
+        return pilotBits_ == 64 ? v : v & ((std::uint64_t(1) << pilotBits_) - 1);
+    }
+
+    std::size_t slotFor(std::uint64_t h) const {
+        std::size_t pos = positionFor(h, pilotAt(bucketFor(h)));
+        return pos < entries_.size() ? pos : remap_[pos - entries_.size()];
+    }
+
+    /**
+     * One construction attempt with `seed`
+     * @param slotOf Output: final slot of each input entry
+     * @return false if this seed failed (two keys with equal hashes)
+     */
+    bool tryBuild(const std::vector<std::pair<std::string, T>> &entries, std::uint64_t seed, std::vector<std::uint32_t> &slotOf) {
+        const std::size_t n = entries.size();
+        seed_ = seed;
+        pilotCount_ = std::max<std::size_t>(1, static_cast<std::size_t>(static_cast<double>(n) / kBucketSize));
+        slots_ = std::max<std::size_t>(1, static_cast<std::size_t>(static_cast<double>(n) / kAlpha));
+        if (slots_ < n) slots_ = n;
+
+        std::vector<std::uint64_t> hashes(n);
+        for (std::size_t i = 0; i < n; ++i) hashes[i] = hashKey(entries[i].first, seed);
+
+        // Group keys by bucket (counting sort), then order buckets largest first
+        std::vector<std::size_t> start(pilotCount_ + 1, 0);
+        for (auto h : hashes) ++start[bucketFor(h) + 1];
+        for (std::size_t b = 0; b < pilotCount_; ++b) start[b + 1] += start[b];
+        std::vector<std::size_t> members(n), fill(start.begin(), start.end() - 1);
+        for (std::size_t i = 0; i < n; ++i) members[fill[bucketFor(hashes[i])]++] = i;
+        std::vector<std::size_t> order(pilotCount_);
+        for (std::size_t b = 0; b < pilotCount_; ++b) order[b] = b;
+        std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+            return start[a + 1] - start[a] > start[b + 1] - start[b];
+        });
+
+        // Pilot search
+        std::vector<std::uint64_t> pilots(pilotCount_, 0);
+        std::vector<bool> taken(slots_, false);
+        std::vector<std::size_t> pos;
+        std::uint64_t maxPilot = 0;
+        for (std::size_t b : order) {
+            std::size_t first = start[b], count = start[b + 1] - start[b];
+            if (count == 0) break;  // Remaining buckets are empty too
+            for (std::size_t i = first; i < start[b + 1]; ++i) {
+                for (std::size_t j = first; j < i; ++j) {
+                    if (hashes[members[i]] != hashes[members[j]]) continue;
+                    if (entries[members[i]].first == entries[members[j]].first) {
+                        throw std::invalid_argument("PerfectHashTable: duplicate key " + entries[members[i]].first);
+                    }
+                    return false;  // Distinct keys, same 64-bit hash: retry with another seed
+                }
+            }
+            for (std::uint64_t p = 0; ; ++p) {
+                if (p == kMaxPilot) return false;  // Pathological seed: retry with another
+                pos.clear();
+                bool ok = true;
+                for (std::size_t i = first; i < start[b + 1] && ok; ++i) {
+                    std::size_t s = positionFor(hashes[members[i]], p);
+                    ok = !taken[s] && std::find(pos.begin(), pos.end(), s) == pos.end();
+                    pos.push_back(s);
+                }
+                if (!ok) continue;
+                for (std::size_t s : pos) taken[s] = true;
+                pilots[b] = p;
+                maxPilot = std::max(maxPilot, p);
+                break;
+            }
+        }
+
+        // Pack pilots
+        pilotBits_ = 0;
+        while (pilotBits_ < 64 && (maxPilot >> pilotBits_) != 0) ++pilotBits_;
+        pilots_.assign(pilotBits_ ? (pilotCount_ * pilotBits_ + 63) / 64 + 1 : 0, 0);
+        for (std::size_t b = 0; b < pilotCount_ && pilotBits_; ++b) {
+            std::size_t bit = b * pilotBits_, word = bit / 64, shift = bit % 64;
+            pilots_[word] |= pilots[b] << shift;
+            if (shift + pilotBits_ > 64) pilots_[word + 1] |= pilots[b] >> (64 - shift);
+        }
+        stats_.maxPilot = maxPilot;
+
+        // Remap slots >= n onto the free slots below n
+        remap_.assign(slots_ - n, 0);
+        stats_.remapped = 0;
+        std::size_t freeSlot = 0;
+        for (std::size_t s = n; s < slots_; ++s) {
+            if (!taken[s]) continue;
+            while (taken[freeSlot]) ++freeSlot;
+            remap_[s - n] = static_cast<std::uint32_t>(freeSlot++);
+            ++stats_.remapped;
+        }
+
+        slotOf.assign(n, 0);
+        for (std::size_t i = 0; i < n; ++i) {
+            std::size_t s = positionFor(hashes[i], pilots[bucketFor(hashes[i])]);
+            slotOf[i] = static_cast<std::uint32_t>(s < n ? s : remap_[s - n]);
+        }
+        return true;
+    }
+};
+
+} // namespace inv
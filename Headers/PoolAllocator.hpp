@@ -0,0 +1,231 @@
+/**
+ * PoolAllocator.hpp
+ *
+ * Slab-based node pool and a standard-conforming allocator that uses it.
+ *
+ * HashTable<T> allocates one std::list node per entry. With the default
+ * allocator every node is a separate malloc() call: each pays a chunk header
+ * and rounding, nodes end up scattered across the heap, and after many
+ * inserts and erases the heap is fragmented. NodePool instead carves nodes
+ * out of large contiguous slabs:
+ *
+ * - Single-object allocations are rounded up to 8 bytes and served from a
+ *   per-size free list, or bump-allocated from the current slab
+ * - Freed objects go onto their size's free list and are reused first
+ * - Multi-object (array) allocations, e.g. a bucket array, and objects too
+ *   large for a slab go straight to ::operator new
+ * - All slabs are released in one step when the pool is destroyed
+ *
+ * PoolAllocator<T> is a plain NodePool pointer: HashTable keeps a copy in
+ * every bucket (std::forward_list stores its allocator), so a pooled bucket
+ * is two pointers, 16 bytes, and copying one costs no reference counting.
+ * The pool belongs to the table: a default-constructed (unbound) allocator
+ * tells HashTable's AllocatorState to create a pool and own it for the
+ * table's lifetime. An allocator bound to a caller's NodePool uses that pool
+ * instead, which must then outlive the table.
+ *
+ * Thread Safety: a pool is not synchronized. Like the containers using it,
+ * it must only be mutated from one thread at a time.
+ *
+ * Usage:
+ *   inv::HashTable<inv::Product, inv::PoolAllocator<inv::Product>> table;
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+namespace inv {
+
+template <typename Alloc>
+class AllocatorState;  // HashTable.hpp
+
+/**
+ * NodePool - Slab allocator with per-size free lists
+ */
+class NodePool {
+public:
+    /**
+     * @param slabBytes Size of each slab (default 64 KiB)
+     */
+    explicit NodePool(std::size_t slabBytes = 64 * 1024) : slabBytes_(slabBytes) {}
+
+    ~NodePool() { release(); }
+
+    NodePool(const NodePool &) = delete;
+    NodePool &operator=(const NodePool &) = delete;
+
+    /**
+     * Allocate one object of `bytes` bytes (alignment up to kGranularity)
+     *
+     * Time Complexity: O(1) amortized
+     */
+    void *allocate(std::size_t bytes) {
+        std::size_t size = roundUp(bytes);
+        if (size > maxPooled()) return ::operator new(bytes);
+        std::size_t cls = size / kGranularity;
+        if (cls >= freeLists_.size()) freeLists_.resize(cls + 1, nullptr);
+        inUse_ += size;
+        if (FreeBlock *b = freeLists_[cls]) {
+            freeLists_[cls] = b->next;
+            return b;
+        }
+        if (static_cast<std::size_t>(end_ - cur_) < size) newSlab();
+        void *p = cur_;
+        cur_ += size;
+        return p;
+    }
+
+    /**
+     * Return an object obtained from allocate(bytes) to its free list
+     *
+     * Time Complexity: O(1)
+     */
+    void deallocate(void *p, std::size_t bytes) {
+        if (!p) return;
+        std::size_t size = roundUp(bytes);
+        if (size > maxPooled()) { ::operator delete(p); return; }
+        std::size_t cls = size / kGranularity;
+        FreeBlock *b = static_cast<FreeBlock *>(p);
+        b->next = freeLists_[cls];
+        freeLists_[cls] = b;
+        inUse_ -= size;
+    }
+
+    /**
+     * Free every slab at once
+     * Only valid when no object allocated from the pool is still alive.
+     */
+    void release() {
+        for (char *s : slabs_) ::operator delete(s);
+        slabs_.clear();
+        freeLists_.clear();
+        cur_ = end_ = nullptr;
+        inUse_ = 0;
+    }
+
+    /** Number of slabs allocated */
+    std::size_t slabCount() const { return slabs_.size(); }
+
+    /** Bytes of each slab */
+    std::size_t slabBytes() const { return slabBytes_; }
+
+    /** Bytes reserved in slabs */
+    std::size_t bytesReserved() const { return slabs_.size() * slabBytes_; }
+
+    /** Bytes currently handed out from slabs (rounded sizes) */
+    std::size_t bytesInUse() const { return inUse_; }
+
+    /** Bytes a single allocation of `bytes` occupies in a slab */
+    static constexpr std::size_t roundUp(std::size_t bytes) {
+        return (bytes + kGranularity - 1) / kGranularity * kGranularity;
+    }
+
+    /** Allocation granularity and maximum supported alignment */
+    static constexpr std::size_t kGranularity = 8;
+
+private:
+    struct FreeBlock { FreeBlock *next; };
+
+    std::size_t slabBytes_;
+    std::vector<char *> slabs_;
+    std::vector<FreeBlock *> freeLists_;  // Indexed by size / kGranularity
+    char *cur_ {nullptr};                 // Bump pointer into the newest slab
+    char *end_ {nullptr};
+    std::size_t inUse_ {0};
+
+    /** Largest object served from slabs; bigger ones bypass the pool */
+    std::size_t maxPooled() const { return slabBytes_ / 8; }
+
+    /**
+     * Start a new slab; the unused tail of the previous one is abandoned
+     * (at most maxPooled() bytes)
+     */
+    void newSlab() {
+        char *s = static_cast<char *>(::operator new(slabBytes_));
+        slabs_.push_back(s);
+        cur_ = s;
+        end_ = s + slabBytes_;
+    }
+};
+
+/**
+ * PoolAllocator<T> - Allocator that serves single objects from a NodePool
+ *
+ * Default construction leaves the allocator unbound: it serves everything
+ * from ::operator new until a table binds it to a pool it owns. Copies
+ * (including rebinds to other types) share the pool. Two allocators compare
+ * equal when they share a pool, which lets splice_after move nodes between
+ * the buckets of one table.
+ */
+template <typename T>
+class PoolAllocator {
+public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    PoolAllocator() noexcept = default;
+
+    /** Allocator serving single objects from `pool` (which must outlive it) */
+    explicit PoolAllocator(NodePool &pool) noexcept : pool_(&pool) {}
+
+    template <typename U>
+    PoolAllocator(const PoolAllocator<U> &o) noexcept : pool_(o.pool_) {}
+
+    T *allocate(std::size_t n) {
+        if (pooled(n)) return static_cast<T *>(pool_->allocate(sizeof(T)));
+        return static_cast<T *>(::operator new(n * sizeof(T)));
+    }
+
+    void deallocate(T *p, std::size_t n) noexcept {
+        if (pooled(n)) pool_->deallocate(p, sizeof(T));
+        else ::operator delete(p);
+    }
+
+    /** true once bound to a pool */
+    bool bound() const { return pool_ != nullptr; }
+
+    /** The shared pool (for memory accounting; requires bound()) */
+    const NodePool &pool() const { return *pool_; }
+
+    template <typename U>
+    bool operator==(const PoolAllocator<U> &o) const { return pool_ == o.pool_; }
+    template <typename U>
+    bool operator!=(const PoolAllocator<U> &o) const { return pool_ != o.pool_; }
+
+private:
+    template <typename U> friend class PoolAllocator;
+
+    NodePool *pool_ {nullptr};  // Not owned
+
+    bool pooled(std::size_t n) const { return pool_ && n == 1 && alignof(T) <= NodePool::kGranularity; }
+};
+
+/**
+ * AllocatorState for PoolAllocator - The table owns the pool
+ *
+ * An unbound allocator gets a new pool that lives as long as the table; a
+ * bound one is used as given. A pooled table can be moved into a new one
+ * but not assigned (assignment would free the pool before the nodes).
+ */
+template <typename T>
+class AllocatorState<PoolAllocator<T>> {
+public:
+    explicit AllocatorState(const PoolAllocator<T> &alloc)
+        : owned_(alloc.bound() ? nullptr : new NodePool()),
+          alloc_(owned_ ? PoolAllocator<T>(*owned_) : alloc) {}
+    AllocatorState(AllocatorState &&) = default;
+    AllocatorState &operator=(AllocatorState &&) = delete;
+    const PoolAllocator<T> &get() const { return alloc_; }
+private:
+    std::unique_ptr<NodePool> owned_;
+    PoolAllocator<T> alloc_;
+};
+
+} // namespace inv
@@ -0,0 +1,156 @@
+/**
+ * RenderedStore.hpp
+ *
+ * Arena of pre-rendered `find` output blocks.
+ *
+ * printProduct() formats labels, optional fields and a word-wrapped
+ * description on every `find`. With pre-rendering enabled the engine runs
+ * it once per product, stores the text here, and keeps a 32-bit handle in
+ * Product::renderedRef; `find` then writes the stored bytes with one
+ * ostream::write.
+ *
+ * Text is appended to fixed-size chunks (a block larger than a chunk gets
+ * its own), so stored bytes never move and adding a block never copies the
+ * others. A replaced or erased product's block is released: its bytes stay
+ * in the chunk as garbage until the owner rebuilds the store (see
+ * Engine::setPrerenderedOutput), and its handle is reused.
+ *
+ * Thread Safety: write()/view() may run concurrently with each other;
+ * add(), release() and clear() must not run concurrently with anything
+ * (the engine calls them with its catalog lock held exclusively).
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace inv {
+
+/**
+ * RenderedStore - Append-only chunks of rendered text addressed by handle
+ */
+class RenderedStore {
+public:
+    /** Handle of "not rendered" (Product::renderedRef default) */
+    static constexpr std::uint32_t kNone = 0xFFFFFFFFu;
+
+    /** Size of a regular chunk */
+    static constexpr std::size_t kChunkBytes = 256 * 1024;
+
+    /**
+     * Store a rendered block
+     *
+     * @param text Output bytes
+     * @return Handle for write()/view()/release()
+     *
+     * Time Complexity: O(text) amortized
+     */
+    std::uint32_t add(const std::string &text) {
+        if (chunks_.empty() || chunks_.back().size - chunks_.back().used < text.size()) {
+            Chunk c;
+            c.size = text.size() > kChunkBytes ? text.size() : kChunkBytes;
+            c.bytes.reset(new char[c.size]);
+            chunks_.push_back(std::move(c));
+        }
+        Chunk &c = chunks_.back();
+        if (!text.empty()) std::memcpy(c.bytes.get() + c.used, text.data(), text.size());
+        Span span {c.bytes.get() + c.used, static_cast<std::uint32_t>(text.size())};
+        c.used += text.size();
+        liveBytes_ += text.size();
+
+        std::uint32_t ref;
+        if (!freeRefs_.empty()) {
+            ref = freeRefs_.back();
+            freeRefs_.pop_back();
+            spans_[ref] = span;
+        } else {
+            if (spans_.size() >= kNone) throw std::length_error("RenderedStore: too many entries");
+            ref = static_cast<std::uint32_t>(spans_.size());
+            spans_.push_back(span);
+        }
+        return ref;
+    }
+
+    /**
+     * Drop a block; its bytes become garbage and its handle is reused
+     * (kNone is ignored)
+     */
+    void release(std::uint32_t ref) {
+        if (ref == kNone || ref >= spans_.size() || !spans_[ref].data) return;
+        liveBytes_ -= spans_[ref].length;
+        garbageBytes_ += spans_[ref].length;
+        spans_[ref] = Span {};
+        freeRefs_.push_back(ref);
+    }
+
+    /**
+     * Write a block to out
+     * @return false for kNone or a released handle
+     */
+    bool write(std::uint32_t ref, std::ostream &out) const {
+        if (ref >= spans_.size() || !spans_[ref].data) return false;
+        out.write(spans_[ref].data, static_cast<std::streamsize>(spans_[ref].length));
+        return true;
+    }
+
+    /** A block's bytes ("" for kNone or a released handle) */
+    std::string view(std::uint32_t ref) const {
+        if (ref >= spans_.size() || !spans_[ref].data) return std::string();
+        return std::string(spans_[ref].data, spans_[ref].length);
+    }
+
+    /** Drop everything */
+    void clear() {
+        chunks_.clear();
+        spans_.clear();
+        freeRefs_.clear();
+        liveBytes_ = garbageBytes_ = 0;
+    }
+
+    /** Number of live blocks */
+    std::size_t size() const { return spans_.size() - freeRefs_.size(); }
+
+    /** Bytes of live blocks */
+    std::size_t liveBytes() const { return liveBytes_; }
+
+    /** Bytes of released blocks still occupying chunks */
+    std::size_t garbageBytes() const { return garbageBytes_; }
+
+    /** Visit each chunk's allocation size (for memory accounting) */
+    template <typename F>
+    void forEachChunk(F fn) const {
+        for (const auto &c : chunks_) fn(c.size);
+    }
+
+    /** Bytes of the handle table */
+    std::size_t spanBytes() const {
+        return spans_.capacity() * sizeof(Span) + freeRefs_.capacity() * sizeof(std::uint32_t);
+    }
+
+private:
+    struct Chunk {
+        std::unique_ptr<char[]> bytes;
+        std::size_t size {0};
+        std::size_t used {0};
+    };
+
+    struct Span {
+        const char *data {nullptr};
+        std::uint32_t length {0};
+    };
+
+    std::vector<Chunk> chunks_;
+    std::vector<Span> spans_;
+    std::vector<std::uint32_t> freeRefs_;
+    std::size_t liveBytes_ {0};
+    std::size_t garbageBytes_ {0};
+};
+
+} // namespace inv
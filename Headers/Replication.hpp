@@ -0,0 +1,390 @@
+/**
+ * Replication.hpp
+ *
+ * Read replicas that follow a primary engine's mutation log.
+ *
+ * The primary calls Engine::enableMutationLog() and runs a
+ * ReplicationServer; each replica process runs a Replica that connects to
+ * it, receives the log as binary batches and applies them to its own
+ * engine (Engine::applyMutations), which keeps serving reads meanwhile.
+ * Reads scale out by spreading clients over the replicas.
+ *
+ * Stream format (endpoints as in Net.hpp: "unix:<path>" or "<host>:<port>"):
+ * - replica -> primary, once: 8-byte magic "INVREPL1", u64 start position
+ * - primary -> replica, repeatedly: a 32-byte batch header
+ *     u32 magic 'IRPB', u32 record count, u32 payload bytes, u32 reserved,
+ *     u64 first position, u64 log end when the batch was sent
+ *   followed by the payload (records as laid out in MutationLog.hpp).
+ *   An empty batch is a heartbeat, sent when the replica is caught up.
+ * - primary -> replica, instead of batches, if the start position is past
+ *   the log's end: a header with magic 'IRPX', zero count and payload, the
+ *   requested position and the log end; then the connection is closed.
+ *
+ * Resuming: a replica always asks for the position after the last record
+ * it applied, so after a dropped connection or a restart of the Replica
+ * object (Replica::start(..., from)) it receives each record exactly once.
+ * A primary restart starts a new log, so replicas must then start over from
+ * an empty engine: a replica asking for a position the new log has not
+ * reached is rejected, and Replica stops and reports it (error()) rather
+ * than reconnecting.
+ *
+ * Usage:
+ *   primary: engine.load(csv); engine.enableMutationLog();
+ *            server.listen("127.0.0.1:7400"); server.serve(engine);
+ *   replica: inv::Replica r; r.start("127.0.0.1:7400", replicaEngine);
+ *            r.waitCaughtUp(std::chrono::seconds(10));
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "Engine.hpp"
+#include "MutationLog.hpp"
+#include "Net.hpp"
+
+namespace inv {
+
+namespace repl {
+
+constexpr char kHelloMagic[8] = {'I', 'N', 'V', 'R', 'E', 'P', 'L', '1'};
+constexpr std::uint32_t kBatchMagic = 0x42505249u;  // "IRPB"
+constexpr std::uint32_t kRejectMagic = 0x58505249u; // "IRPX"
+constexpr std::size_t kHelloBytes = 16;
+constexpr std::size_t kBatchHeaderBytes = 32;
+constexpr std::size_t kMaxBatchRecords = 4096;
+constexpr std::size_t kMaxBatchBytes = 1 << 20;
+
+/** Idle time after which a caught-up primary sends a heartbeat */
+constexpr std::chrono::milliseconds kHeartbeat {200};
+
+/** Delay between a replica's reconnection attempts */
+constexpr std::chrono::milliseconds kRetryDelay {100};
+
+inline std::string batchHeader(std::uint32_t count, std::uint32_t payloadBytes, std::uint64_t first, std::uint64_t logEnd,
+                               std::uint32_t magic = kBatchMagic) {
+    std::string h;
+    h.reserve(kBatchHeaderBytes);
+    mapped::put32(h, magic);
+    mapped::put32(h, count);
+    mapped::put32(h, payloadBytes);
+    mapped::put32(h, 0);
+    mapped::put64(h, first);
+    mapped::put64(h, logEnd);
+    return h;
+}
+
+} // namespace repl
+
+/**
+ * ReplicationServer - Streams a primary engine's mutation log to replicas
+ *
+ * Each connected replica gets its own thread, which copies batches from the
+ * log (up to kMaxBatchRecords records / about kMaxBatchBytes bytes) and
+ * blocks on the log while the replica is caught up. Threads of replicas
+ * that disconnected are joined at the next accept.
+ */
+class ReplicationServer {
+public:
+    ReplicationServer() = default;
+    ~ReplicationServer() { stop(); }
+    ReplicationServer(const ReplicationServer &) = delete;
+    ReplicationServer &operator=(const ReplicationServer &) = delete;
+
+    /**
+     * Bind and listen
+     *
+     * @param endpoint "unix:<path>" or "<host>:<port>" (port 0 = any free port)
+     * @return false if the endpoint cannot be bound
+     */
+    bool listen(const std::string &endpoint) {
+        int fd = net::listenOn(endpoint, endpoint_, unixPath_);
+        if (fd < 0) return false;
+        listenFd_ = fd;
+        return true;
+    }
+
+    /** Endpoint replicas should connect to (with the actual port if 0 was given) */
+    const std::string &endpoint() const { return endpoint_; }
+
+    /** Replica threads not yet joined (finished ones are reaped on accept) */
+    std::size_t workerCount() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return workers_.size();
+    }
+
+    /**
+     * Accept replicas and stream to them until stop()
+     *
+     * @param engine Primary engine; enableMutationLog() must have been called
+     * @return false if the engine has no mutation log
+     */
+    bool serve(const Engine &engine) {
+        const MutationLog *log = engine.mutationLog();
+        if (!log) return false;
+        for (;;) {
+            int fd = ::accept4(listenFd_, nullptr, nullptr, SOCK_CLOEXEC);
+            if (fd < 0) {
+                if (stopping_ || errno != EINTR) break;
+                continue;
+            }
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (stopping_) { ::close(fd); break; }
+            reapFinished();
+            clients_.push_back(fd);
+            workers_.emplace_back([this, fd, log]() { stream(fd, *log); });
+        }
+        std::vector<std::thread> workers;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            workers.swap(workers_);
+        }
+        for (auto &w : workers) w.join();
+        return true;
+    }
+
+    /** Stop accepting, disconnect replicas and unblock serve() */
+    void stop() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_ || listenFd_ < 0) return;
+        stopping_ = true;
+        ::shutdown(listenFd_, SHUT_RDWR);
+        for (int fd : clients_) ::shutdown(fd, SHUT_RDWR);
+        ::close(listenFd_);
+        if (!unixPath_.empty()) ::unlink(unixPath_.c_str());
+    }
+
+private:
+    std::atomic<int> listenFd_ {-1};
+    std::string endpoint_;
+    std::string unixPath_;
+    mutable std::mutex mutex_;
+    std::atomic<bool> stopping_ {false};
+    std::vector<int> clients_;
+    std::vector<std::thread> workers_;
+    std::vector<std::thread::id> finished_;  // Workers done streaming, not yet joined
+
+    /** Join workers that have finished (mutex_ held; they no longer need it) */
+    void reapFinished() {
+        for (std::thread::id id : finished_) {
+            auto it = std::find_if(workers_.begin(), workers_.end(), [&](const std::thread &w) { return w.get_id() == id; });
+            if (it == workers_.end()) continue;
+            it->join();
+            workers_.erase(it);
+        }
+        finished_.clear();
+    }
+
+    void stream(int fd, const MutationLog &log) {
+        net::Reader in(fd);
+        std::string hello;
+        if (in.exact(repl::kHelloBytes, hello) && std::memcmp(hello.data(), repl::kHelloMagic, 8) == 0) {
+            std::uint64_t position = mapped::load64(hello.data() + 8);
+            std::string payload;
+            if (position > log.end()) {
+                std::string reject = repl::batchHeader(0, 0, position, log.end(), repl::kRejectMagic);
+                net::sendAll(fd, reject.data(), reject.size());
+            }
+            while (!stopping_ && position <= log.end()) {
+                std::size_t n = log.read(position, repl::kMaxBatchRecords, repl::kMaxBatchBytes, payload);
+                if (n == 0 && log.waitBeyond(position, repl::kHeartbeat)) continue;
+                std::string header = repl::batchHeader(static_cast<std::uint32_t>(n), static_cast<std::uint32_t>(payload.size()),
+                                                       position, log.end());
+                if (!net::sendAll(fd, header.data(), header.size()) || !net::sendAll(fd, payload.data(), payload.size())) break;
+                position += n;
+            }
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        clients_.erase(std::remove(clients_.begin(), clients_.end(), fd), clients_.end());
+        ::close(fd);
+        finished_.push_back(std::this_thread::get_id());
+    }
+};
+
+/**
+ * Replica - Keeps an engine in sync with a primary's mutation log
+ *
+ * A background thread connects, applies every batch it receives with
+ * Engine::applyMutations() and reconnects (resuming from position()) when
+ * the connection drops. The engine answers commands concurrently. If the
+ * primary rejects the position (its log is shorter, e.g. after a restart),
+ * the thread stops and error() says why.
+ */
+class Replica {
+public:
+    Replica() = default;
+    ~Replica() { stop(); }
+    Replica(const Replica &) = delete;
+    Replica &operator=(const Replica &) = delete;
+
+    /**
+     * Start following a primary
+     *
+     * @param endpoint Primary's ReplicationServer endpoint
+     * @param engine Engine to apply the log to (must outlive the Replica)
+     * @param from Log position to resume from (records [0, from) are
+     *        already applied to engine)
+     * @return false if already started or the endpoint is malformed
+     */
+    bool start(const std::string &endpoint, Engine &engine, std::uint64_t from = 0) {
+        sockaddr_storage addr;
+        socklen_t len;
+        if (thread_.joinable() || !net::parseEndpoint(endpoint, addr, len)) return false;
+        endpoint_ = endpoint;
+        position_ = from;
+        stopping_ = false;
+        error_.clear();
+        thread_ = std::thread([this, &engine]() { run(engine); });
+        return true;
+    }
+
+    /** Disconnect and stop applying (the engine keeps what it has) */
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+            if (fd_ >= 0) ::shutdown(fd_, SHUT_RDWR);
+        }
+        changed_.notify_all();
+        if (thread_.joinable()) thread_.join();
+    }
+
+    /** Position after the last applied record (where a restart resumes) */
+    std::uint64_t position() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return position_;
+    }
+
+    /** Primary's log end as of the last batch received */
+    std::uint64_t primaryEnd() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return primaryEnd_;
+    }
+
+    /** Batches (including heartbeats) received so far */
+    std::uint64_t batches() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return batches_;
+    }
+
+    /** Why the replica stopped following (empty while it follows) */
+    std::string error() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return error_;
+    }
+
+    /**
+     * Wait until the records up to position have been applied
+     * @return false on timeout or if the primary rejected the replica
+     */
+    template <typename Duration>
+    bool waitFor(std::uint64_t position, Duration timeout) const {
+        std::unique_lock<std::mutex> lock(mutex_);
+        changed_.wait_for(lock, timeout, [&]() { return position_ >= position || !error_.empty(); });
+        return position_ >= position;
+    }
+
+    /**
+     * Wait until a batch has been received and everything the primary had
+     * logged when it sent the batch has been applied
+     * @return false on timeout or if the primary rejected the replica
+     */
+    template <typename Duration>
+    bool waitCaughtUp(Duration timeout) const {
+        std::unique_lock<std::mutex> lock(mutex_);
+        auto caughtUp = [&]() { return batches_ > 0 && position_ >= primaryEnd_; };
+        changed_.wait_for(lock, timeout, [&]() { return caughtUp() || !error_.empty(); });
+        return error_.empty() && caughtUp();
+    }
+
+private:
+    std::string endpoint_;
+    std::thread thread_;
+    mutable std::mutex mutex_;
+    mutable std::condition_variable changed_;
+    bool stopping_ {false};
+    int fd_ {-1};
+    std::uint64_t position_ {0};
+    std::uint64_t primaryEnd_ {0};
+    std::uint64_t batches_ {0};
+    std::string error_;  // Set when the primary rejects us; stops run()
+
+    void run(Engine &engine) {
+        for (;;) {
+            int fd = net::connectTo(endpoint_);
+            std::uint64_t from;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (stopping_) { if (fd >= 0) ::close(fd); return; }
+                fd_ = fd;
+                from = position_;
+            }
+            if (fd >= 0) {
+                follow(fd, from, engine);
+                std::lock_guard<std::mutex> lock(mutex_);
+                fd_ = -1;
+                ::close(fd);
+            }
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (!error_.empty()) return;
+            if (changed_.wait_for(lock, repl::kRetryDelay, [&]() { return stopping_; })) return;
+        }
+    }
+
+    /** Stream batches on one connection until it fails */
+    void follow(int fd, std::uint64_t from, Engine &engine) {
+        std::string hello(repl::kHelloMagic, 8);
+        mapped::put64(hello, from);
+        if (!net::sendAll(fd, hello.data(), hello.size())) return;
+
+        net::Reader in(fd);
+        std::string header, payload;
+        std::vector<Mutation> batch;
+        while (in.exact(repl::kBatchHeaderBytes, header)) {
+            const char *h = header.data();
+            std::uint32_t count = mapped::load32(h + 4);
+            std::uint32_t bytes = mapped::load32(h + 8);
+            std::uint64_t first = mapped::load64(h + 16);
+            std::uint64_t logEnd = mapped::load64(h + 24);
+            if (mapped::load32(h) == repl::kRejectMagic) {
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    error_ = "primary's log ends at " + std::to_string(logEnd) + ", before position " +
+                             std::to_string(first) + " (primary restarted?)";
+                }
+                changed_.notify_all();
+                return;
+            }
+            if (mapped::load32(h) != repl::kBatchMagic || first != from) return;
+            if (!in.exact(bytes, payload)) return;
+
+            batch.resize(count);
+            const char *p = payload.data();
+            const char *end = p + payload.size();
+            for (auto &m : batch) if (!MutationLog::decode(p, end, m)) return;
+            if (p != end || (count > 0 && !engine.applyMutations(batch))) return;
+            from += count;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                position_ = from;
+                primaryEnd_ = logEnd;
+                ++batches_;
+            }
+            changed_.notify_all();
+        }
+    }
+};
+
+} // namespace inv
@@ -0,0 +1,232 @@
+/**
+ * ResultCache.hpp
+ *
+ * Bounded cache of rendered query output with CLOCK eviction.
+ *
+ * The engine stores the complete output of `find` and `listInventory`
+ * under the normalized command ("f:<id>" / "l:<category>") together with
+ * the dataset generation it was computed from. A lookup only hits if the
+ * stored generation equals the current one, so bumping the engine's
+ * generation on a reload or mutation invalidates every entry at once
+ * without touching them; stale entries are overwritten or evicted later.
+ *
+ * Layout: 16 independently locked shards picked by the key's 64-bit hash.
+ * Each shard maps hash -> slot (the key is compared on hit, so a hash
+ * collision is a miss, never a wrong answer) and evicts with CLOCK: a hit
+ * sets the slot's reference bit, and the hand clears set bits and evicts the
+ * first slot it finds clear. Values are shared, immutable strings, so a hit
+ * is one hash lookup plus copying a pointer under the shard lock; the bytes
+ * are written to the stream after the lock is released.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "MappedHashTable.hpp"
+
+namespace inv {
+
+/**
+ * ResultCacheStats - Counters and occupancy of a ResultCache
+ */
+struct ResultCacheStats {
+    std::uint64_t hits {0};
+    std::uint64_t misses {0};      // Including stale entries
+    std::uint64_t stale {0};       // Found, but from an older generation
+    std::uint64_t evictions {0};
+    std::size_t entries {0};
+    std::size_t bytes {0};         // Charged bytes (keys, values and per-entry overhead)
+    std::size_t capacityBytes {0};
+};
+
+/**
+ * ResultCache - Generation-checked cache of command output
+ *
+ * Thread Safety: all methods may be called concurrently.
+ */
+class ResultCache {
+public:
+    static constexpr std::size_t kShards = 16;
+    static constexpr std::size_t kEntryOverhead = 96;  // Slot, map node and string headers
+
+    /**
+     * @param capacityBytes Upper bound on charged bytes (split evenly
+     *        between shards; an output larger than a shard is not cached)
+     */
+    explicit ResultCache(std::size_t capacityBytes) : shardCapacity_(capacityBytes / kShards) {}
+
+    ResultCache(const ResultCache &) = delete;
+    ResultCache &operator=(const ResultCache &) = delete;
+
+    /**
+     * Write the cached output for key if it was computed at generation
+     *
+     * @param key Normalized command
+     * @param generation Current dataset generation
+     * @param out Receives the output on a hit
+     * @return true on a hit
+     *
+     * Time Complexity: O(1) average plus the output size
+     */
+    bool lookup(const std::string &key, std::uint64_t generation, std::ostream &out) {
+        std::uint64_t h = mapped::hashKey(key.data(), key.size());
+        Shard &s = shards_[h >> 60];
+        std::shared_ptr<const std::string> value;
+        {
+            std::lock_guard<std::mutex> lock(s.mutex);
+            auto it = s.index.find(h);
+            if (it == s.index.end() || s.slots[it->second].key != key) { ++s.misses; return false; }
+            Slot &slot = s.slots[it->second];
+            if (slot.generation != generation) { ++s.misses; ++s.stale; return false; }
+            slot.referenced = true;
+            ++s.hits;
+            value = slot.value;
+        }
+        out.write(value->data(), static_cast<std::streamsize>(value->size()));
+        return true;
+    }
+
+    /**
+     * Store output for key, computed at generation
+     *
+     * Replaces an entry with the same key. Evicts with CLOCK until the
+     * shard is within its capacity.
+     *
+     * Time Complexity: O(1) amortized
+     */
+    void insert(const std::string &key, std::uint64_t generation, std::string output) {
+        if (key.size() + output.size() + kEntryOverhead > shardCapacity_) return;
+        insert(key, generation, std::make_shared<const std::string>(std::move(output)));
+    }
+
+    /**
+     * Store an already shared output buffer (e.g. one a SingleFlight call
+     * handed to several callers) without copying it
+     */
+    void insert(const std::string &key, std::uint64_t generation, std::shared_ptr<const std::string> value) {
+        std::size_t charge = key.size() + value->size() + kEntryOverhead;
+        if (charge > shardCapacity_) return;
+        std::uint64_t h = mapped::hashKey(key.data(), key.size());
+        Shard &s = shards_[h >> 60];
+
+        std::lock_guard<std::mutex> lock(s.mutex);
+        auto it = s.index.find(h);
+        if (it != s.index.end()) {
+            // Same key (refresh) or a colliding one (replace it)
+            Slot &slot = s.slots[it->second];
+            s.bytes -= slot.charge;
+            slot.key = key;
+            slot.value = std::move(value);
+            slot.generation = generation;
+            slot.charge = charge;
+            slot.referenced = false;
+            s.bytes += charge;
+            while (s.bytes > shardCapacity_) evictOne(s, it->second);
+            return;
+        }
+        while (s.bytes + charge > shardCapacity_) evictOne(s, kNoSlot);
+        std::uint32_t index;
+        if (!s.free.empty()) {
+            index = s.free.back();
+            s.free.pop_back();
+        } else {
+            index = static_cast<std::uint32_t>(s.slots.size());
+            s.slots.emplace_back();
+        }
+        Slot &slot = s.slots[index];
+        slot.used = true;
+        slot.hash = h;
+        slot.key = key;
+        slot.value = std::move(value);
+        slot.generation = generation;
+        slot.charge = charge;
+        slot.referenced = false;  // Must be hit once to survive the next sweep
+        s.bytes += charge;
+        s.index.emplace(h, index);
+    }
+
+    /** Drop every entry (counters are kept) */
+    void clear() {
+        for (auto &s : shards_) {
+            std::lock_guard<std::mutex> lock(s.mutex);
+            s.index.clear();
+            s.slots.clear();
+            s.free.clear();
+            s.hand = 0;
+            s.bytes = 0;
+        }
+    }
+
+    /** Counters and occupancy, summed over the shards */
+    ResultCacheStats stats() const {
+        ResultCacheStats st;
+        st.capacityBytes = shardCapacity_ * kShards;
+        for (const auto &s : shards_) {
+            std::lock_guard<std::mutex> lock(s.mutex);
+            st.hits += s.hits;
+            st.misses += s.misses;
+            st.stale += s.stale;
+            st.evictions += s.evictions;
+            st.entries += s.index.size();
+            st.bytes += s.bytes;
+        }
+        return st;
+    }
+
+private:
+    static constexpr std::uint32_t kNoSlot = 0xFFFFFFFFu;
+
+    struct Slot {
+        std::uint64_t hash {0};
+        std::string key;
+        std::shared_ptr<const std::string> value;
+        std::uint64_t generation {0};
+        std::size_t charge {0};
+        bool referenced {false};
+        bool used {false};
+    };
+
+    struct Shard {
+        mutable std::mutex mutex;
+        std::unordered_map<std::uint64_t, std::uint32_t> index;  // Key hash -> slot
+        std::vector<Slot> slots;
+        std::vector<std::uint32_t> free;
+        std::size_t hand {0};
+        std::size_t bytes {0};
+        std::uint64_t hits {0};
+        std::uint64_t misses {0};
+        std::uint64_t stale {0};
+        std::uint64_t evictions {0};
+    };
+
+    const std::size_t shardCapacity_;
+    Shard shards_[kShards];
+
+    /** Advance the CLOCK hand and evict one slot (never keep) */
+    static void evictOne(Shard &s, std::uint32_t keep) {
+        for (;;) {
+            if (s.hand >= s.slots.size()) s.hand = 0;
+            std::uint32_t i = static_cast<std::uint32_t>(s.hand++);
+            Slot &slot = s.slots[i];
+            if (!slot.used || i == keep) continue;
+            if (slot.referenced) { slot.referenced = false; continue; }
+            s.index.erase(slot.hash);
+            s.bytes -= slot.charge;
+            slot = Slot();
+            s.free.push_back(i);
+            ++s.evictions;
+            return;
+        }
+    }
+};
+
+} // namespace inv
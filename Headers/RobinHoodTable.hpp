@@ -0,0 +1,450 @@
+/**
+ * RobinHoodTable.hpp
+ *
+ * Open-addressing hash table with Robin Hood probing and backward-shift
+ * deletion: an alternative to HashTable for high-churn workloads.
+ *
+ * Layout:
+ * - One contiguous array of slots holding the key-value entries inline (no
+ *   per-entry allocation, no list links), plus a parallel array of 8-byte
+ *   metadata words: the entry's probe distance (0 = empty, 1 = home slot)
+ *   and 32 bits of its hash.
+ * - The capacity is a power of two. A key's home slot is the top bits of its
+ *   Fibonacci-mixed hash, which are also the stored 32 hash bits, so
+ *   growing never rehashes a key string.
+ *
+ * Robin Hood invariant: along any run of occupied slots, entries are ordered
+ * by home slot. Equivalently, a new entry takes the first slot whose
+ * occupant is closer to home than the new entry would be, and the rest of the
+ * run shifts forward by one. This keeps the probe length variance small, and
+ * lets a lookup stop as soon as it reaches a slot whose occupant is closer to
+ * home than the probe (the key cannot be further on).
+ *
+ * Backward-shift deletion: erasing an entry moves each following entry of
+ * its run back one slot (closer to home) until an empty slot or an entry
+ * already at home is reached. No tombstones are left behind, so probe
+ * lengths after any amount of insert/erase churn are the same as for a
+ * table built fresh with the same keys.
+ *
+ * Interface: insert(), emplace(), try_emplace(), find(), erase(), clear(),
+ * size(), forEach() and reserve() behave like HashTable's. Unlike
+ * HashTable, entries move when the table is modified, so a pointer from
+ * find() or emplace() is only valid until the next insert, erase or rehash.
+ *
+ * Requirements: T must be move-constructible.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace inv {
+
+/**
+ * RobinHoodStats - Probe-length figures of a RobinHoodTable
+ */
+struct RobinHoodStats {
+    std::size_t size {0};          // Number of entries
+    std::size_t slots {0};         // Capacity (power of two)
+    double loadFactor {0.0};       // size / slots
+    std::size_t emptySlots {0};    // Slots holding no entry
+    std::size_t longestProbe {0};  // Largest probe length (1 = found in its home slot)
+    std::vector<std::size_t> probeHistogram; // probeHistogram[k] = entries found after k probes
+    double avgProbesHit {0.0};     // Average slots examined by a successful find
+    double avgProbesMiss {0.0};    // Average slots examined by an unsuccessful find
+    std::size_t rehashCount {0};   // Number of rehashes since construction
+    std::size_t slotBytes {0};     // Bytes used by the entry and metadata arrays
+};
+
+/**
+ * RobinHoodTable<T> - String-keyed open-addressing table (Robin Hood probing)
+ *
+ * Time Complexity:
+ * - Insert: O(1) average (amortized with growth); the shift is bounded by
+ *   the length of the run the entry lands in
+ * - Find: O(1) average, probe lengths stay O(log n) with high probability
+ * - Erase: O(1) average (backward shift of the rest of the run)
+ *
+ * Space Complexity: O(m) where m is the capacity (entries stored inline)
+ */
+template <typename T>
+class RobinHoodTable {
+public:
+    /** Maximum load factor before the capacity doubles */
+    static constexpr double kMaxLoadFactor = 0.875;
+
+    /**
+     * Constructor - Allocate room for `expected` entries without growing
+     *
+     * @param expected Entries the table should hold before its first rehash
+     */
+    explicit RobinHoodTable(std::size_t expected = 16) { allocate(capacityFor(expected)); }
+
+    RobinHoodTable(const RobinHoodTable &o) : size_(o.size_), rehashCount_(o.rehashCount_) {
+        allocate(o.meta_.size());
+        meta_ = o.meta_;
+        for (std::size_t i = 0; i < meta_.size(); ++i) {
+            if (meta_[i].dist) new (&entries_[i]) Entry(o.entries_[i].key, o.entries_[i].value);
+        }
+    }
+
+    /** The moved-from table may only be assigned to or destroyed */
+    RobinHoodTable(RobinHoodTable &&o) noexcept { swap(o); }
+
+    RobinHoodTable &operator=(RobinHoodTable o) noexcept { swap(o); return *this; }
+
+    ~RobinHoodTable() { destroyAll(); deallocate(); }
+
+    /**
+     * Insert or update a key-value pair
+     *
+     * @param key String key to insert/update
+     * @param value Value to associate with the key
+     * @return true if new entry was inserted, false if existing entry was updated
+     *
+     * Time Complexity: O(1) average, O(n) if rehashing triggered
+     */
+    bool insert(const std::string &key, const T &value) {
+        return emplaceImpl(key, true, value).second;
+    }
+
+    /**
+     * Insert or update a key-value pair, moving both into the table
+     *
+     * @param key String key to insert/update (moved from)
+     * @param value Value to associate with the key (moved from)
+     * @return true if new entry was inserted, false if existing entry was updated
+     */
+    bool insert(std::string &&key, T &&value) {
+        return emplaceImpl(std::move(key), true, std::move(value)).second;
+    }
+
+    /**
+     * Insert or update an entry, constructing the value from `args`
+     *
+     * @return Pointer to the stored value (valid until the next modification),
+     *         and true if a new entry was inserted
+     */
+    template <typename K, typename... Args>
+    std::pair<T*, bool> emplace(K &&key, Args &&...args) {
+        return emplaceImpl(std::forward<K>(key), true, std::forward<Args>(args)...);
+    }
+
+    /**
+     * Insert an entry only if the key is absent (arguments are left untouched
+     * if it exists)
+     *
+     * @return Pointer to the stored (new or existing) value, and true if inserted
+     */
+    template <typename K, typename... Args>
+    std::pair<T*, bool> try_emplace(K &&key, Args &&...args) {
+        return emplaceImpl(std::forward<K>(key), false, std::forward<Args>(args)...);
+    }
+
+    /**
+     * Find a value by key
+     *
+     * @param key String key to search for
+     * @return Pointer to value if found (valid until the next modification),
+     *         nullptr if not found
+     *
+     * Time Complexity: O(1) average
+     */
+    T* find(const std::string &key) {
+        Probe p = probe(key, tagOf(key));
+        return p.found ? &entries_[p.slot].value : nullptr;
+    }
+
+    const T* find(const std::string &key) const {
+        Probe p = probe(key, tagOf(key));
+        return p.found ? &entries_[p.slot].value : nullptr;
+    }
+
+    /**
+     * Remove a key-value pair, shifting the rest of its run back one slot
+     *
+     * @param key String key to remove
+     * @return true if key was found and removed, false if key didn't exist
+     *
+     * Time Complexity: O(1) average
+     */
+    bool erase(const std::string &key) {
+        Probe p = probe(key, tagOf(key));
+        if (!p.found) return false;
+        std::size_t i = p.slot;
+        entries_[i].~Entry();
+        for (std::size_t j = next(i); meta_[j].dist > 1; i = j, j = next(j)) {
+            new (&entries_[i]) Entry(std::move(entries_[j]));
+            entries_[j].~Entry();
+            meta_[i] = meta_[j];
+            --meta_[i].dist;
+        }
+        meta_[i].dist = 0;
+        --size_;
+        return true;
+    }
+
+    /**
+     * Remove every entry (the capacity is kept)
+     *
+     * Time Complexity: O(m) where m is the capacity
+     */
+    void clear() {
+        destroyAll();
+        size_ = 0;
+    }
+
+    /** Number of key-value pairs */
+    std::size_t size() const { return size_; }
+
+    /** Number of slots (a power of two) */
+    std::size_t slotCount() const { return meta_.size(); }
+
+    /** size / slotCount */
+    double loadFactor() const {
+        return static_cast<double>(size_) / static_cast<double>(meta_.size());
+    }
+
+    /**
+     * Visit every key-value pair (slot order); the table must not be
+     * modified from inside the callback
+     *
+     * @param fn Callable invoked as fn(const std::string &key, const T &value)
+     */
+    template <typename F>
+    void forEach(F &&fn) const {
+        for (std::size_t i = 0; i < meta_.size(); ++i) {
+            if (meta_[i].dist) fn(entries_[i].key, static_cast<const T &>(entries_[i].value));
+        }
+    }
+
+    /** Same as above with mutable access to the values */
+    template <typename F>
+    void forEach(F &&fn) {
+        for (std::size_t i = 0; i < meta_.size(); ++i) {
+            if (meta_[i].dist) fn(static_cast<const std::string &>(entries_[i].key), entries_[i].value);
+        }
+    }
+
+    /**
+     * Grow so that `count` entries fit without another rehash
+     *
+     * @param count Number of entries the table should hold without growing
+     *
+     * Time Complexity: O(m) where m is the capacity (if rehashing)
+     */
+    void reserve(std::size_t count) {
+        std::size_t cap = capacityFor(count);
+        if (cap > meta_.size()) rehash(cap);
+    }
+
+    /** Bytes per slot (inline entry plus metadata word) */
+    static constexpr std::size_t slotBytes() { return sizeof(Entry) + sizeof(Meta); }
+
+    /**
+     * Collect probe-length statistics
+     *
+     * Hits: an entry at distance d from home is found after d probes. Misses:
+     * for every possible home slot, the probe runs until it reaches a slot
+     * whose occupant is closer to its own home (or empty).
+     *
+     * Time Complexity: O(m * average run length)
+     */
+    RobinHoodStats stats() const {
+        RobinHoodStats st;
+        st.size = size_;
+        st.slots = meta_.size();
+        st.loadFactor = loadFactor();
+        st.rehashCount = rehashCount_;
+        st.slotBytes = meta_.size() * slotBytes();
+        std::size_t hitProbes = 0, missProbes = 0;
+        for (std::size_t i = 0; i < meta_.size(); ++i) {
+            const std::uint32_t d = meta_[i].dist;
+            if (d == 0) ++st.emptySlots;
+            if (d >= st.probeHistogram.size()) st.probeHistogram.resize(d + 1, 0);
+            if (d) ++st.probeHistogram[d];
+            st.longestProbe = std::max<std::size_t>(st.longestProbe, d);
+            hitProbes += d;
+            std::uint32_t probes = 1;
+            for (std::size_t j = i; meta_[j].dist >= probes; j = next(j)) ++probes;
+            missProbes += probes;
+        }
+        if (size_ > 0) st.avgProbesHit = static_cast<double>(hitProbes) / static_cast<double>(size_);
+        st.avgProbesMiss = static_cast<double>(missProbes) / static_cast<double>(meta_.size());
+        return st;
+    }
+
+private:
+    /**
+     * Entry - Key-value pair stored inline in a slot
+     */
+    struct Entry {
+        std::string key;
+        T value;
+
+        template <typename K, typename... Args>
+        Entry(K &&k, Args &&...args) : key(std::forward<K>(k)), value(std::forward<Args>(args)...) {}
+    };
+
+    /**
+     * Meta - Per-slot probe distance (0 = empty, 1 = home slot) and hash bits
+     */
+    struct Meta {
+        std::uint32_t dist;
+        std::uint32_t tag;
+    };
+
+    /** Result of walking a key's probe sequence */
+    struct Probe {
+        std::size_t slot;     // Slot holding the key, or where it would be inserted
+        std::uint32_t dist;   // Probe distance at `slot`
+        bool found;
+    };
+
+    static constexpr std::size_t kMinCapacity = 8;
+
+    std::vector<Meta> meta_;
+    Entry *entries_ {nullptr};     // Raw storage; only slots with dist != 0 are constructed
+    unsigned shift_ {32};          // 32 - log2(capacity)
+    std::size_t size_ {0};
+    std::size_t rehashCount_ {0};
+
+    /** Smallest power-of-two capacity holding `count` entries under kMaxLoadFactor */
+    static std::size_t capacityFor(std::size_t count) {
+        std::size_t cap = kMinCapacity;
+        while (static_cast<double>(count) > static_cast<double>(cap) * kMaxLoadFactor) cap *= 2;
+        return cap;
+    }
+
+    /** Top 32 bits of the Fibonacci-mixed std::hash (home slot = tag >> shift_) */
+    static std::uint32_t tagOf(const std::string &key) {
+        std::uint64_t h = static_cast<std::uint64_t>(std::hash<std::string>{}(key));
+        return static_cast<std::uint32_t>((h * 0x9E3779B97F4A7C15ULL) >> 32);
+    }
+
+    std::size_t home(std::uint32_t tag) const { return tag >> shift_; }
+    std::size_t next(std::size_t i) const { return (i + 1) & (meta_.size() - 1); }
+
+    /**
+     * Walk a key's probe sequence until the key is found or a slot whose
+     * occupant is closer to home than the probe (or empty) is reached
+     */
+    Probe probe(const std::string &key, std::uint32_t tag) const {
+        std::size_t i = home(tag);
+        for (std::uint32_t d = 1; ; ++d, i = next(i)) {
+            const Meta &m = meta_[i];
+            if (m.dist < d) return {i, d, false};
+            if (m.dist == d && m.tag == tag && entries_[i].key == key) return {i, d, true};
+        }
+    }
+
+    /**
+     * Shared implementation of insert/emplace/try_emplace
+     */
+    template <typename K, typename... Args>
+    std::pair<T*, bool> emplaceImpl(K &&key, bool assign, Args &&...args) {
+        const std::uint32_t tag = tagOf(key);
+        Probe p = probe(key, tag);
+        if (p.found) {
+            if (assign) assignValue(entries_[p.slot].value, std::forward<Args>(args)...);
+            return {&entries_[p.slot].value, false};
+        }
+        // Build the entry first so a throwing constructor leaves the table intact
+        Entry e(std::forward<K>(key), std::forward<Args>(args)...);
+        if (static_cast<double>(size_ + 1) > static_cast<double>(meta_.size()) * kMaxLoadFactor) {
+            rehash(meta_.size() * 2);
+            p = probe(e.key, tag);
+        }
+        ++size_;
+        return {&place(p.slot, p.dist, tag, std::move(e)), true};
+    }
+
+    /**
+     * Store an entry at `slot` (its Robin Hood position), first shifting the
+     * rest of the run forward one slot if `slot` is occupied
+     */
+    T &place(std::size_t slot, std::uint32_t dist, std::uint32_t tag, Entry &&e) {
+        if (meta_[slot].dist != 0) {
+            std::size_t j = slot;
+            while (meta_[j].dist != 0) j = next(j);
+            const std::size_t mask = meta_.size() - 1;
+            for (; j != slot; j = (j - 1) & mask) {
+                std::size_t prev = (j - 1) & mask;
+                new (&entries_[j]) Entry(std::move(entries_[prev]));
+                entries_[prev].~Entry();
+                meta_[j] = meta_[prev];
+                ++meta_[j].dist;
+            }
+        }
+        new (&entries_[slot]) Entry(std::move(e));
+        meta_[slot] = Meta{dist, tag};
+        return entries_[slot].value;
+    }
+
+    static void assignValue(T &dst, const T &src) { dst = src; }
+    static void assignValue(T &dst, T &&src) { dst = std::move(src); }
+    template <typename... Args>
+    static void assignValue(T &dst, Args &&...args) { dst = T(std::forward<Args>(args)...); }
+
+    /**
+     * Move every entry into a table of `capacity` slots
+     *
+     * Home slots come from the stored hash bits, so keys are not rehashed.
+     * Each entry is placed exactly as an insert would place it.
+     */
+    void rehash(std::size_t capacity) {
+        std::vector<Meta> oldMeta;
+        oldMeta.swap(meta_);
+        Entry *oldEntries = entries_;
+        const std::size_t oldCap = oldMeta.size();
+        allocate(capacity);
+        for (std::size_t i = 0; i < oldCap; ++i) {
+            if (oldMeta[i].dist == 0) continue;
+            const std::uint32_t tag = oldMeta[i].tag;
+            std::size_t s = home(tag);
+            std::uint32_t d = 1;
+            while (meta_[s].dist >= d) { s = next(s); ++d; }
+            place(s, d, tag, std::move(oldEntries[i]));
+            oldEntries[i].~Entry();
+        }
+        std::allocator<Entry>().deallocate(oldEntries, oldCap);
+        ++rehashCount_;
+    }
+
+    void allocate(std::size_t capacity) {
+        entries_ = std::allocator<Entry>().allocate(capacity);
+        meta_.assign(capacity, Meta{0, 0});
+        unsigned bits = 0;
+        while ((std::size_t(1) << bits) < capacity) ++bits;
+        shift_ = 32 - bits;
+    }
+
+    void deallocate() {
+        if (entries_) std::allocator<Entry>().deallocate(entries_, meta_.size());
+        entries_ = nullptr;
+    }
+
+    void destroyAll() {
+        for (std::size_t i = 0; i < meta_.size(); ++i) {
+            if (meta_[i].dist) { entries_[i].~Entry(); meta_[i].dist = 0; }
+        }
+    }
+
+    void swap(RobinHoodTable &o) noexcept {
+        meta_.swap(o.meta_);
+        std::swap(entries_, o.entries_);
+        std::swap(shift_, o.shift_);
+        std::swap(size_, o.size_);
+        std::swap(rehashCount_, o.rehashCount_);
+    }
+};
+
+} // namespace inv
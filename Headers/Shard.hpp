@@ -0,0 +1,334 @@
+/**
+ * Shard.hpp
+ *
+ * Hash-partitioned catalog served by several engine processes.
+ *
+ * Each shard process runs an Engine that loads only the products whose Uniq
+ * Id hashes to it (Engine::setShard, ShardFilter) and answers commands on a
+ * socket (ShardServer). A coordinator (ShardRouter) presents the same command
+ * interface as a single Engine:
+ * - `find <id>` goes to the one shard owning the id
+ * - `listInventory <category>` is sent to every shard; the per-shard lists
+ *   are merged back into source-file order using each product's record
+ *   number, so the output matches an unpartitioned engine
+ * - `:tablestats`, `:memory` and `:stats` are sent to every shard and the
+ *   reports are printed one after another
+ *
+ * Endpoints are "unix:<path>" (Unix domain socket) or "<host>:<port>" (TCP,
+ * IPv4; "localhost" means 127.0.0.1), so a whole cluster can run as local
+ * processes on one host.
+ *
+ * Wire format (one request at a time per connection):
+ * - request: the command line followed by '\n'
+ * - reply:   the output's length in decimal, '\n', then exactly that many
+ *            bytes of output
+ * Besides the REPL commands, shards answer `:shardlist <category>` with one
+ * "<record number> <id> - <name>" line per product (or "Invalid Category");
+ * the router uses it for merging.
+ *
+ * Usage:
+ *   shard k: engine.setShard(k, N); engine.load(csv);
+ *            server.listen("unix:/tmp/inv-k.sock"); server.serve(engine);
+ *   router:  inv::ShardRouter r; r.connect({"unix:/tmp/inv-0.sock", ...});
+ *            r.evalCommand("find <id>", std::cout);
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "Engine.hpp"
+#include "Net.hpp"
+
+namespace inv {
+
+/**
+ * ShardServer - Serves one engine's commands on a socket
+ *
+ * serve() accepts connections until stop() and answers each on its own
+ * thread; Engine::evalCommand is safe to call concurrently.
+ */
+class ShardServer {
+public:
+    ShardServer() = default;
+    ~ShardServer() { stop(); }
+    ShardServer(const ShardServer &) = delete;
+    ShardServer &operator=(const ShardServer &) = delete;
+
+    /**
+     * Bind and listen (a stale Unix socket file at the path is replaced)
+     *
+     * @param endpoint "unix:<path>" or "<host>:<port>" (port 0 = any free port)
+     * @return false if the endpoint cannot be bound
+     */
+    bool listen(const std::string &endpoint) {
+        int fd = net::listenOn(endpoint, endpoint_, unixPath_);
+        if (fd < 0) return false;
+        listenFd_ = fd;
+        return true;
+    }
+
+    /** Endpoint clients should connect to (with the actual port if 0 was given) */
+    const std::string &endpoint() const { return endpoint_; }
+
+    /**
+     * Accept and answer connections until stop()
+     *
+     * @param engine Engine to evaluate commands on (must outlive serve())
+     */
+    void serve(const Engine &engine) {
+        for (;;) {
+            int fd = ::accept4(listenFd_, nullptr, nullptr, SOCK_CLOEXEC);
+            if (fd < 0) {
+                if (stopping_ || errno != EINTR) break;
+                continue;
+            }
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (stopping_) { ::close(fd); break; }
+            clients_.push_back(fd);
+            workers_.emplace_back([this, fd, &engine]() { handle(fd, engine); });
+        }
+        std::vector<std::thread> workers;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            workers.swap(workers_);
+        }
+        for (auto &w : workers) w.join();
+    }
+
+    /**
+     * Stop accepting, close client connections and unblock serve()
+     * Safe to call from any thread (including a signal-driven one).
+     */
+    void stop() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_ || listenFd_ < 0) return;
+        stopping_ = true;
+        ::shutdown(listenFd_, SHUT_RDWR);
+        for (int fd : clients_) ::shutdown(fd, SHUT_RDWR);
+        ::close(listenFd_);
+        if (!unixPath_.empty()) ::unlink(unixPath_.c_str());
+    }
+
+    /**
+     * The reply a shard gives to one command line (also used in-process)
+     *
+     * @param engine Engine holding this shard's products
+     * @param line Command line
+     * @return Output bytes
+     */
+    static std::string evaluate(const Engine &engine, const std::string &line) {
+        std::ostringstream out;
+        if (line.compare(0, 11, ":shardlist ") == 0) {
+            std::string category = detail::trim(line.substr(11));
+            bool found = engine.forEachInCategory(category, [&](const std::string &id, const Product &p) {
+                out << p.recordIndex << ' ' << id << " - " << p.productName << '\n';
+            });
+            if (!found) out << "Invalid Category" << '\n';
+        } else if (Engine::validCommand(line)) {
+            engine.evalCommand(line, out);
+        } else {
+            out << "Command not supported. Enter :help for list of supported commands" << '\n';
+        }
+        return out.str();
+    }
+
+private:
+    std::atomic<int> listenFd_ {-1};
+    std::string endpoint_;
+    std::string unixPath_;
+    std::mutex mutex_;
+    bool stopping_ {false};
+    std::vector<int> clients_;
+    std::vector<std::thread> workers_;
+
+    void handle(int fd, const Engine &engine) {
+        net::Reader in(fd);
+        std::string line;
+        while (in.line(line)) {
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            if (!net::sendReply(fd, evaluate(engine, line))) break;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        clients_.erase(std::remove(clients_.begin(), clients_.end(), fd), clients_.end());
+        ::close(fd);
+    }
+};
+
+/**
+ * ShardRouter - Coordinator presenting N shards as one engine
+ *
+ * Holds one connection per shard. evalCommand() may be called from several
+ * threads: a `find` locks only the owning shard's connection; scatter
+ * commands lock every connection (in shard order), send all requests first
+ * and then collect the replies, so the shards work in parallel.
+ */
+class ShardRouter {
+public:
+    /**
+     * Connect to every shard; shard k must have been loaded with
+     * setShard(k, endpoints.size())
+     *
+     * @param endpoints Shard endpoints in shard order
+     * @return false if any shard is unreachable
+     */
+    bool connect(const std::vector<std::string> &endpoints) {
+        shards_.clear();
+        for (const auto &e : endpoints) {
+            std::unique_ptr<Shard> s(new Shard());
+            s->endpoint = e;
+            if (!s->reconnect()) { shards_.clear(); return false; }
+            shards_.push_back(std::move(s));
+        }
+        return !shards_.empty();
+    }
+
+    /** Number of shards */
+    std::size_t shardCount() const { return shards_.size(); }
+
+    /** Split a comma-separated endpoint list */
+    static std::vector<std::string> parseEndpoints(const std::string &list) {
+        std::vector<std::string> out;
+        std::string item;
+        std::istringstream in(list);
+        while (std::getline(in, item, ',')) if (!item.empty()) out.push_back(item);
+        return out;
+    }
+
+    /**
+     * Evaluate a REPL command across the shards
+     *
+     * @param line User input command (as accepted by Engine::validCommand)
+     * @param out Stream that receives the merged output
+     */
+    void evalCommand(const std::string &line, std::ostream &out) const {
+        if (line == ":help") {
+            Engine::printHelp(out);
+        } else if (line.rfind("find", 0) == 0) {
+            auto pos = line.find(' ');
+            std::string id = pos == std::string::npos ? std::string() : detail::trim(line.substr(pos + 1));
+            if (id.empty()) { out << "Inventory not found" << '\n'; return; }
+            Shard &s = *shards_[ShardFilter::shardOf(id, shards_.size())];
+            std::lock_guard<std::mutex> lock(s.mutex);
+            std::string reply;
+            if (s.request("find " + id, reply)) out << reply;
+            else out << "Shard unavailable: " << s.endpoint << '\n';
+        } else if (line.rfind("listInventory", 0) == 0) {
+            auto pos = line.find(' ');
+            std::string category = pos == std::string::npos ? std::string() : detail::trim(line.substr(pos + 1));
+            if (category.empty()) { out << "Invalid Category" << '\n'; return; }
+            listInventory(category, out);
+        } else {
+            // :tablestats, :memory, :stats - one report per shard
+            std::vector<std::string> replies = scatter(line);
+            for (std::size_t k = 0; k < shards_.size(); ++k) {
+                out << "Shard " << k << " (" << shards_[k]->endpoint << "):" << '\n';
+                out << replies[k];
+            }
+        }
+    }
+
+private:
+    struct Shard {
+        std::string endpoint;
+        int fd {-1};
+        std::unique_ptr<net::Reader> in;
+        std::mutex mutex;
+
+        ~Shard() { if (fd >= 0) ::close(fd); }
+
+        bool reconnect() {
+            if (fd >= 0) ::close(fd);
+            fd = net::connectTo(endpoint);
+            in.reset(new net::Reader(fd));
+            return fd >= 0;
+        }
+
+        bool send(const std::string &line) {
+            std::string msg = line + "\n";
+            if (fd >= 0 && net::sendAll(fd, msg.data(), msg.size())) return true;
+            // One reconnect attempt (e.g. after the shard restarted)
+            return reconnect() && net::sendAll(fd, msg.data(), msg.size());
+        }
+
+        bool receive(std::string &reply) {
+            if (fd >= 0 && net::receiveReply(*in, reply)) return true;
+            if (fd >= 0) { ::close(fd); fd = -1; }
+            return false;
+        }
+
+        bool request(const std::string &line, std::string &reply) {
+            if (send(line) && receive(reply)) return true;
+            return send(line) && receive(reply);  // Connection was stale
+        }
+    };
+
+    std::vector<std::unique_ptr<Shard>> shards_;
+
+    /**
+     * Send line to every shard, then collect every reply
+     * (an unreachable shard contributes a one-line notice)
+     */
+    std::vector<std::string> scatter(const std::string &line) const {
+        std::vector<std::unique_lock<std::mutex>> locks;
+        for (auto &s : shards_) locks.emplace_back(s->mutex);
+        std::vector<char> sent(shards_.size());
+        for (std::size_t k = 0; k < shards_.size(); ++k) sent[k] = shards_[k]->send(line);
+        std::vector<std::string> replies(shards_.size());
+        for (std::size_t k = 0; k < shards_.size(); ++k) {
+            if (!sent[k] || !shards_[k]->receive(replies[k])) {
+                replies[k] = "Shard unavailable: " + shards_[k]->endpoint + "\n";
+            }
+        }
+        return replies;
+    }
+
+    /**
+     * Scatter `:shardlist`, then merge the per-shard lists by record number
+     * (ties, i.e. the same record listed twice, keep shard order)
+     */
+    void listInventory(const std::string &category, std::ostream &out) const {
+        struct Item { std::uint64_t record; std::size_t shard; std::string text; };
+        std::vector<Item> items;
+        std::vector<std::string> replies = scatter(":shardlist " + category);
+        bool found = false;
+        for (std::size_t k = 0; k < replies.size(); ++k) {
+            std::istringstream in(replies[k]);
+            std::string row;
+            while (std::getline(in, row)) {
+                auto sp = row.find(' ');
+                if (row.empty() || !std::isdigit(static_cast<unsigned char>(row[0])) || sp == std::string::npos) {
+                    if (row.rfind("Shard unavailable", 0) == 0) out << row << '\n';
+                    continue;  // "Invalid Category": nothing from this shard
+                }
+                found = true;
+                items.push_back(Item {std::strtoull(row.c_str(), nullptr, 10), k, row.substr(sp + 1)});
+            }
+        }
+        if (!found) { out << "Invalid Category" << '\n'; return; }
+        std::stable_sort(items.begin(), items.end(), [](const Item &a, const Item &b) {
+            return a.record != b.record ? a.record < b.record : a.shard < b.shard;
+        });
+        for (const auto &it : items) out << it.text << '\n';
+    }
+};
+
+} // namespace inv
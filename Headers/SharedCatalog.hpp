@@ -0,0 +1,362 @@
+/**
+ * SharedCatalog.hpp
+ *
+ * Catalog shared by many query processes through POSIX shared memory.
+ *
+ * One loader process parses the CSV and publishes the catalog; every query
+ * process attaches read-only and serves lookups straight from the shared
+ * pages, so a box running 16 query processes holds one copy of the products
+ * and category index instead of 16 private heaps.
+ *
+ * Segments (derived from a base name such as "/inv_catalog"):
+ * - "<name>": control block holding the published generation number
+ * - "<name>.<g>": generation g's catalog, laid out as a MappedHashTable file
+ *   (product table image + category index image, see packMappedImages())
+ *
+ * Generation swap:
+ * 1. The loader fills a new segment "<name>.<g>" completely.
+ * 2. It stores g into the control block (an atomic in the shared mapping,
+ *    release order), so the new data is visible in one step.
+ * 3. It unlinks the previous generation's name.
+ * Readers compare the control generation with the one they hold before each
+ * command (one atomic load) and map the new segment when it has changed, so
+ * running processes pick up new data without a restart. A reader still
+ * holding the previous generation keeps its mapping; the kernel frees the
+ * segment once the last mapping is gone.
+ *
+ * On systems without POSIX shared memory, publishing and attaching fail.
+ *
+ * Usage:
+ *   loader:  inv::publishSharedCatalog("/inv_catalog", bytes);
+ *   queries: inv::SharedCatalogReader r;
+ *            if (r.attach("/inv_catalog")) auto cat = r.current();
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "MappedFile.hpp"
+#include "MappedHashTable.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define INV_HAVE_SHM 1
+#endif
+
+namespace inv {
+
+/**
+ * MappedCatalog - One immutable generation of a mapped catalog
+ *
+ * Views of the product table and category index plus whatever keeps their
+ * bytes alive (a file mapping or a shared-memory mapping). Held through
+ * std::shared_ptr, so a generation stays mapped while any command still
+ * uses it.
+ */
+struct MappedCatalog {
+    std::uint64_t generation {0};                        // 0 for catalog files
+    MappedHashTable<Product> products;                   // Uniq Id -> Product
+    MappedHashTable<std::vector<std::string>> categories; // Category -> Uniq Ids
+    std::size_t heapBytes {0};                           // Heap copy if the file could not be mmapped
+    std::shared_ptr<void> storage;                       // Owner of the mapped bytes
+
+    /**
+     * View the two images of a catalog laid out by packMappedImages()
+     *
+     * @return false if the bytes are not a valid catalog
+     */
+    bool attach(const char *data, std::size_t size) {
+        const char *img;
+        std::size_t bytes;
+        return mappedImage(data, size, 0, img, bytes) && products.attach(img, bytes) &&
+               mappedImage(data, size, 1, img, bytes) && categories.attach(img, bytes);
+    }
+
+    /**
+     * Map a catalog file written by Engine::saveCatalog()
+     *
+     * @param path Catalog file
+     * @return The catalog, or nullptr if the file is missing or invalid
+     */
+    static std::shared_ptr<MappedCatalog> openFile(const std::string &path) {
+        std::shared_ptr<MappedFile> file = std::make_shared<MappedFile>();
+        std::shared_ptr<MappedCatalog> cat = std::make_shared<MappedCatalog>();
+        if (!file->open(path) || !cat->attach(file->data(), file->size())) return nullptr;
+        cat->heapBytes = file->heapBytes();
+        cat->storage = file;
+        return cat;
+    }
+};
+
+namespace shm {
+
+constexpr char kControlMagic[8] = {'I', 'N', 'V', 'S', 'H', 'M', '0', '1'};
+
+/**
+ * Control block at the start of the "<name>" segment
+ * The counters are lock-free atomics, so they work across processes.
+ */
+struct Control {
+    char magic[8];
+    std::atomic<std::uint64_t> generation;     // Published generation (0 = none yet)
+    std::atomic<std::uint64_t> lastAssigned;   // Last generation number handed to a loader
+};
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "shared-memory generations need lock-free 64-bit atomics");
+
+/** POSIX shared memory names start with a single '/' */
+inline std::string normalize(const std::string &name) {
+    return name.empty() || name[0] != '/' ? "/" + name : name;
+}
+
+inline std::string segmentName(const std::string &name, std::uint64_t generation) {
+    return normalize(name) + "." + std::to_string(generation);
+}
+
+/**
+ * Mapping - RAII mmap of a shared-memory object
+ */
+class Mapping {
+public:
+    Mapping() = default;
+    ~Mapping() { close(); }
+    Mapping(const Mapping &) = delete;
+    Mapping &operator=(const Mapping &) = delete;
+
+    /**
+     * Map an existing object
+     *
+     * @param name Object name
+     * @param writable Map read-write instead of read-only
+     * @return false if the object does not exist or cannot be mapped
+     */
+    bool open(const std::string &name, bool writable) {
+        close();
+#ifdef INV_HAVE_SHM
+        int fd = ::shm_open(name.c_str(), writable ? O_RDWR : O_RDONLY, 0);
+        if (fd < 0) return false;
+        struct stat st;
+        bool ok = ::fstat(fd, &st) == 0 && st.st_size > 0 && map(fd, static_cast<std::size_t>(st.st_size), writable);
+        ::close(fd);
+        return ok;
+#else
+        (void)name; (void)writable;
+        return false;
+#endif
+    }
+
+    /**
+     * Create a new object of the given size and map it read-write
+     *
+     * @return false if the object already exists or cannot be created
+     */
+    bool create(const std::string &name, std::size_t size) {
+        close();
+#ifdef INV_HAVE_SHM
+        int fd = ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+        if (fd < 0) return false;
+        bool ok = ::ftruncate(fd, static_cast<off_t>(size)) == 0 && map(fd, size, true);
+        ::close(fd);
+        if (!ok) ::shm_unlink(name.c_str());
+        return ok;
+#else
+        (void)name; (void)size;
+        return false;
+#endif
+    }
+
+    /** Unmap (the object itself persists until unlinked) */
+    void close() {
+#ifdef INV_HAVE_SHM
+        if (data_) ::munmap(data_, size_);
+#endif
+        data_ = nullptr;
+        size_ = 0;
+    }
+
+    char *data() const { return static_cast<char *>(data_); }
+    std::size_t size() const { return size_; }
+
+private:
+    void *data_ {nullptr};
+    std::size_t size_ {0};
+
+#ifdef INV_HAVE_SHM
+    bool map(int fd, std::size_t size, bool writable) {
+        void *p = ::mmap(nullptr, size, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+        if (p == MAP_FAILED) return false;
+        data_ = p;
+        size_ = size;
+        return true;
+    }
+#endif
+};
+
+/** Remove an object's name (existing mappings stay valid) */
+inline void unlink(const std::string &name) {
+#ifdef INV_HAVE_SHM
+    ::shm_unlink(name.c_str());
+#else
+    (void)name;
+#endif
+}
+
+/**
+ * Map the control block, creating it if it does not exist yet
+ */
+inline bool openControl(Mapping &m, const std::string &name, bool writable) {
+    if (m.open(name, writable)) {
+        return m.size() >= sizeof(Control) && std::memcmp(m.data(), kControlMagic, sizeof kControlMagic) == 0;
+    }
+    if (!writable || !m.create(name, sizeof(Control))) return false;
+    Control *c = new (m.data()) Control;
+    c->generation.store(0);
+    c->lastAssigned.store(0);
+    std::memcpy(c->magic, kControlMagic, sizeof kControlMagic);
+    return true;
+}
+
+} // namespace shm
+
+/**
+ * publishSharedCatalog - Publish catalog bytes as the next generation
+ *
+ * @param name Base name of the segments (e.g. "/inv_catalog")
+ * @param bytes Catalog laid out by packMappedImages()
+ * @param generation Receives the published generation number
+ * @return false if shared memory is unavailable, a segment could not be
+ *         created, or a newer generation was published concurrently
+ *
+ * Time Complexity: O(bytes)
+ */
+inline bool publishSharedCatalog(const std::string &name, const std::string &bytes, std::uint64_t *generation = nullptr) {
+    shm::Mapping control;
+    if (!shm::openControl(control, shm::normalize(name), true)) return false;
+    shm::Control *c = reinterpret_cast<shm::Control *>(control.data());
+
+    const std::uint64_t g = c->lastAssigned.fetch_add(1) + 1;
+    const std::string segment = shm::segmentName(name, g);
+    {
+        shm::Mapping data;
+        if (!data.create(segment, bytes.size())) return false;
+        std::memcpy(data.data(), bytes.data(), bytes.size());
+    }
+
+    // Only move forward: a slower concurrent loader must not roll back
+    std::uint64_t prev = c->generation.load(std::memory_order_acquire);
+    while (prev < g && !c->generation.compare_exchange_weak(prev, g, std::memory_order_acq_rel)) {}
+    if (prev > g) {
+        shm::unlink(segment);
+        return false;
+    }
+    if (prev != 0) shm::unlink(shm::segmentName(name, prev));
+    if (generation) *generation = g;
+    return true;
+}
+
+/**
+ * removeSharedCatalog - Unlink the control block and the current generation
+ * Attached readers keep serving the generation they have mapped.
+ *
+ * @param name Base name of the segments
+ */
+inline void removeSharedCatalog(const std::string &name) {
+    shm::Mapping control;
+    if (shm::openControl(control, shm::normalize(name), false)) {
+        const shm::Control *c = reinterpret_cast<const shm::Control *>(control.data());
+        std::uint64_t g = c->generation.load(std::memory_order_acquire);
+        if (g != 0) shm::unlink(shm::segmentName(name, g));
+    }
+    shm::unlink(shm::normalize(name));
+}
+
+/**
+ * SharedCatalogReader - Read-only attachment to a published catalog
+ *
+ * current() is safe to call from any number of threads: the common case is
+ * one atomic load of the control generation plus a shared_ptr copy; after a
+ * swap the first caller maps the new generation under a mutex.
+ */
+class SharedCatalogReader {
+public:
+    /** Retries when a generation is unlinked between reading its number and opening it */
+    static constexpr int kMaxAttempts = 8;
+
+    SharedCatalogReader() = default;
+    SharedCatalogReader(const SharedCatalogReader &) = delete;
+    SharedCatalogReader &operator=(const SharedCatalogReader &) = delete;
+
+    /**
+     * Attach to a published catalog
+     *
+     * @param name Base name given to publishSharedCatalog()
+     * @return false if no catalog has been published under that name
+     */
+    bool attach(const std::string &name) {
+        name_ = name;
+        if (!shm::openControl(control_, shm::normalize(name), false)) return false;
+        controlBlock_ = reinterpret_cast<const shm::Control *>(control_.data());
+        return current() != nullptr;
+    }
+
+    /**
+     * The newest published generation (mapping it first if it changed)
+     *
+     * @return Catalog to serve from, or nullptr if nothing could be mapped;
+     *         if the newest generation cannot be mapped, the previous one
+     *         is returned
+     */
+    std::shared_ptr<const MappedCatalog> current() const {
+        if (!controlBlock_) return nullptr;
+        const std::uint64_t g = controlBlock_->generation.load(std::memory_order_acquire);
+        std::shared_ptr<const MappedCatalog> cur = std::atomic_load(&current_);
+        if (cur && cur->generation == g) return cur;
+        return reload();
+    }
+
+    /** Generation currently served (0 if none) */
+    std::uint64_t generation() const {
+        std::shared_ptr<const MappedCatalog> cur = std::atomic_load(&current_);
+        return cur ? cur->generation : 0;
+    }
+
+private:
+    std::string name_;
+    shm::Mapping control_;
+    const shm::Control *controlBlock_ {nullptr};
+    mutable std::mutex reloadMutex_;
+    mutable std::shared_ptr<const MappedCatalog> current_;  // Accessed with std::atomic_load/store
+
+    std::shared_ptr<const MappedCatalog> reload() const {
+        std::lock_guard<std::mutex> lock(reloadMutex_);
+        for (int attempt = 0; attempt < kMaxAttempts; ++attempt) {
+            const std::uint64_t g = controlBlock_->generation.load(std::memory_order_acquire);
+            std::shared_ptr<const MappedCatalog> cur = std::atomic_load(&current_);
+            if (g == 0 || (cur && cur->generation == g)) return cur;
+
+            std::shared_ptr<shm::Mapping> data = std::make_shared<shm::Mapping>();
+            if (!data->open(shm::segmentName(name_, g), false)) continue;  // Superseded meanwhile
+            std::shared_ptr<MappedCatalog> next = std::make_shared<MappedCatalog>();
+            if (!next->attach(data->data(), data->size())) continue;
+            next->generation = g;
+            next->storage = data;
+            std::atomic_store(&current_, std::shared_ptr<const MappedCatalog>(next));
+            return next;
+        }
+        return std::atomic_load(&current_);
+    }
+};
+
+} // namespace inv
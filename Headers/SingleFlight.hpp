@@ -0,0 +1,157 @@
+/**
+ * SingleFlight.hpp
+ *
+ * Coalescing of identical concurrent queries.
+ *
+ * When many threads ask for the same output at once (e.g. dozens of clients
+ * of a --serve process sending `listInventory` for one hot category within a
+ * millisecond), the first one computes it and the others wait for that
+ * computation and share its result buffer instead of repeating the scan.
+ * Only calls that overlap are coalesced: once the computation finishes its
+ * key is forgotten, so a later call computes again (pair with ResultCache
+ * to keep results).
+ *
+ * Calls are keyed by the normalized command and the dataset generation they
+ * run against, so a caller never receives output computed from a different
+ * generation than the one it pinned.
+ *
+ * Layout: 16 independently locked shards picked by the key's 64-bit hash,
+ * each mapping key -> in-flight call. Waiters block on the call's own
+ * condition variable, so the shard lock is held only to join or leave.
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "MappedHashTable.hpp"
+
+namespace inv {
+
+/**
+ * SingleFlightStats - Counters of a SingleFlight
+ */
+struct SingleFlightStats {
+    std::uint64_t computed {0};  // Calls that ran the computation
+    std::uint64_t shared {0};    // Calls that waited for another's result
+};
+
+/**
+ * SingleFlight - Runs one computation per key at a time and shares its result
+ *
+ * Thread Safety: all methods may be called concurrently.
+ */
+class SingleFlight {
+public:
+    static constexpr std::size_t kShards = 16;
+
+    SingleFlight() = default;
+    SingleFlight(const SingleFlight &) = delete;
+    SingleFlight &operator=(const SingleFlight &) = delete;
+
+    /**
+     * Return compute()'s result, joining an identical call in flight
+     *
+     * @param key Normalized command
+     * @param generation Dataset generation the result is computed from
+     * @param compute Called as compute() -> std::string if no identical
+     *        call is in flight; an exception it throws is rethrown to every
+     *        caller sharing the call
+     * @param leader Set to true if this call ran compute()
+     * @return The shared output
+     *
+     * Time Complexity: O(1) average plus compute() or the wait for it
+     */
+    template <typename F>
+    std::shared_ptr<const std::string> run(const std::string &key, std::uint64_t generation, F compute,
+                                           bool *leader = nullptr) {
+        std::uint64_t h = mapped::hashKey(key.data(), key.size());
+        Shard &s = shards_[h >> 60];
+        std::shared_ptr<Call> call;
+        bool lead = false;
+        {
+            std::lock_guard<std::mutex> lock(s.mutex);
+            auto it = s.calls.find(key);
+            if (it != s.calls.end() && it->second->generation == generation) {
+                call = it->second;
+                ++s.shared;
+            } else {
+                // None in flight, or one for another generation (which keeps
+                // running for its own callers but is no longer joinable)
+                call = std::make_shared<Call>();
+                call->generation = generation;
+                s.calls[key] = call;
+                ++s.computed;
+                lead = true;
+            }
+        }
+        if (leader) *leader = lead;
+
+        if (!lead) {
+            std::unique_lock<std::mutex> lock(call->mutex);
+            call->finished.wait(lock, [&]() { return call->done; });
+            if (call->error) std::rethrow_exception(call->error);
+            return call->result;
+        }
+
+        std::shared_ptr<const std::string> result;
+        std::exception_ptr error;
+        try {
+            result = std::make_shared<const std::string>(compute());
+        } catch (...) {
+            error = std::current_exception();
+        }
+        {
+            std::lock_guard<std::mutex> lock(s.mutex);
+            auto it = s.calls.find(key);
+            if (it != s.calls.end() && it->second == call) s.calls.erase(it);
+        }
+        {
+            std::lock_guard<std::mutex> lock(call->mutex);
+            call->result = result;
+            call->error = error;
+            call->done = true;
+        }
+        call->finished.notify_all();
+        if (error) std::rethrow_exception(error);
+        return result;
+    }
+
+    /** Counters, summed over the shards */
+    SingleFlightStats stats() const {
+        SingleFlightStats st;
+        for (const auto &s : shards_) {
+            std::lock_guard<std::mutex> lock(s.mutex);
+            st.computed += s.computed;
+            st.shared += s.shared;
+        }
+        return st;
+    }
+
+private:
+    struct Call {
+        std::mutex mutex;
+        std::condition_variable finished;
+        std::uint64_t generation {0};
+        bool done {false};
+        std::shared_ptr<const std::string> result;
+        std::exception_ptr error;
+    };
+
+    struct Shard {
+        mutable std::mutex mutex;
+        std::unordered_map<std::string, std::shared_ptr<Call>> calls;  // In flight only
+        std::uint64_t computed {0};
+        std::uint64_t shared {0};
+    };
+
+    Shard shards_[kShards];
+};
+
+} // namespace inv
@@ -0,0 +1,133 @@
+/**
+ * SmallString.hpp
+ *
+ * Compact string for short Product fields.
+ *
+ * Prices, quantities, stock status and ASINs are almost always shorter than
+ * 24 bytes, but each std::string costs 32 bytes inline (plus a heap buffer
+ * past its 15-character SSO limit). SmallString is 24 bytes:
+ *
+ * - Up to 23 characters are stored inline. The last byte holds
+ *   `23 - length`, so a 23-character string's length byte doubles as its
+ *   terminating NUL and every inline string is NUL-terminated in place.
+ * - Longer strings spill to one heap buffer; the last byte is then kHeapTag
+ *   and the first 16 bytes hold the pointer and length.
+ *
+ * Only the operations Product needs are provided: construction/assignment
+ * from std::string and C strings, comparison, streaming, and conversion back
+ * to std::string.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <ostream>
+#include <string>
+
+namespace inv {
+
+/**
+ * SmallString - 24-byte string with 23 characters of inline capacity
+ */
+class SmallString {
+public:
+    /** Longest string stored without a heap allocation */
+    static constexpr std::size_t kInlineCapacity = 23;
+
+    SmallString() noexcept { setInline(0); }
+    SmallString(const char *s) { assign(s, std::strlen(s)); }
+    SmallString(const std::string &s) { assign(s.data(), s.size()); }
+    SmallString(const char *s, std::size_t n) { assign(s, n); }
+
+    SmallString(const SmallString &o) { assign(o.data(), o.size()); }
+    SmallString(SmallString &&o) noexcept {
+        std::memcpy(buf_, o.buf_, sizeof(buf_));
+        o.setInline(0);
+    }
+
+    ~SmallString() { release(); }
+
+    SmallString &operator=(const SmallString &o) {
+        if (this != &o) { release(); assign(o.data(), o.size()); }
+        return *this;
+    }
+    SmallString &operator=(SmallString &&o) noexcept {
+        if (this != &o) {
+            release();
+            std::memcpy(buf_, o.buf_, sizeof(buf_));
+            o.setInline(0);
+        }
+        return *this;
+    }
+    SmallString &operator=(const std::string &s) { release(); assign(s.data(), s.size()); return *this; }
+    SmallString &operator=(const char *s) { release(); assign(s, std::strlen(s)); return *this; }
+
+    /** Characters (NUL-terminated) */
+    const char *data() const { return isInline() ? buf_ : heapPtr(); }
+    const char *c_str() const { return data(); }
+
+    std::size_t size() const { return isInline() ? kInlineCapacity - static_cast<unsigned char>(buf_[kTagByte]) : heapSize(); }
+    bool empty() const { return size() == 0; }
+
+    /** true if the characters live inside the object (no heap buffer) */
+    bool isInline() const { return static_cast<unsigned char>(buf_[kTagByte]) != kHeapTag; }
+
+    /** Copy into a std::string */
+    std::string str() const { return std::string(data(), size()); }
+    operator std::string() const { return str(); }
+
+    friend bool operator==(const SmallString &a, const SmallString &b) { return equal(a, b.data(), b.size()); }
+    friend bool operator==(const SmallString &a, const std::string &b) { return equal(a, b.data(), b.size()); }
+    friend bool operator==(const std::string &a, const SmallString &b) { return equal(b, a.data(), a.size()); }
+    friend bool operator==(const SmallString &a, const char *b) { return equal(a, b, std::strlen(b)); }
+    friend bool operator!=(const SmallString &a, const SmallString &b) { return !(a == b); }
+    friend bool operator!=(const SmallString &a, const std::string &b) { return !(a == b); }
+    friend bool operator!=(const SmallString &a, const char *b) { return !(a == b); }
+
+    friend std::ostream &operator<<(std::ostream &out, const SmallString &s) {
+        return out.write(s.data(), static_cast<std::streamsize>(s.size()));
+    }
+
+private:
+    static constexpr std::size_t kTagByte = kInlineCapacity;
+    static constexpr unsigned char kHeapTag = 0xFF;
+
+    char buf_[kInlineCapacity + 1];
+
+    void setInline(std::size_t n) {
+        buf_[n] = '\0';
+        buf_[kTagByte] = static_cast<char>(kInlineCapacity - n);
+    }
+
+    char *heapPtr() const { char *p; std::memcpy(&p, buf_, sizeof(p)); return p; }
+    std::size_t heapSize() const { std::size_t n; std::memcpy(&n, buf_ + sizeof(char *), sizeof(n)); return n; }
+
+    /** Store n characters (the current contents must already be released) */
+    void assign(const char *s, std::size_t n) {
+        if (n <= kInlineCapacity) {
+            std::memcpy(buf_, s, n);
+            setInline(n);
+            return;
+        }
+        char *p = new char[n + 1];
+        std::memcpy(p, s, n);
+        p[n] = '\0';
+        std::memcpy(buf_, &p, sizeof(p));
+        std::memcpy(buf_ + sizeof(char *), &n, sizeof(n));
+        buf_[kTagByte] = static_cast<char>(kHeapTag);
+    }
+
+    void release() {
+        if (!isInline()) delete[] heapPtr();
+        setInline(0);
+    }
+
+    static bool equal(const SmallString &a, const char *s, std::size_t n) {
+        return a.size() == n && std::memcmp(a.data(), s, n) == 0;
+    }
+};
+
+static_assert(sizeof(SmallString) == 24, "SmallString must stay 24 bytes");
+
+} // namespace inv
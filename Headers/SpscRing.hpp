@@ -0,0 +1,155 @@
+/**
+ * SpscRing.hpp
+ *
+ * Bounded lock-free single-producer / single-consumer ring buffer.
+ *
+ * One thread pushes and one thread pops; neither ever takes a lock. The
+ * producer publishes a slot by advancing `tail_` with release ordering and
+ * the consumer frees one by advancing `head_`, so each side only reads the
+ * other's index to check for space or data (and caches the value it saw, so
+ * most operations touch no shared cache line at all).
+ *
+ * Backpressure: push() waits while the ring is full and pop() while it is
+ * empty, spinning briefly and then yielding the CPU. Both report how long
+ * they waited, which is how a pipeline tells a stage that is starved for
+ * input from one that is blocked by its consumer. The producer close()s the
+ * ring when it is done; pop() then drains what is left and returns false.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace inv {
+
+/**
+ * SpscRing<T> - Fixed-capacity FIFO between exactly two threads
+ *
+ * @tparam T Element type (moved in and out)
+ */
+template <typename T>
+class SpscRing {
+public:
+    /**
+     * @param capacity Minimum number of elements held (rounded up to a
+     *        power of two, at least 2)
+     */
+    explicit SpscRing(std::size_t capacity) {
+        std::size_t n = 2;
+        while (n < capacity) n <<= 1;
+        slots_.resize(n);
+        mask_ = n - 1;
+    }
+
+    SpscRing(const SpscRing &) = delete;
+    SpscRing &operator=(const SpscRing &) = delete;
+
+    /** Number of slots */
+    std::size_t capacity() const { return slots_.size(); }
+
+    /**
+     * Append v if there is room (producer only)
+     * @return false if the ring is full (v is left untouched)
+     */
+    bool tryPush(T &v) {
+        std::size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - headCache_ == slots_.size()) {
+            headCache_ = head_.load(std::memory_order_acquire);
+            if (tail - headCache_ == slots_.size()) return false;
+        }
+        slots_[tail & mask_] = std::move(v);
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Take the oldest element if there is one (consumer only)
+     * @return false if the ring is empty
+     */
+    bool tryPop(T &out) {
+        std::size_t head = head_.load(std::memory_order_relaxed);
+        if (head == tailCache_) {
+            tailCache_ = tail_.load(std::memory_order_acquire);
+            if (head == tailCache_) return false;
+        }
+        out = std::move(slots_[head & mask_]);
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Append v, waiting while the ring is full (producer only)
+     *
+     * @param v Element (moved from)
+     * @param waitedSec If given, receives the seconds spent waiting
+     * @param abandon If given, waiting stops (and v is dropped) once it is
+     *        set, for a consumer that quits without draining the ring
+     * @return false if abandoned
+     */
+    bool push(T v, double *waitedSec = nullptr, const std::atomic<bool> *abandon = nullptr) {
+        if (tryPush(v)) return true;
+        auto start = Clock::now();
+        bool pushed = true;
+        for (unsigned spins = 0; !tryPush(v); ++spins) {
+            if (abandon && abandon->load(std::memory_order_acquire)) { pushed = false; break; }
+            backoff(spins);
+        }
+        if (waitedSec) *waitedSec += std::chrono::duration<double>(Clock::now() - start).count();
+        return pushed;
+    }
+
+    /**
+     * Take the oldest element, waiting while the ring is empty and open
+     * (consumer only)
+     *
+     * @param out Receives the element
+     * @param waitedSec If given, receives the seconds spent waiting
+     * @return false once the ring is closed and drained
+     */
+    bool pop(T &out, double *waitedSec = nullptr) {
+        if (tryPop(out)) return true;
+        auto start = Clock::now();
+        bool got = false;
+        for (unsigned spins = 0;; ++spins) {
+            if (tryPop(out)) { got = true; break; }
+            if (closed_.load(std::memory_order_acquire)) {
+                got = tryPop(out);  // Pushed just before close()
+                break;
+            }
+            backoff(spins);
+        }
+        if (waitedSec) *waitedSec += std::chrono::duration<double>(Clock::now() - start).count();
+        return got;
+    }
+
+    /** No more pushes will follow (producer only) */
+    void close() { closed_.store(true, std::memory_order_release); }
+
+private:
+    using Clock = std::chrono::steady_clock;
+    static constexpr std::size_t kLine = 64;
+
+    std::vector<T> slots_;
+    std::size_t mask_ {0};
+    // Each index on its own cache line, next to the copy of the other
+    // index its owner caches
+    char pad0_[kLine];
+    std::atomic<std::size_t> head_ {0};  // Written by the consumer
+    std::size_t tailCache_ {0};          // Consumer's last view of tail_
+    char pad1_[kLine];
+    std::atomic<std::size_t> tail_ {0};  // Written by the producer
+    std::size_t headCache_ {0};          // Producer's last view of head_
+    char pad2_[kLine];
+    std::atomic<bool> closed_ {false};
+
+    static void backoff(unsigned spins) {
+        if (spins >= 64) std::this_thread::yield();
+    }
+};
+
+} // namespace inv
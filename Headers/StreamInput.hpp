@@ -0,0 +1,228 @@
+/**
+ * StreamInput.hpp
+ *
+ * Streaming CSV input from a file or a pipe, gunzipped on the fly.
+ *
+ * StreamInput opens a path ("-" is standard input) and starts a producer
+ * thread that reads it with read(2) and, if the bytes start with the gzip
+ * magic, decompresses them (gzip::Decoder). The producer hands 256 KiB
+ * blocks to the loading thread through an SpscRing, and stream() exposes
+ * them as a std::istream for loadCsv()/loadCsvPipelined(). Decompression
+ * therefore overlaps parsing, and neither a temporary uncompressed file nor
+ * the whole input is ever held in memory: at most kRingBlocks + 2 blocks
+ * are in flight.
+ *
+ *   stdin/file ──read(2)──> [gunzip] ──blocks──> istream ──> loadCsv
+ *        producer thread                       loading thread
+ *
+ * The stream just ends at the first read or decompression error; finish()
+ * joins the producer and reports it, so a truncated or corrupt feed is not
+ * mistaken for a short one.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <streambuf>
+#include <string>
+#include <thread>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "Gzip.hpp"
+#include "SpscRing.hpp"
+
+namespace inv {
+
+/**
+ * StreamInputStats - Where a streamed load spent its time
+ */
+struct StreamInputStats {
+    bool compressed {false};
+    std::uint64_t inputBytes {0};   // Bytes read from the file or pipe
+    std::uint64_t outputBytes {0};  // Bytes handed to the parser
+    double producerBusySec {0.0};   // Reading and decompressing
+    double producerBlockedSec {0.0};// Waiting for the parser to take a block
+    double consumerStarvedSec {0.0};// Parser waiting for the next block
+};
+
+/**
+ * isGzipFile - true if the file at path starts with the gzip magic bytes
+ */
+inline bool isGzipFile(const std::string &path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    char head[2];
+    ssize_t n = ::read(fd, head, sizeof(head));
+    ::close(fd);
+    return n == 2 && gzip::isGzip(head, 2);
+}
+
+/**
+ * StreamInput - A file or pipe as an istream fed by a producer thread
+ *
+ * Use: open(), load from stream(), then finish(). The destructor abandons
+ * an unfinished producer.
+ */
+class StreamInput {
+public:
+    /** Bytes per block handed to the parser */
+    static constexpr std::size_t kBlockBytes = 256 * 1024;
+
+    /** Blocks the ring holds */
+    static constexpr std::size_t kRingBlocks = 8;
+
+    StreamInput() : ring_(kRingBlocks), buf_(*this), stream_(&buf_) {}
+    StreamInput(const StreamInput &) = delete;
+    StreamInput &operator=(const StreamInput &) = delete;
+    ~StreamInput() { finish(); }
+
+    /**
+     * Open a file ("-" for standard input) and start the producer
+     * @return false if the file cannot be opened (see error())
+     */
+    bool open(const std::string &path) {
+        if (started_) return fail("already open");
+        if (path == "-") {
+            fd_ = 0;
+        } else {
+            fd_ = ::open(path.c_str(), O_RDONLY);
+            if (fd_ < 0) return fail("cannot open " + path);
+            ownsFd_ = true;
+        }
+        started_ = true;
+        producer_ = std::thread([this]() { produce(); });
+        return true;
+    }
+
+    /** The decompressed bytes (valid after open()) */
+    std::istream &stream() { return stream_; }
+
+    /**
+     * Stop reading and wait for the producer
+     * @return false if the input was unreadable, truncated or corrupt
+     */
+    bool finish() {
+        if (producer_.joinable()) {
+            abandon_.store(true, std::memory_order_release);
+            producer_.join();
+        }
+        if (ownsFd_) { ::close(fd_); ownsFd_ = false; }
+        return started_ && error_.empty();
+    }
+
+    /** Why open() or finish() failed */
+    const std::string &error() const { return error_; }
+
+    /** Counters (complete after finish()) */
+    const StreamInputStats &stats() const { return stats_; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    /** istream buffer over the blocks popped from the ring */
+    class BlockBuf : public std::streambuf {
+    public:
+        explicit BlockBuf(StreamInput &owner) : owner_(owner) {}
+
+    protected:
+        int_type underflow() override {
+            while (gptr() == egptr()) {
+                if (!owner_.ring_.pop(block_, &owner_.stats_.consumerStarvedSec)) return traits_type::eof();
+                char *b = &block_[0];
+                setg(b, b, b + block_.size());
+            }
+            return traits_type::to_int_type(*gptr());
+        }
+
+    private:
+        StreamInput &owner_;
+        std::string block_;
+    };
+
+    SpscRing<std::string> ring_;
+    BlockBuf buf_;
+    std::istream stream_;
+    std::thread producer_;
+    std::atomic<bool> abandon_ {false};
+    int fd_ {-1};
+    bool ownsFd_ {false};
+    bool started_ {false};
+    std::string error_;  // Written by the producer until joined
+    StreamInputStats stats_;
+    std::string pending_;
+
+    bool fail(const std::string &message) {
+        if (error_.empty()) error_ = message;
+        return false;
+    }
+
+    std::size_t readSome(char *buf, std::size_t n) {
+        for (;;) {
+            ssize_t got = ::read(fd_, buf, n);
+            if (got >= 0) {
+                stats_.inputBytes += static_cast<std::uint64_t>(got);
+                return static_cast<std::size_t>(got);
+            }
+            if (errno != EINTR) { fail(std::string("read error: ") + std::strerror(errno)); return 0; }
+        }
+    }
+
+    /** Queue bytes for the parser in kBlockBytes blocks */
+    bool emit(const char *data, std::size_t n, bool last = false) {
+        if (n) pending_.append(data, n);
+        stats_.outputBytes += n;
+        if (pending_.size() < kBlockBytes && !(last && !pending_.empty())) return true;
+        std::string block;
+        block.reserve(kBlockBytes + 1024);
+        block.swap(pending_);
+        return ring_.push(std::move(block), &stats_.producerBlockedSec, &abandon_);
+    }
+
+    /** Producer thread: read, gunzip if needed, push blocks, close the ring */
+    void produce() {
+        auto start = Clock::now();
+        char head[2];
+        std::size_t have = 0;
+        while (have < 2) {
+            std::size_t got = readSome(head + have, 2 - have);
+            if (got == 0) break;
+            have += got;
+        }
+        if (gzip::isGzip(head, have)) {
+            stats_.compressed = true;
+            bool headGiven = false;
+            gzip::Decoder decoder([&](char *buf, std::size_t n) -> std::size_t {
+                if (!headGiven) {
+                    headGiven = true;
+                    std::memcpy(buf, head, 2);
+                    return 2;
+                }
+                return readSome(buf, n);
+            }, kBlockBytes);
+            if (!decoder.run([&](const char *data, std::size_t n) { return emit(data, n); })) {
+                if (!abandon_.load()) fail(decoder.error());  // Unless a read error came first
+            }
+        } else {
+            std::string chunk(64 * 1024, '\0');
+            bool open = emit(head, have);
+            while (open) {
+                std::size_t got = readSome(&chunk[0], chunk.size());
+                if (got == 0) break;
+                open = emit(chunk.data(), got);
+            }
+        }
+        emit(nullptr, 0, true);
+        ring_.close();
+        stats_.producerBusySec = std::chrono::duration<double>(Clock::now() - start).count()
+                                 - stats_.producerBlockedSec;
+    }
+};
+
+} // namespace inv
@@ -0,0 +1,592 @@
+/**
+ * Hash Table Microbenchmarks
+ *
+ * Self-contained benchmark harness for the HashTable<T> container. Measures
+ * insert, hit-find, miss-find, erase and rehash throughput for
+ * HashTable<Product> and HashTable<int> over a range of table sizes and
+ * compares each operation against std::unordered_map. HashTable is measured
+ * with the default allocator, with PoolAllocator, and with its miss filter
+ * (blocked Bloom filter) enabled, and with the CuckooBuckets policy;
+ * RobinHoodTable (open addressing) is measured alongside.
+ *
+ * A second section runs a mixed churn workload (finds, inserts of new keys
+ * and erases at a steady table size) on the chained tables, RobinHoodTable
+ * and std::unordered_map, and reports the probe lengths left afterwards. A
+ * third section times each find individually and reports its latency
+ * percentiles (p50 to max).
+ *
+ * Every measurement is repeated several times on freshly built tables and
+ * reported as mean ns/op with the standard deviation across repetitions.
+ *
+ * Usage:
+ *   ./benchexe [--min N] [--max N] [--reps R] [--product-max N] [--perf]
+ *
+ *   --min N          Smallest table size (default 1000)
+ *   --max N          Largest table size, sizes grow by 10x (default 10000000)
+ *   --reps R         Repetitions per measurement (default 5)
+ *   --product-max N  Largest size used for Product tables (default: --max,
+ *                    capped at 1000000; a 10M Product table needs several GB)
+ *   --perf           Also report hardware counters (cycles, instructions, IPC,
+ *                    cache and branch misses) per operation, via perf_event
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../Headers/CuckooHashTable.hpp"
+#include "../Headers/HashTable.hpp"
+#include "../Headers/PerfCounters.hpp"
+#include "../Headers/PoolAllocator.hpp"
+#include "../Headers/RobinHoodTable.hpp"
+
+using std::cout;
+using std::endl;
+using std::size_t;
+using std::string;
+using std::vector;
+
+namespace {
+
+// ============================================================================
+// HARNESS
+// ============================================================================
+
+using Clock = std::chrono::steady_clock;
+
+/**
+ * Sink for benchmark results so the optimizer cannot drop the measured work
+ */
+volatile size_t g_sink = 0;
+
+/**
+ * Hardware counters for the benchmark thread (nullptr unless --perf)
+ */
+inv::PerfCounters *g_perf = nullptr;
+
+/**
+ * Summary of repeated measurements of one operation, in ns per operation
+ */
+struct Sample {
+    double mean {0.0};
+    double stddev {0.0};
+};
+
+/**
+ * Compute mean and (sample) standard deviation of a set of measurements
+ * @param v Per-repetition ns/op values
+ * @return Sample summary
+ */
+Sample summarize(const vector<double> &v) {
+    Sample s;
+    if (v.empty()) return s;
+    for (double x : v) s.mean += x;
+    s.mean /= static_cast<double>(v.size());
+    if (v.size() > 1) {
+        double acc = 0.0;
+        for (double x : v) acc += (x - s.mean) * (x - s.mean);
+        s.stddev = std::sqrt(acc / static_cast<double>(v.size() - 1));
+    }
+    return s;
+}
+
+/**
+ * Time a callable and return the elapsed nanoseconds divided by `ops`
+ */
+template <typename F>
+double nsPerOp(size_t ops, F &&f) {
+    auto start = Clock::now();
+    f();
+    auto end = Clock::now();
+    double ns = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+    return ns / static_cast<double>(ops == 0 ? 1 : ops);
+}
+
+/**
+ * nsPerOp() that also adds the hardware counter delta to `perf` (if --perf)
+ */
+template <typename F>
+double measure(size_t ops, inv::PerfSample &perf, F &&f) {
+    inv::PerfSample before = g_perf ? g_perf->read() : inv::PerfSample();
+    double ns = nsPerOp(ops, std::forward<F>(f));
+    if (g_perf) perf += g_perf->read() - before;
+    return ns;
+}
+
+/**
+ * Generate `n` distinct 32-character hex keys shaped like the dataset's Uniq Ids
+ * @param n Number of keys
+ * @param seed RNG seed (different seeds give disjoint key sets with overwhelming probability)
+ */
+vector<string> makeKeys(size_t n, unsigned seed) {
+    static const char hex[] = "0123456789abcdef";
+    std::mt19937_64 rng(seed);
+    vector<string> keys; keys.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        string k(32, '0');
+        uint64_t a = rng(), b = rng();
+        for (int j = 0; j < 16; ++j) { k[j] = hex[(a >> (j * 4)) & 0xf]; k[16 + j] = hex[(b >> (j * 4)) & 0xf]; }
+        keys.push_back(std::move(k));
+    }
+    return keys;
+}
+
+/**
+ * Build a Product with field sizes typical of the bundled CSV
+ */
+inv::Product makeSampleProduct() {
+    inv::Product p;
+    p.productName = "DB Longboards CoreFlex Crossbow 41\" Bamboo Fiberglass Longboard Complete";
+    p.brandName = "DB Longboards";
+    p.categories = {"Sports & Outdoors", "Outdoor Recreation", "Skateboarding"};
+    p.category = "Sports & Outdoors | Outdoor Recreation | Skateboarding";
+    p.listPrice = "$249.99";
+    p.sellingPrice = "$237.68";
+    p.quantity = "1";
+    p.asin = "B07XYZ1234";
+    p.modelNumber = "CF-41-XB";
+    p.productDescription = string(600, 'x');
+    p.stock = "In Stock";
+    return p;
+}
+
+/**
+ * Value factories so the same benchmark code runs for int and Product
+ */
+int makeValue(int, size_t i) { return static_cast<int>(i); }
+inv::Product makeValue(const inv::Product &proto, size_t) { return proto; }
+
+// ============================================================================
+// TABLE ADAPTERS
+// ============================================================================
+
+/**
+ * Uniform interface over inv::HashTable<T> (chained or cuckoo), inv::RobinHoodTable<T> and
+ * std::unordered_map<string, T>; probes() reports average probes per hit and
+ * miss where the table can compute them
+ */
+template <typename T>
+struct InvTable {
+    static const char *name() { return "HashTable"; }
+    inv::HashTable<T> t;
+    bool insert(const string &k, const T &v) { return t.insert(k, v); }
+    bool has(const string &k) const { return t.find(k) != nullptr; }
+    bool erase(const string &k) { return t.erase(k); }
+    void reserve(size_t n) { t.reserve(n); }
+    bool probes(double &hit, double &miss) const { auto st = t.stats(); hit = st.avgProbesHit; miss = st.avgProbesMiss; return true; }
+};
+
+template <typename T>
+struct PoolTable {
+    static const char *name() { return "HashTable+pool"; }
+    inv::HashTable<T, inv::PoolAllocator<T>> t;
+    bool insert(const string &k, const T &v) { return t.insert(k, v); }
+    bool has(const string &k) const { return t.find(k) != nullptr; }
+    bool erase(const string &k) { return t.erase(k); }
+    void reserve(size_t n) { t.reserve(n); }
+    bool probes(double &hit, double &miss) const { auto st = t.stats(); hit = st.avgProbesHit; miss = st.avgProbesMiss; return true; }
+};
+
+template <typename T>
+struct FilterTable {
+    static const char *name() { return "HashTable+bloom"; }
+    inv::HashTable<T> t;
+    FilterTable() { t.enableMissFilter(); }
+    bool insert(const string &k, const T &v) { return t.insert(k, v); }
+    bool has(const string &k) const { return t.find(k) != nullptr; }
+    bool erase(const string &k) { return t.erase(k); }
+    void reserve(size_t n) { t.reserve(n); }
+    bool probes(double &hit, double &miss) const { auto st = t.stats(); hit = st.avgProbesHit; miss = st.avgProbesMiss; return true; }
+};
+
+template <typename T>
+struct CuckooTable {
+    static const char *name() { return "HashTable+cuckoo"; }
+    inv::HashTable<T, std::allocator<T>, inv::CuckooBuckets> t;
+    bool insert(const string &k, const T &v) { return t.insert(k, v); }
+    bool has(const string &k) const { return t.find(k) != nullptr; }
+    bool erase(const string &k) { return t.erase(k); }
+    void reserve(size_t n) { t.reserve(n); }
+    bool probes(double &hit, double &miss) const { auto st = t.stats(); hit = st.avgProbesHit; miss = st.avgProbesMiss; return true; }
+};
+
+template <typename T>
+struct RobinTable {
+    static const char *name() { return "RobinHood"; }
+    inv::RobinHoodTable<T> t;
+    bool insert(const string &k, const T &v) { return t.insert(k, v); }
+    bool has(const string &k) const { return t.find(k) != nullptr; }
+    bool erase(const string &k) { return t.erase(k); }
+    void reserve(size_t n) { t.reserve(n); }
+    bool probes(double &hit, double &miss) const { auto st = t.stats(); hit = st.avgProbesHit; miss = st.avgProbesMiss; return true; }
+};
+
+template <typename T>
+struct StdTable {
+    static const char *name() { return "unordered_map"; }
+    std::unordered_map<string, T> t;
+    bool insert(const string &k, const T &v) {
+        auto r = t.emplace(k, v);
+        if (!r.second) r.first->second = v;
+        return r.second;
+    }
+    bool has(const string &k) const { return t.find(k) != t.end(); }
+    bool erase(const string &k) { return t.erase(k) != 0; }
+    void reserve(size_t n) { t.reserve(n); }
+    bool probes(double &, double &) const { return false; }
+};
+
+// ============================================================================
+// BENCHMARKS
+// ============================================================================
+
+/**
+ * Per-operation results for one table type at one size
+ */
+struct Result {
+    Sample insert, hitFind, missFind, erase, rehash;
+    // Counter totals over all repetitions (valid only with --perf)
+    inv::PerfSample insertPerf, hitPerf, missPerf, erasePerf, rehashPerf;
+    size_t opsPerKind {0};  // Operations behind each counter total
+};
+
+/**
+ * Run every operation `reps` times for one table type at one size
+ *
+ * Each repetition builds a fresh table so that insert and rehash include
+ * growth from the default bucket count, exactly like the loader.
+ */
+template <typename Table, typename T>
+Result runOne(const vector<string> &keys, const vector<string> &missing, const T &proto, int reps) {
+    const size_t n = keys.size();
+    vector<double> ins, hit, miss, era, reh;
+    Result res;
+    vector<string> shuffled = keys;
+    std::mt19937 rng(42);
+
+    for (int r = 0; r < reps; ++r) {
+        std::shuffle(shuffled.begin(), shuffled.end(), rng);
+        {
+            Table t;
+            ins.push_back(measure(n, res.insertPerf, [&] {
+                for (size_t i = 0; i < n; ++i) t.insert(keys[i], makeValue(proto, i));
+            }));
+            hit.push_back(measure(n, res.hitPerf, [&] {
+                size_t c = 0;
+                for (const auto &k : shuffled) c += t.has(k);
+                g_sink += c;
+            }));
+            miss.push_back(measure(n, res.missPerf, [&] {
+                size_t c = 0;
+                for (const auto &k : missing) c += t.has(k);
+                g_sink += c;
+            }));
+            reh.push_back(measure(n, res.rehashPerf, [&] { t.reserve(n * 4); }));
+            era.push_back(measure(n, res.erasePerf, [&] {
+                size_t c = 0;
+                for (const auto &k : shuffled) c += t.erase(k);
+                g_sink += c;
+            }));
+        }
+    }
+    res.opsPerKind = n * static_cast<size_t>(reps);
+    res.insert = summarize(ins);
+    res.hitFind = summarize(hit);
+    res.missFind = summarize(miss);
+    res.erase = summarize(era);
+    res.rehash = summarize(reh);
+    return res;
+}
+
+/**
+ * Print one row of the results table
+ */
+void printRow(const string &value, size_t n, const char *table, const Result &r) {
+    auto cell = [](const Sample &s) {
+        std::ostringstream oss;
+        oss << std::fixed << std::setprecision(1) << s.mean << " ±" << s.stddev;
+        return oss.str();
+    };
+    cout << std::left << std::setw(9) << value
+         << std::right << std::setw(10) << n << "  "
+         << std::left << std::setw(17) << table
+         << std::right
+         << std::setw(16) << cell(r.insert)
+         << std::setw(16) << cell(r.hitFind)
+         << std::setw(16) << cell(r.missFind)
+         << std::setw(16) << cell(r.erase)
+         << std::setw(16) << cell(r.rehash) << endl;
+    auto perfLine = [&](const char *op, const inv::PerfSample &p) {
+        if (!p.valid) return;
+        cout << "    " << std::left << std::setw(10) << op << std::right;
+        inv::printPerf(cout, p, r.opsPerKind);
+        cout << " /op" << endl;
+    };
+    perfLine("insert", r.insertPerf);
+    perfLine("find-hit", r.hitPerf);
+    perfLine("find-miss", r.missPerf);
+    perfLine("erase", r.erasePerf);
+    perfLine("rehash", r.rehashPerf);
+}
+
+/**
+ * Benchmark both table types for value type T over all sizes
+ */
+template <typename T>
+void runSuite(const string &valueName, const T &proto, size_t minN, size_t maxN, int reps) {
+    for (size_t n = minN; n <= maxN; n *= 10) {
+        vector<string> keys = makeKeys(n, 1);
+        vector<string> missing = makeKeys(n, 2);
+        printRow(valueName, n, InvTable<T>::name(), runOne<InvTable<T>>(keys, missing, proto, reps));
+        printRow(valueName, n, PoolTable<T>::name(), runOne<PoolTable<T>>(keys, missing, proto, reps));
+        printRow(valueName, n, FilterTable<T>::name(), runOne<FilterTable<T>>(keys, missing, proto, reps));
+        printRow(valueName, n, CuckooTable<T>::name(), runOne<CuckooTable<T>>(keys, missing, proto, reps));
+        printRow(valueName, n, RobinTable<T>::name(), runOne<RobinTable<T>>(keys, missing, proto, reps));
+        printRow(valueName, n, StdTable<T>::name(), runOne<StdTable<T>>(keys, missing, proto, reps));
+    }
+}
+
+// ============================================================================
+// MIXED CHURN WORKLOAD
+// ============================================================================
+
+/**
+ * One operation of the mixed workload
+ */
+struct MixedOp {
+    enum Kind : char { Find, Insert, Erase } kind;
+    const string *key;
+};
+
+/**
+ * Generate a steady-state churn workload over a table that starts with `keys`
+ *
+ * 50% finds (half of them for live keys, half for keys never inserted), 25%
+ * inserts of new keys and 25% erases of random live keys, so the table size
+ * stays around keys.size() while every key is eventually replaced, like
+ * stock updates that retire and add products.
+ *
+ * @param keys Initial contents
+ * @param fresh Keys available for inserts (must outnumber the inserts)
+ * @param missing Keys that are never inserted
+ * @param ops Number of operations
+ */
+vector<MixedOp> makeMixed(const vector<string> &keys, const vector<string> &fresh,
+                          const vector<string> &missing, size_t ops) {
+    std::mt19937_64 rng(99);
+    vector<const string *> live;
+    for (const auto &k : keys) live.push_back(&k);
+    vector<MixedOp> out; out.reserve(ops);
+    size_t nextFresh = 0;
+    for (size_t i = 0; i < ops; ++i) {
+        unsigned r = static_cast<unsigned>(rng() % 100);
+        if (r < 50 || live.empty()) {
+            bool hit = r < 25 && !live.empty();
+            out.push_back({MixedOp::Find, hit ? live[rng() % live.size()] : &missing[rng() % missing.size()]});
+        } else if (r < 75) {
+            live.push_back(&fresh[nextFresh++ % fresh.size()]);
+            out.push_back({MixedOp::Insert, live.back()});
+        } else {
+            size_t j = rng() % live.size();
+            out.push_back({MixedOp::Erase, live[j]});
+            live[j] = live.back();
+            live.pop_back();
+        }
+    }
+    return out;
+}
+
+/**
+ * Time the mixed workload on one table type and print ns/op plus the
+ * average probe lengths after the churn
+ */
+template <typename Table, typename T>
+void runMixedOne(const string &valueName, size_t n, const vector<string> &keys,
+                 const vector<MixedOp> &ops, const T &proto, int reps) {
+    vector<double> times;
+    double hit = 0.0, miss = 0.0;
+    bool haveProbes = false;
+    inv::PerfSample perf;
+    for (int r = 0; r < reps; ++r) {
+        Table t;
+        for (size_t i = 0; i < keys.size(); ++i) t.insert(keys[i], makeValue(proto, i));
+        times.push_back(measure(ops.size(), perf, [&] {
+            size_t c = 0;
+            for (size_t i = 0; i < ops.size(); ++i) {
+                const MixedOp &op = ops[i];
+                if (op.kind == MixedOp::Find) c += t.has(*op.key);
+                else if (op.kind == MixedOp::Insert) c += t.insert(*op.key, makeValue(proto, i));
+                else c += t.erase(*op.key);
+            }
+            g_sink += c;
+        }));
+        haveProbes = t.probes(hit, miss);
+    }
+    Sample s = summarize(times);
+    std::ostringstream cell, probes;
+    cell << std::fixed << std::setprecision(1) << s.mean << " ±" << s.stddev;
+    if (haveProbes) probes << std::fixed << std::setprecision(2) << hit << " / " << miss;
+    else probes << "-";
+    cout << std::left << std::setw(9) << valueName
+         << std::right << std::setw(10) << n << "  "
+         << std::left << std::setw(17) << Table::name()
+         << std::right << std::setw(16) << cell.str()
+         << std::setw(20) << probes.str() << endl;
+    if (perf.valid) {
+        cout << "    " << std::left << std::setw(10) << "mixed" << std::right;
+        inv::printPerf(cout, perf, ops.size() * static_cast<size_t>(reps));
+        cout << " /op" << endl;
+    }
+}
+
+/**
+ * Run the mixed churn workload (4 operations per initial key) for every
+ * table type and size
+ */
+template <typename T>
+void runMixedSuite(const string &valueName, const T &proto, size_t minN, size_t maxN, int reps) {
+    for (size_t n = minN; n <= maxN; n *= 10) {
+        vector<string> keys = makeKeys(n, 1);
+        vector<string> missing = makeKeys(n, 2);
+        vector<string> fresh = makeKeys(2 * n, 3);
+        vector<MixedOp> ops = makeMixed(keys, fresh, missing, 4 * n);
+        runMixedOne<InvTable<T>>(valueName, n, keys, ops, proto, reps);
+        runMixedOne<PoolTable<T>>(valueName, n, keys, ops, proto, reps);
+        runMixedOne<CuckooTable<T>>(valueName, n, keys, ops, proto, reps);
+        runMixedOne<RobinTable<T>>(valueName, n, keys, ops, proto, reps);
+        runMixedOne<StdTable<T>>(valueName, n, keys, ops, proto, reps);
+    }
+}
+
+// ============================================================================
+// LOOKUP LATENCY DISTRIBUTION
+// ============================================================================
+
+/**
+ * Time every find of a shuffled hit/miss mix individually and print the
+ * p50/p99/p99.9/max latency in ns (clock overhead included, equally for
+ * every table); the tail shows the cost of the longest chains or probes
+ */
+template <typename Table, typename T>
+void runLatencyOne(const string &valueName, const vector<string> &keys,
+                   const vector<const string *> &lookups, const T &proto) {
+    Table t;
+    for (size_t i = 0; i < keys.size(); ++i) t.insert(keys[i], makeValue(proto, i));
+    vector<double> ns; ns.reserve(lookups.size());
+    size_t c = 0;
+    for (const string *k : lookups) {
+        auto start = Clock::now();
+        c += t.has(*k);
+        ns.push_back(static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count()));
+    }
+    g_sink += c;
+    std::sort(ns.begin(), ns.end());
+    auto pct = [&](double p) { return ns[std::min(ns.size() - 1, static_cast<size_t>(p * static_cast<double>(ns.size())))]; };
+    cout << std::left << std::setw(9) << valueName
+         << std::right << std::setw(10) << keys.size() << "  "
+         << std::left << std::setw(17) << Table::name() << std::right << std::fixed << std::setprecision(0)
+         << std::setw(10) << pct(0.5) << std::setw(10) << pct(0.99) << std::setw(10) << pct(0.999)
+         << std::setw(10) << ns.back() << endl;
+    cout.unsetf(std::ios::fixed);
+}
+
+/**
+ * Per-lookup latency percentiles (half hits, half misses, 10 lookups per key)
+ */
+template <typename T>
+void runLatencySuite(const string &valueName, const T &proto, size_t minN, size_t maxN) {
+    for (size_t n = minN; n <= maxN; n *= 10) {
+        vector<string> keys = makeKeys(n, 1);
+        vector<string> missing = makeKeys(n, 2);
+        vector<const string *> lookups;
+        std::mt19937_64 rng(5);
+        for (size_t i = 0; i < 10 * n; ++i) lookups.push_back(i % 2 ? &keys[rng() % n] : &missing[rng() % n]);
+        runLatencyOne<InvTable<T>>(valueName, keys, lookups, proto);
+        runLatencyOne<PoolTable<T>>(valueName, keys, lookups, proto);
+        runLatencyOne<CuckooTable<T>>(valueName, keys, lookups, proto);
+        runLatencyOne<RobinTable<T>>(valueName, keys, lookups, proto);
+        runLatencyOne<StdTable<T>>(valueName, keys, lookups, proto);
+    }
+}
+
+/**
+ * Parse a size argument; accepts plain integers
+ */
+size_t parseSize(const char *s) { return static_cast<size_t>(std::strtoull(s, nullptr, 10)); }
+
+} // namespace
+
+/**
+ * Benchmark entry point
+ * Parses options and runs the int and Product suites
+ */
+int main(int argc, char const *argv[]) {
+    size_t minN = 1'000, maxN = 10'000'000, productMax = 0;
+    int reps = 5;
+    bool perf = false;
+    for (int i = 1; i < argc; ++i) {
+        string a = argv[i];
+        if (a == "--min" && i + 1 < argc) minN = parseSize(argv[++i]);
+        else if (a == "--max" && i + 1 < argc) maxN = parseSize(argv[++i]);
+        else if (a == "--reps" && i + 1 < argc) reps = std::max(1, std::atoi(argv[++i]));
+        else if (a == "--product-max" && i + 1 < argc) productMax = parseSize(argv[++i]);
+        else if (a == "--perf") perf = true;
+        else {
+            std::cerr << "usage: " << argv[0] << " [--min N] [--max N] [--reps R] [--product-max N] [--perf]" << endl;
+            return 1;
+        }
+    }
+    if (productMax == 0) productMax = std::min<size_t>(maxN, 1'000'000);
+    if (minN == 0) minN = 1;
+
+    inv::PerfCounters counters;
+    if (perf) {
+        if (counters.available()) g_perf = &counters;
+        else std::cerr << "Hardware counters unavailable (" << counters.error() << ")" << endl;
+    }
+
+    cout << "HashTable microbenchmarks (ns/op, mean ±stddev over " << reps << " reps)" << endl;
+    cout << std::left << std::setw(9) << "value"
+         << std::right << std::setw(10) << "size" << "  "
+         << std::left << std::setw(17) << "table"
+         << std::right
+         << std::setw(16) << "insert"
+         << std::setw(16) << "find-hit"
+         << std::setw(16) << "find-miss"
+         << std::setw(16) << "erase"
+         << std::setw(16) << "rehash" << endl;
+
+    runSuite<int>("int", 0, minN, maxN, reps);
+    runSuite<inv::Product>("Product", makeSampleProduct(), minN, productMax, reps);
+
+    cout << endl << "Mixed churn workload: 50% find (half misses), 25% insert, 25% erase; "
+         << "4 ops per initial key (ns/op, probes per hit / miss afterwards)" << endl;
+    cout << std::left << std::setw(9) << "value"
+         << std::right << std::setw(10) << "size" << "  "
+         << std::left << std::setw(17) << "table"
+         << std::right << std::setw(16) << "mixed"
+         << std::setw(20) << "probes hit/miss" << endl;
+    runMixedSuite<int>("int", 0, minN, maxN, reps);
+    runMixedSuite<inv::Product>("Product", makeSampleProduct(), minN, productMax, reps);
+
+    cout << endl << "find latency per lookup (ns; half hits, half misses)" << endl;
+    cout << std::left << std::setw(9) << "value"
+         << std::right << std::setw(10) << "size" << "  "
+         << std::left << std::setw(17) << "table"
+         << std::right << std::setw(10) << "p50" << std::setw(10) << "p99"
+         << std::setw(10) << "p99.9" << std::setw(10) << "max" << endl;
+    runLatencySuite<int>("int", 0, minN, maxN);
+    runLatencySuite<inv::Product>("Product", makeSampleProduct(), minN, productMax);
+    return g_sink == static_cast<size_t>(-1) ? 1 : 0;
+}
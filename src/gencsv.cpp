@@ -0,0 +1,184 @@
+/**
+ * Synthetic Inventory CSV Generator
+ *
+ * Produces CSV files shaped like the bundled Amazon export so the loader can
+ * be benchmarked at production scale. The generator reads the sample file
+ * once, keeps its rows as templates, and writes any number of new records:
+ *
+ * - Same 28-column header, copied verbatim from the sample
+ * - Fresh 32-character hex Uniq Ids (deterministic for a given seed)
+ * - Category and Brand Name drawn independently from the sample's empirical
+ *   distributions, so popular categories/brands stay popular
+ * - All other columns copied from a randomly chosen template row, keeping
+ *   realistic field lengths, quoting and embedded commas
+ * - Some descriptions are split over multiple lines inside quotes to exercise
+ *   the multi-line record path
+ *
+ * Rows are streamed straight to the output, so memory use does not depend on
+ * the number of rows generated.
+ *
+ * Usage:
+ *   ./gencsvexe --rows N [--out path] [--sample path] [--seed S] [--multiline-pct P]
+ */
+
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../Headers/Parser.hpp"
+
+using std::cerr;
+using std::endl;
+using std::size_t;
+using std::string;
+using std::vector;
+
+namespace {
+
+const char *kDefaultSample = "marketing_sample_for_amazon_com-ecommerce__20200101_20200131__10k_data.csv";
+
+/**
+ * Quote a field for CSV output if it contains a comma, quote or line break
+ * @param f Raw field value
+ * @return RFC 4180 encoded field
+ */
+string csvField(const string &f) {
+    if (f.find_first_of(",\"\r\n") == string::npos) return f;
+    string out; out.reserve(f.size() + 2);
+    out.push_back('"');
+    for (char c : f) {
+        if (c == '"') out.push_back('"');
+        out.push_back(c);
+    }
+    out.push_back('"');
+    return out;
+}
+
+/**
+ * Break a long text into several lines at word boundaries
+ * Mirrors how the scraped descriptions in the sample contain raw newlines.
+ */
+string addLineBreaks(const string &text, std::mt19937_64 &rng) {
+    string out = text;
+    std::uniform_int_distribution<size_t> gap(80, 240);
+    size_t pos = gap(rng);
+    while (pos < out.size()) {
+        size_t sp = out.find(' ', pos);
+        if (sp == string::npos) break;
+        out[sp] = '\n';
+        pos = sp + gap(rng);
+    }
+    return out;
+}
+
+/**
+ * Format 128 random bits as a 32-character lowercase hex id
+ */
+string makeId(std::mt19937_64 &rng) {
+    static const char hex[] = "0123456789abcdef";
+    string k(32, '0');
+    uint64_t a = rng(), b = rng();
+    for (int j = 0; j < 16; ++j) { k[j] = hex[(a >> (j * 4)) & 0xf]; k[16 + j] = hex[(b >> (j * 4)) & 0xf]; }
+    return k;
+}
+
+} // namespace
+
+/**
+ * Generator entry point
+ * Loads template rows from the sample file and streams synthetic rows out
+ */
+int main(int argc, char const *argv[]) {
+    size_t rows = 0;
+    string out = "-", sample = kDefaultSample;
+    uint64_t seed = 2020;
+    int multilinePct = 10;
+    for (int i = 1; i < argc; ++i) {
+        string a = argv[i];
+        if (a == "--rows" && i + 1 < argc) rows = static_cast<size_t>(std::strtoull(argv[++i], nullptr, 10));
+        else if (a == "--out" && i + 1 < argc) out = argv[++i];
+        else if (a == "--sample" && i + 1 < argc) sample = argv[++i];
+        else if (a == "--seed" && i + 1 < argc) seed = std::strtoull(argv[++i], nullptr, 10);
+        else if (a == "--multiline-pct" && i + 1 < argc) multilinePct = std::atoi(argv[++i]);
+        else {
+            cerr << "usage: " << argv[0] << " --rows N [--out path] [--sample path] [--seed S] [--multiline-pct P]" << endl;
+            return 1;
+        }
+    }
+    if (rows == 0) {
+        cerr << "--rows must be positive" << endl;
+        return 1;
+    }
+
+    // Read the sample once, keeping raw (unsanitized) fields as templates
+    std::ifstream in(sample);
+    if (!in.is_open()) {
+        cerr << "Failed to open sample: " << sample << endl;
+        return 1;
+    }
+    string headerLine;
+    if (!std::getline(in, headerLine)) {
+        cerr << "Sample has no header: " << sample << endl;
+        return 1;
+    }
+    auto H = inv::detail::buildHeader(headerLine);
+    const size_t idCol = H.get("Uniq Id");
+    const size_t catCol = H.get("Category");
+    const size_t brandCol = H.get("Brand Name");
+    const size_t descCol = H.get("Product Description");
+    const size_t aboutCol = H.get("About Product");
+    const size_t width = inv::detail::parseCsvLine(headerLine).size();
+
+    vector<vector<string>> templates;
+    string rec;
+    while (inv::detail::readRecord(in, rec)) {
+        if (rec.empty()) continue;
+        auto cols = inv::detail::parseCsvLine(rec);
+        cols.resize(width);
+        templates.push_back(std::move(cols));
+    }
+    if (templates.empty()) {
+        cerr << "Sample has no records: " << sample << endl;
+        return 1;
+    }
+
+    std::ofstream file;
+    if (out != "-") {
+        file.open(out, std::ios::binary);
+        if (!file.is_open()) {
+            cerr << "Failed to open output: " << out << endl;
+            return 1;
+        }
+    }
+    std::ostream &os = (out == "-") ? std::cout : file;
+
+    std::mt19937_64 rng(seed);
+    std::uniform_int_distribution<size_t> pick(0, templates.size() - 1);
+    std::uniform_int_distribution<int> pct(0, 99);
+
+    os << headerLine << '\n';
+    string line;
+    for (size_t r = 0; r < rows; ++r) {
+        const auto &base = templates[pick(rng)];
+        const auto &catRow = templates[pick(rng)];
+        const auto &brandRow = templates[pick(rng)];
+        bool multiline = pct(rng) < multilinePct;
+
+        line.clear();
+        for (size_t c = 0; c < width; ++c) {
+            if (c > 0) line.push_back(',');
+            if (c == idCol) { line += makeId(rng); continue; }
+            const string &v = (c == catCol) ? catRow[c] : (c == brandCol) ? brandRow[c] : base[c];
+            if (multiline && (c == descCol || c == aboutCol) && !v.empty()) line += csvField(addLineBreaks(v, rng));
+            else line += csvField(v);
+        }
+        line.push_back('\n');
+        os.write(line.data(), static_cast<std::streamsize>(line.size()));
+    }
+    os.flush();
+    return os ? 0 : 1;
+}
@@ -0,0 +1,176 @@
+/**
+ * End-to-End Ingestion Benchmark
+ *
+ * Times loadCsv() on one or more CSV files, end to end and per phase
+ * (read, parse, build, insert, index; see inv::LoadStats). Each file is
+ * loaded into a fresh table and category index, optionally several times,
+ * and the per-phase times are reported together with throughput.
+ *
+ * Use gencsvexe to produce synthetic files at production scale.
+ *
+ * With --perf, hardware counters (cycles, instructions, cache misses, branch
+ * misses) are also sampled at every phase boundary and reported per record.
+ * Sampling costs a syscall per phase, so wall-clock numbers from a --perf
+ * run are inflated; compare them only against other --perf runs.
+ *
+ * With --lazy, cold fields (asin, model number, description) are deferred to
+ * the mmapped source file (inv::ColdFieldStore) instead of being parsed.
+ *
+ * With --pipeline N, files are loaded by loadCsvPipelined() with N parser
+ * threads; the phase lines then show each stage's busy time (parse includes
+ * build, and phases overlap, so they add up to more than the total), followed
+ * by each stage's capacity, starved/blocked time and the bottleneck stage.
+ *
+ * Gzip files and "-" (standard input, one run only) are streamed through
+ * inv::StreamInput, which decompresses on its own thread while the loader
+ * parses; an "input" line then shows the decode thread's busy time, how
+ * long it waited for the parser (blocked) and the parser for it (starved).
+ * Lazy cold fields need a plain file and are not used for streamed input.
+ *
+ * Usage:
+ *   ./loadbenchexe [--reps R] [--perf] [--lazy] [--pipeline N] [file.csv|file.csv.gz|- ...]
+ *   (defaults to the bundled 10k sample)
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../Headers/HashTable.hpp"
+#include "../Headers/LoadPipeline.hpp"
+#include "../Headers/Parser.hpp"
+#include "../Headers/StreamInput.hpp"
+
+using std::cout;
+using std::endl;
+using std::string;
+using std::vector;
+
+namespace {
+
+const char *kDefaultCsv = "marketing_sample_for_amazon_com-ecommerce__20200101_20200131__10k_data.csv";
+
+/**
+ * Print one phase line: seconds, share of total, ns per record
+ */
+void printPhase(const char *name, double sec, const inv::LoadStats &st, const inv::PerfSample *perf = nullptr) {
+    double share = st.totalSec > 0 ? 100.0 * sec / st.totalSec : 0.0;
+    double nsPerRec = st.records > 0 ? 1e9 * sec / static_cast<double>(st.records) : 0.0;
+    cout << "  " << std::left << std::setw(8) << name << std::right
+         << std::setw(10) << std::setprecision(3) << sec << " s"
+         << std::setw(8) << std::setprecision(1) << share << " %"
+         << std::setw(12) << std::setprecision(0) << nsPerRec << " ns/rec";
+    if (perf && perf->valid) {
+        cout << "   ";
+        inv::printPerf(cout, *perf, st.records);
+        cout << " /rec";
+    }
+    cout << endl;
+}
+
+/**
+ * Load one file `reps` times and print the phase breakdown of each run
+ * @return false if the file could not be loaded
+ */
+bool benchFile(const string &path, int reps, bool perf, bool lazy, size_t pipeline) {
+    for (int r = 0; r < reps; ++r) {
+        inv::HashTable<inv::Product> table;
+        std::unordered_map<string, vector<string>> index;
+        inv::LoadStats st;
+        inv::ColdFieldStore coldFields;
+        inv::PerfCounters counters;
+        if (perf) {
+            if (counters.available()) st.perf = &counters;
+            else if (r == 0) std::cerr << "Hardware counters unavailable (" << counters.error() << ")" << endl;
+        }
+        inv::LoadPipelineStats stages;
+        inv::LoadPipelineOptions options;
+        options.parsers = pipeline;
+        if (pipeline > 0) st.pipeline = &stages;
+        const bool streamed = path == "-" || inv::isGzipFile(path);
+        inv::StreamInput input;
+        bool loaded;
+        if (streamed) {
+            loaded = input.open(path);
+            if (loaded && pipeline > 0) loaded = inv::loadCsvPipelined(input.stream(), table, index, options, &st);
+            else if (loaded) loaded = inv::loadCsv(input.stream(), table, index, &st);
+            loaded = input.finish() && loaded;
+        } else if (pipeline > 0) {
+            loaded = inv::loadCsvPipelined(path, table, index, options, &st, nullptr, lazy ? &coldFields : nullptr);
+        } else {
+            loaded = inv::loadCsv(path, table, index, &st, nullptr, lazy ? &coldFields : nullptr);
+        }
+        if (!loaded) {
+            std::cerr << "Failed to load: " << path;
+            if (!input.error().empty()) std::cerr << " (" << input.error() << ")";
+            std::cerr << endl;
+            return false;
+        }
+        double mb = static_cast<double>(st.bytes) / (1024.0 * 1024.0);
+        cout << std::fixed;
+        cout << path << " (run " << (r + 1) << "/" << reps << ")" << endl;
+        cout << "  records " << st.records << ", products " << table.size()
+             << ", categories " << index.size()
+             << ", " << std::setprecision(1) << mb << " MiB" << endl;
+        cout << "  total   " << std::setw(10) << std::setprecision(3) << st.totalSec << " s"
+             << std::setw(10) << std::setprecision(1) << (st.totalSec > 0 ? mb / st.totalSec : 0.0) << " MiB/s"
+             << std::setw(12) << std::setprecision(0) << (st.totalSec > 0 ? st.records / st.totalSec : 0.0) << " rec/s" << endl;
+        if (streamed) {
+            const inv::StreamInputStats &in = input.stats();
+            cout << "  input   " << (in.compressed ? "gzip " : "plain ")
+                 << std::setprecision(1) << in.inputBytes / (1024.0 * 1024.0) << " -> "
+                 << in.outputBytes / (1024.0 * 1024.0) << " MiB, decode busy "
+                 << std::setprecision(3) << in.producerBusySec << " s, blocked " << in.producerBlockedSec
+                 << " s, parser starved " << in.consumerStarvedSec << " s" << endl;
+        }
+        printPhase("read", st.readSec, st, &st.readPerf);
+        printPhase("parse", st.parseSec, st, &st.parsePerf);
+        printPhase("build", st.buildSec, st, &st.buildPerf);
+        printPhase("insert", st.insertSec, st, &st.insertPerf);
+        printPhase("index", st.indexSec, st, &st.indexPerf);
+        if (pipeline > 0) {
+            cout << "  pipeline stages:" << endl;
+            inv::printPipelineStats(stages, cout);
+        } else {
+            double other = st.totalSec - (st.readSec + st.parseSec + st.buildSec + st.insertSec + st.indexSec);
+            printPhase("other", other, st);
+        }
+        cout.unsetf(std::ios::floatfield);
+        if (path == "-") break;  // Standard input can be read only once
+    }
+    return true;
+}
+
+} // namespace
+
+/**
+ * Benchmark entry point
+ */
+int main(int argc, char const *argv[]) {
+    int reps = 1;
+    bool perf = false;
+    bool lazy = false;
+    size_t pipeline = 0;
+    vector<string> files;
+    for (int i = 1; i < argc; ++i) {
+        string a = argv[i];
+        if (a == "--reps" && i + 1 < argc) reps = std::max(1, std::atoi(argv[++i]));
+        else if (a == "--perf") perf = true;
+        else if (a == "--lazy") lazy = true;
+        else if (a == "--pipeline" && i + 1 < argc) pipeline = std::strtoull(argv[++i], nullptr, 10);
+        else if (a.size() > 1 && a[0] == '-') {
+            std::cerr << "usage: " << argv[0] << " [--reps R] [--perf] [--lazy] [--pipeline N] [file.csv|file.csv.gz|- ...]" << endl;
+            return 1;
+        }
+        else files.push_back(a);
+    }
+    if (files.empty()) files.push_back(kDefaultCsv);
+
+    bool ok = true;
+    for (const auto &f : files) ok = benchFile(f, reps, perf, lazy, pipeline) && ok;
+    return ok ? 0 : 1;
+}
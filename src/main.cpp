@@ -1,34 +1,91 @@
 /**
  * Amazon Inventory Management System
- * 
+ *
  * A command-line REPL (Read-Eval-Print Loop) application for querying
  * product inventory loaded from a CSV file. Uses a custom hash table
  * for O(1) product lookup by ID and a category index for filtering.
- * 
+ * Command evaluation lives in inv::Engine (Headers/Engine.hpp); this file
+ * only handles startup and the interactive loop.
+ *
  * Supported Commands:
  *  - find <Uniq Id>           : Search for a product by its unique ID
  *  - listInventory <Category> : List all products in a specific category
+ *  - :tablestats              : Print hash table chain/probe statistics
+ *  - :stats                   : Print per-command counts and latency
+ *  - :memory                  : Print exact memory used by table and index
  *  - :help                    : Display command help
  *  - :quit                    : Exit the application
+ *  - :load <csv>              : (--primary only) Upsert every product of a CSV
+ *  - :erase <Uniq Id>         : (--primary only) Remove a product
+ *
+ * Command-line Options:
+ *  - --record <file>          : Append every entered command to <file>
+ *                               (replayable with replayexe --commands <file>)
+ *  - --perf                   : Also count cycles, instructions, cache and
+ *                               branch misses per command (Linux perf_event)
+ *  - --compress-descriptions  : Keep product descriptions block-compressed in
+ *                               memory, decompressing them on `find`
+ *  - --lazy-cold-fields       : Leave asin, model number and description in
+ *                               the mmapped CSV until `find` needs them
+ *  - --readonly               : After loading, freeze the catalog into a
+ *                               read-only minimal perfect hash snapshot
+ *  - --miss-filter            : Put a blocked Bloom filter in front of `find`
+ *                               so unknown ids are rejected without a chain walk
+ *  - --save-catalog <file>    : After loading, write the catalog to a table
+ *                               file that --catalog can map
+ *  - --catalog <file>         : Memory-map a saved catalog instead of loading
+ *                               the CSV (read-only; shared between processes)
+ *  - --publish-shm <name>     : After loading, publish the catalog to POSIX
+ *                               shared memory as a new generation (loader)
+ *  - --shm <name>             : Serve the catalog published under <name>
+ *                               (read-only; follows newer generations)
+ *  - --shard <k>/<N>          : Load only partition k of N (by Uniq Id hash)
+ *  - --serve <endpoint>       : Instead of the REPL, answer commands on a
+ *                               socket ("unix:<path>" or "<host>:<port>")
+ *  - --shards <e0,e1,...>     : Coordinator: load nothing and route every
+ *                               command to the shard servers at these endpoints
+ *  - --primary <endpoint>     : After loading, log every change and stream the
+ *                               log to replicas connecting to <endpoint>
+ *  - --replica-of <endpoint>  : Load nothing; follow the primary at <endpoint>
+ *                               and serve reads from the replicated catalog
+ *  - --cdc <endpoint>         : Stream coalesced change events (inserts,
+ *                               erases, field updates) to clients on <endpoint>
+ *  - --watch <endpoint>       : No catalog or REPL: print the change events
+ *                               streamed by a --cdc process, one per line
+ *  - --result-cache <MiB>     : Cache find/listInventory output (CLOCK
+ *                               eviction, invalidated by any data change)
+ *  - --prerender              : Render every product's `find` output once at
+ *                               load/upsert time; `find` writes stored bytes
+ *  - --coalesce               : Let identical concurrent listInventory
+ *                               commands (e.g. --serve clients) share one scan
+ *  - --load-threads <N>       : Load CSVs with the pipelined loader (read,
+ *                               N parser threads, insert and index stages)
+ *  - --load <csv|->           : Load this CSV instead of the bundled dataset;
+ *                               gzip files are decompressed while parsing and
+ *                               "-" streams it from standard input (which then
+ *                               is at EOF: pair with --serve, --save-catalog or
+ *                               --publish-shm)
  */
 
+#include <chrono>
+#include <cstdlib>
 #include <iostream>
+#include <fstream>
+#include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
-#include <unordered_map>
-#include <sstream>
 
-#include "../Headers/HashTable.hpp"
-#include "../Headers/Parser.hpp"
+#include "../Headers/Engine.hpp"
+#include "../Headers/Replication.hpp"
+#include "../Headers/Shard.hpp"
+#include "../Headers/StreamInput.hpp"
 
 using std::cin;
 using std::cout;
 using std::endl;
 using std::getline;
-using std::size_t;
 using std::string;
-using std::unordered_map;
-using std::vector;
 
 namespace {
 
@@ -37,202 +94,136 @@ namespace {
 // ============================================================================
 
 /**
- * Primary storage: Hash table mapping Uniq Id -> Product
- * Provides O(1) average-case lookup for finding products by ID
+ * Query engine: owns the product hash table (Uniq Id -> Product) and the
+ * category index (Category -> Uniq Ids), and evaluates REPL commands
  */
-inv::HashTable<inv::Product> g_table;
+inv::Engine g_engine;
 
 /**
- * Secondary index: Category -> list of Uniq Ids
- * Enables efficient querying of all products in a given category
- * Products can belong to multiple categories (stored in Product.categories)
+ * Coordinator for a sharded catalog (used instead of g_engine when
+ * --shards is given)
  */
-unordered_map<string, vector<string>> g_categoryIndex;
-
-// ============================================================================
-// UTILITY FUNCTIONS
-// ============================================================================
+inv::ShardRouter g_router;
 
 /**
- * Trim leading and trailing whitespace from a string
- * @param s Input string
- * @return Trimmed string
+ * Follows a primary's mutation log into g_engine (with --replica-of)
  */
-static string trim(const string &s) {
-    size_t start = 0; 
-    while (start < s.size() && std::isspace(static_cast<unsigned char>(s[start]))) ++start;
-    size_t end = s.size(); 
-    while (end > start && std::isspace(static_cast<unsigned char>(s[end-1]))) --end;
-    return s.substr(start, end-start);
-}
+inv::Replica g_replica;
 
 /**
- * Print a product's details in a formatted, human-readable manner
- * Wraps long product descriptions to improve readability
- * 
- * @param p The product to print
+ * Optional command log written when --record is given
+ * One command per line, in the order they were entered
  */
-static void printProduct(const inv::Product &p) {
-    cout << "Uniq Id: " << p.uniqId << endl;
-    cout << "Product Name: " << p.productName << endl;
-    cout << "Brand Name: " << p.brandName << endl;
-    cout << "Category: " << p.category << endl;
-    cout << "List Price: " << p.listPrice << endl;
-    cout << "Selling Price: " << p.sellingPrice << endl;
-    cout << "Quantity: " << p.quantity << endl;
-    if (!p.asin.empty()) cout << "Asin: " << p.asin << endl;
-    if (!p.modelNumber.empty()) cout << "Model Number: " << p.modelNumber << endl;
-    
-    /**
-     * Lambda helper to wrap and print long text fields with proper indentation
-     * Breaks text into lines that fit within maxWidth characters
-     */
-    auto wrapAndPrint = [&](const std::string &label, const std::string &text, size_t maxWidth = 100) {
-        cout << label;
-        if (text.empty()) { cout << endl; return; }
-        
-        // Split text into words
-        std::istringstream iss(text);
-        std::vector<std::string> words;
-        std::string w;
-        while (iss >> w) words.push_back(w);
-
-        const std::string indent = "    "; // 4 spaces for wrapped lines
-        size_t lineWidth = maxWidth;
-
-        // Start a new line for the wrapped block
-        cout << '\n';
-        std::string cur = indent;
-        for (size_t i = 0; i < words.size(); ++i) {
-            const std::string &word = words[i];
-            if (cur.size() + (cur.size() > indent.size() ? 1 : 0) + word.size() > lineWidth) {
-                cout << cur << std::endl;
-                cur = indent + word;
-            } else {
-                if (cur.size() > indent.size()) cur += ' ';
-                cur += word;
-            }
-        }
-        if (!cur.empty()) cout << cur << std::endl;
-    };
-
-    wrapAndPrint("Product Description:", p.productDescription, 100);
-    if (!p.stock.empty()) cout << "Stock: " << p.stock << endl;
-}
+std::ofstream g_record;
 
 } // namespace
 
 // ============================================================================
-// REPL COMMAND HANDLERS
+// REPL
 // ============================================================================
 
 /**
- * Display help information about available commands
+ * Load a CSV into g_engine
+ * Plain files are loaded directly (so lazy cold fields can map them); "-"
+ * (standard input) and gzip files are streamed through a StreamInput,
+ * decompressing on its thread while this one parses
+ *
+ * @param path CSV file, gzip-compressed CSV file, or "-"
+ * @param error Receives the reason of a stream failure (truncated or
+ *        corrupt input), if any
+ * @return true if the whole input was loaded
  */
-/**
- * Display help information about available commands
- */
-void printHelp()
+bool loadDataset(const string &path, string &error)
 {
-    cout << "Supported list of commands: " << endl;
-    cout << " 1. find <inventoryid> - Finds if the inventory exists. If exists, prints details. If not, prints 'Inventory not found'." << endl;
-    cout << " 2. listInventory <category_string> - Lists just the id and name of all inventory belonging to the specified category. If the category doesn't exists, prints 'Invalid Category'.\n"
-         << endl;
-    cout << " Use :quit to quit the REPL" << endl;
+    if (path != "-" && !inv::isGzipFile(path)) return g_engine.load(path);
+    inv::StreamInput input;
+    bool ok = input.open(path) && g_engine.load(input.stream());
+    ok = input.finish() && ok;
+    error = input.error();
+    return ok;
 }
 
 /**
- * Validate whether a command line is recognized
- * @param line User input command
- * @return true if command is valid, false otherwise
+ * Initialize the application
+ * Loads the CSV data file into the hash table and category index (or maps
+ * a saved catalog file or shared-memory catalog), then displays the welcome
+ * message
+ *
+ * @param catalog Catalog file to map instead of loading the CSV (empty = CSV)
+ * @param shm Shared-memory catalog to attach to instead (empty = none)
+ * @param shards Shard endpoints to route to instead (empty = none)
+ * @param primary Primary to replicate instead (empty = none)
+ * @param csv CSV to load (see loadDataset)
  */
-bool validCommand(string line)
+void bootStrap(const string &catalog, const string &shm, const string &shards, const string &primary, const string &csv)
 {
-    return (line == ":help") ||
-           (line.rfind("find", 0) == 0) ||
-           (line.rfind("listInventory", 0) == 0);
-}
+    cout << "\n Welcome to Amazon Inventory Query System" << endl;
+    cout << " enter :quit to exit. or :help to list supported commands." << endl;
 
-/**
- * Evaluate and execute a user command
- * Parses the command and its arguments, then performs the requested action
- * 
- * @param line User input command string
- */
-void evalCommand(string line)
-{
-    if (line == ":help")
-    {
-        printHelp();
+    if (!shards.empty()) {
+        if (!g_router.connect(inv::ShardRouter::parseEndpoints(shards))) {
+            cout << "Failed to connect to shards: " << shards << endl;
+        }
+        cout << "\n> ";
+        return;
     }
-    else if (line.rfind("find", 0) == 0)
-    {
-        // Command: find <id>
-        // Searches for a product by unique ID and displays full details
-        auto pos = line.find(' ');
-        if (pos == string::npos || pos + 1 >= line.size()) {
-            cout << "Inventory not found" << endl;
-            return;
-        }
-        string id = trim(line.substr(pos + 1));
-        if (id.empty()) { 
-            cout << "Inventory not found" << endl; 
-            return; 
-        }
-        
-        // Lookup product in hash table (O(1) average case)
-        auto *p = g_table.find(id);
-        if (!p) {
-            cout << "Inventory not found" << endl;
-        } else {
-            printProduct(*p);
+
+    if (!primary.empty()) {
+        if (!g_replica.start(primary, g_engine) || !g_replica.waitCaughtUp(std::chrono::seconds(30))) {
+            std::string why = g_replica.error();
+            cout << "Failed to catch up with primary: " << primary << (why.empty() ? "" : " (" + why + ")") << endl;
         }
+        cout << "\n> ";
+        return;
     }
-    else if (line.rfind("listInventory", 0) == 0)
-    {
-        // Command: listInventory <category>
-        // Lists all products belonging to a specific category
-        auto pos = line.find(' ');
-        if (pos == string::npos || pos + 1 >= line.size()) {
-            cout << "Invalid Category" << endl;
-            return;
-        }
-        string category = trim(line.substr(pos + 1));
-        
-        // Check if category exists in the index
-        auto it = g_categoryIndex.find(category);
-        if (it == g_categoryIndex.end()) {
-            cout << "Invalid Category" << endl;
-            return;
-        }
-        
-        // Iterate through all product IDs in this category
-        for (const auto &id : it->second) {
-            const inv::Product *p = g_table.find(id);
-            if (p) {
-                cout << id << " - " << p->productName << endl;
-            }
+
+    if (!shm.empty()) {
+        if (!g_engine.attachSharedCatalog(shm)) {
+            cout << "Failed to attach shared catalog: " << shm << endl;
+        }
+        cout << "\n> ";
+        return;
+    }
+    if (!catalog.empty()) {
+        if (!g_engine.openCatalog(catalog)) {
+            cout << "Failed to open catalog: " << catalog << endl;
         }
+        cout << "\n> ";
+        return;
     }
+
+    // Load CSV data into hash table and build category index
+    // The parser sanitizes data and handles multi-line fields
+    string error;
+    if (!loadDataset(csv, error)) {
+        cout << "Failed to load dataset: " << csv << (error.empty() ? "" : " (" + error + ")") << endl;
+    }
+    cout << "\n> ";
 }
 
 /**
- * Initialize the application
- * Loads the CSV data file into the hash table and category index,
- * then displays the welcome message
+ * Apply a primary's mutation command (:load / :erase)
+ *
+ * @param line User input command
+ * @return false if line is not a mutation command
  */
-void bootStrap()
+bool applyMutationCommand(const string &line)
 {
-    cout << "\n Welcome to Amazon Inventory Query System" << endl;
-    cout << " enter :quit to exit. or :help to list supported commands." << endl;
-    
-    // Load CSV data into hash table and build category index
-    // The parser sanitizes data and handles multi-line fields
-    const string csv = "marketing_sample_for_amazon_com-ecommerce__20200101_20200131__10k_data.csv";
-    if (!inv::loadCsv(csv, g_table, g_categoryIndex)) {
-        cout << "Failed to load dataset: " << csv << endl;
+    if (line.rfind(":load ", 0) == 0)
+    {
+        string path = inv::detail::trim(line.substr(6));
+        string error;
+        if (loadDataset(path, error)) cout << "Loaded " << path << " (log position " << g_engine.mutationLog()->end() << ")" << endl;
+        else cout << "Failed to load dataset: " << path << (error.empty() ? "" : " (" + error + ")") << endl;
+        return true;
     }
-    cout << "\n> ";
+    if (line.rfind(":erase ", 0) == 0)
+    {
+        if (g_engine.eraseProduct(inv::detail::trim(line.substr(7)))) cout << "Erased (log position " << g_engine.mutationLog()->end() << ")" << endl;
+        else cout << "Inventory not found" << endl;
+        return true;
+    }
+    return false;
 }
 
 /**
@@ -241,21 +232,214 @@ void bootStrap()
  */
 int main(int argc, char const *argv[])
 {
+    bool perf = false;
+    bool readonly = false;
+    string catalog, saveCatalog, shm, publishShm, serve, shards, primaryEndpoint, replicaOf, cdc, watch;
+    string csv = "marketing_sample_for_amazon_com-ecommerce__20200101_20200131__10k_data.csv";
+    for (int i = 1; i < argc; ++i)
+    {
+        string arg = argv[i];
+        if (arg == "--record" && i + 1 < argc)
+        {
+            g_record.open(argv[++i], std::ios::app);
+            if (!g_record.is_open()) {
+                std::cerr << "Failed to open record file: " << argv[i] << endl;
+                return 1;
+            }
+        }
+        else if (arg == "--perf")
+        {
+            perf = true;
+        }
+        else if (arg == "--compress-descriptions")
+        {
+            g_engine.setCompressDescriptions(true);
+        }
+        else if (arg == "--lazy-cold-fields")
+        {
+            g_engine.setLazyColdFields(true);
+        }
+        else if (arg == "--readonly")
+        {
+            readonly = true;
+        }
+        else if (arg == "--miss-filter")
+        {
+            g_engine.setMissFilter(true);
+        }
+        else if (arg == "--prerender")
+        {
+            g_engine.setPrerenderedOutput(true);
+        }
+        else if (arg == "--coalesce")
+        {
+            g_engine.enableRequestCoalescing(true);
+        }
+        else if (arg == "--load-threads" && i + 1 < argc)
+        {
+            g_engine.setLoadPipeline(std::strtoull(argv[++i], nullptr, 10));
+        }
+        else if (arg == "--load" && i + 1 < argc)
+        {
+            csv = argv[++i];
+        }
+        else if (arg == "--catalog" && i + 1 < argc)
+        {
+            catalog = argv[++i];
+        }
+        else if (arg == "--save-catalog" && i + 1 < argc)
+        {
+            saveCatalog = argv[++i];
+        }
+        else if (arg == "--shm" && i + 1 < argc)
+        {
+            shm = argv[++i];
+        }
+        else if (arg == "--publish-shm" && i + 1 < argc)
+        {
+            publishShm = argv[++i];
+        }
+        else if (arg == "--shard" && i + 1 < argc)
+        {
+            unsigned long k = 0, n = 0;
+            char slash = 0;
+            std::istringstream spec(argv[++i]);
+            if (!(spec >> k >> slash >> n) || slash != '/' || n == 0 || k >= n) {
+                std::cerr << "--shard expects <k>/<N> with k < N" << endl;
+                return 1;
+            }
+            g_engine.setShard(k, n);
+        }
+        else if (arg == "--serve" && i + 1 < argc)
+        {
+            serve = argv[++i];
+        }
+        else if (arg == "--shards" && i + 1 < argc)
+        {
+            shards = argv[++i];
+        }
+        else if (arg == "--primary" && i + 1 < argc)
+        {
+            primaryEndpoint = argv[++i];
+        }
+        else if (arg == "--replica-of" && i + 1 < argc)
+        {
+            replicaOf = argv[++i];
+        }
+        else if (arg == "--cdc" && i + 1 < argc)
+        {
+            cdc = argv[++i];
+        }
+        else if (arg == "--watch" && i + 1 < argc)
+        {
+            watch = argv[++i];
+        }
+        else if (arg == "--result-cache" && i + 1 < argc)
+        {
+            g_engine.enableResultCache(std::strtoull(argv[++i], nullptr, 10) << 20);
+        }
+        else
+        {
+            std::cerr << "usage: " << argv[0] << " [--record <file>] [--perf] [--compress-descriptions] [--lazy-cold-fields] [--readonly] [--miss-filter] [--catalog <file>] [--save-catalog <file>] [--shm <name>] [--publish-shm <name>] [--shard <k>/<N>] [--serve <endpoint>] [--shards <endpoints>] [--primary <endpoint>] [--replica-of <endpoint>] [--cdc <endpoint>] [--watch <endpoint>] [--result-cache <MiB>] [--prerender] [--coalesce] [--load-threads <N>] [--load <csv|->]" << endl;
+            return 1;
+        }
+    }
+
+    if (!watch.empty())
+    {
+        // Change feed consumer: print events until the server goes away
+        inv::ChangeFeedClient client;
+        if (!client.connect(watch)) {
+            std::cerr << "Failed to connect to change feed: " << watch << endl;
+            return 1;
+        }
+        std::vector<inv::ChangeEvent> events;
+        while (client.next(events))
+        {
+            for (const auto &e : events) inv::printChangeEvent(e, cout);
+            cout << std::flush;
+        }
+        return 0;
+    }
+
+    g_engine.enableCommandStats(perf);
+
+    // Change feed: on before loading so a replica's catch-up is streamed too
+    inv::ChangeFeedServer changes;
+    std::thread changesThread;
+    if (!cdc.empty())
+    {
+        if (!changes.listen(cdc)) {
+            std::cerr << "Failed to serve change feed on " << cdc << endl;
+            return 1;
+        }
+        inv::ChangeFeed &feed = g_engine.enableChangeFeed();
+        changesThread = std::thread([&changes, &feed]() { changes.serve(feed); });
+    }
+
     string line;
-    bootStrap();  // Initialize and load data
-    
+    bootStrap(catalog, shm, shards, replicaOf, csv);  // Initialize and load data
+    if (!saveCatalog.empty() && !g_engine.saveCatalog(saveCatalog)) {
+        std::cerr << "Failed to write catalog: " << saveCatalog << endl;
+    }
+    if (!publishShm.empty() && !g_engine.publishCatalog(publishShm)) {
+        std::cerr << "Failed to publish shared catalog: " << publishShm << endl;
+    }
+    if (readonly) g_engine.freeze();
+
+    // Primary: stream the mutation log to replicas in the background
+    inv::ReplicationServer replication;
+    std::thread replicationThread;
+    if (!primaryEndpoint.empty())
+    {
+        if (!g_engine.enableMutationLog() || !replication.listen(primaryEndpoint)) {
+            std::cerr << "Failed to serve replicas on " << primaryEndpoint << endl;
+            return 1;
+        }
+        std::cerr << "Streaming mutation log to replicas on " << replication.endpoint() << endl;
+        replicationThread = std::thread([&replication]() { replication.serve(g_engine); });
+    }
+
+    if (!serve.empty())
+    {
+        // Shard server: answer commands on the socket until killed
+        inv::ShardServer server;
+        if (!server.listen(serve)) {
+            std::cerr << "Failed to listen on " << serve << endl;
+            return 1;
+        }
+        std::cerr << "Serving shard " << g_engine.shard().index << "/" << g_engine.shard().count << " ("
+                  << g_engine.productCount() << " products) on " << server.endpoint() << endl;
+        server.serve(g_engine);
+        replication.stop();
+        if (replicationThread.joinable()) replicationThread.join();
+        changes.stop();
+        if (changesThread.joinable()) changesThread.join();
+        return 0;
+    }
+
     // Main loop: read commands until user enters ":quit"
     while (getline(cin, line) && line != ":quit")
     {
-        if (validCommand(line))
+        if (g_record.is_open()) g_record << line << '\n';
+        if (g_engine.mutationLog() && applyMutationCommand(line))
+        {
+            // Handled (primary only)
+        }
+        else if (inv::Engine::validCommand(line))
         {
-            evalCommand(line);
+            if (g_router.shardCount() > 0) g_router.evalCommand(line, cout);
+            else g_engine.evalCommand(line, cout);
         }
         else
         {
             cout << "Command not supported. Enter :help for list of supported commands" << endl;
         }
-        cout << "> ";  // Display prompt for next command
+        cout << "> " << std::flush;  // Display prompt for next command
     }
+    replication.stop();
+    if (replicationThread.joinable()) replicationThread.join();
+    changes.stop();
+    if (changesThread.joinable()) changesThread.join();
     return 0;
 }
@@ -0,0 +1,382 @@
+/**
+ * Query Workload Replayer and Load Generator
+ *
+ * Drives an in-process inv::Engine with a stream of REPL commands from N
+ * threads and reports throughput and the latency distribution. Used as the
+ * acceptance test for concurrency and caching changes to the engine.
+ *
+ * Workload sources:
+ * - Recorded: a file with one command per line, e.g. produced by
+ *   `mainexe --record cmds.txt`. Commands are replayed in order, round-robin
+ *   across threads, looping over the file until --ops commands have run.
+ * - Synthetic (default): a mix of `find <id>` and `listInventory <category>`
+ *   over the ids and categories actually loaded. Both are drawn from Zipf
+ *   distributions so a few hot ids/categories dominate, like real traffic.
+ *   A share of finds can target ids that do not exist.
+ *
+ * Pacing:
+ * - --rate 0 (default): closed loop, each thread issues its next command as
+ *   soon as the previous one finishes.
+ * - --rate R: open loop at R commands/s in total. Latency is measured from the
+ *   time a command was scheduled, not when it started, so queueing caused by
+ *   a slow engine shows up in the tail instead of being hidden.
+ *
+ * Engine statistics:
+ * - --stats: print the engine's per-command breakdown (as `:stats` does)
+ * - --perf:  same, with hardware counters per command (implies --stats)
+ *
+ * --readonly freezes the engine into its perfect-hash snapshot after the
+ * workload is built, to measure single-probe lookups. --miss-filter loads
+ * the catalog with a Bloom filter in front of find (pair with --miss-pct).
+ * --catalog maps a table file written by `mainexe --save-catalog` instead of
+ * parsing the CSV, as a read-only replica process would; --shm attaches to a
+ * catalog published to shared memory by `mainexe --publish-shm`.
+ * --replica-of follows a primary (`mainexe --primary <endpoint>`) instead,
+ * running the workload once caught up while the replica keeps applying.
+ * --result-cache serves repeated find/listInventory output from a cache of
+ * the given size and prints its hit rate after the run. --prerender renders
+ * every product's find output at load time, so find writes stored bytes.
+ * --coalesce lets identical listInventory commands running at the same
+ * time on different threads share one scan.
+ *
+ * Usage:
+ *   ./replayexe [--csv path] [--commands file] [--ops N] [--threads T]
+ *               [--rate R] [--zipf S] [--find-pct P] [--miss-pct P] [--seed S]
+ *               [--stats] [--perf] [--readonly] [--miss-filter]
+ *               [--catalog file] [--shm name] [--replica-of endpoint]
+ *               [--result-cache MiB] [--prerender] [--coalesce]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../Headers/Engine.hpp"
+#include "../Headers/Replication.hpp"
+
+using std::cerr;
+using std::cout;
+using std::endl;
+using std::size_t;
+using std::string;
+using std::vector;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const char *kDefaultCsv = "marketing_sample_for_amazon_com-ecommerce__20200101_20200131__10k_data.csv";
+
+/**
+ * Replay configuration (command-line options)
+ */
+struct Options {
+    string csv = kDefaultCsv;
+    string commands;          // Recorded command file; empty = synthetic workload
+    string catalog;           // Mapped catalog file to serve instead of the CSV
+    string shm;               // Shared-memory catalog to serve instead of the CSV
+    string replicaOf;         // Primary to replicate instead of loading the CSV
+    size_t ops = 0;           // Total commands to run (0 = file length, or 100000 for synthetic)
+    unsigned threads = 1;
+    double rate = 0.0;        // Total commands per second (0 = unthrottled)
+    double zipf = 1.0;        // Zipf exponent for id/category popularity
+    int findPct = 90;         // Share of synthetic commands that are finds
+    int missPct = 0;          // Share of synthetic finds that target missing ids
+    uint64_t seed = 7;
+    bool stats = false;       // Report engine per-command statistics
+    bool perf = false;        // Include hardware counters in those statistics
+    bool readonly = false;    // Freeze into the perfect-hash snapshot before running
+    bool missFilter = false;  // Load with a miss filter in front of the product table
+    size_t resultCacheMiB = 0;  // Result cache size (0 = no cache)
+    bool prerender = false;   // Pre-render find output at load time
+    bool coalesce = false;    // Share in-flight listInventory output between threads
+};
+
+/**
+ * ZipfSampler - Draws ranks 0..n-1 with P(k) proportional to 1 / (k+1)^s
+ * Precomputes the CDF once; each draw is a binary search.
+ */
+class ZipfSampler {
+public:
+    ZipfSampler(size_t n, double s) : cdf_(n) {
+        double sum = 0.0;
+        for (size_t k = 0; k < n; ++k) { sum += 1.0 / std::pow(static_cast<double>(k + 1), s); cdf_[k] = sum; }
+        for (auto &c : cdf_) c /= sum;
+    }
+
+    template <typename Rng>
+    size_t operator()(Rng &rng) const {
+        double u = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+        auto it = std::lower_bound(cdf_.begin(), cdf_.end(), u);
+        return it == cdf_.end() ? cdf_.size() - 1 : static_cast<size_t>(it - cdf_.begin());
+    }
+
+private:
+    vector<double> cdf_;
+};
+
+/**
+ * Read a recorded command file (one command per line, blank lines and
+ * :quit skipped)
+ */
+bool readCommands(const string &path, vector<string> &out) {
+    std::ifstream in(path);
+    if (!in.is_open()) return false;
+    string line;
+    while (std::getline(in, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty() || line == ":quit") continue;
+        out.push_back(line);
+    }
+    return true;
+}
+
+/**
+ * Build a synthetic Zipf-distributed find/listInventory mix over the
+ * engine's real ids and categories
+ */
+vector<string> makeSynthetic(const inv::Engine &engine, const Options &opt) {
+    std::mt19937_64 rng(opt.seed);
+    vector<string> ids;
+    vector<string> cats;
+    ids.reserve(engine.productCount());
+    if (engine.mapped()) {
+        std::shared_ptr<const inv::MappedCatalog> cat = engine.mappedCatalog();
+        cat->products.forEach([&](const string &key, const inv::Product &) { ids.push_back(key); });
+        cat->categories.forEach([&](const string &c, const vector<string> &) { cats.push_back(c); });
+    } else {
+        engine.table().forEach([&](const string &key, const inv::Product &) { ids.push_back(key); });
+        for (const auto &kv : engine.categoryIndex()) cats.push_back(kv.first);
+    }
+    // Sort before shuffling so popularity ranks are reproducible for a seed
+    std::sort(ids.begin(), ids.end());
+    std::sort(cats.begin(), cats.end());
+    std::shuffle(ids.begin(), ids.end(), rng);
+    std::shuffle(cats.begin(), cats.end(), rng);
+
+    vector<string> cmds;
+    if (ids.empty() || cats.empty()) return cmds;
+    ZipfSampler idRank(ids.size(), opt.zipf), catRank(cats.size(), opt.zipf);
+    std::uniform_int_distribution<int> pct(0, 99);
+    cmds.reserve(opt.ops);
+    for (size_t i = 0; i < opt.ops; ++i) {
+        if (pct(rng) < opt.findPct) {
+            if (pct(rng) < opt.missPct) {
+                std::ostringstream miss;
+                miss << "find missing-" << std::hex << rng();
+                cmds.push_back(miss.str());
+            } else {
+                cmds.push_back("find " + ids[idRank(rng)]);
+            }
+        } else {
+            cmds.push_back("listInventory " + cats[catRank(rng)]);
+        }
+    }
+    return cmds;
+}
+
+/**
+ * Per-thread results
+ */
+struct ThreadResult {
+    vector<uint64_t> latencyNs;
+    size_t outputBytes {0};
+};
+
+/**
+ * Worker: runs commands t, t+T, t+2T, ... and records each latency
+ */
+void runThread(const inv::Engine &engine, const vector<string> &cmds, const Options &opt,
+               unsigned t, Clock::time_point start, ThreadResult &res) {
+    std::ostringstream out;
+    const double interval = opt.rate > 0 ? 1e9 / opt.rate : 0.0;
+    res.latencyNs.reserve(opt.ops / opt.threads + 1);
+    for (size_t i = t; i < opt.ops; i += opt.threads) {
+        Clock::time_point begin;
+        if (interval > 0) {
+            // Open loop: command i is due at start + i * interval
+            begin = start + std::chrono::nanoseconds(static_cast<int64_t>(static_cast<double>(i) * interval));
+            auto now = Clock::now();
+            if (begin > now) std::this_thread::sleep_until(begin);
+        } else {
+            begin = Clock::now();
+        }
+        out.str("");
+        out.clear();
+        engine.evalCommand(cmds[i % cmds.size()], out);
+        auto end = Clock::now();
+        res.outputBytes += static_cast<size_t>(out.tellp());
+        res.latencyNs.push_back(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count()));
+    }
+}
+
+/**
+ * Value at quantile q of a sorted sample
+ */
+uint64_t quantile(const vector<uint64_t> &sorted, double q) {
+    if (sorted.empty()) return 0;
+    size_t idx = static_cast<size_t>(std::ceil(q * static_cast<double>(sorted.size())));
+    idx = idx == 0 ? 0 : idx - 1;
+    return sorted[std::min(idx, sorted.size() - 1)];
+}
+
+/**
+ * Print a latency value in microseconds
+ */
+string us(uint64_t ns) {
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(1) << static_cast<double>(ns) / 1000.0 << " us";
+    return oss.str();
+}
+
+} // namespace
+
+/**
+ * Replay entry point
+ * Loads the dataset, builds the workload, runs it and prints the report
+ */
+int main(int argc, char const *argv[]) {
+    Options opt;
+    for (int i = 1; i < argc; ++i) {
+        string a = argv[i];
+        auto next = [&]() -> const char * { return i + 1 < argc ? argv[++i] : nullptr; };
+        const char *v = nullptr;
+        if (a == "--csv" && (v = next())) opt.csv = v;
+        else if (a == "--commands" && (v = next())) opt.commands = v;
+        else if (a == "--catalog" && (v = next())) opt.catalog = v;
+        else if (a == "--shm" && (v = next())) opt.shm = v;
+        else if (a == "--replica-of" && (v = next())) opt.replicaOf = v;
+        else if (a == "--ops" && (v = next())) opt.ops = static_cast<size_t>(std::strtoull(v, nullptr, 10));
+        else if (a == "--threads" && (v = next())) opt.threads = static_cast<unsigned>(std::max(1, std::atoi(v)));
+        else if (a == "--rate" && (v = next())) opt.rate = std::atof(v);
+        else if (a == "--zipf" && (v = next())) opt.zipf = std::atof(v);
+        else if (a == "--find-pct" && (v = next())) opt.findPct = std::atoi(v);
+        else if (a == "--miss-pct" && (v = next())) opt.missPct = std::atoi(v);
+        else if (a == "--seed" && (v = next())) opt.seed = std::strtoull(v, nullptr, 10);
+        else if (a == "--stats") opt.stats = true;
+        else if (a == "--perf") opt.stats = opt.perf = true;
+        else if (a == "--readonly") opt.readonly = true;
+        else if (a == "--miss-filter") opt.missFilter = true;
+        else if (a == "--result-cache" && (v = next())) opt.resultCacheMiB = std::strtoull(v, nullptr, 10);
+        else if (a == "--prerender") opt.prerender = true;
+        else if (a == "--coalesce") opt.coalesce = true;
+        else {
+            cerr << "usage: " << argv[0] << " [--csv path] [--commands file] [--ops N] [--threads T]"
+                 << " [--rate R] [--zipf S] [--find-pct P] [--miss-pct P] [--seed S] [--stats] [--perf] [--readonly] [--miss-filter] [--catalog file] [--shm name] [--replica-of endpoint] [--result-cache MiB] [--prerender] [--coalesce]" << endl;
+            return 1;
+        }
+    }
+
+    inv::Engine engine;
+    inv::Replica replica;
+    engine.setMissFilter(opt.missFilter);
+    engine.enableResultCache(opt.resultCacheMiB << 20);
+    engine.setPrerenderedOutput(opt.prerender);
+    engine.enableRequestCoalescing(opt.coalesce);
+    auto loadStart = Clock::now();
+    if (!opt.replicaOf.empty()) {
+        if (!replica.start(opt.replicaOf, engine) || !replica.waitCaughtUp(std::chrono::seconds(60))) {
+            std::string why = replica.error();
+            cerr << "Failed to catch up with primary: " << opt.replicaOf << (why.empty() ? "" : " (" + why + ")") << endl;
+            return 1;
+        }
+    } else if (!opt.shm.empty()) {
+        if (!engine.attachSharedCatalog(opt.shm)) {
+            cerr << "Failed to attach shared catalog: " << opt.shm << endl;
+            return 1;
+        }
+    } else if (!opt.catalog.empty()) {
+        if (!engine.openCatalog(opt.catalog)) {
+            cerr << "Failed to open catalog: " << opt.catalog << endl;
+            return 1;
+        }
+    } else if (!engine.load(opt.csv)) {
+        cerr << "Failed to load dataset: " << opt.csv << endl;
+        return 1;
+    }
+    double loadSec = std::chrono::duration<double>(Clock::now() - loadStart).count();
+
+    vector<string> cmds;
+    if (!opt.commands.empty()) {
+        if (!readCommands(opt.commands, cmds)) {
+            cerr << "Failed to open command file: " << opt.commands << endl;
+            return 1;
+        }
+        if (opt.ops == 0) opt.ops = cmds.size();
+    } else {
+        if (opt.ops == 0) opt.ops = 100'000;
+        cmds = makeSynthetic(engine, opt);
+    }
+    if (cmds.empty()) {
+        cerr << "No commands to replay" << endl;
+        return 1;
+    }
+
+    if (opt.readonly) {
+        replica.stop();  // A frozen engine cannot apply further mutations
+        engine.freeze();
+    }
+    if (opt.stats) engine.enableCommandStats(opt.perf);
+
+    vector<ThreadResult> results(opt.threads);
+    vector<std::thread> workers;
+    auto start = Clock::now();
+    for (unsigned t = 0; t < opt.threads; ++t) {
+        workers.emplace_back(runThread, std::cref(engine), std::cref(cmds), std::cref(opt), t, start, std::ref(results[t]));
+    }
+    for (auto &w : workers) w.join();
+    double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+    vector<uint64_t> all;
+    size_t bytes = 0;
+    for (auto &r : results) {
+        all.insert(all.end(), r.latencyNs.begin(), r.latencyNs.end());
+        bytes += r.outputBytes;
+    }
+    std::sort(all.begin(), all.end());
+    double mean = 0.0;
+    for (auto ns : all) mean += static_cast<double>(ns);
+    mean = all.empty() ? 0.0 : mean / static_cast<double>(all.size());
+
+    cout << std::fixed;
+    cout << "Dataset: " << (!opt.replicaOf.empty() ? "replica of " + opt.replicaOf : !opt.shm.empty() ? opt.shm : !opt.catalog.empty() ? opt.catalog : opt.csv) << " (" << engine.productCount() << " products, loaded in "
+         << std::setprecision(2) << loadSec << " s)" << endl;
+    cout << "Workload: " << (opt.commands.empty() ? "synthetic zipf" : opt.commands)
+         << ", " << all.size() << " commands, " << opt.threads << " thread(s), rate "
+         << (opt.rate > 0 ? std::to_string(static_cast<long long>(opt.rate)) + "/s" : string("unthrottled")) << endl;
+    cout << "Elapsed: " << std::setprecision(3) << elapsed << " s" << endl;
+    cout << "Throughput: " << std::setprecision(0) << (elapsed > 0 ? static_cast<double>(all.size()) / elapsed : 0.0)
+         << " cmd/s, " << std::setprecision(1) << (elapsed > 0 ? static_cast<double>(bytes) / (1024.0 * 1024.0) / elapsed : 0.0)
+         << " MiB/s output" << endl;
+    cout << "Latency: mean " << us(static_cast<uint64_t>(mean))
+         << ", p50 " << us(quantile(all, 0.50))
+         << ", p90 " << us(quantile(all, 0.90))
+         << ", p99 " << us(quantile(all, 0.99))
+         << ", p99.9 " << us(quantile(all, 0.999))
+         << ", max " << us(all.empty() ? 0 : all.back()) << endl;
+    if (opt.stats) {
+        cout << "Engine command statistics:" << endl;
+        engine.printCommandStats(cout);
+    } else if (const inv::ResultCache *cache = engine.resultCache()) {
+        inv::ResultCacheStats rc = cache->stats();
+        cout << "Result cache: " << rc.hits << " hits, " << rc.misses << " misses, " << rc.entries << " entries, "
+             << rc.bytes << " bytes, " << rc.evictions << " evictions" << endl;
+    }
+    if (!opt.stats) {
+        if (const inv::SingleFlight *sf = engine.requestCoalescing()) {
+            inv::SingleFlightStats st = sf->stats();
+            cout << "Request coalescing: " << st.computed << " computed, " << st.shared << " shared" << endl;
+        }
+    }
+    return 0;
+}
@@ -6,10 +6,47 @@
  * Each test function focuses on a specific aspect of the hash table's behavior.
  */
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdint>
+#include <fstream>
 #include <iostream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
 #include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "../Headers/ChangeFeed.hpp"
+#include "../Headers/CuckooHashTable.hpp"
+#include "../Headers/DescriptionStore.hpp"
+#include "../Headers/Engine.hpp"
 #include "../Headers/HashTable.hpp"
+#include "../Headers/LoadPipeline.hpp"
+#include "../Headers/MappedHashTable.hpp"
+#include "../Headers/MemoryUsage.hpp"
+#include "../Headers/Parser.hpp"
+#include "../Headers/PerfectHashTable.hpp"
+#include "../Headers/PoolAllocator.hpp"
+#include "../Headers/Replication.hpp"
+#include "../Headers/ResultCache.hpp"
+#include "../Headers/RobinHoodTable.hpp"
+#include "../Headers/SharedCatalog.hpp"
+#include "../Headers/Shard.hpp"
+#include "../Headers/SingleFlight.hpp"
+#include "../Headers/SmallString.hpp"
+#include "../Headers/SpscRing.hpp"
+#include "../Headers/StreamInput.hpp"
 
 using namespace std;
 
@@ -82,6 +119,44 @@ void test_insert_update() {
     assert(f != nullptr && f->productName == "First-updated");  // Verify value was updated
 }
 
+/**
+ * Test: Move-aware insert, emplace and try_emplace
+ * 
+ * Purpose: Validates that rvalue insert moves the value in, emplace
+ *          inserts-or-updates, and try_emplace never touches an existing
+ *          entry (nor its arguments).
+ * 
+ * Why chosen: The loader moves every Product into the table instead of
+ *             copying it, so the move paths must store the same data the
+ *             copying insert would, and report new vs. updated correctly.
+ */
+void test_move_insert_and_emplace() {
+    inv::HashTable<inv::Product> ht(3);
+    auto p1 = makeProduct("m1", "Moved");
+    p1.productDescription = string(200, 'x');  // Heap-allocated, so a move leaves the source empty
+    string key = p1.uniqId;
+    assert(ht.insert(std::move(key), std::move(p1)) == true);
+    assert(p1.productDescription.empty());  // Moved from, not copied
+    auto *f = ht.find("m1");
+    assert(f != nullptr && f->productName == "Moved" && f->productDescription.size() == 200);
+
+    // emplace updates an existing key, like insert
+    auto r = ht.emplace(string("m1"), makeProduct("m1", "Replaced"));
+    assert(r.second == false && r.first == ht.find("m1") && r.first->productName == "Replaced");
+
+    // try_emplace leaves an existing entry and its argument untouched
+    auto p2 = makeProduct("m1", "Ignored");
+    auto r2 = ht.try_emplace(string("m1"), std::move(p2));
+    assert(r2.second == false && r2.first->productName == "Replaced");
+    assert(p2.productName == "Ignored");
+
+    // New keys: pointer stays valid across the rehashes that follow
+    auto r3 = ht.try_emplace(string("m2"), makeProduct("m2", "Second"));
+    assert(r3.second == true);
+    for (int i = 0; i < 50; ++i) ht.emplace("filler" + to_string(i), makeProduct("f", "Filler"));
+    assert(r3.first == ht.find("m2") && r3.first->productName == "Second");
+}
+
 // ============================================================================
 // FIND OPERATION TESTS
 // ============================================================================
@@ -229,6 +304,1716 @@ void test_template_insert_update_int() {
     assert(v != nullptr && *v == 11);  // Verify value was updated
 }
 
+// ============================================================================
+// STATISTICS TESTS
+// ============================================================================
+
+/**
+ * Test: Verify stats() reports a layout consistent with the table contents
+ * 
+ * Purpose: Validates that the chain histogram accounts for every bucket and
+ *          entry, and that rehashes and probe averages are reported.
+ * 
+ * Why chosen: The statistics are used to diagnose hash clustering, so they
+ *             must agree exactly with size() and bucketCount().
+ */
+void test_stats_consistent() {
+    inv::HashTable<int> ht(3);
+    const int N = 50;
+    for (int i = 0; i < N; ++i) ht.insert("s" + to_string(i), i);
+
+    inv::HashTableStats st = ht.stats();
+    assert(st.size == ht.size());
+    assert(st.bucketCount == ht.bucketCount());
+    assert(st.rehashCount > 0);  // 50 items in 3 buckets must have grown the table
+
+    size_t buckets = 0, entries = 0;
+    for (size_t k = 0; k < st.chainHistogram.size(); ++k) {
+        buckets += st.chainHistogram[k];
+        entries += k * st.chainHistogram[k];
+    }
+    assert(buckets == st.bucketCount);  // Every bucket counted exactly once
+    assert(entries == st.size);         // Every entry counted exactly once
+    assert(st.chainHistogram[0] == st.emptyBuckets);
+    assert(st.chainHistogram.size() == st.longestChain + 1);
+    assert(st.avgProbesHit >= 1.0 && st.avgProbesHit <= st.longestChain);
+}
+
+// ============================================================================
+// ALLOCATOR TESTS
+// ============================================================================
+
+/**
+ * Test: Use HashTable with PoolAllocator through growth and churn
+ * 
+ * Purpose: Validates that a pooled table behaves exactly like the default
+ *          one across rehashes, and that erased nodes are reused instead of
+ *          growing the pool. Also checks that a pooled bucket stays two
+ *          pointers and that a table can use a pool owned by the caller.
+ * 
+ * Why chosen: The pool replaces per-node malloc for the whole catalog, so
+ *             rehash (which relinks nodes between buckets) and erase/insert
+ *             churn must both keep working and keep memory bounded.
+ */
+void test_pool_allocator_churn() {
+    inv::HashTable<int, inv::PoolAllocator<int>> ht(3);
+    const int N = 500;
+    for (int i = 0; i < N; ++i) assert(ht.insert("p" + to_string(i), i));
+    assert((int)ht.size() == N);
+    for (int i = 0; i < N; ++i) {
+        auto *v = ht.find("p" + to_string(i));
+        assert(v != nullptr && *v == i);  // Survived every rehash
+    }
+
+    const size_t slabs = ht.get_allocator().pool().slabCount();
+    for (int round = 0; round < 5; ++round) {
+        for (int i = 0; i < N; ++i) assert(ht.erase("p" + to_string(i)));
+        assert(ht.size() == 0);
+        for (int i = 0; i < N; ++i) assert(ht.insert("p" + to_string(i), i + round));
+    }
+    assert(ht.get_allocator().pool().slabCount() == slabs);  // Freed nodes were reused
+    assert(*ht.find("p7") == 7 + 4);
+    assert((inv::HashTable<int, inv::PoolAllocator<int>>::bucketBytes() == 2 * sizeof(void *)));
+
+    inv::NodePool own(4096);
+    {
+        inv::HashTable<int, inv::PoolAllocator<int>> shared(3, inv::PoolAllocator<int>(own));
+        for (int i = 0; i < N; ++i) assert(shared.insert("q" + to_string(i), i));
+        assert(&shared.get_allocator().pool() == &own && own.slabCount() > 0);
+    }
+    assert(own.bytesInUse() == 0);
+}
+
+// ============================================================================
+// MEMORY ACCOUNTING TESTS
+// ============================================================================
+
+/**
+ * Test: Verify measureMemory() counts heap strings, inline strings and nodes
+ * 
+ * Purpose: Validates that long strings are counted with their capacity,
+ *          short (SSO) strings are not counted, and every node and category
+ *          index entry is accounted for.
+ * 
+ * Why chosen: The :memory report is used to decide where memory goes, so
+ *             each bucket of the breakdown must be exact.
+ */
+void test_memory_accounting() {
+    inv::HashTable<inv::Product> ht(5);
+    unordered_map<string, vector<string>> index;
+    auto p = makeProduct("m1", "Short");
+    p.productDescription = string(1000, 'd');  // Forces a heap buffer
+    ht.insert(p.uniqId, p);
+    index["Test"].push_back(p.uniqId);
+
+    inv::MemoryReport r = inv::measureMemory(ht, index);
+    assert(r.products == 1 && r.categories == 1);
+    assert(r.tableNodes.allocations == 1);
+    assert(r.tableNodes.requested == decltype(ht)::nodeBytes());
+    assert(r.keyStrings.allocations == 0);  // "m1" fits in the small-string buffer
+
+    const inv::Product *stored = ht.find("m1");
+    assert(stored != nullptr);
+    // Description buffer + categories vector buffer; every other field is short
+    assert(r.fieldStrings.allocations == 2);
+    assert(r.fieldStrings.requested == stored->productDescription.capacity() + 1
+                                       + stored->categories.capacity() * sizeof(string));
+    assert(r.indexNodes.allocations == 1 && r.indexIdVectors.allocations == 1);
+
+    // Allocator slack is never negative and chunks are never smaller than requests
+    for (size_t req : {1u, 24u, 25u, 1000u, 200000u}) assert(inv::mallocChunkBytes(req) >= req);
+}
+
+// ============================================================================
+// MISS FILTER TESTS
+// ============================================================================
+
+/**
+ * Test: Miss filter never hides a stored key and rejects most absent ones
+ * 
+ * Purpose: Enables the Bloom filter on a populated table, keeps inserting
+ *          through several rehashes, erases some keys, and checks that every
+ *          stored key is still found, erased and never-inserted keys are not,
+ *          and that at most a few percent of absent keys pass the filter.
+ * 
+ * Why chosen: A false negative in the filter would make `find` report an
+ *             existing product as missing, so correctness across inserts,
+ *             rehashes (filter rebuilds) and erasures matters more than the
+ *             exact false positive rate.
+ */
+void test_miss_filter() {
+    inv::HashTable<int> ht(11);
+    for (int i = 0; i < 100; ++i) ht.insert("key-" + to_string(i), i);
+    ht.enableMissFilter();
+    assert(ht.missFilterEnabled());
+    for (int i = 100; i < 5000; ++i) ht.insert("key-" + to_string(i), i);  // Several rehashes
+    for (int i = 0; i < 5000; i += 2) assert(ht.erase("key-" + to_string(i)));
+    for (int i = 0; i < 5000; ++i) {
+        const int *v = ht.find("key-" + to_string(i));
+        if (i % 2) assert(v != nullptr && *v == i);
+        else assert(v == nullptr);
+    }
+
+    const inv::BlockedBloomFilter &filter = ht.missFilter();
+    size_t passed = 0;
+    for (int i = 0; i < 10000; ++i) passed += filter.mayContain(std::hash<string>{}("absent-" + to_string(i)));
+    assert(passed < 10000 * 3 / 100);
+
+    inv::HashTableStats st = ht.stats();
+    assert(st.missFilter && st.filterBytes == filter.bytes());
+    assert(st.filterFalsePositiveRate > 0.0 && st.filterFalsePositiveRate < 0.03);
+
+    ht.clear();
+    assert(ht.missFilterEnabled() && ht.find("key-1") == nullptr);
+    ht.insert("key-1", 1);
+    assert(*ht.find("key-1") == 1);
+    ht.disableMissFilter();
+    assert(!ht.missFilterEnabled() && *ht.find("key-1") == 1 && !ht.stats().missFilter);
+}
+
+// ============================================================================
+// ROBIN HOOD TABLE TESTS
+// ============================================================================
+
+/**
+ * Test: RobinHoodTable matches a reference map under insert/erase churn
+ * 
+ * Purpose: Runs random inserts, updates, erases and finds against both a
+ *          RobinHoodTable that starts at its minimum size (so runs wrap
+ *          around the end of the slot array and the table grows several
+ *          times) and std::unordered_map, checking every answer. Afterwards
+ *          the probe lengths must equal those of a table of the same
+ *          capacity built fresh from the surviving keys.
+ * 
+ * Why chosen: Backward-shift deletion exists so that churn leaves no
+ *             tombstones; identical probe statistics to a fresh build show
+ *             that erases restore the layout instead of degrading it.
+ */
+void test_robin_hood_table() {
+    inv::RobinHoodTable<int> rh(1);
+    unordered_map<string, int> ref;
+    unsigned x = 12345;
+    auto rnd = [&]() { x = x * 1103515245u + 12345u; return (x >> 8) % 3000; };
+    for (int step = 0; step < 40000; ++step) {
+        string k = "k" + to_string(rnd());
+        if (step % 3 == 0) {
+            assert(rh.erase(k) == (ref.erase(k) == 1));
+        } else {
+            bool isNew = ref.find(k) == ref.end();
+            ref[k] = step;
+            assert(rh.insert(k, step) == isNew);
+        }
+        const int *v = rh.find(k);
+        auto it = ref.find(k);
+        assert((v == nullptr) == (it == ref.end()));
+        if (v) assert(*v == it->second);
+        assert(rh.size() == ref.size());
+    }
+    size_t visited = 0;
+    rh.forEach([&](const string &k, const int &v) { ++visited; assert(ref.at(k) == v); });
+    assert(visited == ref.size());
+
+    inv::RobinHoodTable<int> fresh(0);
+    fresh.reserve(static_cast<size_t>(static_cast<double>(rh.slotCount()) * inv::RobinHoodTable<int>::kMaxLoadFactor));
+    assert(fresh.slotCount() == rh.slotCount());
+    for (const auto &kv : ref) fresh.insert(kv.first, kv.second);
+    inv::RobinHoodStats churned = rh.stats(), built = fresh.stats();
+    assert(churned.size == built.size && churned.emptySlots == built.emptySlots);
+    assert(churned.longestProbe == built.longestProbe && churned.probeHistogram == built.probeHistogram);
+    assert(churned.avgProbesMiss == built.avgProbesMiss);
+
+    // try_emplace leaves existing entries alone; copies are deep
+    auto r = rh.try_emplace(ref.begin()->first, -1);
+    assert(!r.second && *r.first == ref.begin()->second);
+    inv::RobinHoodTable<int> copy = rh;
+    rh.clear();
+    assert(rh.size() == 0 && rh.find(ref.begin()->first) == nullptr);
+    assert(copy.size() == ref.size() && *copy.find(ref.begin()->first) == ref.begin()->second);
+}
+
+// ============================================================================
+// CUCKOO TABLE TESTS
+// ============================================================================
+
+/**
+ * Test: CuckooBuckets policy matches a reference map and serves concurrent readers
+ * 
+ * Purpose: Runs random inserts, updates and erases on a
+ *          HashTable<int, std::allocator<int>, CuckooBuckets> that starts
+ *          tiny (forcing cuckoo moves and several rehashes) and checks every
+ *          answer against std::unordered_map. Then reader threads look up a
+ *          fixed set of keys while the writer churns other keys through the
+ *          same buckets; none of the fixed keys may ever be reported missing.
+ *          Also checks that a held ReadGuard keeps retired nodes alive and
+ *          that they are all freed by the first write after readers leave.
+ * 
+ * Why chosen: A cuckoo insert moves other entries between their two
+ *             buckets. The optimistic version check is what stops a reader
+ *             from missing a key mid-move, so it is exercised directly.
+ */
+void test_cuckoo_table() {
+    using Cuckoo = inv::HashTable<int, std::allocator<int>, inv::CuckooBuckets>;
+    Cuckoo ht(1);
+    unordered_map<string, int> ref;
+    unsigned x = 777;
+    auto rnd = [&]() { x = x * 1103515245u + 12345u; return (x >> 8) % 4000; };
+    for (int step = 0; step < 30000; ++step) {
+        string k = "c" + to_string(rnd());
+        if (step % 4 == 0) {
+            assert(ht.erase(k) == (ref.erase(k) == 1));
+        } else {
+            bool isNew = ref.find(k) == ref.end();
+            ref[k] = step;
+            assert(ht.insert(k, step) == isNew);
+        }
+        const int *v = ht.find(k);
+        auto it = ref.find(k);
+        assert((v == nullptr) == (it == ref.end()));
+        if (v) assert(*v == it->second);
+    }
+    assert(ht.size() == ref.size());
+    size_t visited = 0;
+    ht.forEach([&](const string &k, const int &v) { ++visited; assert(ref.at(k) == v); });
+    assert(visited == ref.size());
+    inv::HashTableStats st = ht.stats();
+    assert(st.bucketSlots == Cuckoo::kSlots && st.rehashCount > 0);
+    assert(st.avgProbesHit >= 1.0 && st.avgProbesHit <= 2.0);
+    auto r = ht.try_emplace(ref.begin()->first, -1);
+    assert(!r.second && *r.first == ref.begin()->second);
+    assert(st.retiredBytes == 0);
+
+    // A reader inside a guard holds back what is retired after it entered,
+    // and only that: the next write after it leaves frees everything
+    {
+        auto guard = ht.readGuard();
+        const int *pinned = ht.find(ref.begin()->first);
+        assert(ht.insert(ref.begin()->first, 1) == false);
+        assert(ht.erase(next(ref.begin())->first));
+        assert(ht.stats().retiredBytes == 2 * Cuckoo::nodeBytes());
+        assert(*pinned == ref.begin()->second);
+    }
+    ht.insert("after-guard", 0);
+    assert(ht.stats().retiredBytes == 0);
+
+    // Concurrent readers while one writer inserts and erases other keys
+    Cuckoo shared(64);
+    for (int i = 0; i < 2000; ++i) shared.insert("fixed-" + to_string(i), i);
+    std::atomic<bool> done(false);
+    std::atomic<size_t> misses(0);
+    vector<std::thread> readers;
+    for (int t = 0; t < 3; ++t) {
+        readers.emplace_back([&, t] {
+            int i = t;
+            while (!done.load()) {
+                auto guard = shared.readGuard();
+                const int *v = shared.find("fixed-" + to_string(i % 2000));
+                if (!v || *v != i % 2000) misses.fetch_add(1);
+                i += 7;
+            }
+        });
+    }
+    for (int round = 0; round < 20; ++round) {
+        for (int i = 0; i < 2000; ++i) shared.insert("churn-" + to_string(round * 2000 + i), i);
+        for (int i = 0; i < 2000; ++i) assert(shared.erase("churn-" + to_string(round * 2000 + i)));
+    }
+    done.store(true);
+    for (auto &th : readers) th.join();
+    assert(misses.load() == 0);
+    assert(shared.size() == 2000);
+    shared.erase("fixed-0");
+    assert(shared.stats().retiredBytes == 0);
+}
+
+// ============================================================================
+// PERFECT HASH TESTS
+// ============================================================================
+
+/**
+ * Test: PerfectHashTable finds every key, rejects misses and duplicates
+ * 
+ * Purpose: Builds read-only snapshots of several sizes (including empty and
+ *          single-key) from a HashTable and checks every key is found with
+ *          its value, missing keys return nullptr, the index stays around
+ *          3 bits per key, and duplicate keys are rejected.
+ * 
+ * Why chosen: The snapshot replaces the chained table for read-only
+ *             replicas, so it must answer exactly like the table it was
+ *             built from.
+ */
+void test_perfect_hash_table() {
+    inv::PerfectHashTable<int> empty;
+    assert(empty.size() == 0 && empty.find("x") == nullptr);
+
+    for (int n : {1, 2, 10, 5000}) {
+        inv::HashTable<int> ht;
+        for (int i = 0; i < n; ++i) ht.insert("id-" + to_string(i * 7919), i);
+        vector<pair<string, int>> entries;
+        ht.forEach([&](const string &k, int &v) { entries.emplace_back(k, v); });
+        inv::PerfectHashTable<int> ph(std::move(entries));
+        assert(ph.size() == static_cast<size_t>(n));
+        for (int i = 0; i < n; ++i) {
+            const int *v = ph.find("id-" + to_string(i * 7919));
+            assert(v != nullptr && *v == i);
+        }
+        assert(ph.find("id-1") == nullptr && ph.find("") == nullptr);
+        size_t visited = 0;
+        ph.forEach([&](const string &k, const int &v) { ++visited; assert(*ht.find(k) == v); });
+        assert(visited == static_cast<size_t>(n));
+        if (n >= 1000) assert(ph.stats().bitsPerKey < 4.0);
+    }
+
+    bool threw = false;
+    try {
+        inv::PerfectHashTable<int> dup(vector<pair<string, int>>{{"a", 1}, {"b", 2}, {"a", 3}});
+    } catch (const invalid_argument &) {
+        threw = true;
+    }
+    assert(threw);
+}
+
+// ============================================================================
+// MAPPED TABLE TESTS
+// ============================================================================
+
+/**
+ * Test: MappedHashTable file round trip, corruption checks and engine catalog
+ * 
+ * Purpose: Writes an int table and a Product table into one file, opens both
+ *          images through separate mappings and checks every key, misses and
+ *          forEach; checks that truncated or foreign files are rejected; then
+ *          saves an engine's catalog and checks that an engine serving the
+ *          mapped file answers find and listInventory identically.
+ * 
+ * Why chosen: Offsets, padding and the value encoding are all hand-laid
+ *             bytes, and the mapped catalog must be a drop-in replacement
+ *             for loading the CSV in every process that opens it.
+ */
+void test_mapped_hash_table() {
+    const string path = "mapped_table_test.invt";
+    inv::MappedTableBuilder<int> ints;
+    for (int i = 0; i < 5000; ++i) ints.add("id-" + to_string(i * 7919), i);
+    inv::MappedTableBuilder<inv::Product> products;
+    inv::Product p = makeProduct("p1", "Widget", "Acme");
+    p.categories = {"Toys", "Games"};
+    p.asin = "B00000000000000000000000000X";  // Longer than SmallString's inline capacity
+    p.productDescription = string(300, 'd');
+    products.add("p1", p);
+    inv::MappedTableBuilder<int> empty;
+    assert(inv::writeMappedImages(path, {&ints.image(), &products.image(), &empty.image()}));
+
+    inv::MappedHashTable<int> a, b;  // Two independent mappings of one file
+    inv::MappedHashTable<inv::Product> prod;
+    inv::MappedHashTable<int> none;
+    assert(a.open(path, 0) && b.open(path, 0) && prod.open(path, 1) && none.open(path, 2));
+    assert(!prod.open(path, 3) && !prod.isOpen() && prod.open(path, 1));
+    assert(a.size() == 5000 && none.size() == 0);
+    for (int i = 0; i < 5000; ++i) {
+        int va = -1, vb = -1;
+        assert(a.find("id-" + to_string(i * 7919), va) && va == i);
+        assert(b.find("id-" + to_string(i * 7919), vb) && vb == i);
+    }
+    int v;
+    assert(!a.find("id-1", v) && !a.find("", v) && !none.find("id-0", v));
+    size_t visited = 0;
+    a.forEach([&](const string &k, const int &value) { ++visited; assert(k == "id-" + to_string(value * 7919)); });
+    assert(visited == 5000 && a.stats().size == 5000 && a.stats().longestChain >= 1);
+
+    inv::Product q;
+    assert(prod.find("p1", q) && !prod.find("p2", q));
+    assert(q.productName == "Widget" && q.brandName == "Acme" && q.asin == p.asin);
+    assert(q.categories == p.categories && q.productDescription == p.productDescription && q.stock.empty());
+
+    // Truncated and foreign files are rejected
+    string bytes;
+    {
+        ifstream in(path, ios::binary);
+        bytes.assign(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+    }
+    {
+        ofstream out(path, ios::binary | ios::trunc);
+        out.write(bytes.data(), static_cast<streamsize>(bytes.size() / 2));
+    }
+    inv::MappedHashTable<int> bad;
+    assert(!bad.open(path, 0) && !bad.find("id-0", v));
+    {
+        ofstream out(path, ios::binary | ios::trunc);
+        out << "Uniq Id,Product Name\n";
+    }
+    assert(!bad.open(path, 0));
+
+    // Engine catalog round trip
+    const string csv = "mapped_table_test.csv";
+    {
+        ofstream f(csv, ios::binary);
+        f << "Uniq Id,Product Name,Brand Name,Category,Selling Price,Product Description\n";
+        f << "a1,First,B1,Toys | Games,$1,\"Desc, with comma\"\n";
+        f << "a2,Second,B2,Toys,$2,Two\n";
+        f << "a3,Third,B3,Games,$3,\n";
+    }
+    inv::Engine loaded, served;
+    loaded.setCompressDescriptions(true);
+    assert(loaded.load(csv) && loaded.saveCatalog(path));
+    remove(csv.c_str());
+    assert(served.openCatalog(path) && served.mapped() && served.productCount() == 3);
+    assert(!served.load(csv) && !served.openCatalog(path));
+    for (const char *cmd : {"find a1", "find a2", "find a3", "find a4", "listInventory Toys",
+                            "listInventory Games", "listInventory Nope"}) {
+        ostringstream x, y;
+        loaded.evalCommand(cmd, x);
+        served.evalCommand(cmd, y);
+        assert(x.str() == y.str());
+    }
+    inv::Engine broken;
+    assert(!broken.openCatalog("missing_" + path) && !broken.mapped());
+    remove(path.c_str());
+}
+
+// ============================================================================
+// SHARED CATALOG TESTS
+// ============================================================================
+
+/**
+ * Test: Shared-memory catalog publish, attach and generation swap
+ * 
+ * Purpose: A loader engine publishes a catalog; a query engine in this
+ *          process and one in a forked child attach and find its products.
+ *          The loader then publishes a second generation with a new product,
+ *          which the attached engine serves on its next command without
+ *          re-attaching, while a pinned pointer to the first generation
+ *          stays readable after its name is removed.
+ * 
+ * Why chosen: The point of the mode is that many processes share one copy
+ *             and follow reloads; both need a separate process and a swap
+ *             under an attached reader to be exercised.
+ */
+void test_shared_catalog() {
+    const string name = "/inv_tests_" + to_string(getpid());
+    const string csv = "shared_catalog_test.csv";
+    auto writeCsv = [&](int rows) {
+        ofstream f(csv, ios::binary);
+        f << "Uniq Id,Product Name,Category,Selling Price\n";
+        for (int i = 0; i < rows; ++i) f << "s" << i << ",Item " << i << ",Toys,$" << i << "\n";
+    };
+    inv::Engine reader;
+    assert(!reader.attachSharedCatalog(name));  // Nothing published yet
+
+    writeCsv(2);
+    inv::Engine first;
+    uint64_t g1 = 0, g2 = 0;
+    assert(first.load(csv) && first.publishCatalog(name, &g1) && g1 >= 1);
+    assert(reader.attachSharedCatalog(name) && reader.mapped() && reader.productCount() == 2);
+    ostringstream out;
+    reader.evalCommand("find s1", out);
+    assert(out.str().find("Item 1") != string::npos);
+
+    pid_t child = fork();
+    if (child == 0) {
+        inv::Engine other;
+        ostringstream o;
+        bool ok = other.attachSharedCatalog(name) && other.productCount() == 2;
+        if (ok) other.evalCommand("listInventory Toys", o);
+        _exit(ok && o.str() == "s0 - Item 0\ns1 - Item 1\n" ? 0 : 1);
+    }
+    int status = -1;
+    assert(child > 0 && waitpid(child, &status, 0) == child && WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+    std::shared_ptr<const inv::MappedCatalog> pinned = reader.mappedCatalog();
+    writeCsv(3);
+    inv::Engine second;
+    assert(second.load(csv) && second.publishCatalog(name, &g2) && g2 > g1);
+    remove(csv.c_str());
+    out.str("");
+    reader.evalCommand("find s2", out);
+    assert(out.str().find("Item 2") != string::npos && reader.productCount() == 3);
+    assert(reader.mappedCatalog()->generation == g2 && pinned->generation == g1);
+    inv::Product p;
+    assert(pinned->products.find("s0", p) && p.productName == "Item 0" && !pinned->products.find("s2", p));
+
+    inv::removeSharedCatalog(name);
+    inv::Engine late;
+    assert(!late.attachSharedCatalog(name));
+    out.str("");
+    reader.evalCommand("find s0", out);  // Attached readers keep their mapping
+    assert(out.str().find("Item 0") != string::npos);
+}
+
+// ============================================================================
+// SHARDING TESTS
+// ============================================================================
+
+/**
+ * Test: Hash-partitioned shards behind a coordinator
+ * 
+ * Purpose: Loads one CSV into an unpartitioned engine and into three shard
+ *          engines (two served on Unix sockets, one on TCP loopback), then
+ *          checks that the coordinator's find and listInventory output is
+ *          byte-for-byte the unpartitioned engine's, for every product and
+ *          category, misses and invalid categories, and that every product
+ *          landed on exactly one shard. Also checks that reply frames with
+ *          a malformed or oversized length are rejected.
+ * 
+ * Why chosen: The merge only preserves order if record numbers survive the
+ *             trip, and routing only works if the coordinator and loader
+ *             agree on the hash; comparing against a single engine catches
+ *             either going wrong.
+ */
+void test_sharded_catalog() {
+    const string csv = "shard_test.csv";
+    const int kRows = 60;
+    {
+        ofstream f(csv, ios::binary);
+        f << "Uniq Id,Product Name,Category,Selling Price\n";
+        const char *cats[] = {"Toys", "Toys | Games", "Books", "Garden"};
+        for (int i = 0; i < kRows; ++i) {
+            f << "sh" << i << ",Item " << i << "," << cats[i % 4] << ",$" << i << "\n";
+        }
+    }
+    inv::Engine whole;
+    assert(whole.load(csv));
+
+    const size_t kShards = 3;
+    const string prefix = "inv_shard_test_" + to_string(getpid()) + "_";
+    vector<string> endpoints = {"unix:" + prefix + "0.sock", "unix:" + prefix + "1.sock", "127.0.0.1:0"};
+    vector<unique_ptr<inv::Engine>> engines;
+    vector<unique_ptr<inv::ShardServer>> servers;
+    vector<thread> threads;
+    size_t total = 0;
+    for (size_t k = 0; k < kShards; ++k) {
+        engines.emplace_back(new inv::Engine());
+        engines[k]->setShard(k, kShards);
+        assert(engines[k]->load(csv));
+        total += engines[k]->productCount();
+        servers.emplace_back(new inv::ShardServer());
+        assert(servers[k]->listen(endpoints[k]));
+        endpoints[k] = servers[k]->endpoint();  // Actual TCP port
+        threads.emplace_back([&servers, &engines, k]() { servers[k]->serve(*engines[k]); });
+    }
+    remove(csv.c_str());
+    assert(total == whole.productCount());
+    assert(inv::ShardRouter::parseEndpoints(endpoints[0] + "," + endpoints[1] + "," + endpoints[2]) == endpoints);
+
+    inv::ShardRouter router;
+    assert(router.connect(endpoints) && router.shardCount() == kShards);
+    auto same = [&](const string &cmd) {
+        ostringstream expected, actual;
+        whole.evalCommand(cmd, expected);
+        router.evalCommand(cmd, actual);
+        return expected.str() == actual.str();
+    };
+    for (int i = 0; i < kRows; ++i) {
+        const string id = "sh" + to_string(i);
+        assert(same("find " + id));
+        auto holds = [&](size_t k) {
+            ostringstream o;
+            engines[k]->evalCommand("find " + id, o);
+            return o.str() != "Inventory not found\n";
+        };
+        size_t owners = 0;
+        for (size_t k = 0; k < kShards; ++k) owners += holds(k) ? 1 : 0;
+        assert(owners == 1 && holds(inv::ShardFilter::shardOf(id, kShards)));
+    }
+    assert(same("find missing"));
+    assert(same("listInventory Toys") && same("listInventory Games") && same("listInventory Books"));
+    assert(same("listInventory Garden") && same("listInventory Nowhere"));
+
+    string reply = inv::ShardServer::evaluate(*engines[0], ":shardlist Nowhere");
+    assert(reply == "Invalid Category\n");
+    ostringstream stats;
+    router.evalCommand(":tablestats", stats);
+    assert(stats.str().find("Shard 2 (" + endpoints[2] + "):") != string::npos);
+
+    for (auto &s : servers) s->stop();
+    for (auto &t : threads) t.join();
+    ifstream gone(prefix + "0.sock");
+    assert(!gone);
+
+    // Reply frames: a length over the cap, or a length line that never
+    // ends, fails the read instead of buffering it
+    auto frame = [](const string &bytes, string &body) {
+        int fds[2];
+        assert(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+        assert(inv::net::sendAll(fds[0], bytes.data(), bytes.size()));
+        ::close(fds[0]);
+        inv::net::Reader in(fds[1]);
+        bool ok = inv::net::receiveReply(in, body);
+        ::close(fds[1]);
+        return ok;
+    };
+    string body;
+    assert(frame("5\nhello", body) && body == "hello");
+    assert(!frame(to_string(inv::net::kMaxReplyBytes + 1) + "\n", body));
+    assert(!frame("99999999999999999999999\n", body));
+    assert(!frame(string(64, '7'), body));
+    assert(!frame("12x\n", body));
+}
+
+// ============================================================================
+// REPLICATION TESTS
+// ============================================================================
+
+/**
+ * Test: Replicas following a primary's mutation log
+ * 
+ * Purpose: A primary loads a CSV, logs it and streams the log over a Unix
+ *          socket. A replica catches up and must answer every find and
+ *          listInventory exactly like the primary, and keep doing so after
+ *          upserts (same and changed categories, new products) and erases.
+ *          The replica is then stopped, more mutations are made, and a new
+ *          Replica resumes the same engine from the old position; a second
+ *          replica starts from scratch over TCP loopback. A replica asking
+ *          for a position past the log's end must be rejected and stop, and
+ *          the server must join the threads of replicas that left. Finally a CSV is
+ *          loaded into a logging engine with compressed descriptions and
+ *          lazy cold fields: the table keeps them deferred, while the log
+ *          and `find` see every field.
+ * 
+ * Why chosen: Category lists are where an incrementally maintained index
+ *             goes wrong (order, leftovers after a category is left), and
+ *             resuming from a position must neither skip nor repeat records.
+ */
+void test_replication() {
+    const string csv = "replication_test.csv";
+    {
+        ofstream f(csv, ios::binary);
+        f << "Uniq Id,Product Name,Category,Selling Price\n";
+        const char *cats[] = {"Toys", "Toys | Games", "Books"};
+        for (int i = 0; i < 30; ++i) f << "r" << i << ",Item " << i << "," << cats[i % 3] << ",$" << i << "\n";
+    }
+    inv::Engine primary;
+    assert(primary.load(csv) && primary.enableMutationLog());
+    remove(csv.c_str());
+    const inv::MutationLog &log = *primary.mutationLog();
+    assert(log.end() == 30);
+    string one;
+    const char *p = nullptr;
+    inv::Mutation m;
+    assert(log.read(3, 1, 0, one) == 1);
+    p = one.data();
+    assert(inv::MutationLog::decode(p, one.data() + one.size(), m) && p == one.data() + one.size());
+    assert(m.op == inv::Mutation::Upsert && m.product.uniqId == "r3" && m.product.recordIndex == 3);
+
+    inv::ReplicationServer server;
+    const string sock = "unix:inv_repl_test_" + to_string(getpid()) + ".sock";
+    assert(server.listen(sock));
+    thread serving([&]() { server.serve(primary); });
+
+    vector<string> commands = {"find missing", "listInventory Toys", "listInventory Games", "listInventory Books",
+                               "listInventory Puzzles", "listInventory Nowhere"};
+    for (int i = 0; i < 32; ++i) commands.push_back("find r" + to_string(i));
+    auto sameAs = [&](const inv::Engine &replica) {
+        for (const auto &cmd : commands) {
+            ostringstream expected, actual;
+            primary.evalCommand(cmd, expected);
+            replica.evalCommand(cmd, actual);
+            if (expected.str() != actual.str()) return false;
+        }
+        return true;
+    };
+    auto product = [](const string &id, const string &name, vector<string> categories) {
+        inv::Product q;
+        q.uniqId = id;
+        q.productName = name;
+        q.categories = std::move(categories);
+        return q;
+    };
+
+    inv::Engine a;
+    {
+        inv::Replica replica;
+        assert(replica.start(sock, a) && replica.waitCaughtUp(std::chrono::seconds(10)));
+        assert(replica.position() == 30 && sameAs(a));
+
+        assert(primary.upsertProduct(product("r4", "Renamed", {"Toys", "Games"})));   // Same categories
+        assert(primary.upsertProduct(product("r0", "Moved", {"Books", "Puzzles"})));  // Left Toys, joined two
+        assert(primary.upsertProduct(product("r30", "New", {"Toys"})));
+        assert(primary.eraseProduct("r1") && !primary.eraseProduct("r1"));
+        assert(replica.waitFor(log.end(), std::chrono::seconds(10)) && sameAs(a));
+        ostringstream games;
+        a.evalCommand("listInventory Games", games);
+        assert(games.str().find("r4 - Renamed") != string::npos && games.str().find("r1 -") == string::npos);
+        assert(replica.position() == 34);
+    }
+    const uint64_t resumeAt = 34;
+    assert(primary.eraseProduct("r2") && primary.upsertProduct(product("r31", "Later", {"Books"})));
+    {
+        inv::Replica resumed;
+        assert(resumed.start(sock, a, resumeAt) && resumed.waitFor(log.end(), std::chrono::seconds(10)));
+        assert(resumed.position() == log.end() && sameAs(a) && a.productCount() == primary.productCount());
+    }
+
+    inv::ReplicationServer tcp;
+    assert(tcp.listen("127.0.0.1:0"));
+    thread tcpServing([&]() { tcp.serve(primary); });
+    inv::Engine b;
+    inv::Replica fresh;
+    assert(fresh.start(tcp.endpoint(), b) && fresh.waitCaughtUp(std::chrono::seconds(10)) && sameAs(b));
+    fresh.stop();
+
+    inv::Engine frozen;
+    frozen.freeze();
+    assert(!frozen.enableMutationLog() && !frozen.upsertProduct(product("x", "X", {})));
+
+    // A replica asking for a position past the log's end (the primary
+    // restarted) is rejected once and stops, instead of reconnecting
+    {
+        inv::Engine ahead;
+        inv::Replica lost;
+        auto begin = std::chrono::steady_clock::now();
+        assert(lost.start(sock, ahead, log.end() + 100) && !lost.waitCaughtUp(std::chrono::seconds(10)));
+        assert(std::chrono::steady_clock::now() - begin < std::chrono::seconds(5));
+        assert(lost.error().find("before position " + to_string(log.end() + 100)) != string::npos);
+        assert(lost.batches() == 0);
+    }
+
+    // Threads of replicas that left are joined as new ones connect
+    bool reaped = false;
+    for (int i = 0; i < 200 && !reaped; ++i) {
+        int fd = inv::net::connectTo(sock);
+        assert(fd >= 0);
+        ::close(fd);
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        reaped = server.workerCount() <= 1;  // Only the connection just made may be left
+    }
+    assert(reaped);
+
+    // A load on a logging primary keeps descriptions compressed and cold
+    // fields deferred, and still logs complete products
+    const string more = "replication_test_more.csv";
+    {
+        ofstream f(more, ios::binary);
+        f << "Uniq Id,Product Name,Category,Asin,Product Description\n";
+        for (int i = 0; i < 3; ++i) f << "m" << i << ",More " << i << ",Toys,B00" << i << ",Described " << i << "\n";
+    }
+    inv::Engine compact;
+    compact.setCompressDescriptions(true);
+    compact.setLazyColdFields(true);
+    assert(compact.enableMutationLog() && compact.load(more));
+    const inv::Product *stored = compact.table().find("m1");
+    assert(stored && stored->sourceRef != inv::ColdFieldStore::kNone && stored->productDescription.empty());
+    assert(compact.mutationLog()->read(1, 1, 0, one) == 1);
+    p = one.data();
+    assert(inv::MutationLog::decode(p, one.data() + one.size(), m) && m.product.uniqId == "m1");
+    assert(m.product.asin == "B001" && m.product.productDescription == "Described 1");
+    ostringstream shown;
+    compact.evalCommand("find m2", shown);
+    assert(shown.str().find("Described 2") != string::npos && shown.str().find("B002") != string::npos);
+    remove(more.c_str());
+
+    server.stop();
+    tcp.stop();
+    serving.join();
+    tcpServing.join();
+}
+
+// ============================================================================
+// CHANGE FEED TESTS
+// ============================================================================
+
+/**
+ * Test: Change-data-capture events, coalescing and the socket stream
+ * 
+ * Purpose: Feeds one window of mutations that exercise every coalescing
+ *          rule and checks the single batch that comes out (kinds, fields,
+ *          sequence numbers, first-occurrence order). Checks that a full
+ *          batch is delivered without waiting for its window. Then enables
+ *          the feed on an engine, checks that upserts report exactly the
+ *          fields they changed (and nothing for a no-op upsert), and checks
+ *          that a socket client receives the same batch as an in-process
+ *          subscriber.
+ * 
+ * Why chosen: A cache acting on these events drops or keeps entries based
+ *             on them. A wrong merge, such as an erase followed by an insert
+ *             coming out as an erase, leaves the cache silently wrong.
+ */
+void test_change_feed() {
+    using inv::ChangeEvent;
+    std::mutex mutex;
+    std::condition_variable arrived;
+    vector<vector<ChangeEvent>> batches;
+    auto collect = [&](const vector<ChangeEvent> &b) {
+        std::lock_guard<std::mutex> lock(mutex);
+        batches.push_back(b);
+        arrived.notify_all();
+    };
+    {
+        inv::ChangeFeed feed(std::chrono::hours(1));
+        feed.subscribe(collect);
+        feed.record(ChangeEvent::Insert, "a");
+        feed.record(ChangeEvent::Update, "b", ChangeEvent::SellingPrice);
+        feed.record(ChangeEvent::Update, "a", ChangeEvent::Stock);
+        feed.record(ChangeEvent::Update, "b", ChangeEvent::Stock);
+        feed.record(ChangeEvent::Insert, "c");
+        feed.record(ChangeEvent::Erase, "c");           // Never existed outside the window
+        feed.record(ChangeEvent::Update, "d", ChangeEvent::ProductName);
+        feed.record(ChangeEvent::Erase, "d");
+        feed.record(ChangeEvent::Erase, "e");
+        feed.record(ChangeEvent::Insert, "e");          // Replaced: refetch everything
+        feed.flush();
+        assert(batches.size() == 1 && batches[0].size() == 4);
+        const vector<ChangeEvent> &b = batches[0];
+        assert(b[0].id == "a" && b[0].kind == ChangeEvent::Insert && b[0].fields == ChangeEvent::AllFields && b[0].sequence == 3);
+        assert(b[1].id == "b" && b[1].kind == ChangeEvent::Update && b[1].fields == (ChangeEvent::SellingPrice | ChangeEvent::Stock));
+        assert(b[2].id == "d" && b[2].kind == ChangeEvent::Erase && b[2].sequence == 8);
+        assert(b[3].id == "e" && b[3].kind == ChangeEvent::Update && b[3].fields == ChangeEvent::AllFields && b[3].sequence == 10);
+        assert(feed.stats().mutations == 10 && feed.stats().coalesced == 5 && feed.stats().events == 4);
+        feed.flush();
+        assert(batches.size() == 1);  // Nothing pending: no empty batch
+    }
+    batches.clear();
+    {
+        inv::ChangeFeed feed(std::chrono::hours(1), 3);
+        feed.subscribe(collect);
+        feed.record(ChangeEvent::Insert, "x");
+        feed.record(ChangeEvent::Insert, "y");
+        feed.record(ChangeEvent::Insert, "z");  // Third id: delivered without a flush
+        std::unique_lock<std::mutex> lock(mutex);
+        assert(arrived.wait_for(lock, std::chrono::seconds(10), [&]() { return !batches.empty(); }));
+        assert(batches[0].size() == 3);
+    }
+    batches.clear();
+
+    const string csv = "change_feed_test.csv";
+    {
+        ofstream f(csv, ios::binary);
+        f << "Uniq Id,Product Name,Category,Selling Price,Stock\n";
+        for (int i = 0; i < 5; ++i) f << "c" << i << ",Item " << i << ",Toys,$" << i << ",In Stock\n";
+    }
+    inv::Engine engine;
+    assert(engine.load(csv));
+    remove(csv.c_str());
+    inv::ChangeFeed &feed = engine.enableChangeFeed(std::chrono::hours(1));
+    assert(&engine.enableChangeFeed() == &feed && engine.changeFeed() == &feed);
+    feed.subscribe(collect);
+
+    inv::ChangeFeedServer server;
+    const string sock = "unix:inv_cdc_test_" + to_string(getpid()) + ".sock";
+    assert(server.listen(sock));
+    thread serving([&]() { server.serve(feed); });
+    inv::ChangeFeedClient client;
+    assert(client.connect(sock));
+    for (int i = 0; i < 1000 && server.clientCount() == 0; ++i) std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    assert(server.clientCount() == 1);
+
+    inv::Product same = *engine.table().find("c0");
+    inv::Product priced = *engine.table().find("c1");
+    priced.sellingPrice = "$99";
+    priced.stock = "Sold Out";
+    inv::Product added;
+    added.uniqId = "c9";
+    added.productName = "New";
+    assert(engine.upsertProduct(same) && engine.upsertProduct(priced) && engine.upsertProduct(added));
+    assert(engine.eraseProduct("c2"));
+    feed.flush();
+    assert(batches.size() == 1 && batches[0].size() == 3);
+    const vector<ChangeEvent> &b = batches[0];
+    assert(b[0].id == "c1" && b[0].kind == ChangeEvent::Update && b[0].fields == (ChangeEvent::SellingPrice | ChangeEvent::Stock));
+    assert(b[1].id == "c9" && b[1].kind == ChangeEvent::Insert && b[2].id == "c2" && b[2].kind == ChangeEvent::Erase);
+
+    vector<ChangeEvent> received;
+    assert(client.next(received) && received.size() == 3);
+    for (size_t i = 0; i < 3; ++i) {
+        assert(received[i].id == b[i].id && received[i].kind == b[i].kind);
+        assert(received[i].fields == b[i].fields && received[i].sequence == b[i].sequence);
+    }
+    ostringstream line;
+    inv::printChangeEvent(received[0], line);
+    assert(line.str() == to_string(b[0].sequence) + " update c1 sellingPrice,stock\n");
+
+    server.stop();
+    serving.join();
+    assert(!client.next(received));
+}
+
+// ============================================================================
+// RESULT CACHE TESTS
+// ============================================================================
+
+/**
+ * Test: Generation-checked result cache with CLOCK eviction
+ * 
+ * Purpose: Checks hits, generation mismatches (reported as stale misses),
+ *          the byte bound, that entries hit since the last sweep survive
+ *          eviction while unreferenced ones go, and that an output larger
+ *          than a shard is not cached. On an engine, repeated find and
+ *          listInventory commands must be hits with byte-identical output,
+ *          and an upsert or erase must change the very next answer.
+ * 
+ * Why chosen: A cache that serves an answer from before a mutation is
+ *             worse than no cache, and the eviction policy is what keeps
+ *             the hot keys resident under a skewed workload.
+ */
+void test_result_cache() {
+    const size_t shardBytes = 1024;
+    inv::ResultCache cache(shardBytes * inv::ResultCache::kShards);
+    ostringstream out;
+    assert(!cache.lookup("f:a", 1, out));
+    cache.insert("f:a", 1, "alpha\n");
+    assert(cache.lookup("f:a", 1, out) && out.str() == "alpha\n");
+    assert(!cache.lookup("f:a", 2, out));  // Newer generation: stale
+    cache.insert("f:a", 2, "beta\n");
+    out.str("");
+    assert(cache.lookup("f:a", 2, out) && out.str() == "beta\n");
+    cache.insert("f:huge", 2, string(shardBytes, 'x'));
+    assert(!cache.lookup("f:huge", 2, out));
+    inv::ResultCacheStats st = cache.stats();
+    assert(st.hits == 2 && st.stale == 1 && st.entries == 1 && st.bytes <= st.capacityBytes);
+
+    // Fill far past capacity while hitting one key between inserts: it stays
+    const string hot = "l:hot";
+    cache.insert(hot, 2, string(100, 'h'));
+    for (int i = 0; i < 2000; ++i) {
+        cache.insert("f:" + to_string(i), 2, string(100, 'c'));
+        out.str("");
+        assert(cache.lookup(hot, 2, out) && out.str().size() == 100);
+    }
+    st = cache.stats();
+    assert(st.evictions > 0 && st.bytes <= st.capacityBytes);
+    cache.clear();
+    assert(cache.stats().entries == 0 && !cache.lookup(hot, 2, out));
+
+    const string csv = "result_cache_test.csv";
+    {
+        ofstream f(csv, ios::binary);
+        f << "Uniq Id,Product Name,Category,Selling Price\n";
+        for (int i = 0; i < 6; ++i) f << "q" << i << ",Item " << i << ",Toys,$" << i << "\n";
+    }
+    inv::Engine plain, cached;
+    assert(plain.load(csv) && cached.load(csv));
+    remove(csv.c_str());
+    cached.enableResultCache(1 << 20);
+    auto same = [&](const string &cmd) {
+        ostringstream a, b;
+        plain.evalCommand(cmd, a);
+        cached.evalCommand(cmd, b);
+        return a.str() == b.str();
+    };
+    for (int round = 0; round < 2; ++round) {
+        assert(same("find q1") && same("find  q1 ") && same("find nope") && same("listInventory Toys"));
+    }
+    st = cached.resultCache()->stats();
+    assert(st.misses == 3 && st.hits == 5);  // "find  q1 " normalizes to the same key
+
+    uint64_t before = cached.generation();
+    inv::Product renamed = *plain.table().find("q1");
+    renamed.productName = "Renamed";
+    assert(plain.upsertProduct(renamed) && cached.upsertProduct(renamed));
+    assert(cached.generation() != before);
+    assert(same("find q1") && same("listInventory Toys"));
+    assert(plain.eraseProduct("q2") && cached.eraseProduct("q2"));
+    assert(same("find q2") && same("listInventory Toys") && same(":help"));
+    ostringstream renamedOut;
+    cached.evalCommand("find q1", renamedOut);
+    assert(renamedOut.str().find("Renamed") != string::npos);
+}
+
+// ============================================================================
+// PRE-RENDERED OUTPUT TESTS
+// ============================================================================
+
+/**
+ * Test: Pre-rendered find output and its invalidation
+ * 
+ * Purpose: Checks RenderedStore handles (reuse after release, live and
+ *          released byte counts), then compares an engine with
+ *          pre-rendered output against a plain one: every find must be
+ *          byte-identical after loading (also with lazy cold fields),
+ *          after upserts and erases, after freeze() and once rendering is
+ *          turned off. Repeated upserts of long products must make the
+ *          engine rebuild the store instead of accumulating released bytes.
+ * 
+ * Why chosen: find writes stored bytes without looking at the product, so
+ *             a block left over from before a mutation would be served
+ *             silently; only a comparison with freshly formatted output
+ *             catches that.
+ */
+void test_prerendered_output() {
+    inv::RenderedStore store;
+    uint32_t a = store.add("alpha\n"), b = store.add("beta\n");
+    ostringstream out;
+    assert(store.write(a, out) && store.view(b) == "beta\n" && out.str() == "alpha\n");
+    store.release(a);
+    assert(!store.write(a, out) && store.size() == 1 && store.liveBytes() == 5 && store.garbageBytes() == 6);
+    assert(store.add("gamma\n") == a && store.view(a) == "gamma\n");  // Handle reused
+    assert(!store.write(inv::RenderedStore::kNone, out));
+
+    const string csv = "prerender_test.csv";
+    {
+        ofstream f(csv, ios::binary);
+        f << "Uniq Id,Product Name,Category,Selling Price,Model Number,About Product\n";
+        for (int i = 0; i < 8; ++i) {
+            f << "r" << i << ",Item " << i << ",Toys | Games,$" << i << ",M-" << i << ",\"";
+            for (int w = 0; w < 40 * i; ++w) f << "word" << w << ' ';  // Wrapped descriptions of varied length
+            f << "\"\n";
+        }
+    }
+    inv::Engine plain, rendered, lazy;
+    lazy.setLazyColdFields(true);
+    assert(rendered.setPrerenderedOutput(true) && lazy.setPrerenderedOutput(true));
+    assert(plain.load(csv) && rendered.load(csv) && lazy.load(csv));
+    assert(rendered.renderedOutput().size() == 8 && lazy.renderedOutput().size() == 8);
+    auto same = [&](inv::Engine &e) {
+        for (const char *id : {"r0", "r1", "r3", "r7", "nope"}) {
+            ostringstream x, y;
+            plain.evalCommand(string("find ") + id, x);
+            e.evalCommand(string("find ") + id, y);
+            if (x.str() != y.str()) return false;
+        }
+        return true;
+    };
+    assert(same(rendered) && same(lazy));
+
+    inv::Product changed = *plain.table().find("r3");
+    changed.sellingPrice = "$99";
+    changed.productDescription = "Replaced description";
+    changed.renderedRef = 0;  // Foreign handles are ignored
+    assert(plain.upsertProduct(changed) && rendered.upsertProduct(changed));
+    assert(plain.eraseProduct("r1") && rendered.eraseProduct("r1"));
+    assert(same(rendered) && rendered.renderedOutput().size() == 7 && rendered.renderedOutput().garbageBytes() > 0);
+
+    // Released bytes are reclaimed once they outweigh live ones
+    changed.productDescription = string(64 * 1024, 'd');
+    for (int i = 0; i < 12; ++i) {
+        changed.quantity = to_string(i);
+        assert(plain.upsertProduct(changed) && rendered.upsertProduct(changed));
+    }
+    const inv::RenderedStore &rs = rendered.renderedOutput();
+    assert(rs.garbageBytes() <= rs.liveBytes() || rs.garbageBytes() < inv::RenderedStore::kChunkBytes);
+    assert(same(rendered));
+
+    ostringstream mem;
+    rendered.evalCommand(":memory", mem);
+    assert(mem.str().find("Rendered output (7 products") != string::npos);
+
+    rendered.freeze();
+    assert(!rendered.setPrerenderedOutput(false) && same(rendered));
+    assert(lazy.setPrerenderedOutput(false) && lazy.renderedOutput().size() == 0);
+    assert(plain.load(csv) && lazy.load(csv) && same(lazy));  // Reload: both back to the file's products
+    remove(csv.c_str());
+}
+
+// ============================================================================
+// REQUEST COALESCING TESTS
+// ============================================================================
+
+/**
+ * Test: Single-flight coalescing of identical concurrent queries
+ * 
+ * Purpose: Holds one computation open until three more callers with the
+ *          same key and generation have joined it, then checks that all
+ *          four get the same buffer and the computation ran once. A caller
+ *          at another generation must compute its own result, an exception
+ *          must reach every caller that shared the call, and a key must be
+ *          computed again once its call has finished. On an engine,
+ *          listInventory from several threads must match a plain engine's
+ *          output, with every call counted as computed or shared.
+ * 
+ * Why chosen: A waiter that is never woken hangs a server thread, and one
+ *             that receives another generation's output serves stale data;
+ *             both only show up under real concurrency.
+ */
+void test_request_coalescing() {
+    inv::SingleFlight flight;
+    std::mutex gateMutex;
+    std::condition_variable gateCv;
+    bool gateOpen = false;
+    std::atomic<int> computations {0};
+    auto slow = [&]() {
+        ++computations;
+        std::unique_lock<std::mutex> lock(gateMutex);
+        gateCv.wait(lock, [&]() { return gateOpen; });
+        return string("shared output\n");
+    };
+    auto release = [&]() {
+        {
+            std::lock_guard<std::mutex> lock(gateMutex);
+            gateOpen = true;
+        }
+        gateCv.notify_all();
+    };
+
+    vector<shared_ptr<const string>> results(4);
+    vector<bool> leaders(4, false);
+    vector<thread> threads;
+    threads.emplace_back([&]() { bool l; results[0] = flight.run("l:Toys", 1, slow, &l); leaders[0] = l; });
+    while (computations.load() == 0) this_thread::yield();
+    for (int i = 1; i < 4; ++i) {
+        threads.emplace_back([&, i]() { bool l; results[i] = flight.run("l:Toys", 1, slow, &l); leaders[i] = l; });
+    }
+    while (flight.stats().shared < 3) this_thread::yield();
+    // Same key at another generation: not joined
+    auto other = flight.run("l:Toys", 2, []() { return string("newer\n"); });
+    assert(*other == "newer\n");
+    release();
+    for (auto &t : threads) t.join();
+    for (int i = 0; i < 4; ++i) assert(results[i] == results[0] && leaders[i] == (i == 0));
+    assert(*results[0] == "shared output\n" && computations.load() == 1);
+    inv::SingleFlightStats st = flight.stats();
+    assert(st.computed == 2 && st.shared == 3);
+
+    // Finished calls are forgotten
+    bool leader = false;
+    assert(*flight.run("l:Toys", 1, []() { return string("again\n"); }, &leader) == "again\n" && leader);
+
+    // Errors reach the caller
+    bool threw = false;
+    try {
+        flight.run("l:Broken", 1, []() -> string { throw std::runtime_error("scan failed"); });
+    } catch (const std::runtime_error &) {
+        threw = true;
+    }
+    assert(threw);
+
+    const string csv = "coalescing_test.csv";
+    {
+        ofstream f(csv, ios::binary);
+        f << "Uniq Id,Product Name,Category,Selling Price\n";
+        for (int i = 0; i < 50; ++i) f << "c" << i << ",Item " << i << "," << (i % 2 ? "Toys" : "Games | Toys") << ",$" << i << "\n";
+    }
+    inv::Engine plain, coalesced;
+    assert(plain.load(csv) && coalesced.load(csv));
+    remove(csv.c_str());
+    coalesced.enableRequestCoalescing(true);
+    coalesced.enableResultCache(1 << 20);
+    ostringstream toys, games;
+    plain.evalCommand("listInventory Toys", toys);
+    plain.evalCommand("listInventory Games", games);
+    std::atomic<bool> mismatch {false};
+    vector<thread> clients;
+    for (int t = 0; t < 4; ++t) {
+        clients.emplace_back([&, t]() {
+            for (int i = 0; i < 200; ++i) {
+                bool hot = (i + t) % 3 != 0;
+                ostringstream out;
+                coalesced.evalCommand(hot ? "listInventory Toys" : "listInventory  Games ", out);
+                if (out.str() != (hot ? toys.str() : games.str())) mismatch = true;
+            }
+        });
+    }
+    for (auto &t : clients) t.join();
+    assert(!mismatch);
+    st = coalesced.requestCoalescing()->stats();
+    assert(st.computed + st.shared + coalesced.resultCache()->stats().hits == 800);
+    ostringstream found;
+    coalesced.evalCommand("find c3", found);  // find is not coalesced
+    assert(coalesced.requestCoalescing()->stats().computed == st.computed);
+}
+
+// ============================================================================
+// PIPELINED LOADER TESTS
+// ============================================================================
+
+/**
+ * Test: Lock-free ring and the pipelined loader
+ * 
+ * Purpose: Pushes 100k sequence numbers through a 4-slot SpscRing from a
+ *          second thread and checks that they arrive complete and in order
+ *          after close(). Then loads a file with multi-line records,
+ *          duplicate and missing ids and blank lines through
+ *          loadCsvPipelined() with tiny batches and rings (so every stage
+ *          hits backpressure) and 1-3 parsers. Products, record indexes,
+ *          description and cold-field handles and the category index's
+ *          order must equal a loadCsv() of the same file, with or without
+ *          a shard filter, and the stage counts must add up.
+ * 
+ * Why chosen: The inserter relies on the round-robin hand-off to restore
+ *             file order; a batch taken from the wrong parser would reorder
+ *             category listings or let an older duplicate win, which only a
+ *             comparison with the serial loader reveals.
+ */
+void test_pipelined_load() {
+    inv::SpscRing<int> ring(3);
+    assert(ring.capacity() == 4);
+    const int count = 100000;
+    std::thread producer([&]() {
+        for (int i = 0; i < count; ++i) ring.push(i);
+        ring.close();
+    });
+    int expected = 0, value;
+    double waited = 0.0;
+    while (ring.pop(value, &waited)) assert(value == expected++);
+    producer.join();
+    assert(expected == count && !ring.tryPop(value));
+
+    const string csv = "pipelined_load_test.csv";
+    {
+        ofstream f(csv, ios::binary);
+        f << "Uniq Id,Product Name,Category,Selling Price,Model Number,About Product\n";
+        for (int i = 0; i < 300; ++i) {
+            if (i % 37 == 0) f << "\n";                                  // Blank line
+            if (i % 50 == 7) { f << ",No id,Toys,$1,,\n"; continue; }     // Skipped
+            int id = i % 41 == 0 ? i / 2 : i;                             // Some duplicates
+            f << "p" << id << ",Item " << i << "," << (i % 3 ? "Toys | Games" : "Games") << ",$" << i
+              << ",M" << i << ",\"About " << i << (i % 5 == 0 ? "\nsecond line, with comma" : "") << "\"\n";
+        }
+    }
+    using Index = std::unordered_map<string, vector<string>>;
+    auto dump = [](const inv::HashTable<inv::Product> &table, const inv::DescriptionStore *d, const inv::ColdFieldStore *c) {
+        std::map<string, string> out;
+        table.forEach([&](const string &key, const inv::Product &p) {
+            inv::Product full = p;
+            if (c) c->fill(full);
+            ostringstream os;
+            inv::printProduct(full, os, d);
+            os << full.recordIndex << ' ' << full.descriptionRef << ' ' << full.sourceRef;
+            out[key] = os.str();
+        });
+        return out;
+    };
+
+    for (int mode = 0; mode < 3; ++mode) {            // plain, compressed descriptions, lazy cold fields
+        for (int shardCount = 1; shardCount <= 2; ++shardCount) {
+            inv::ShardFilter shard;
+            shard.index = 1;
+            shard.count = static_cast<size_t>(shardCount);
+            inv::HashTable<inv::Product> serialTable;
+            Index serialIndex;
+            inv::DescriptionStore serialDesc;
+            inv::ColdFieldStore serialCold;
+            inv::LoadStats serialStats;
+            assert(inv::loadCsv(csv, serialTable, serialIndex, &serialStats, mode == 1 ? &serialDesc : nullptr,
+                                mode == 2 ? &serialCold : nullptr, &shard));
+            for (size_t parsers = 1; parsers <= 3; ++parsers) {
+                inv::HashTable<inv::Product> table;
+                Index index;
+                inv::DescriptionStore desc;
+                inv::ColdFieldStore cold;
+                inv::LoadStats st;
+                inv::LoadPipelineStats stages;
+                st.pipeline = &stages;
+                inv::LoadPipelineOptions options;
+                options.parsers = parsers;
+                options.batchRecords = 7;
+                options.ringBatches = 2;
+                assert(inv::loadCsvPipelined(csv, table, index, options, &st, mode == 1 ? &desc : nullptr,
+                                             mode == 2 ? &cold : nullptr, &shard));
+                assert(index == serialIndex);
+                assert(dump(table, mode == 1 ? &desc : nullptr, mode == 2 ? &cold : nullptr) ==
+                       dump(serialTable, mode == 1 ? &serialDesc : nullptr, mode == 2 ? &serialCold : nullptr));
+                assert(st.records == serialStats.records && st.products == serialStats.products && st.bytes == serialStats.bytes);
+                assert(stages.parse.threads == parsers && stages.read.records == st.records);
+                assert(stages.insert.records == st.products && stages.index.records == st.products);
+                assert(stages.parse.batches == stages.insert.batches && stages.read.batches == stages.insert.batches);
+            }
+        }
+    }
+
+    inv::HashTable<inv::Product> none;
+    Index noIndex;
+    assert(!inv::loadCsvPipelined("does_not_exist.csv", none, noIndex, inv::LoadPipelineOptions()));
+
+    // Engine: same catalog either way
+    inv::Engine serial, piped;
+    piped.setLoadPipeline(2);
+    assert(serial.load(csv) && piped.load(csv));
+    remove(csv.c_str());
+    for (const char *cmd : {"find p5", "find p10", "listInventory Toys", "listInventory Games"}) {
+        ostringstream a, b;
+        serial.evalCommand(cmd, a);
+        piped.evalCommand(cmd, b);
+        assert(a.str() == b.str());
+    }
+}
+
+// ============================================================================
+// STREAMING GZIP INPUT TESTS
+// ============================================================================
+
+/**
+ * Test: gzip decoding and streamed loading
+ * 
+ * Purpose: Decodes a gzip -9 member (dynamic Huffman codes), a member
+ *          built here with a stored block and a file name field, and one
+ *          built here with fixed codes whose 258-byte matches reach back
+ *          the full 32 KiB window across output blocks. Reads are 7 bytes
+ *          at a time, so refills land mid-code. Concatenated members decode
+ *          as one stream, and every truncation, a flipped CRC and a bad
+ *          block type are rejected. Then a gzip file, read through a
+ *          StreamInput, must load into the same table and index as the
+ *          plain file (serial and pipelined), a truncated one must make
+ *          finish() fail, a reader that stops early must not hang the
+ *          producer, and Engine::load(istream) must match
+ *          Engine::load(path).
+ * 
+ * Why chosen: The decoder is only exercised on well-formed input by the
+ *             bundled dataset; window slides, back-references across a
+ *             flush and checksum/length checks are where a streaming
+ *             inflater goes wrong silently.
+ */
+void test_gzip_stream() {
+    assert(inv::gzip::crc32(0, "123456789", 9) == 0xCBF43926u);
+
+    auto gunzip = [](const string &gz, string &out, string *error = nullptr) {
+        size_t pos = 0;
+        inv::gzip::Decoder decoder([&](char *buf, size_t n) {
+            size_t take = std::min<size_t>({n, 7, gz.size() - pos});
+            gz.copy(buf, take, pos);
+            pos += take;
+            return take;
+        }, 4096);
+        out.clear();
+        bool ok = decoder.run([&](const char *data, size_t n) { out.append(data, n); return true; });
+        if (error) *error = decoder.error();
+        assert(!ok || decoder.outputBytes() == out.size());
+        return ok;
+    };
+    // A gzip member around deflate data (with a file name when named)
+    auto member = [](const string &deflated, const string &plain, bool named) {
+        string gz("\x1f\x8b\x08", 3);
+        gz += named ? '\x08' : '\x00';
+        gz += string(4, '\0') + string("\x00\x03", 2);  // Modification time, extra flags, OS
+        if (named) gz += string("data.csv") + '\0';
+        gz += deflated;
+        std::uint32_t words[2] = {inv::gzip::crc32(0, plain.data(), plain.size()), static_cast<std::uint32_t>(plain.size())};
+        for (std::uint32_t w : words) for (int i = 0; i < 4; ++i) gz += static_cast<char>(w >> (8 * i));
+        return gz;
+    };
+
+    // Dynamic codes: gzip -n -9 of this CSV
+    string csv = "Uniq Id,Product Name,Category,Selling Price\n";
+    const char *colors[] = {"Red", "Blue", "Green"};
+    for (int i = 0; i < 12; ++i) {
+        csv += "p" + std::to_string(i) + "," + colors[i % 3] + " ball " + std::to_string(i) + "," +
+               (i % 2 ? "Toys | Games" : "Toys") + ",$" + std::to_string(i) + ".99\n";
+    }
+    static const char kDynamic[] =
+        "\x1f\x8b\x08\x00\x00\x00\x00\x00\x02\x03\x65\x90\xbd\x0e\x82\x30\x14\x46\x77\x9e\xa2\x83\xe3\x8d"
+        "\x69\xf9\xef\xaa\x03\x71\x31\xc4\x9f\x07\x40\xb8\x21\x4d\x2a\x60\x85\x81\xc4\x87\x97\x5c\x6a\x68"
+        "\xea\xfc\x9d\x73\x86\xef\xde\xa9\x17\x3b\x35\x50\x9a\xbe\x99\xea\x91\x9d\xab\x27\xc2\xb1\x1a\xb1"
+        "\xed\xcd\x0c\x57\xd4\x5a\x75\x2d\x2b\x8d\xaa\x31\x18\x38\x5c\xb0\x61\x8f\x4a\x6b\xc6\xe1\xd6\xcf"
+        "\x6f\xd8\xf1\xbd\x94\xc1\x20\xe0\xa0\x27\x5c\x17\x41\x0b\xfb\xb0\x62\x49\x2d\x84\x20\x22\x84\xc2"
+        "\x20\x76\x2b\x12\x5a\x39\xa4\x29\xda\xaa\x91\xe7\x46\x04\xc4\x4e\x3d\xb6\x6a\x4c\x4b\xe2\x56\x13"
+        "\x4f\x4e\x08\x49\xb7\x7a\x6a\xdd\x94\x86\xcc\xa9\x66\x9e\x9a\x11\x91\xbb\xf5\xdc\xca\x39\x4d\x72"
+        "\xab\x4a\xcf\x95\xeb\x23\xdc\xbd\xe4\xf7\x96\xb0\x77\x09\xb7\x2c\xfe\x1e\xa3\xcb\xbe\x24\xb0\x78"
+        "\xd9\x9a\x01\x00\x00";
+    const string dynamicGz(kDynamic, sizeof(kDynamic) - 1);
+    string out, error;
+    assert(gunzip(dynamicGz, out) && out == csv);
+
+    // Stored block
+    const string hello = "hello, stored\n";
+    string stored("\x01", 1);
+    stored += static_cast<char>(hello.size()) + string(1, '\0') + static_cast<char>(~hello.size()) + '\xff' + hello;
+    const string storedGz = member(stored, hello, true);
+    assert(gunzip(storedGz, out) && out == hello);
+
+    // Fixed codes: 40000 literals, then 258-byte matches at distance 32768
+    string bits;
+    std::uint32_t acc = 0;
+    int used = 0;
+    auto put = [&](std::uint32_t v, int n) {  // LSB first
+        for (int i = 0; i < n; ++i) {
+            acc |= ((v >> i) & 1u) << used;
+            if (++used == 8) { bits += static_cast<char>(acc); acc = 0; used = 0; }
+        }
+    };
+    auto code = [&](std::uint32_t c, int n) { for (int i = n - 1; i >= 0; --i) put(c >> i, 1); };  // Huffman codes MSB first
+    string window;
+    put(1, 1);
+    put(1, 2);
+    for (int i = 0; i < 40000; ++i) {
+        unsigned char c = static_cast<unsigned char>('a' + (i * 7 + i / 26) % 26);
+        code(0x30 + c, 8);
+        window += static_cast<char>(c);
+    }
+    for (int i = 0; i < 10000; ++i) {  // About 2.6 MB: more than a StreamInput ring holds
+        code(0xC0 + 5, 8);   // Length 258 (symbol 285)
+        code(29, 5);         // Distance 24577 + 8191
+        put(8191, 13);
+        for (int k = 0; k < 258; ++k) window += window[window.size() - 32768];
+    }
+    code(0, 7);              // End of block
+    if (used) bits += static_cast<char>(acc);
+    const string fixedGz = member(bits, window, false);
+    assert(gunzip(fixedGz, out) && out == window);
+
+    // Concatenated members
+    assert(gunzip(dynamicGz + storedGz + fixedGz, out) && out == csv + hello + window);
+
+    // Truncation, corruption
+    for (size_t n = 0; n < dynamicGz.size(); ++n) assert(!gunzip(dynamicGz.substr(0, n), out));
+    string badCrc = storedGz;
+    badCrc[badCrc.size() - 8] ^= 1;
+    assert(!gunzip(badCrc, out, &error) && error == "gzip CRC mismatch");
+    string badType = storedGz;
+    badType[19] = '\x07';  // BFINAL, BTYPE 3
+    assert(!gunzip(badType, out, &error) && error == "invalid deflate block type");
+    assert(!gunzip(dynamicGz + "junk", out, &error) && error == "trailing data after gzip stream");
+    assert(!gunzip(csv, out, &error) && error == "not a gzip stream");
+
+    // StreamInput: a gzip file loads like the plain file
+    const string plainPath = "gzip_stream_test.csv", gzPath = "gzip_stream_test.csv.gz", cutPath = "gzip_stream_cut.csv.gz";
+    ofstream(plainPath, ios::binary) << csv;
+    ofstream(gzPath, ios::binary) << dynamicGz;
+    ofstream(cutPath, ios::binary) << fixedGz.substr(0, fixedGz.size() - 4);  // No length
+    assert(inv::isGzipFile(gzPath) && !inv::isGzipFile(plainPath) && !inv::isGzipFile("does_not_exist.csv"));
+
+    using Index = std::unordered_map<string, vector<string>>;
+    auto dump = [](const inv::HashTable<inv::Product> &table) {
+        std::map<string, string> rows;
+        table.forEach([&](const string &key, const inv::Product &p) {
+            ostringstream os;
+            inv::printProduct(p, os);
+            rows[key] = os.str();
+        });
+        return rows;
+    };
+    inv::HashTable<inv::Product> plainTable;
+    Index plainIndex;
+    assert(inv::loadCsv(plainPath, plainTable, plainIndex));
+    for (size_t parsers = 0; parsers <= 2; ++parsers) {
+        inv::StreamInput input;
+        assert(input.open(gzPath));
+        inv::HashTable<inv::Product> table;
+        Index index;
+        inv::LoadPipelineOptions options;
+        options.parsers = parsers;
+        assert(parsers ? inv::loadCsvPipelined(input.stream(), table, index, options) : inv::loadCsv(input.stream(), table, index));
+        assert(input.finish() && input.error().empty());
+        assert(index == plainIndex && dump(table) == dump(plainTable));
+        assert(input.stats().compressed && input.stats().inputBytes == dynamicGz.size() && input.stats().outputBytes == csv.size());
+    }
+    {
+        inv::StreamInput input;
+        assert(input.open(plainPath));
+        inv::HashTable<inv::Product> table;
+        Index index;
+        assert(inv::loadCsv(input.stream(), table, index) && input.finish());
+        assert(!input.stats().compressed && dump(table) == dump(plainTable));
+    }
+    {
+        inv::StreamInput input;
+        assert(input.open(cutPath));
+        string all((std::istreambuf_iterator<char>(input.stream())), std::istreambuf_iterator<char>());
+        assert(!input.finish() && input.error() == "truncated gzip trailer");
+        assert(all == window);
+    }
+    {
+        inv::StreamInput input;
+        assert(!input.open("does_not_exist.csv") && !input.finish());
+    }
+    {
+        // Abandoned early: the producer must not block on a full ring
+        inv::StreamInput input;
+        assert(input.open(cutPath));
+        char c;
+        assert(input.stream().get(c) && c == window[0]);
+    }
+    remove(plainPath.c_str());
+    remove(gzPath.c_str());
+    remove(cutPath.c_str());
+
+    // Engine: load(istream) == load(path)
+    ofstream(plainPath, ios::binary) << csv;
+    inv::Engine fromFile, fromStream;
+    std::istringstream in(csv);
+    assert(fromFile.load(plainPath) && fromStream.load(in));
+    remove(plainPath.c_str());
+    for (const char *cmd : {"find p4", "listInventory Toys", "listInventory Games"}) {
+        ostringstream a, b;
+        fromFile.evalCommand(cmd, a);
+        fromStream.evalCommand(cmd, b);
+        assert(a.str() == b.str());
+    }
+    std::istringstream empty;
+    assert(!fromStream.load(empty));
+}
+
+// ============================================================================
+// SMALL STRING TESTS
+// ============================================================================
+
+/**
+ * Test: SmallString inline/heap boundary, copies, moves and comparisons
+ * 
+ * Purpose: Validates that strings of up to 23 characters stay inline and
+ *          NUL-terminated, longer ones spill to the heap, and that copy,
+ *          move and reassignment across the boundary keep the contents.
+ * 
+ * Why chosen: Product's price, quantity, asin and stock fields are
+ *             SmallStrings, so the 23/24-character boundary (where the length
+ *             byte doubles as the terminator) must round-trip exactly.
+ */
+void test_small_string() {
+    inv::SmallString empty;
+    assert(empty.empty() && empty.size() == 0 && empty.isInline() && empty.c_str()[0] == '\0');
+
+    string s23(23, 'a'), s24(24, 'b');
+    inv::SmallString a(s23), b(s24);
+    assert(a.isInline() && a.size() == 23 && a == s23 && a.c_str()[23] == '\0');
+    assert(!b.isInline() && b.size() == 24 && b == s24 && b.str() == s24);
+
+    inv::SmallString c = b;   // Deep copy of a heap string
+    assert(c == b && c.data() != b.data());
+    inv::SmallString d = std::move(c);
+    assert(d == s24 && c.empty());
+    d = a;                    // Heap -> inline
+    assert(d.isInline() && d == a);
+    d = s24;                  // Inline -> heap
+    assert(!d.isInline() && d == s24);
+    d = "$1.99";
+    assert(d.isInline() && d == "$1.99" && d != "$1.98" && string(d) == "$1.99");
+
+    // Memory accounting counts only spilled buffers
+    inv::HeapBytes h;
+    inv::addString(h, a);
+    inv::addString(h, b);
+    assert(h.allocations == 1 && h.requested == 25);
+    assert(sizeof(inv::SmallString) < sizeof(string));
+}
+
+// ============================================================================
+// DESCRIPTION STORE TESTS
+// ============================================================================
+
+/**
+ * Test: LZ codec round trips and DescriptionStore retrieval across blocks
+ * 
+ * Purpose: Validates that compress/decompress restore empty, incompressible,
+ *          highly repetitive (overlapping matches, long length extensions)
+ *          and text-like inputs exactly, that corrupt input is rejected, and
+ *          that descriptions come back intact from sealed and open blocks.
+ * 
+ * Why chosen: Descriptions are only stored compressed, so any codec or
+ *             block-offset bug silently corrupts product output.
+ */
+void test_description_store() {
+    auto roundTrip = [](const string &in) {
+        string c = inv::lz::compress(in.data(), in.size());
+        string out(in.size(), '\0');
+        return inv::lz::decompress(c.data(), c.size(), &out[0], out.size()) && out == in;
+    };
+    string noise;
+    unsigned x = 12345;
+    for (int i = 0; i < 5000; ++i) { x = x * 1103515245u + 12345u; noise.push_back(static_cast<char>(x >> 16)); }
+    string text;
+    for (int i = 0; i < 300; ++i) text += "Product " + to_string(i % 17) + " is durable, lightweight and easy to clean. ";
+    assert(roundTrip(""));
+    assert(roundTrip("abc"));
+    assert(roundTrip(noise));
+    assert(roundTrip(string(100000, 'a')));  // Overlapping matches, length extensions, > one window
+    assert(roundTrip(text));
+    string c = inv::lz::compress(text.data(), text.size());
+    assert(c.size() < text.size() / 4);
+    string out(text.size(), '\0');
+    assert(!inv::lz::decompress(c.data(), c.size() / 2, &out[0], out.size()));  // Truncated input
+
+    inv::DescriptionStore store(1024, 2);  // Small blocks so descriptions span many of them
+    assert(store.add("") == inv::DescriptionStore::kNone);
+    vector<uint32_t> refs;
+    vector<string> texts;
+    for (int i = 0; i < 200; ++i) {
+        texts.push_back("Description " + to_string(i) + ": " + string(static_cast<size_t>(i % 50), 'z') + text.substr(0, static_cast<size_t>(i)));
+        refs.push_back(store.add(texts.back()));
+    }
+    assert(store.get(refs.back()) == texts.back());  // Still in the open block
+    store.seal();
+    assert(store.blockCount() > 10 && store.openBytes() == 0);
+    for (size_t i = 0; i < refs.size(); ++i) assert(store.get(refs[i]) == texts[i]);
+    assert(store.get(refs[0]) == texts[0] && store.cacheHits() > 0);
+    assert(store.get(inv::DescriptionStore::kNone).empty());
+}
+
+// ============================================================================
+// LAZY COLD FIELD TESTS
+// ============================================================================
+
+/**
+ * Test: Lazily parsed cold fields match an eager load
+ * 
+ * Purpose: Loads the same CSV eagerly and in lazy mode and checks that the
+ *          hot fields are identical, the cold fields are empty until filled,
+ *          and ColdFieldStore::fill() restores exactly what the eager load
+ *          parsed. The parsed-field cache must stay within its byte budget,
+ *          parse() and fill(p, false) must bypass it, and in an Engine the
+ *          mutation log and pre-rendering (whole-catalog passes) must leave
+ *          it empty while an erase drops the erased product's entry.
+ * 
+ * Why chosen: Lazy mode re-parses records by byte offset, so multi-line
+ *             records, quoted commas, a missing description (About Product
+ *             fallback) and a final line without newline must all keep the
+ *             offsets aligned.
+ */
+void test_lazy_cold_fields() {
+    const string path = "lazy_cold_fields_test.csv";
+    {
+        ofstream f(path, ios::binary);
+        f << "Uniq Id,Product Name,Asin,Category,Model Number,About Product,Stock,Product Description\n";
+        f << "a1,First,B0001,Toys | Games,M-1,about one,In Stock,\"Desc, with comma\"\n";
+        f << "a2,\"Second\nspans lines\",B0002,Toys,M-2,\"about\ntwo\",,\n";
+        f << "a3,Third,,Games,,,Out,\"Quoted \"\"desc\"\"\nover two lines\"";  // No final newline
+    }
+    inv::HashTable<inv::Product> eager, lazy;
+    unordered_map<string, vector<string>> eagerIndex, lazyIndex;
+    inv::ColdFieldStore cold;
+    assert(inv::loadCsv(path, eager, eagerIndex));
+    assert(inv::loadCsv(path, lazy, lazyIndex, nullptr, nullptr, &cold));
+    remove(path.c_str());
+    assert(eager.size() == 3 && lazy.size() == 3 && cold.size() == 3);
+    assert(eager.find("a2")->productDescription == "about two");  // About Product fallback
+
+    for (const char *id : {"a1", "a2", "a3"}) {
+        const inv::Product *e = eager.find(id);
+        inv::Product l = *lazy.find(id);
+        assert(l.productName == e->productName && l.category == e->category && l.stock == e->stock);
+        assert(l.asin.empty() && l.modelNumber.empty() && l.productDescription.empty());
+        cold.fill(l);
+        assert(l.asin == e->asin && l.modelNumber == e->modelNumber && l.productDescription == e->productDescription);
+    }
+    inv::Product again = *lazy.find("a3");
+    cold.fill(again);  // Served from the cache
+    assert(again.productDescription == "Quoted \"desc\" over two lines");
+
+    // The cache is bounded, bypassable and forgets replaced records
+    const size_t full = cold.cacheBytes();
+    assert(full > 3 * inv::ColdFieldStore::kEntryOverhead && full <= cold.cacheBudget());
+    const std::uint32_t a1 = lazy.find("a1")->sourceRef;
+    cold.forget(a1);
+    assert(cold.cacheBytes() < full);
+    const size_t afterForget = cold.cacheBytes();
+    assert(cold.parse(a1).asin == "B0001" && cold.cacheBytes() == afterForget);
+    inv::Product uncached = *lazy.find("a1");
+    cold.fill(uncached, false);
+    assert(uncached.modelNumber == "M-1" && cold.cacheBytes() == afterForget);
+    const size_t budget = inv::ColdFieldStore::kEntryOverhead + 40;
+    cold.setCacheBudget(budget);
+    for (int round = 0; round < 3; ++round) {
+        for (const char *id : {"a1", "a2", "a3"}) {
+            inv::Product l = *lazy.find(id);
+            cold.fill(l);
+            assert(l.productDescription == eager.find(id)->productDescription);
+            assert(cold.cacheBytes() <= budget);
+        }
+    }
+    cold.setCacheBudget(0);
+    assert(cold.cacheBytes() == 0);
+
+    // Engine: whole-catalog passes leave the cache alone; erase drops entries
+    {
+        ofstream f(path, ios::binary);
+        f << "Uniq Id,Product Name,Asin,Category,Model Number,Product Description\n";
+        f << "a1,First,B0001,Toys,M-1,one\na2,Second,B0002,Toys,M-2,two\n";
+    }
+    inv::Engine engine;
+    engine.setLazyColdFields(true);
+    engine.setPrerenderedOutput(true);
+    assert(engine.load(path));
+    auto memory = [&engine]() {
+        ostringstream os;
+        engine.evalCommand(":memory", os);
+        return os.str();
+    };
+    assert(engine.enableMutationLog());
+    assert(memory().find("(2 deferred, 0 cached)") != string::npos);
+    ostringstream found;
+    engine.setPrerenderedOutput(false);
+    engine.evalCommand("find a2", found);
+    assert(found.str().find("Model Number: M-2") != string::npos);
+    assert(memory().find("(2 deferred, 1 cached)") != string::npos);
+    assert(engine.eraseProduct("a2"));
+    assert(memory().find("(2 deferred, 0 cached)") != string::npos);
+    remove(path.c_str());
+}
+
 /**
  * Main test runner
  * 
@@ -245,6 +2030,9 @@ int main() {
     test_insert_update();
     cout << " test_insert_update passed\n";
     
+    test_move_insert_and_emplace();
+    cout << " test_move_insert_and_emplace passed\n";
+    
     test_find_missing();
     cout << " test_find_missing passed\n";
     
@@ -263,6 +2051,63 @@ int main() {
     test_template_insert_update_int();
     cout << " test_template_insert_update_int passed\n";
     
+    test_stats_consistent();
+    cout << " test_stats_consistent passed\n";
+    
+    test_memory_accounting();
+    cout << " test_memory_accounting passed\n";
+    
+    test_pool_allocator_churn();
+    cout << " test_pool_allocator_churn passed\n";
+    
+    test_miss_filter();
+    cout << " test_miss_filter passed\n";
+    
+    test_robin_hood_table();
+    cout << " test_robin_hood_table passed\n";
+    
+    test_cuckoo_table();
+    cout << " test_cuckoo_table passed\n";
+    
+    test_perfect_hash_table();
+    cout << " test_perfect_hash_table passed\n";
+
+    test_mapped_hash_table();
+    cout << " test_mapped_hash_table passed\n";
+
+    test_shared_catalog();
+    cout << " test_shared_catalog passed\n";
+
+    test_sharded_catalog();
+    cout << " test_sharded_catalog passed\n";
+
+    test_replication();
+    cout << " test_replication passed\n";
+
+    test_change_feed();
+    cout << " test_change_feed passed\n";
+
+    test_result_cache();
+    cout << " test_result_cache passed\n";
+    test_prerendered_output();
+    cout << " test_prerendered_output passed\n";
+    test_request_coalescing();
+    cout << " test_request_coalescing passed\n";
+    test_pipelined_load();
+    cout << " test_pipelined_load passed\n";
+    
+    test_gzip_stream();
+    cout << " test_gzip_stream passed\n";
+    
+    test_small_string();
+    cout << " test_small_string passed\n";
+    
+    test_description_store();
+    cout << " test_description_store passed\n";
+    
+    test_lazy_cold_fields();
+    cout << " test_lazy_cold_fields passed\n";
+    
     cout << "All tests passed.\n";
     return 0;
 }